@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <fstream>
+#include <filesystem>
+
+#include <esp_log.h>
+
+#include "server/http_server.h"
+#include "http_client.h"
+
+constexpr const uint16_t PORT = 18280;
+constexpr const size_t FILE_SIZE = 16U * 1024U;
+constexpr const size_t UPLOAD_SIZE = 4U * 1024U;
+constexpr const uint32_t UPLOAD_EVERY = 4U;
+
+// load harness for the worker pool: every client thread fetches a file and every fourth
+// request uploads one instead, so both priorities compete for the workers. next to the
+// client side rate it reports what the server measured, queue wait and service time
+// percentiles per route and how many requests were turned away with a 503.
+class worker_pool_fixture : public benchmark::Fixture
+{
+public:
+    void SetUp(const benchmark::State &state) override
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (state.thread_index() != 0)
+            return;
+
+        std::filesystem::create_directories(m_root);
+        std::ofstream(m_root / "app.js") << std::string(FILE_SIZE, 'x');
+
+        // every upload logs, that would be most of what this measures.
+        esp_log_level_set("http_server", ESP_LOG_WARN);
+
+        m_rejected = 0;
+        mp_server = std::make_unique<http_server>(PORT, m_root.string());
+    }
+
+    void TearDown(const benchmark::State &state) override
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (state.thread_index() != 0)
+            return;
+
+        mp_server.reset();
+        std::filesystem::remove_all(m_root);
+    }
+
+protected:
+    std::mutex m_mutex;
+    std::filesystem::path m_root = std::filesystem::temp_directory_path() / "rclink_bench_http_workers";
+    std::unique_ptr<http_server> mp_server;
+    std::atomic<uint32_t> m_rejected = 0;
+};
+
+BENCHMARK_DEFINE_F(worker_pool_fixture, mixed_load)(benchmark::State &state)
+{
+    http_client client(PORT);
+    http_response response;
+    const std::string upload(UPLOAD_SIZE, 'u');
+    const std::string upload_path = "/upload_" + std::to_string(state.thread_index()) + ".bin";
+    uint32_t requests = 0;
+
+    for (auto _ : state)
+    {
+        const bool is_upload = ++requests % UPLOAD_EVERY == 0;
+        const bool sent = is_upload ? client.request("POST", upload_path, upload, response) : client.get("/app.js", response);
+
+        if (!sent)
+        {
+            state.SkipWithError("request failed");
+            break;
+        }
+
+        if (response.status == 503)
+            m_rejected++;
+        else if (response.status != 200)
+        {
+            state.SkipWithError("unexpected status");
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() != 0)
+        return;
+
+    const auto statistics = mp_server->get_statistics();
+    const auto &files = statistics.routes[static_cast<size_t>(http_server::route::file)];
+    const auto &uploads = statistics.routes[static_cast<size_t>(http_server::route::upload)];
+
+    state.counters["rejected"] = m_rejected.load();
+    state.counters["max_queue_depth"] = statistics.max_queue_depth;
+    state.counters["file_wait_p50_us"] = files.wait_time_p50_us;
+    state.counters["file_wait_p99_us"] = files.wait_time_p99_us;
+    state.counters["file_service_p50_us"] = files.service_time_p50_us;
+    state.counters["file_service_p99_us"] = files.service_time_p99_us;
+    state.counters["upload_wait_p99_us"] = uploads.wait_time_p99_us;
+    state.counters["upload_service_p99_us"] = uploads.service_time_p99_us;
+}
+BENCHMARK_REGISTER_F(worker_pool_fixture, mixed_load)->ThreadRange(1, 8)->UseRealTime();
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <cstdlib>
+
+#include <tlvcpp/tlv_tree.h>
+
+#include "memory/memory_account.h"
+
+static memory_account bench_memory("bench");
+
+// what booking a block costs on top of the heap it comes from, for sizes from a tlv node
+// up to a firmware pipeline buffer.
+static void heap_allocate_release(benchmark::State &state)
+{
+    const size_t size = state.range(0);
+
+    for (auto _ : state)
+    {
+        void *allocated = malloc(size);
+
+        benchmark::DoNotOptimize(allocated);
+
+        free(allocated);
+    }
+}
+BENCHMARK(heap_allocate_release)->RangeMultiplier(8)->Range(16, 16384);
+
+static void account_allocate_release(benchmark::State &state)
+{
+    const size_t size = state.range(0);
+
+    for (auto _ : state)
+    {
+        void *allocated = bench_memory.allocate(size);
+
+        benchmark::DoNotOptimize(allocated);
+
+        bench_memory.release(allocated, size);
+    }
+}
+BENCHMARK(account_allocate_release)->RangeMultiplier(8)->Range(16, 16384);
+
+// a vector growing to size bytes one push at a time, reallocating along the way.
+template <typename buffer_type>
+static void grow_buffer(benchmark::State &state, buffer_type buffer)
+{
+    const size_t size = state.range(0);
+
+    for (auto _ : state)
+    {
+        buffer_type grown(buffer.get_allocator());
+
+        for (size_t i = 0; i < size; i++)
+            grown.push_back(static_cast<uint8_t>(i));
+
+        benchmark::DoNotOptimize(grown.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * size);
+}
+
+static void default_allocator_vector(benchmark::State &state)
+{
+    grow_buffer(state, std::vector<uint8_t>());
+}
+BENCHMARK(default_allocator_vector)->Arg(256)->Arg(4096);
+
+static void account_allocator_vector(benchmark::State &state)
+{
+    grow_buffer(state, std::vector<uint8_t, account_allocator<uint8_t>>(account_allocator<uint8_t>(bench_memory)));
+}
+BENCHMARK(account_allocator_vector)->Arg(256)->Arg(4096);
+
+static tlvcpp::tlv_tree_node message(const size_t size)
+{
+    tlvcpp::tlv_tree_node root;
+    std::vector<uint8_t> value(size, 0x5a);
+
+    root.add_child(0x42, value.size(), value.data());
+
+    return root;
+}
+
+// how the websocket server queues a message, serialized straight into the end of the
+// transmit buffer whose capacity the account tracks.
+static void transmit_in_place(benchmark::State &state)
+{
+    const auto node = message(state.range(0));
+    std::vector<uint8_t> buffer;
+
+    buffer.reserve(8192);
+
+    for (auto _ : state)
+    {
+        buffer.clear();
+        buffer.push_back(0);
+        buffer.push_back(0);
+
+        size_t bytes_written = 0;
+
+        benchmark::DoNotOptimize(node.serialize(buffer, &bytes_written));
+    }
+}
+BENCHMARK(transmit_in_place)->Arg(16)->Arg(1024);
+
+// and what allocating the buffer through account_allocator would cost instead, tlvcpp only
+// serializes into a plain vector so every message would go through a temporary.
+static void transmit_through_temporary(benchmark::State &state)
+{
+    const auto node = message(state.range(0));
+    std::vector<uint8_t, account_allocator<uint8_t>> buffer{account_allocator<uint8_t>(bench_memory)};
+
+    buffer.reserve(8192);
+
+    for (auto _ : state)
+    {
+        buffer.clear();
+
+        std::vector<uint8_t> serialized;
+        size_t bytes_written = 0;
+
+        serialized.reserve(state.range(0) + 16U);
+
+        benchmark::DoNotOptimize(node.serialize(serialized, &bytes_written));
+
+        const uint16_t size = bytes_written;
+
+        buffer.insert(buffer.end(), reinterpret_cast<const uint8_t *>(&size), reinterpret_cast<const uint8_t *>(&size) + sizeof(size));
+        buffer.insert(buffer.end(), serialized.begin(), serialized.end());
+    }
+}
+BENCHMARK(transmit_through_temporary)->Arg(16)->Arg(1024);
\ No newline at end of file
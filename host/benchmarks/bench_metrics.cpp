@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "metrics/metrics.h"
+
+static metric_counter shared_counter("bench_updates_total", "Counter every benchmark thread updates.");
+static metric_histogram<4> shared_histogram("bench_latency_us", "Histogram every benchmark thread observes.", {10, 100, 1000, 10000});
+
+// how much a counter update costs once several tasks hammer the same cache line, the worst
+// case of a hot metric like requests handled on both cores.
+static void counter_contention(benchmark::State &state)
+{
+    for (auto _ : state)
+        shared_counter.add();
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(counter_contention)->ThreadRange(1, 8)->UseRealTime();
+
+static void histogram_contention(benchmark::State &state)
+{
+    uint32_t value = state.thread_index();
+
+    for (auto _ : state)
+        shared_histogram.observe(value++ % 20000U);
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(histogram_contention)->ThreadRange(1, 8)->UseRealTime();
+
+// every registered metric through a buffer the size of the http server's metrics chunks.
+static void render_all(benchmark::State &state)
+{
+    std::vector<char> buffer(512);
+    size_t rendered = 0;
+
+    for (auto _ : state)
+    {
+        metric_writer writer(buffer.data(), buffer.size(), [&rendered](const char *, const size_t size)
+                             {
+                                 rendered += size;
+
+                                 return true; });
+
+        benchmark::DoNotOptimize(metric::render_all(writer));
+    }
+
+    state.SetBytesProcessed(rendered);
+}
+BENCHMARK(render_all);
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "object_pool.h"
+
+// every heap allocation this binary makes, so each benchmark can report its own. the
+// default operator delete frees with free() already.
+static std::atomic<size_t> allocations = 0;
+
+__attribute__((noinline)) void *operator new(const size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto pointer = std::malloc(size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+static memory_account pool_memory("bench_object_pool");
+
+constexpr const size_t CAPACITY = 256;
+constexpr const size_t CHUNK_SIZE = 8;
+
+// about what an lvgl image object takes.
+struct widget
+{
+    uint8_t state[96];
+};
+
+// reset_balls over and over: every ball goes away and as many come back.
+static void refill_new_delete(benchmark::State &state)
+{
+    const size_t count = state.range(0);
+    std::vector<widget *> balls;
+
+    balls.reserve(count);
+
+    const size_t initial = allocations;
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+            balls.push_back(new widget);
+
+        benchmark::DoNotOptimize(balls.data());
+
+        for (const auto ball : balls)
+            delete ball;
+
+        balls.clear();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["allocations_per_refill"] = static_cast<double>(allocations - initial) / state.iterations();
+}
+BENCHMARK(refill_new_delete)->RangeMultiplier(4)->Range(16, 256);
+
+static void refill_pool(benchmark::State &state)
+{
+    const size_t count = state.range(0);
+    object_pool<widget> pool(CAPACITY, CHUNK_SIZE, pool_memory);
+    std::vector<widget *> balls;
+
+    balls.reserve(count);
+
+    const size_t initial = allocations;
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+            balls.push_back(pool.acquire());
+
+        benchmark::DoNotOptimize(balls.data());
+
+        for (const auto ball : balls)
+            pool.release(ball);
+
+        balls.clear();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["allocations_per_refill"] = static_cast<double>(allocations - initial) / state.iterations();
+    state.counters["allocated"] = pool.statistics().allocated;
+}
+BENCHMARK(refill_pool)->RangeMultiplier(4)->Range(16, 256);
\ No newline at end of file
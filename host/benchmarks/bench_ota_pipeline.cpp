@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <esp_log.h>
+#include <esp_ota_ops.h>
+
+#include "host_shim.h"
+#include "server/ota_pipeline.h"
+
+constexpr const size_t IMAGE_SIZE = 128U * 1024U;
+constexpr const size_t BUFFER_SIZE = 4096U;
+constexpr const size_t RECEIVE_SIZE = 1024U;
+// roughly what the device receives over wifi, per KiB.
+constexpr const auto RECEIVE_TIME = std::chrono::microseconds(250);
+
+static memory_account benchmark_account("ota_benchmark");
+
+class ota_writer : public flash_writer
+{
+public:
+    ota_writer(const esp_ota_handle_t handle) : m_handle(handle) {}
+
+    bool write(const uint8_t *data, size_t size) override
+    {
+        return esp_ota_write(m_handle, data, size) == ESP_OK;
+    }
+
+private:
+    const esp_ota_handle_t m_handle;
+};
+
+// receives an image at a fixed rate while the flash is slower or faster than that. with a
+// single buffer receiving and writing take turns, with more they overlap and the update
+// only takes as long as the slower of the two.
+static void ota_update(benchmark::State &state)
+{
+    const size_t buffer_count = state.range(0);
+    std::vector<uint8_t> image(IMAGE_SIZE, 0x5a);
+
+    image[0] = 0xe9;
+
+    esp_log_level_set("ota_pipeline", ESP_LOG_WARN);
+
+    host_shim::set_running_image({});
+    host_shim::set_flash_write_delay(state.range(1));
+
+    for (auto _ : state)
+    {
+        esp_ota_handle_t handle = 0;
+
+        if (esp_ota_begin(esp_ota_get_next_update_partition(nullptr), OTA_WITH_SEQUENTIAL_WRITES, &handle) != ESP_OK)
+        {
+            state.SkipWithError("couldn't begin the ota session");
+            break;
+        }
+
+        ota_writer writer(handle);
+        ota_pipeline pipeline(writer, benchmark_account, BUFFER_SIZE, buffer_count);
+        bool written = !pipeline.failed();
+
+        for (size_t offset = 0; offset < image.size() && written; offset += RECEIVE_SIZE)
+        {
+            std::this_thread::sleep_for(RECEIVE_TIME);
+
+            written = pipeline.write(image.data() + offset, std::min(RECEIVE_SIZE, image.size() - offset));
+        }
+
+        written = pipeline.finish() && written;
+
+        esp_ota_abort(handle);
+
+        if (!written)
+        {
+            state.SkipWithError("the update failed");
+            break;
+        }
+    }
+
+    host_shim::set_flash_write_delay(0);
+
+    state.SetBytesProcessed(state.iterations() * IMAGE_SIZE);
+}
+BENCHMARK(ota_update)
+    ->ArgNames({"buffers", "flash_us_per_kib"})
+    ->ArgsProduct({{1, 2, 4}, {0, 250, 1000}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
\ No newline at end of file
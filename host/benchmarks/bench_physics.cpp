@@ -0,0 +1,227 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "physics/ball_storage.h"
+#include "physics/engine.h"
+#include "physics/kernels.h"
+#include "physics/spatial_grid.h"
+#include "physics/world.h"
+
+constexpr const float WIDTH = 320.0f;
+constexpr const float HEIGHT = 170.0f;
+constexpr const float TIMESTEP = 1.0f / 120;
+constexpr const uint64_t SEED = 1;
+
+constexpr const uint32_t DRIFT_STEPS = 10 * 120;
+
+// steps of a populated world, with the contacts it resolved and how far its kinetic energy
+// drifted over ten simulated seconds. collisions lose 1% and the walls nothing, so the
+// drift may only ever be negative.
+static void engine_step(benchmark::State &state)
+{
+    const size_t count = state.range(0);
+
+    engine simulated(WIDTH, HEIGHT, TIMESTEP, SEED);
+
+    simulated.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        simulated.spawn_ball();
+        simulated.step();
+    }
+
+    const float initial_energy = simulated.kinetic_energy();
+
+    simulated.step(DRIFT_STEPS);
+
+    const float energy_drift = simulated.kinetic_energy() / initial_energy - 1;
+    const auto initial = simulated.statistics();
+
+    for (auto _ : state)
+        simulated.step();
+
+    const auto &final = simulated.statistics();
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["balls"] = count;
+    state.counters["contacts_per_step"] = static_cast<double>(final.contacts - initial.contacts) / (final.steps - initial.steps);
+    state.counters["energy_drift"] = energy_drift;
+}
+BENCHMARK(engine_step)->RangeMultiplier(4)->Range(16, 1024);
+
+struct ball_positions
+{
+    std::vector<float> x;
+    std::vector<float> y;
+};
+
+static ball_positions scattered(const size_t count)
+{
+    std::mt19937 random(SEED);
+    std::uniform_real_distribution<float> x(world::BALL_RADIUS, WIDTH - world::BALL_RADIUS);
+    std::uniform_real_distribution<float> y(world::BALL_RADIUS, HEIGHT - world::BALL_RADIUS);
+    ball_positions positions;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        positions.x.push_back(x(random));
+        positions.y.push_back(y(random));
+    }
+
+    return positions;
+}
+
+static bool overlap(const ball_positions &positions, const size_t first, const size_t second)
+{
+    const float dx = positions.x[first] - positions.x[second];
+    const float dy = positions.y[first] - positions.y[second];
+
+    return dx * dx + dy * dy < 4 * world::BALL_RADIUS * world::BALL_RADIUS;
+}
+
+// the broad phase alone, finding the overlapping pairs of balls scattered over the screen:
+// the pair loop the world used before against the grid, which also pays for moving every
+// ball to its current cell.
+static void broad_phase_pairs(benchmark::State &state)
+{
+    const auto positions = scattered(state.range(0));
+    const size_t count = positions.x.size();
+    size_t overlapping = 0;
+
+    for (auto _ : state)
+    {
+        overlapping = 0;
+
+        for (size_t first = 0; first < count; first++)
+            for (size_t second = first + 1; second < count; second++)
+                overlapping += overlap(positions, first, second);
+
+        benchmark::DoNotOptimize(overlapping);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["overlapping"] = overlapping;
+    state.counters["candidates"] = count * (count - 1) / 2;
+}
+BENCHMARK(broad_phase_pairs)->RangeMultiplier(4)->Range(16, 1024);
+
+static void broad_phase_grid(benchmark::State &state)
+{
+    const auto positions = scattered(state.range(0));
+    const size_t count = positions.x.size();
+    spatial_grid grid(WIDTH, HEIGHT, 2 * world::BALL_RADIUS);
+    size_t overlapping = 0;
+    size_t candidates = 0;
+
+    grid.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+        grid.insert(i, positions.x[i], positions.y[i]);
+
+    for (auto _ : state)
+    {
+        overlapping = 0;
+        candidates = 0;
+
+        for (size_t i = 0; i < count; i++)
+            grid.update(i, positions.x[i], positions.y[i]);
+
+        grid.for_each_pair([&](const size_t first, const size_t second)
+                           {
+                               candidates++;
+                               overlapping += overlap(positions, first, second); });
+
+        benchmark::DoNotOptimize(overlapping);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.counters["overlapping"] = overlapping;
+    state.counters["candidates"] = candidates;
+}
+BENCHMARK(broad_phase_grid)->RangeMultiplier(4)->Range(16, 1024);
+
+// the per ball part of a step, bouncing off the walls and moving on, over the structure of
+// arrays the world keeps against the array of structures it had before.
+struct ball
+{
+    float x;
+    float y;
+    float vx;
+    float vy;
+};
+
+static void reflect_and_integrate(std::vector<ball> &balls, const float timestep)
+{
+    const float min = world::BALL_RADIUS;
+    const float max_x = WIDTH - world::BALL_RADIUS;
+    const float max_y = HEIGHT - world::BALL_RADIUS;
+
+    for (auto &ball : balls)
+    {
+        if ((ball.x < min && ball.vx < 0.0f) || (ball.x > max_x && ball.vx > 0.0f))
+            ball.vx = -ball.vx;
+
+        if ((ball.y < min && ball.vy < 0.0f) || (ball.y > max_y && ball.vy > 0.0f))
+            ball.vy = -ball.vy;
+
+        ball.x += ball.vx * timestep;
+        ball.y += ball.vy * timestep;
+    }
+}
+
+static std::vector<ball> moving(const size_t count)
+{
+    const auto positions = scattered(count);
+    std::mt19937 random(SEED);
+    std::uniform_real_distribution<float> velocity(-200.0f, 200.0f);
+    std::vector<ball> balls;
+
+    for (size_t i = 0; i < count; i++)
+        balls.push_back({positions.x[i], positions.y[i], velocity(random), velocity(random)});
+
+    return balls;
+}
+
+static void motion_array_of_structures(benchmark::State &state)
+{
+    auto balls = moving(state.range(0));
+
+    for (auto _ : state)
+    {
+        reflect_and_integrate(balls, TIMESTEP);
+
+        benchmark::DoNotOptimize(balls.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * balls.size());
+}
+BENCHMARK(motion_array_of_structures)->RangeMultiplier(4)->Range(16, 4096);
+
+static void motion_structure_of_arrays(benchmark::State &state)
+{
+    ball_storage balls;
+
+    for (const auto &ball : moving(state.range(0)))
+        balls.push_back(ball.x, ball.y, ball.vx, ball.vy);
+
+    const size_t count = balls.size();
+    const float min = world::BALL_RADIUS;
+
+    for (auto _ : state)
+    {
+        reflect(balls.x(), balls.vx(), count, min, WIDTH - world::BALL_RADIUS);
+        reflect(balls.y(), balls.vy(), count, min, HEIGHT - world::BALL_RADIUS);
+        integrate(balls.x(), balls.vx(), count, TIMESTEP);
+        integrate(balls.y(), balls.vy(), count, TIMESTEP);
+
+        benchmark::DoNotOptimize(balls.x());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(motion_structure_of_arrays)->RangeMultiplier(4)->Range(16, 4096);
\ No newline at end of file
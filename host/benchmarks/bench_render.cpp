@@ -0,0 +1,101 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+#include "physics/engine.h"
+#include "render/dirty_region.h"
+
+constexpr const float WIDTH = 320.0f;
+constexpr const float HEIGHT = 170.0f;
+constexpr const float TIMESTEP = 1.0f / 120;
+constexpr const uint64_t SEED = 1;
+constexpr const int32_t SPRITE_SIZE = 30;
+constexpr const int32_t SCREEN_AREA = static_cast<int32_t>(WIDTH * HEIGHT);
+
+static dirty_region::rect sprite_at(const float x, const float y)
+{
+    const int32_t left = std::lround(x) - SPRITE_SIZE / 2;
+    const int32_t top = std::lround(y) - SPRITE_SIZE / 2;
+
+    return {left, top, left + SPRITE_SIZE - 1, top + SPRITE_SIZE - 1};
+}
+
+constexpr const size_t FRAME_COUNT = 240;
+
+// the sprites each frame marks, where every ball that moved was and where it is now.
+static std::vector<std::vector<dirty_region::rect>> record_frames(const size_t count)
+{
+    engine simulated(WIDTH, HEIGHT, TIMESTEP, SEED);
+
+    simulated.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+        simulated.spawn_ball();
+
+    simulated.step(120);
+
+    std::vector<dirty_region::rect> previous;
+    std::vector<std::vector<dirty_region::rect>> frames(FRAME_COUNT);
+
+    for (size_t i = 0; i < count; i++)
+        previous.push_back(sprite_at(simulated.balls().x()[i], simulated.balls().y()[i]));
+
+    for (auto &frame : frames)
+    {
+        simulated.step();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const auto next = sprite_at(simulated.balls().x()[i], simulated.balls().y()[i]);
+
+            if (next.x1 == previous[i].x1 && next.y1 == previous[i].y1)
+                continue;
+
+            frame.push_back(previous[i]);
+            frame.push_back(next);
+
+            previous[i] = next;
+        }
+    }
+
+    return frames;
+}
+
+// a frame of the ball layer, merging what it marked into at most max_rects rectangles.
+// separate is what invalidating each sprite on its own added up to before the merging.
+static void invalidate_frame(benchmark::State &state)
+{
+    const auto frames = record_frames(state.range(0));
+
+    dirty_region region(state.range(1));
+    size_t frame = 0;
+    int64_t merged = 0;
+    int64_t separate = 0;
+    int64_t rects = 0;
+
+    for (auto _ : state)
+    {
+        for (const auto &area : frames[frame])
+        {
+            region.add(area);
+
+            separate += area.area();
+        }
+
+        merged += region.area();
+        rects += region.rects().size();
+        frame = (frame + 1) % frames.size();
+
+        region.clear();
+    }
+
+    const double iterations = state.iterations();
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["invalidated_per_frame"] = merged / iterations;
+    state.counters["separate_per_frame"] = separate / iterations;
+    state.counters["screen_fraction"] = merged / iterations / SCREEN_AREA;
+    state.counters["rects_per_frame"] = rects / iterations;
+}
+BENCHMARK(invalidate_frame)->ArgsProduct({{4, 8, 16, 32}, {1, 4, 16, 64}})->ArgNames({"balls", "max_rects"});
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+
+#include "hud/status_source.h"
+#include "sensors/sensor_service.h"
+
+constexpr const uint32_t INTERVAL = 200;
+constexpr const float WEIGHT = 0.1f;
+constexpr const int32_t THRESHOLD = 20;
+constexpr const int STARTUP_READS = 10;
+
+// stands in for the battery's adc conversion, which isn't part of the host build. the
+// argument is how long a read takes in microseconds.
+static int32_t read_battery(const int64_t latency_us)
+{
+    const auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(latency_us);
+
+    while (std::chrono::steady_clock::now() < until)
+        ;
+
+    return 3900;
+}
+
+class null_stream : public data_stream
+{
+public:
+    data_stream &operator>>(tlvcpp::tlv_tree_node &) override { return *this; }
+    data_stream &operator<<(const tlvcpp::tlv_tree_node &) override { return *this; }
+};
+
+// the ui task's share of the battery field before the sensor service: ten reads to settle
+// the average in on_create, then a read and the average on every hud update.
+static void hud_battery_inline(benchmark::State &state)
+{
+    const int64_t latency_us = state.range(0);
+    status_source<uint32_t> battery_voltage;
+    uint32_t voltage_level = 0;
+
+    const auto started_at = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < STARTUP_READS; i++)
+        voltage_level = 0.9f * voltage_level + 0.1f * read_battery(latency_us);
+
+    const std::chrono::duration<double, std::micro> startup = std::chrono::steady_clock::now() - started_at;
+
+    for (auto _ : state)
+    {
+        voltage_level = 0.9f * voltage_level + 0.1f * read_battery(latency_us);
+
+        battery_voltage.set(voltage_level);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["startup_us"] = startup.count();
+}
+BENCHMARK(hud_battery_inline)->Arg(0)->Arg(20)->Arg(100);
+
+// and with it, the reads happen on the sensor task and the hud only picks up the latest value.
+static void hud_battery_service(benchmark::State &state)
+{
+    const int64_t latency_us = state.range(0);
+    null_stream stream;
+    sensor_service sensors(stream);
+    status_source<uint32_t> battery_voltage;
+
+    auto read = [latency_us]()
+    {
+        return read_battery(latency_us);
+    };
+
+    const auto started_at = std::chrono::steady_clock::now();
+
+    sensors.add(sensor::battery, {.interval = INTERVAL, .weight = WEIGHT, .threshold = THRESHOLD, .read = read});
+    sensors.start();
+
+    const std::chrono::duration<double, std::micro> startup = std::chrono::steady_clock::now() - started_at;
+
+    for (auto _ : state)
+        if (sensors.ready(sensor::battery))
+            battery_voltage.set(sensors.latest(sensor::battery));
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["startup_us"] = startup.count();
+}
+BENCHMARK(hud_battery_service)->Arg(0)->Arg(20)->Arg(100);
\ No newline at end of file
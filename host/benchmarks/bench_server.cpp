@@ -0,0 +1,257 @@
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+#include "server/http_server.h"
+#include "server/websocket_server.h"
+#include "http_client.h"
+#include "websocket_client.h"
+
+constexpr const uint16_t HTTP_PORT = 18180;
+constexpr const uint16_t WEBSOCKET_PORT = 18181;
+constexpr const size_t MAX_BATCH_SIZE = 64;
+// the server drops whatever doesn't fit its receive buffer, a batch has to fit in there.
+constexpr const size_t RECEIVE_BUFFER_SIZE = 4U * 1024U;
+
+using benchmark_clock = std::chrono::steady_clock;
+
+static tlvcpp::tlv_tree_node message(const uint32_t tag, const size_t size)
+{
+    tlvcpp::tlv_tree_node root;
+    std::vector<uint8_t> value(size, static_cast<uint8_t>(tag));
+
+    root.add_child(tag, value.size(), value.data());
+
+    return root;
+}
+
+// p50/p90/p99 of the samples in microseconds, next to the rates google benchmark reports.
+static void report_percentiles(benchmark::State &state, std::vector<double> &samples, const benchmark::Counter::Flags flags = benchmark::Counter::kDefaults)
+{
+    if (samples.empty())
+        return;
+
+    std::sort(samples.begin(), samples.end());
+
+    const auto percentile = [&samples](const double fraction)
+    {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()))];
+    };
+
+    state.counters["p50_us"] = benchmark::Counter(percentile(0.50), flags);
+    state.counters["p90_us"] = benchmark::Counter(percentile(0.90), flags);
+    state.counters["p99_us"] = benchmark::Counter(percentile(0.99), flags);
+}
+
+static double elapsed_us(const benchmark_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(benchmark_clock::now() - start).count();
+}
+
+static bool connect(websocket_client &client)
+{
+    if (!client.connect(WEBSOCKET_PORT))
+        return false;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    return true;
+}
+
+// client to server: batches of messages in one frame, drained by polling like the dispatch
+// worker does.
+static void websocket_receive(benchmark::State &state)
+{
+    websocket_server server(WEBSOCKET_PORT);
+    websocket_client client;
+
+    if (!connect(client))
+    {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    const auto framed = websocket_client::frame(message(0x10, state.range(0)));
+    const size_t batch_size = std::clamp(RECEIVE_BUFFER_SIZE / framed.size(), size_t(1), MAX_BATCH_SIZE);
+    std::vector<uint8_t> batch;
+
+    for (size_t i = 0; i < batch_size; i++)
+        batch.insert(batch.end(), framed.begin(), framed.end());
+
+    for (auto _ : state)
+    {
+        if (!client.send(batch, 1024))
+        {
+            state.SkipWithError("send failed");
+            break;
+        }
+
+        size_t received = 0;
+
+        while (received < batch_size)
+        {
+            tlvcpp::tlv_tree_node node;
+
+            server >> node;
+            received += node.children().size();
+
+            if (node.children().empty())
+                std::this_thread::yield();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch_size);
+    state.SetBytesProcessed(state.iterations() * batch.size());
+}
+BENCHMARK(websocket_receive)->Arg(16)->Arg(256)->Arg(2048)->UseRealTime();
+
+// server to client, through the tx buffer and its chunked frames.
+static void websocket_send(benchmark::State &state)
+{
+    websocket_server server(WEBSOCKET_PORT);
+    websocket_client client;
+
+    if (!connect(client))
+    {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    const auto node = message(0x20, state.range(0));
+
+    for (auto _ : state)
+    {
+        server << node;
+
+        tlvcpp::tlv_tree_node received;
+
+        if (!client.receive(received))
+        {
+            state.SkipWithError("receive failed");
+            break;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(websocket_send)->Arg(16)->Arg(256)->Arg(2048)->UseRealTime();
+
+// one message there and back, the latency a controller sees.
+static void websocket_round_trip(benchmark::State &state)
+{
+    websocket_server server(WEBSOCKET_PORT);
+    websocket_client client;
+
+    if (!connect(client))
+    {
+        state.SkipWithError("connect failed");
+        return;
+    }
+
+    const auto framed = websocket_client::frame(message(0x30, state.range(0)));
+    std::vector<double> samples;
+
+    for (auto _ : state)
+    {
+        const auto start = benchmark_clock::now();
+
+        if (!client.send(framed))
+        {
+            state.SkipWithError("send failed");
+            break;
+        }
+
+        tlvcpp::tlv_tree_node node;
+
+        while (node.children().empty())
+        {
+            server >> node;
+
+            if (node.children().empty())
+                std::this_thread::yield();
+        }
+
+        server << node;
+
+        tlvcpp::tlv_tree_node echoed;
+
+        if (!client.receive(echoed))
+        {
+            state.SkipWithError("receive failed");
+            break;
+        }
+
+        samples.push_back(elapsed_us(start));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    report_percentiles(state, samples);
+}
+BENCHMARK(websocket_round_trip)->Arg(16)->Arg(2048)->UseRealTime();
+
+// a file served to several keep-alive clients at once, the percentiles are averaged over the
+// client threads.
+class http_fixture : public benchmark::Fixture
+{
+public:
+    void SetUp(const benchmark::State &state) override
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (state.thread_index() != 0)
+            return;
+
+        std::filesystem::create_directories(m_root);
+        std::ofstream(m_root / "app.js") << std::string(state.range(0), 'x');
+
+        mp_server = std::make_unique<http_server>(HTTP_PORT, m_root.string());
+    }
+
+    void TearDown(const benchmark::State &state) override
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (state.thread_index() != 0)
+            return;
+
+        mp_server.reset();
+        std::filesystem::remove_all(m_root);
+    }
+
+protected:
+    std::mutex m_mutex;
+    std::filesystem::path m_root = std::filesystem::temp_directory_path() / "rclink_bench_server";
+    std::unique_ptr<http_server> mp_server;
+};
+
+BENCHMARK_DEFINE_F(http_fixture, http_get)(benchmark::State &state)
+{
+    http_client client(HTTP_PORT);
+    http_response response;
+    std::vector<double> samples;
+
+    for (auto _ : state)
+    {
+        const auto start = benchmark_clock::now();
+
+        if (!client.get("/app.js", response) || response.status != 200)
+        {
+            state.SkipWithError("request failed");
+            break;
+        }
+
+        samples.push_back(elapsed_us(start));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    report_percentiles(state, samples, benchmark::Counter::kAvgThreads);
+}
+BENCHMARK_REGISTER_F(http_fixture, http_get)->Arg(512)->Arg(65536)->Threads(1)->Threads(4)->UseRealTime();
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+constexpr const size_t SPRITE_COUNT = 8;
+constexpr const size_t INITIAL_BALLS = 25;
+constexpr const size_t CHANNELS = 4;
+
+static std::string sprite_path(const size_t index)
+{
+    return RCLINK_SOURCE_DIRECTORY "/main/sprites/ball_" + std::to_string(index) + ".png";
+}
+
+static uint32_t read_u32(const uint8_t *data)
+{
+    return (data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+static uint8_t paeth(const int a, const int b, const int c)
+{
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+
+    if (pa <= pb && pa <= pc)
+        return a;
+
+    return pb <= pc ? b : c;
+}
+
+// roughly what lvgl's png decoder did for every new ball: read the file, inflate it and
+// undo the row filters. only the 8 bit rgba the sprites are stored as is handled.
+static bool decode_png(const std::string &path, std::vector<uint8_t> &pixels)
+{
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), {});
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> compressed;
+
+    for (size_t offset = 8; offset + 12 <= data.size();)
+    {
+        const uint32_t length = read_u32(&data[offset]);
+        const auto kind = &data[offset + 4];
+        const auto chunk = &data[offset + 8];
+
+        if (!std::memcmp(kind, "IHDR", 4))
+        {
+            width = read_u32(chunk);
+            height = read_u32(chunk + 4);
+        }
+        else if (!std::memcmp(kind, "IDAT", 4))
+            compressed.insert(compressed.end(), chunk, chunk + length);
+
+        offset += 12 + length;
+    }
+
+    const size_t stride = width * CHANNELS;
+    std::vector<uint8_t> filtered(height * (stride + 1));
+    uLongf filtered_size = filtered.size();
+
+    if (uncompress(filtered.data(), &filtered_size, compressed.data(), compressed.size()) != Z_OK)
+        return false;
+
+    pixels.resize(height * stride);
+
+    for (size_t y = 0; y < height; y++)
+    {
+        const uint8_t kind = filtered[y * (stride + 1)];
+        const uint8_t *source = &filtered[y * (stride + 1) + 1];
+        uint8_t *row = &pixels[y * stride];
+        const uint8_t *previous = y ? row - stride : nullptr;
+
+        for (size_t i = 0; i < stride; i++)
+        {
+            const int left = i >= CHANNELS ? row[i - CHANNELS] : 0;
+            const int up = previous ? previous[i] : 0;
+            const int up_left = previous && i >= CHANNELS ? previous[i - CHANNELS] : 0;
+            int predicted = 0;
+
+            if (kind == 1)
+                predicted = left;
+            else if (kind == 2)
+                predicted = up;
+            else if (kind == 3)
+                predicted = (left + up) >> 1;
+            else if (kind == 4)
+                predicted = paeth(left, up, up_left);
+
+            row[i] = source[i] + predicted;
+        }
+    }
+
+    return true;
+}
+
+// reset_balls before the atlas, every ball decoding its sprite from the filesystem.
+static void reset_balls_png(benchmark::State &state)
+{
+    std::vector<uint8_t> pixels;
+
+    for (auto _ : state)
+        for (size_t i = 0; i < INITIAL_BALLS; i++)
+        {
+            if (!decode_png(sprite_path(i % SPRITE_COUNT), pixels))
+            {
+                state.SkipWithError("couldn't decode sprite!");
+
+                return;
+            }
+
+            benchmark::DoNotOptimize(pixels.data());
+        }
+
+    state.SetItemsProcessed(state.iterations() * INITIAL_BALLS);
+}
+BENCHMARK(reset_balls_png);
+
+// and with it, the pixels are already decoded in rodata. lvgl reads them in place, reading
+// every sprite once is an upper bound of what adding a ball costs now.
+static void reset_balls_atlas(benchmark::State &state)
+{
+    std::vector<std::vector<uint8_t>> atlas(SPRITE_COUNT);
+
+    for (size_t i = 0; i < SPRITE_COUNT; i++)
+        decode_png(sprite_path(i), atlas[i]);
+
+    uint32_t checksum = 0;
+
+    for (auto _ : state)
+        for (size_t i = 0; i < INITIAL_BALLS; i++)
+        {
+            for (const auto value : atlas[i % SPRITE_COUNT])
+                checksum += value;
+
+            benchmark::DoNotOptimize(checksum);
+        }
+
+    state.SetItemsProcessed(state.iterations() * INITIAL_BALLS);
+}
+BENCHMARK(reset_balls_atlas);
\ No newline at end of file
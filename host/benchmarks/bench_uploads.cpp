@@ -0,0 +1,159 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include <esp_log.h>
+#include <esp_rom_md5.h>
+#include <mbedtls/sha256.h>
+
+#include "server/http_server.h"
+#include "http_client.h"
+
+constexpr const uint16_t PORT = 18480;
+constexpr const size_t CHUNK_SIZE = 1024U;
+
+// how long persisting a large upload takes. the first two replay what persist_file does per
+// received chunk without the http around it: writing the file and reading it all back to hash
+// it like it used to, against hashing every chunk on its way to the file like it does now. the
+// host's page cache answers the read back from memory, on littlefs it's a second pass over
+// flash, so the host only shows the lower bound of the difference. the single pass also
+// computes the sha256 the response carries now, the second argument turns it off to compare
+// like for like. the last one is the whole upload through the server.
+static const std::filesystem::path ROOT = std::filesystem::temp_directory_path() / "rclink_bench_uploads";
+
+static std::vector<uint8_t> upload_data(const size_t size)
+{
+    std::vector<uint8_t> data(size);
+
+    for (size_t i = 0; i < size; i++)
+        data[i] = static_cast<uint8_t>(i * 31U);
+
+    return data;
+}
+
+static void write_then_rehash(benchmark::State &state)
+{
+    const auto data = upload_data(state.range(0));
+    const auto path = (ROOT / "rehashed.bin").string();
+    uint8_t buffer[CHUNK_SIZE];
+    uint8_t digest[16];
+
+    std::filesystem::create_directories(ROOT);
+
+    for (auto _ : state)
+    {
+        FILE *file = fopen(path.c_str(), "w");
+
+        for (size_t offset = 0; offset < data.size(); offset += CHUNK_SIZE)
+            fwrite(data.data() + offset, 1, std::min(CHUNK_SIZE, data.size() - offset), file);
+
+        fclose(file);
+
+        md5_context_t md5_context;
+
+        esp_rom_md5_init(&md5_context);
+
+        file = fopen(path.c_str(), "r");
+
+        for (size_t read = 0; (read = fread(buffer, 1, sizeof(buffer), file)) > 0;)
+            esp_rom_md5_update(&md5_context, buffer, read);
+
+        fclose(file);
+
+        esp_rom_md5_final(digest, &md5_context);
+
+        benchmark::DoNotOptimize(digest);
+    }
+
+    state.SetBytesProcessed(state.iterations() * data.size());
+
+    std::filesystem::remove_all(ROOT);
+}
+BENCHMARK(write_then_rehash)->Arg(64 << 10)->Arg(1 << 20)->Arg(4 << 20)->UseRealTime();
+
+static void hash_while_writing(benchmark::State &state)
+{
+    const auto data = upload_data(state.range(0));
+    const bool with_sha256 = state.range(1);
+    const auto temporary_path = (ROOT / "streamed.bin.tmp").string();
+    const auto path = (ROOT / "streamed.bin").string();
+    uint8_t md5_digest[16];
+    uint8_t sha256_digest[32];
+
+    std::filesystem::create_directories(ROOT);
+
+    for (auto _ : state)
+    {
+        md5_context_t md5_context;
+        mbedtls_sha256_context sha256_context;
+
+        esp_rom_md5_init(&md5_context);
+        mbedtls_sha256_init(&sha256_context);
+        mbedtls_sha256_starts(&sha256_context, 0);
+
+        FILE *file = fopen(temporary_path.c_str(), "w");
+
+        for (size_t offset = 0; offset < data.size(); offset += CHUNK_SIZE)
+        {
+            const size_t size = std::min(CHUNK_SIZE, data.size() - offset);
+
+            fwrite(data.data() + offset, 1, size, file);
+            esp_rom_md5_update(&md5_context, data.data() + offset, size);
+
+            if (with_sha256)
+                mbedtls_sha256_update(&sha256_context, data.data() + offset, size);
+        }
+
+        fclose(file);
+        rename(temporary_path.c_str(), path.c_str());
+
+        esp_rom_md5_final(md5_digest, &md5_context);
+        mbedtls_sha256_finish(&sha256_context, sha256_digest);
+        mbedtls_sha256_free(&sha256_context);
+
+        benchmark::DoNotOptimize(md5_digest);
+        benchmark::DoNotOptimize(sha256_digest);
+    }
+
+    state.SetBytesProcessed(state.iterations() * data.size());
+
+    std::filesystem::remove_all(ROOT);
+}
+BENCHMARK(hash_while_writing)->ArgsProduct({{64 << 10, 1 << 20, 4 << 20}, {0, 1}})->UseRealTime();
+
+static void upload(benchmark::State &state)
+{
+    const auto data = upload_data(state.range(0));
+    const std::string body(data.begin(), data.end());
+
+    std::filesystem::create_directories(ROOT);
+
+    // every upload logs.
+    esp_log_level_set("http_server", ESP_LOG_WARN);
+
+    {
+        http_server server(PORT, ROOT.string());
+        http_client client(PORT);
+        http_response response;
+
+        for (auto _ : state)
+            if (!client.request("POST", "/uploaded.bin", body, response) || response.status != 200)
+            {
+                state.SkipWithError("upload failed");
+                break;
+            }
+
+        const auto &uploads = server.get_statistics().routes[static_cast<size_t>(http_server::route::upload)];
+
+        state.counters["service_p50_us"] = uploads.service_time_p50_us;
+        state.counters["service_p99_us"] = uploads.service_time_p99_us;
+    }
+
+    state.SetBytesProcessed(state.iterations() * data.size());
+
+    std::filesystem::remove_all(ROOT);
+}
+BENCHMARK(upload)->Arg(64 << 10)->Arg(1 << 20)->Arg(4 << 20)->UseRealTime();
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+#include <lua.hpp>
+
+#include "scripting/lua_heap.h"
+
+constexpr const size_t LIMIT = 512U * 1024U;
+
+// what a script does every frame, a few hundred short lived tables and strings.
+constexpr const char *FRAME_SCRIPT = R"(
+    kept = {}
+
+    function frame(n)
+        local points = {}
+
+        for i = 1, 200 do
+            points[i] = {x = i, y = n, label = 'p' .. i}
+        end
+
+        kept[n % 4 + 1] = points
+
+        return #points
+    end
+)";
+
+static memory_account benchmark_account("lua_benchmark");
+
+using benchmark_clock = std::chrono::steady_clock;
+
+static void report_pauses(benchmark::State &state, std::vector<double> &pauses)
+{
+    std::sort(pauses.begin(), pauses.end());
+
+    const auto percentile = [&pauses](const double fraction)
+    {
+        return pauses[std::min(pauses.size() - 1, static_cast<size_t>(fraction * pauses.size()))];
+    };
+
+    state.counters["pause_p50_us"] = percentile(0.50);
+    state.counters["pause_p99_us"] = percentile(0.99);
+    state.counters["pause_max_us"] = pauses.back();
+}
+
+static bool call_frame(lua_State *state, const lua_Integer n)
+{
+    lua_getglobal(state, "frame");
+    lua_pushinteger(state, n);
+
+    return lua_pcall(state, 1, 0, 0) == LUA_OK;
+}
+
+// the firmware's setup: the collector only runs from collect() with a budget per frame.
+static void lua_heap_frames(benchmark::State &state)
+{
+    lua_heap heap(LIMIT, benchmark_account, memory_placement::internal);
+    lua_State *lua = lua_newstate(lua_heap::allocate, &heap);
+
+    luaL_openlibs(lua);
+    heap.attach(lua);
+
+    if (luaL_dostring(lua, FRAME_SCRIPT))
+    {
+        state.SkipWithError("script failed");
+        lua_close(lua);
+        return;
+    }
+
+    std::vector<double> pauses;
+    lua_Integer n = 0;
+
+    for (auto _ : state)
+    {
+        if (!call_frame(lua, n++))
+        {
+            state.SkipWithError("frame failed");
+            break;
+        }
+
+        heap.collect(state.range(0));
+
+        pauses.push_back(heap.statistics().last_pause);
+    }
+
+    const auto &statistics = heap.statistics();
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["peak_kib"] = statistics.peak / 1024.0;
+    state.counters["peak_reserved_kib"] = statistics.peak_reserved / 1024.0;
+    state.counters["cycles"] = statistics.cycles;
+    report_pauses(state, pauses);
+
+    lua_close(lua);
+}
+BENCHMARK(lua_heap_frames)->Arg(100)->Arg(500)->Arg(2000);
+
+struct counting_allocator
+{
+    size_t in_use = 0;
+    size_t peak = 0;
+
+    static void *allocate(void *user_data, void *pointer, size_t old_size, size_t new_size)
+    {
+        auto &self = *static_cast<counting_allocator *>(user_data);
+
+        if (!pointer)
+            old_size = 0;
+
+        if (!new_size)
+        {
+            free(pointer);
+            self.in_use -= old_size;
+
+            return nullptr;
+        }
+
+        void *allocated = realloc(pointer, new_size);
+
+        if (allocated)
+        {
+            self.in_use += new_size - old_size;
+            self.peak = std::max(self.peak, self.in_use);
+        }
+
+        return allocated;
+    }
+};
+
+// baseline: malloc and lua's own incremental collector, which runs inside the allocations
+// so its pauses land in the frames themselves.
+static void stock_allocator_frames(benchmark::State &state)
+{
+    counting_allocator allocator;
+    lua_State *lua = lua_newstate(counting_allocator::allocate, &allocator);
+
+    luaL_openlibs(lua);
+
+    if (luaL_dostring(lua, FRAME_SCRIPT))
+    {
+        state.SkipWithError("script failed");
+        lua_close(lua);
+        return;
+    }
+
+    std::vector<double> frame_times;
+    lua_Integer n = 0;
+
+    for (auto _ : state)
+    {
+        const auto started_at = benchmark_clock::now();
+
+        if (!call_frame(lua, n++))
+        {
+            state.SkipWithError("frame failed");
+            break;
+        }
+
+        frame_times.push_back(std::chrono::duration<double, std::micro>(benchmark_clock::now() - started_at).count());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["peak_kib"] = allocator.peak / 1024.0;
+    report_pauses(state, frame_times);
+
+    lua_close(lua);
+}
+BENCHMARK(stock_allocator_frames);
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <benchmark/benchmark.h>
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+
+#include <lua.hpp>
+
+#include "scripting/message_bindings.h"
+
+// every allocation the c++ side makes, receiving a message shouldn't need more than the
+// decoded tree itself. kept out of line so gcc doesn't pair the malloc with the deletes.
+static std::atomic<size_t> heap_allocations = 0;
+
+[[gnu::noinline]] void *operator new(size_t size)
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (void *allocated = malloc(size ? size : 1))
+        return allocated;
+
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+struct counting_allocator
+{
+    size_t allocations = 0;
+
+    static void *allocate(void *user_data, void *pointer, size_t old_size, size_t new_size)
+    {
+        auto &self = *static_cast<counting_allocator *>(user_data);
+
+        if (!new_size)
+        {
+            free(pointer);
+
+            return nullptr;
+        }
+
+        if (!pointer || new_size > old_size)
+            self.allocations++;
+
+        return realloc(pointer, new_size);
+    }
+};
+
+class null_stream : public data_stream
+{
+public:
+    data_stream &operator>>(tlvcpp::tlv_tree_node &node) override { return *this; }
+    data_stream &operator<<(const tlvcpp::tlv_tree_node &node) override { return *this; }
+};
+
+// a joystick sample like the controller sends it, x and y as children of one message.
+static tlvcpp::tlv_tree_node joystick_message()
+{
+    const uint16_t values[] = {512, 384};
+    tlvcpp::tlv_tree_node root;
+    auto &message = root.add_child(0x10);
+
+    message.add_child(0x01, sizeof(values[0]), reinterpret_cast<const uint8_t *>(&values[0]));
+    message.add_child(0x02, sizeof(values[1]), reinterpret_cast<const uint8_t *>(&values[1]));
+
+    return root;
+}
+
+static const char *const HANDLERS[] = {
+    // only the top level node, served by the reused root view.
+    R"(on_message(0x10, function(view) last = view:tag() end))",
+    // each find() hands out a view of its own.
+    R"(on_message(0x10, function(view) x, y = view:find(0x01):u16(), view:find(0x02):u16() end))",
+    // what the views replace, the whole message copied into a lua string.
+    R"(on_message(0x10, function(view) last = view:child(1):value() .. view:child(2):value() end))",
+};
+
+static void message_dispatch(benchmark::State &state)
+{
+    counting_allocator allocator;
+    lua_State *lua = lua_newstate(counting_allocator::allocate, &allocator);
+    null_stream stream;
+
+    luaL_openlibs(lua);
+
+    {
+        scheduler tasks(lua);
+        message_bindings bindings(lua, stream, tasks);
+
+        if (luaL_dostring(lua, HANDLERS[state.range(0)]))
+        {
+            state.SkipWithError("handler failed to load");
+            return;
+        }
+
+        const auto prototype = joystick_message();
+        size_t lua_allocations = 0;
+        size_t cpp_allocations = 0;
+
+        // lua's collector is left on its defaults, it runs inside the handlers like it would
+        // without a frame budget.
+        for (auto _ : state)
+        {
+            auto received = prototype;
+            const size_t lua_before = allocator.allocations;
+            const size_t cpp_before = heap_allocations.load(std::memory_order_relaxed);
+
+            bindings.post(std::move(received));
+            bindings.dispatch();
+
+            lua_allocations += allocator.allocations - lua_before;
+            cpp_allocations += heap_allocations.load(std::memory_order_relaxed) - cpp_before;
+        }
+
+        state.SetItemsProcessed(state.iterations());
+        state.counters["lua_allocations_per_message"] = benchmark::Counter(lua_allocations, benchmark::Counter::kAvgIterations);
+        state.counters["heap_allocations_per_message"] = benchmark::Counter(cpp_allocations, benchmark::Counter::kAvgIterations);
+    }
+
+    lua_close(lua);
+}
+BENCHMARK(message_dispatch)->ArgName("handler")->DenseRange(0, 2);
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <lua.hpp>
+
+// what run_script() saves by loading a script from its bytecode cache instead of compiling
+// the source: the time to load the chunk and the peak lua heap while doing it, which is what
+// limits a script's size on the device. the chunks aren't run, only loaded.
+struct peak_allocator
+{
+    size_t current = 0;
+    size_t peak = 0;
+
+    static void *allocate(void *user_data, void *pointer, size_t old_size, size_t new_size)
+    {
+        auto &self = *static_cast<peak_allocator *>(user_data);
+
+        // lua passes the type instead of the old size for new blocks.
+        self.current -= pointer ? old_size : 0U;
+
+        if (!new_size)
+        {
+            free(pointer);
+
+            return nullptr;
+        }
+
+        void *allocated = realloc(pointer, new_size);
+
+        if (allocated)
+            self.current += new_size;
+        else
+            self.current += pointer ? old_size : 0U;
+
+        self.peak = std::max(self.peak, self.current);
+
+        return allocated;
+    }
+};
+
+static std::string read_file(const char *path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream content;
+
+    content << file.rdbuf();
+
+    return content.str();
+}
+
+// the shipped main.lua, then generated scripts in the shape of a hud or game script with
+// a number of handlers each.
+static std::string script(const int64_t handlers)
+{
+    if (!handlers)
+        return read_file(RCLINK_SOURCE_DIRECTORY "/main/app/scripts/main.lua");
+
+    std::string source = "local state = { count = 0, names = {} }\n";
+
+    for (int64_t i = 0; i < handlers; i++)
+        source += "on_message(" + std::to_string(0x100 + i) + ", function(message)\n"
+                  "    local value = message:u32(1)\n"
+                  "    state.count = state.count + value\n"
+                  "    if value > 100 then\n"
+                  "        state.names[#state.names + 1] = string.format('handler " + std::to_string(i) + " %d', value)\n"
+                  "    end\n"
+                  "    for i = 1, #message do\n"
+                  "        local child = message:child(i)\n"
+                  "        state.count = state.count + child:length()\n"
+                  "    end\n"
+                  "end)\n";
+
+    return source;
+}
+
+static int write_chunk(lua_State *, const void *data, size_t size, void *user_data)
+{
+    static_cast<std::string *>(user_data)->append(static_cast<const char *>(data), size);
+
+    return 0;
+}
+
+static std::string compile(const std::string &source)
+{
+    lua_State *state = luaL_newstate();
+    std::string bytecode;
+
+    if (luaL_loadbuffer(state, source.data(), source.size(), "=script") == LUA_OK)
+        lua_dump(state, write_chunk, &bytecode, 0);
+
+    lua_close(state);
+
+    return bytecode;
+}
+
+static void load(benchmark::State &state, const std::string &chunk, const char *mode)
+{
+    size_t peak = 0;
+    size_t baseline = 0;
+
+    for (auto _ : state)
+    {
+        peak_allocator allocator;
+        lua_State *lua = lua_newstate(peak_allocator::allocate, &allocator);
+
+        baseline = allocator.current;
+        allocator.peak = allocator.current;
+
+        if (luaL_loadbufferx(lua, chunk.data(), chunk.size(), "=script", mode) != LUA_OK)
+        {
+            state.SkipWithError(lua_tostring(lua, -1));
+            lua_close(lua);
+
+            break;
+        }
+
+        peak = allocator.peak - baseline;
+
+        lua_close(lua);
+    }
+
+    state.counters["chunk_bytes"] = chunk.size();
+    state.counters["peak_heap_bytes"] = peak;
+}
+
+static void load_source(benchmark::State &state)
+{
+    load(state, script(state.range(0)), "t");
+}
+BENCHMARK(load_source)->Arg(0)->Arg(10)->Arg(100);
+
+static void load_bytecode(benchmark::State &state)
+{
+    load(state, compile(script(state.range(0))), "b");
+}
+BENCHMARK(load_bytecode)->Arg(0)->Arg(10)->Arg(100);
\ No newline at end of file
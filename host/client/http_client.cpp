@@ -0,0 +1,146 @@
+#include "http_client.h"
+
+#include <cstdlib>
+#include <strings.h>
+
+const std::string *http_response::header(const char *field) const
+{
+    for (const auto &[name, value] : headers)
+        if (!strcasecmp(name.c_str(), field))
+            return &value;
+
+    return nullptr;
+}
+
+bool http_client::request(const char *method, const std::string &path, const std::string &body, http_response &response, const http_headers &headers)
+{
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        const bool is_reused = m_connection.is_open();
+
+        if (!is_reused && !m_connection.open(m_port, 5000U, m_address.c_str()))
+            return false;
+
+        response = {};
+
+        // a server that gives up on the body answers before reading it all, so the response is
+        // read even when sending failed half way.
+        const bool is_sent = send_request(method, path, body, headers, body.size());
+
+        if (read_response(response))
+            return true;
+
+        if (!is_sent && !is_reused)
+            return false;
+
+        m_connection.close();
+
+        if (!is_reused)
+            return false;
+    }
+
+    return false;
+}
+
+bool http_client::send_partial(const char *method, const std::string &path, const size_t content_length, const std::string &partial)
+{
+    m_connection.close();
+
+    if (!m_connection.open(m_port, 5000U, m_address.c_str()))
+        return false;
+
+    const bool sent = send_request(method, path, partial, {}, content_length);
+
+    m_connection.close();
+
+    return sent;
+}
+
+bool http_client::send_request(const char *method, const std::string &path, const std::string &body, const http_headers &headers, const size_t content_length)
+{
+    std::string head = std::string(method) + " " + path + " HTTP/1.1\r\nHost: " + m_address + "\r\nContent-Length: " + std::to_string(content_length) + "\r\n";
+
+    for (const auto &[field, value] : headers)
+        head += field + ": " + value + "\r\n";
+
+    head += "\r\n";
+
+    return m_connection.write(head) && m_connection.write(body);
+}
+
+bool http_client::read_response(http_response &response)
+{
+    auto &buffer = m_connection.buffer();
+    size_t head_end = 0;
+
+    if (!m_connection.fill_until("\r\n\r\n", head_end))
+        return false;
+
+    const std::string head = buffer.substr(0, head_end);
+
+    buffer.erase(0, head_end + 4);
+
+    size_t line_end = head.find("\r\n");
+
+    if (head.compare(0, 9, "HTTP/1.1 "))
+        return false;
+
+    response.status = atoi(head.c_str() + 9);
+
+    while (line_end != std::string::npos)
+    {
+        const size_t start = line_end + 2;
+
+        line_end = head.find("\r\n", start);
+
+        const std::string line = head.substr(start, line_end == std::string::npos ? std::string::npos : line_end - start);
+        const size_t colon = line.find(':');
+
+        if (colon != std::string::npos)
+            response.headers.emplace_back(line.substr(0, colon), line.substr(line.find_first_not_of(' ', colon + 1)));
+    }
+
+    const auto encoding = response.header("Transfer-Encoding");
+
+    if (encoding && !strcasecmp(encoding->c_str(), "chunked"))
+    {
+        while (true)
+        {
+            size_t size_end = 0;
+
+            if (!m_connection.fill_until("\r\n", size_end))
+                return false;
+
+            const size_t size = strtoul(buffer.c_str(), nullptr, 16);
+
+            buffer.erase(0, size_end + 2);
+
+            if (!m_connection.fill(size + 2))
+                return false;
+
+            response.body.append(buffer, 0, size);
+            buffer.erase(0, size + 2);
+
+            if (!size)
+                break;
+        }
+    }
+    else
+    {
+        const auto length = response.header("Content-Length");
+        const size_t size = length ? strtoul(length->c_str(), nullptr, 10) : 0;
+
+        if (!m_connection.fill(size))
+            return false;
+
+        response.body = buffer.substr(0, size);
+        buffer.erase(0, size);
+    }
+
+    const auto connection = response.header("Connection");
+
+    if (connection && !strcasecmp(connection->c_str(), "close"))
+        m_connection.close();
+
+    return true;
+}
\ No newline at end of file
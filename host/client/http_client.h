@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include "socket_connection.h"
+
+using http_headers = std::vector<std::pair<std::string, std::string>>;
+
+struct http_response
+{
+    int status = 0;
+    http_headers headers;
+    std::string body;
+
+    const std::string *header(const char *field) const;
+};
+
+// http/1.1 with keep-alive, a request on a connection the server closed is sent again on a
+// fresh one.
+class http_client
+{
+public:
+    http_client(const uint16_t port, const std::string &address = "127.0.0.1") : m_port(port), m_address(address) {}
+
+    bool request(const char *method, const std::string &path, const std::string &body, http_response &response, const http_headers &headers = {});
+    bool get(const std::string &path, http_response &response) { return request("GET", path, {}, response); }
+
+    // announces content_length bytes but only sends partial before dropping the connection.
+    bool send_partial(const char *method, const std::string &path, const size_t content_length, const std::string &partial);
+
+private:
+    bool send_request(const char *method, const std::string &path, const std::string &body, const http_headers &headers, const size_t content_length);
+    bool read_response(http_response &response);
+
+    uint16_t m_port;
+    std::string m_address;
+    socket_connection m_connection;
+};
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "socket_connection.h"
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+constexpr const size_t READ_SIZE = 16U * 1024U;
+
+socket_connection::~socket_connection()
+{
+    close();
+}
+
+bool socket_connection::open(const uint16_t port, const uint32_t timeout_ms, const char *address)
+{
+    close();
+
+    sockaddr_in server = {};
+
+    server.sin_family = AF_INET;
+    server.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, address, &server.sin_addr) != 1)
+        return false;
+
+    m_socket = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (m_socket < 0)
+        return false;
+
+    const int enabled = 1;
+    const timeval timeout = {.tv_sec = static_cast<time_t>(timeout_ms / 1000U), .tv_usec = static_cast<suseconds_t>((timeout_ms % 1000U) * 1000U)};
+
+    setsockopt(m_socket, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(m_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (connect(m_socket, reinterpret_cast<const sockaddr *>(&server), sizeof(server)))
+    {
+        close();
+
+        return false;
+    }
+
+    return true;
+}
+
+void socket_connection::close()
+{
+    if (m_socket != -1)
+        ::close(m_socket);
+
+    m_socket = -1;
+    m_buffer.clear();
+}
+
+void socket_connection::shutdown()
+{
+    if (m_socket != -1)
+        ::shutdown(m_socket, SHUT_RDWR);
+}
+
+bool socket_connection::write(const void *data, size_t size)
+{
+    auto bytes = static_cast<const uint8_t *>(data);
+
+    while (size)
+    {
+        const ssize_t sent = send(m_socket, bytes, size, MSG_NOSIGNAL);
+
+        if (sent <= 0)
+            return false;
+
+        bytes += sent;
+        size -= sent;
+    }
+
+    return true;
+}
+
+bool socket_connection::fill(const size_t size)
+{
+    char data[READ_SIZE];
+
+    while (m_buffer.size() < size)
+    {
+        const ssize_t received = recv(m_socket, data, sizeof(data), 0);
+
+        if (received <= 0)
+            return false;
+
+        m_buffer.append(data, received);
+    }
+
+    return true;
+}
+
+bool socket_connection::fill_until(const char *delimiter, size_t &offset)
+{
+    char data[READ_SIZE];
+
+    while ((offset = m_buffer.find(delimiter)) == std::string::npos)
+    {
+        const ssize_t received = recv(m_socket, data, sizeof(data), 0);
+
+        if (received <= 0)
+            return false;
+
+        m_buffer.append(data, received);
+    }
+
+    return true;
+}
\ No newline at end of file
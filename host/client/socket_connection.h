@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// a blocking tcp connection, to the loopback server the host build runs unless told otherwise.
+class socket_connection
+{
+public:
+    socket_connection() = default;
+    ~socket_connection();
+
+    socket_connection(const socket_connection &) = delete;
+    socket_connection &operator=(const socket_connection &) = delete;
+
+    bool open(const uint16_t port, const uint32_t timeout_ms = 5000U, const char *address = "127.0.0.1");
+    void close();
+    // unblocks a read on another thread, the descriptor stays valid until close().
+    void shutdown();
+    bool is_open() const { return m_socket != -1; }
+
+    bool write(const void *data, size_t size);
+    bool write(const std::string &data) { return write(data.data(), data.size()); }
+
+    // reads into the internal buffer until at least size bytes are buffered.
+    bool fill(const size_t size);
+    // reads until the buffer holds delimiter, returns its offset.
+    bool fill_until(const char *delimiter, size_t &offset);
+
+    std::string &buffer() { return m_buffer; }
+
+private:
+    int m_socket = -1;
+    std::string m_buffer;
+};
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "websocket_client.h"
+
+#include <random>
+#include <cstring>
+#include <algorithm>
+
+using header_type = uint16_t;
+
+constexpr const uint8_t OPCODE_CONTINUE = 0x0;
+constexpr const uint8_t OPCODE_BINARY = 0x2;
+constexpr const uint8_t OPCODE_CLOSE = 0x8;
+constexpr const uint8_t OPCODE_PING = 0x9;
+constexpr const uint8_t OPCODE_PONG = 0xa;
+
+bool websocket_client::connect(const uint16_t port, const char *path, const char *address)
+{
+    m_stream.clear();
+
+    if (!m_connection.open(port, 5000U, address))
+        return false;
+
+    const std::string request = std::string("GET ") + path + " HTTP/1.1\r\n"
+                                                             "Host: " + address + "\r\n"
+                                                             "Upgrade: websocket\r\n"
+                                                             "Connection: Upgrade\r\n"
+                                                             "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                                             "Sec-WebSocket-Version: 13\r\n\r\n";
+    size_t head_end = 0;
+
+    if (!m_connection.write(request) || !m_connection.fill_until("\r\n\r\n", head_end))
+    {
+        m_connection.close();
+
+        return false;
+    }
+
+    const bool is_upgraded = !m_connection.buffer().compare(0, 12, "HTTP/1.1 101");
+
+    m_connection.buffer().erase(0, head_end + 4);
+
+    if (!is_upgraded)
+        m_connection.close();
+
+    return is_upgraded;
+}
+
+bool websocket_client::send(const std::vector<uint8_t> &data, const size_t fragment_size)
+{
+    size_t offset = 0;
+
+    do
+    {
+        const size_t size = std::min(fragment_size, data.size() - offset);
+
+        if (!send_frame(offset ? OPCODE_CONTINUE : OPCODE_BINARY, offset + size == data.size(), data.data() + offset, size))
+            return false;
+
+        offset += size;
+    } while (offset < data.size());
+
+    return true;
+}
+
+bool websocket_client::receive(tlvcpp::tlv_tree_node &node)
+{
+    while (true)
+    {
+        if (m_stream.size() >= sizeof(header_type))
+        {
+            header_type size;
+
+            memcpy(&size, m_stream.data(), sizeof(size));
+
+            if (m_stream.size() >= sizeof(size) + size)
+            {
+                const bool is_valid = node.deserialize(m_stream.data() + sizeof(size), size);
+
+                m_stream.erase(m_stream.begin(), m_stream.begin() + sizeof(size) + size);
+
+                return is_valid;
+            }
+        }
+
+        if (!receive_frame())
+            return false;
+    }
+}
+
+std::vector<uint8_t> websocket_client::frame(const tlvcpp::tlv_tree_node &node)
+{
+    std::vector<uint8_t> framed(sizeof(header_type));
+    size_t size = 0;
+
+    node.serialize(framed, &size);
+
+    const auto header = static_cast<header_type>(size);
+
+    memcpy(framed.data(), &header, sizeof(header));
+
+    return framed;
+}
+
+bool websocket_client::send_frame(const uint8_t opcode, const bool is_final, const uint8_t *data, const size_t size)
+{
+    static thread_local std::minstd_rand generator(std::random_device{}());
+
+    std::vector<uint8_t> frame;
+
+    frame.reserve(size + 14);
+    frame.push_back((is_final ? 0x80 : 0) | opcode);
+
+    if (size < 126)
+        frame.push_back(0x80 | size);
+    else if (size <= 0xffff)
+    {
+        frame.push_back(0x80 | 126);
+        frame.push_back(size >> 8);
+        frame.push_back(size);
+    }
+    else
+    {
+        frame.push_back(0x80 | 127);
+
+        for (int i = 7; i >= 0; i--)
+            frame.push_back(static_cast<uint64_t>(size) >> (8 * i));
+    }
+
+    const uint32_t mask = generator();
+    uint8_t mask_bytes[4];
+
+    memcpy(mask_bytes, &mask, sizeof(mask_bytes));
+    frame.insert(frame.end(), mask_bytes, mask_bytes + 4);
+
+    for (size_t i = 0; i < size; i++)
+        frame.push_back(data[i] ^ mask_bytes[i & 3]);
+
+    return m_connection.write(frame.data(), frame.size());
+}
+
+bool websocket_client::receive_frame()
+{
+    auto &buffer = m_connection.buffer();
+
+    if (!m_connection.fill(2))
+        return false;
+
+    const uint8_t opcode = buffer[0] & 0x0f;
+    size_t size = buffer[1] & 0x7f;
+    size_t header_size = 2;
+
+    if (size == 126)
+        header_size = 4;
+    else if (size == 127)
+        header_size = 10;
+
+    if (!m_connection.fill(header_size))
+        return false;
+
+    if (size >= 126)
+    {
+        size = 0;
+
+        for (size_t i = 2; i < header_size; i++)
+            size = (size << 8) | static_cast<uint8_t>(buffer[i]);
+    }
+
+    if (!m_connection.fill(header_size + size))
+        return false;
+
+    const auto payload = reinterpret_cast<const uint8_t *>(buffer.data()) + header_size;
+
+    if (opcode == OPCODE_CLOSE)
+    {
+        m_connection.close();
+
+        return false;
+    }
+
+    if (opcode == OPCODE_PING)
+        send_frame(OPCODE_PONG, true, payload, size);
+    else if (opcode != OPCODE_PONG)
+        m_stream.insert(m_stream.end(), payload, payload + size);
+
+    buffer.erase(0, header_size + size);
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <tlvcpp/tlv_tree.h>
+
+#include "socket_connection.h"
+
+// a websocket client speaking the firmware's message stream: every message is a native u16
+// length followed by a serialized tlv tree, and frames may split or merge messages freely.
+class websocket_client
+{
+public:
+    bool connect(const uint16_t port, const char *path = "/", const char *address = "127.0.0.1");
+    void close() { m_connection.close(); }
+    void shutdown() { m_connection.shutdown(); }
+    bool is_open() const { return m_connection.is_open(); }
+
+    // sends data as one websocket message of frames no larger than fragment_size.
+    bool send(const std::vector<uint8_t> &data, const size_t fragment_size = SIZE_MAX);
+
+    // blocks for the next complete message of the stream.
+    bool receive(tlvcpp::tlv_tree_node &node);
+
+    static std::vector<uint8_t> frame(const tlvcpp::tlv_tree_node &node);
+
+private:
+    bool send_frame(const uint8_t opcode, const bool is_final, const uint8_t *data, const size_t size);
+    bool receive_frame();
+
+    socket_connection m_connection;
+    std::vector<uint8_t> m_stream;
+};
\ No newline at end of file
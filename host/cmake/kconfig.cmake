@@ -0,0 +1,61 @@
+# turns the defaults of main/Kconfig.projbuild into the sdkconfig.h an esp-idf build would
+# generate, so the host build follows every default the firmware does.
+#
+#   rclink_generate_sdkconfig(<kconfig> <output> [OVERRIDES NAME=VALUE...])
+#
+# bools become 1 or stay undefined, symbols whose dependency isn't set are dropped and the
+# overrides win over the defaults.
+function(rclink_generate_sdkconfig kconfig output)
+  cmake_parse_arguments(ARG "" "" "OVERRIDES" ${ARGN})
+
+  file(STRINGS ${kconfig} lines)
+
+  set(symbols)
+  set(name)
+
+  foreach(line IN LISTS lines)
+    string(STRIP "${line}" line)
+
+    if(line MATCHES "^config ([A-Z0-9_]+)$")
+      set(name ${CMAKE_MATCH_1})
+      list(APPEND symbols ${name})
+      set(value_${name})
+      set(depends_${name})
+    elseif(name AND line MATCHES "^default ([^ ]+)$" AND NOT DEFINED value_${name})
+      set(value_${name} ${CMAKE_MATCH_1})
+    elseif(name AND line MATCHES "^depends on ([A-Z0-9_]+)$")
+      set(depends_${name} ${CMAKE_MATCH_1})
+    endif()
+  endforeach()
+
+  foreach(override IN LISTS ARG_OVERRIDES)
+    string(REGEX MATCH "^([A-Z0-9_]+)=(.*)$" matched "${override}")
+    set(value_${CMAKE_MATCH_1} ${CMAKE_MATCH_2})
+
+    if(NOT CMAKE_MATCH_1 IN_LIST symbols)
+      list(APPEND symbols ${CMAKE_MATCH_1})
+    endif()
+  endforeach()
+
+  set(content "#pragma once\n\n// generated from ${kconfig}, do not edit.\n")
+
+  foreach(symbol IN LISTS symbols)
+    set(value ${value_${symbol}})
+    set(dependency ${depends_${symbol}})
+
+    if(dependency AND NOT "${value_${dependency}}" MATCHES "^(y|1)$")
+      continue()
+    endif()
+
+    if(value STREQUAL "y")
+      set(value 1)
+    elseif(value STREQUAL "n" OR value STREQUAL "")
+      continue()
+    endif()
+
+    string(APPEND content "#define CONFIG_${symbol} ${value}\n")
+  endforeach()
+
+  file(CONFIGURE OUTPUT ${output} CONTENT "${content}" @ONLY)
+  set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${kconfig})
+endfunction()
@@ -0,0 +1,64 @@
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include <esp_rom_md5.h>
+#include <mbedtls/sha256.h>
+
+#include <cstring>
+
+void esp_rom_md5_init(md5_context_t *context)
+{
+    MD5_Init(context);
+}
+
+void esp_rom_md5_update(md5_context_t *context, const void *data, const uint32_t size)
+{
+    MD5_Update(context, data, size);
+}
+
+void esp_rom_md5_final(uint8_t *digest, md5_context_t *context)
+{
+    MD5_Final(digest, context);
+}
+
+void mbedtls_sha256_init(mbedtls_sha256_context *context)
+{
+    memset(context, 0, sizeof(*context));
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context *context)
+{
+    if (context)
+        memset(context, 0, sizeof(*context));
+}
+
+int mbedtls_sha256_starts(mbedtls_sha256_context *context, const int is224)
+{
+    context->is224 = is224;
+
+    return (is224 ? SHA224_Init(&context->context) : SHA256_Init(&context->context)) ? 0 : -1;
+}
+
+int mbedtls_sha256_update(mbedtls_sha256_context *context, const unsigned char *data, const size_t size)
+{
+    return SHA256_Update(&context->context, data, size) ? 0 : -1;
+}
+
+int mbedtls_sha256_finish(mbedtls_sha256_context *context, unsigned char *digest)
+{
+    return (context->is224 ? SHA224_Final(digest, &context->context) : SHA256_Final(digest, &context->context)) ? 0 : -1;
+}
+
+int mbedtls_sha256(const unsigned char *data, const size_t size, unsigned char *digest, const int is224)
+{
+    mbedtls_sha256_context context;
+
+    mbedtls_sha256_init(&context);
+
+    const int result = mbedtls_sha256_starts(&context, is224) ||
+                       mbedtls_sha256_update(&context, data, size) ||
+                       mbedtls_sha256_finish(&context, digest);
+
+    mbedtls_sha256_free(&context);
+
+    return result ? -1 : 0;
+}
\ No newline at end of file
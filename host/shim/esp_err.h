@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_NOT_SUPPORTED 0x106
+#define ESP_ERR_TIMEOUT 0x107
+
+const char *esp_err_to_name(const esp_err_t error);
+
+inline void esp_error_check(const esp_err_t error, const char *file, const int line, const char *expression)
+{
+    if (error == ESP_OK)
+        return;
+
+    fprintf(stderr, "%s:%d: %s failed: %s\n", file, line, expression, esp_err_to_name(error));
+    abort();
+}
+
+#define ESP_ERROR_CHECK(expression) esp_error_check((expression), __FILE__, __LINE__, #expression)
\ No newline at end of file
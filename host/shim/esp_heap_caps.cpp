@@ -0,0 +1,181 @@
+#include <esp_heap_caps.h>
+
+#include <mutex>
+#include <limits>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+#include "host_shim.h"
+
+enum class heap_region : uint8_t
+{
+    internal,
+    psram,
+};
+
+struct heap_block
+{
+    size_t size;
+    heap_region region;
+};
+
+struct heap_state
+{
+    std::mutex mutex;
+    size_t size[2] = {std::numeric_limits<size_t>::max(), 8U * 1024U * 1024U};
+    size_t used[2] = {};
+    std::unordered_map<void *, heap_block> blocks;
+};
+
+// built on first use, accounts are statics too and may allocate before main().
+static heap_state &heap()
+{
+    static heap_state state;
+
+    return state;
+}
+
+static heap_region region_of(const uint32_t caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) ? heap_region::psram : heap_region::internal;
+}
+
+static bool fits(const heap_state &state, const heap_region region, const size_t size)
+{
+    const auto index = static_cast<size_t>(region);
+
+    return size <= state.size[index] - state.used[index];
+}
+
+static void *allocate(heap_state &state, const size_t size, const uint32_t caps)
+{
+    const auto region = region_of(caps);
+
+    if (!fits(state, region, size))
+        return nullptr;
+
+    void *allocated = malloc(size ? size : 1);
+
+    if (!allocated)
+        return nullptr;
+
+    state.used[static_cast<size_t>(region)] += size;
+    state.blocks[allocated] = {size, region};
+
+    return allocated;
+}
+
+static void release(heap_state &state, void *pointer)
+{
+    const auto block = state.blocks.find(pointer);
+
+    if (block == state.blocks.end())
+        return;
+
+    state.used[static_cast<size_t>(block->second.region)] -= block->second.size;
+    state.blocks.erase(block);
+
+    free(pointer);
+}
+
+// moves the block into the region caps asks for, keeping its contents.
+static void *reallocate(heap_state &state, void *pointer, const size_t size, const uint32_t caps)
+{
+    if (!pointer)
+        return allocate(state, size, caps);
+
+    const auto block = state.blocks.find(pointer);
+
+    if (block == state.blocks.end())
+        return nullptr;
+
+    const heap_block old_block = block->second;
+    void *allocated = allocate(state, size, caps);
+
+    if (!allocated)
+        return nullptr;
+
+    memcpy(allocated, pointer, std::min(size, old_block.size));
+
+    release(state, pointer);
+
+    return allocated;
+}
+
+void *heap_caps_malloc(const size_t size, const uint32_t caps)
+{
+    auto &state = heap();
+    std::lock_guard lock(state.mutex);
+
+    return allocate(state, size, caps);
+}
+
+void *heap_caps_malloc_prefer(const size_t size, const size_t count, ...)
+{
+    auto &state = heap();
+    std::lock_guard lock(state.mutex);
+    void *allocated = nullptr;
+
+    va_list arguments;
+    va_start(arguments, count);
+
+    for (size_t i = 0; i < count && !allocated; i++)
+        allocated = allocate(state, size, va_arg(arguments, uint32_t));
+
+    va_end(arguments);
+
+    return allocated;
+}
+
+void *heap_caps_realloc(void *pointer, const size_t size, const uint32_t caps)
+{
+    auto &state = heap();
+    std::lock_guard lock(state.mutex);
+
+    return reallocate(state, pointer, size, caps);
+}
+
+void *heap_caps_realloc_prefer(void *pointer, const size_t size, const size_t count, ...)
+{
+    auto &state = heap();
+    std::lock_guard lock(state.mutex);
+    void *allocated = nullptr;
+
+    va_list arguments;
+    va_start(arguments, count);
+
+    for (size_t i = 0; i < count && !allocated; i++)
+        allocated = reallocate(state, pointer, size, va_arg(arguments, uint32_t));
+
+    va_end(arguments);
+
+    return allocated;
+}
+
+void heap_caps_free(void *pointer)
+{
+    auto &state = heap();
+    std::lock_guard lock(state.mutex);
+
+    release(state, pointer);
+}
+
+size_t heap_caps_get_free_size(const uint32_t caps)
+{
+    auto &state = heap();
+    std::lock_guard lock(state.mutex);
+    const auto index = static_cast<size_t>(region_of(caps));
+
+    return state.size[index] - state.used[index];
+}
+
+void host_shim::set_heap_size(const uint32_t caps, const size_t size)
+{
+    auto &state = heap();
+    std::lock_guard lock(state.mutex);
+
+    state.size[static_cast<size_t>(region_of(caps))] = size;
+}
\ No newline at end of file
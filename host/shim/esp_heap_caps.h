@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+// two regions on top of malloc, psram for MALLOC_CAP_SPIRAM and internal ram for everything
+// else. see host_shim::set_heap_size() for how big they are.
+void *heap_caps_malloc(const size_t size, const uint32_t caps);
+void *heap_caps_malloc_prefer(const size_t size, const size_t count, ...);
+void *heap_caps_realloc(void *pointer, const size_t size, const uint32_t caps);
+void *heap_caps_realloc_prefer(void *pointer, const size_t size, const size_t count, ...);
+void heap_caps_free(void *pointer);
+size_t heap_caps_get_free_size(const uint32_t caps);
\ No newline at end of file
@@ -0,0 +1,1146 @@
+#include <esp_http_server.h>
+
+#include <map>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <strings.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include <openssl/evp.h>
+
+#include "host_shim.h"
+
+constexpr const size_t RECEIVE_CHUNK_SIZE = 16U * 1024U;
+constexpr const size_t MAX_HEADER_SIZE = 8U * 1024U;
+constexpr const char *WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static std::atomic<uint32_t> frame_payload_delay_us = 0;
+
+struct http_session
+{
+    int socket = -1;
+    uint64_t opened = 0;
+    uint64_t used = 0;
+    std::string input;
+    bool is_websocket = false;
+    const httpd_uri_t *websocket_handler = nullptr;
+    bool is_paused = false;
+    bool should_close = false;
+    std::mutex send_mutex;
+};
+
+struct registered_handler
+{
+    std::string uri;
+    httpd_uri_t definition;
+};
+
+struct http_server
+{
+    httpd_config_t config;
+    std::vector<std::unique_ptr<registered_handler>> handlers;
+    int listener = -1;
+    int wake_pipe[2] = {-1, -1};
+    std::thread thread;
+    std::atomic<bool> is_running = false;
+
+    std::mutex mutex;
+    std::map<int, std::unique_ptr<http_session>> sessions;
+    std::vector<std::pair<httpd_work_fn_t, void *>> work;
+    std::vector<int> closing;
+    uint64_t counter = 0;
+};
+
+struct request_state
+{
+    http_server *server;
+    http_session *session;
+    std::vector<std::pair<std::string, std::string>> headers;
+    size_t remaining = 0;
+
+    std::string status = "200 OK";
+    std::string type = "text/html";
+    std::vector<std::pair<std::string, std::string>> response_headers;
+    bool is_chunked = false;
+    bool is_sent = false;
+    bool is_failed = false;
+    bool is_async = false;
+
+    httpd_ws_type_t frame_type = HTTPD_WS_TYPE_BINARY;
+    bool frame_final = true;
+    const uint8_t *frame_payload = nullptr;
+    size_t frame_size = 0;
+};
+
+static request_state &state_of(httpd_req_t *request)
+{
+    return *static_cast<request_state *>(request->aux);
+}
+
+static void wake(http_server &server)
+{
+    const uint8_t byte = 0;
+
+    if (write(server.wake_pipe[1], &byte, 1) < 0)
+        return;
+}
+
+static bool send_all(http_session &session, const void *data, size_t size)
+{
+    auto bytes = static_cast<const uint8_t *>(data);
+
+    while (size)
+    {
+        const ssize_t sent = send(session.socket, bytes, size, MSG_NOSIGNAL);
+
+        if (sent <= 0)
+            return false;
+
+        bytes += sent;
+        size -= sent;
+    }
+
+    return true;
+}
+
+// the session is taken out of the server first, so a sender holding its mutex finishes before
+// the socket goes away.
+static void close_session(http_server &server, const int socket)
+{
+    std::unique_ptr<http_session> session;
+
+    {
+        std::lock_guard lock(server.mutex);
+
+        const auto found = server.sessions.find(socket);
+
+        if (found == server.sessions.end())
+            return;
+
+        if (found->second->is_paused)
+        {
+            found->second->should_close = true;
+
+            return;
+        }
+
+        session = std::move(found->second);
+        server.sessions.erase(found);
+    }
+
+    std::lock_guard lock(session->send_mutex);
+
+    shutdown(session->socket, SHUT_RDWR);
+    close(session->socket);
+}
+
+static const char *status_text(const httpd_err_code_t error)
+{
+    switch (error)
+    {
+    case HTTPD_501_METHOD_NOT_IMPLEMENTED:
+        return "501 Method Not Implemented";
+    case HTTPD_505_VERSION_NOT_SUPPORTED:
+        return "505 Version Not Supported";
+    case HTTPD_400_BAD_REQUEST:
+        return "400 Bad Request";
+    case HTTPD_401_UNAUTHORIZED:
+        return "401 Unauthorized";
+    case HTTPD_403_FORBIDDEN:
+        return "403 Forbidden";
+    case HTTPD_404_NOT_FOUND:
+        return "404 Not Found";
+    case HTTPD_405_METHOD_NOT_ALLOWED:
+        return "405 Method Not Allowed";
+    case HTTPD_408_REQ_TIMEOUT:
+        return "408 Request Timeout";
+    case HTTPD_411_LENGTH_REQUIRED:
+        return "411 Length Required";
+    case HTTPD_414_URI_TOO_LONG:
+        return "414 URI Too Long";
+    case HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE:
+        return "431 Request Header Fields Too Large";
+    default:
+        return "500 Internal Server Error";
+    }
+}
+
+static std::string response_head(const request_state &state, const char *framing)
+{
+    std::string head = "HTTP/1.1 " + state.status + "\r\nContent-Type: " + state.type + "\r\n" + framing + "\r\n";
+
+    for (const auto &[field, value] : state.response_headers)
+        head += field + ": " + value + "\r\n";
+
+    if (state.is_failed)
+        head += "Connection: close\r\n";
+
+    return head + "\r\n";
+}
+
+static bool send_raw(request_state &state, const std::string &data)
+{
+    std::lock_guard lock(state.session->send_mutex);
+
+    if (send_all(*state.session, data.data(), data.size()))
+        return true;
+
+    state.is_failed = true;
+
+    return false;
+}
+
+bool httpd_uri_match_wildcard(const char *uri_template, const char *uri_to_match, size_t match_upto)
+{
+    const size_t template_length = strlen(uri_template);
+    const char last = template_length > 0 ? uri_template[template_length - 1] : 0;
+    const char before_last = template_length > 1 ? uri_template[template_length - 2] : 0;
+    const bool has_asterisk = last == '*' || (before_last == '*' && last == '?');
+    const bool has_question = last == '?' || (before_last == '?' && last == '*');
+    const size_t exact = template_length - has_asterisk - has_question;
+
+    // a question mark makes the character before it optional.
+    size_t matched = exact - (has_question ? 1U : 0U);
+
+    if (match_upto < matched || strncmp(uri_template, uri_to_match, matched))
+        return false;
+
+    if (has_question && match_upto > matched && uri_to_match[matched] == uri_template[matched])
+        matched++;
+
+    return has_asterisk || match_upto == matched;
+}
+
+static const httpd_uri_t *find_handler(http_server &server, const char *uri, const int method, bool &is_other_method)
+{
+    const size_t length = strcspn(uri, "?");
+
+    is_other_method = false;
+
+    for (const auto &handler : server.handlers)
+    {
+        const auto &definition = handler->definition;
+        const bool matches = server.config.uri_match_fn ? server.config.uri_match_fn(definition.uri, uri, length)
+                                                        : (handler->uri.size() == length && !strncmp(definition.uri, uri, length));
+
+        if (!matches)
+            continue;
+
+        if (definition.method == method)
+            return &definition;
+
+        is_other_method = true;
+    }
+
+    return nullptr;
+}
+
+static std::string websocket_accept(const std::string &key)
+{
+    const std::string combined = key + WEBSOCKET_GUID;
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_size = 0;
+    uint8_t encoded[64] = {};
+
+    EVP_Digest(combined.data(), combined.size(), digest, &digest_size, EVP_sha1(), nullptr);
+    EVP_EncodeBlock(encoded, digest, digest_size);
+
+    return reinterpret_cast<const char *>(encoded);
+}
+
+static const std::string *header_value(const request_state &state, const char *field)
+{
+    for (const auto &[name, value] : state.headers)
+        if (!strcasecmp(name.c_str(), field))
+            return &value;
+
+    return nullptr;
+}
+
+static void fail_request(http_server &server, http_session &session, const httpd_err_code_t error)
+{
+    request_state state = {};
+
+    state.server = &server;
+    state.session = &session;
+    state.status = status_text(error);
+    state.type = "text/plain";
+    state.is_failed = true;
+
+    send_raw(state, response_head(state, "Content-Length: 0"));
+}
+
+// returns whether the session stays open.
+static bool handle_frame(http_server &server, http_session &session, size_t &consumed)
+{
+    const auto input = reinterpret_cast<const uint8_t *>(session.input.data());
+    const size_t available = session.input.size();
+
+    if (available < 2)
+        return true;
+
+    const bool is_final = input[0] & 0x80;
+    const auto type = static_cast<httpd_ws_type_t>(input[0] & 0x0f);
+    const bool is_masked = input[1] & 0x80;
+    size_t size = input[1] & 0x7f;
+    size_t header_size = 2;
+
+    if (size == 126)
+        header_size += 2;
+    else if (size == 127)
+        header_size += 8;
+
+    if (is_masked)
+        header_size += 4;
+
+    if (available < header_size)
+        return true;
+
+    if (size >= 126)
+    {
+        const size_t bytes = size == 126 ? 2 : 8;
+
+        size = 0;
+
+        for (size_t i = 0; i < bytes; i++)
+            size = (size << 8) | input[2 + i];
+    }
+
+    if (available - header_size < size)
+        return true;
+
+    std::vector<uint8_t> payload(input + header_size, input + header_size + size);
+
+    if (is_masked)
+        for (size_t i = 0; i < size; i++)
+            payload[i] ^= input[header_size - 4 + (i & 3)];
+
+    consumed = header_size + size;
+
+    if (type == HTTPD_WS_TYPE_CLOSE || type == HTTPD_WS_TYPE_PING)
+    {
+        httpd_ws_frame_t reply = {
+            .final = true,
+            .fragmented = false,
+            .type = type == HTTPD_WS_TYPE_PING ? HTTPD_WS_TYPE_PONG : HTTPD_WS_TYPE_CLOSE,
+            .payload = payload.data(),
+            .len = type == HTTPD_WS_TYPE_CLOSE ? std::min<size_t>(size, 2U) : size,
+        };
+
+        httpd_ws_send_frame_async(&server, session.socket, &reply);
+
+        return type == HTTPD_WS_TYPE_PING;
+    }
+
+    if (type == HTTPD_WS_TYPE_PONG)
+        return true;
+
+    request_state state = {};
+
+    state.server = &server;
+    state.session = &session;
+    state.frame_type = type;
+    state.frame_final = is_final;
+    state.frame_payload = payload.data();
+    state.frame_size = size;
+
+    httpd_req_t request = {};
+
+    request.handle = &server;
+    request.method = 0;
+    request.content_len = size;
+    request.aux = &state;
+    request.user_ctx = session.websocket_handler->user_ctx;
+    strncpy(request.uri, session.websocket_handler->uri, HTTPD_MAX_URI_LEN);
+
+    return session.websocket_handler->handler(&request) == ESP_OK;
+}
+
+static bool drain_body(request_state &state)
+{
+    char buffer[1024];
+
+    while (state.remaining)
+    {
+        httpd_req_t request = {};
+
+        request.aux = &state;
+
+        const int received = httpd_req_recv(&request, buffer, sizeof(buffer));
+
+        if (received <= 0)
+            return false;
+    }
+
+    return true;
+}
+
+static bool handle_request(http_server &server, http_session &session, size_t &consumed)
+{
+    const size_t header_end = session.input.find("\r\n\r\n");
+
+    if (header_end == std::string::npos)
+    {
+        if (session.input.size() <= MAX_HEADER_SIZE)
+            return true;
+
+        fail_request(server, session, HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE);
+
+        return false;
+    }
+
+    auto state = std::make_unique<request_state>();
+    auto request = std::make_unique<httpd_req_t>();
+
+    state->server = &server;
+    state->session = &session;
+
+    const std::string head = session.input.substr(0, header_end);
+    size_t line_end = head.find("\r\n");
+    const std::string request_line = head.substr(0, line_end);
+    const size_t method_end = request_line.find(' ');
+    const size_t uri_end = request_line.find(' ', method_end + 1);
+
+    if (method_end == std::string::npos || uri_end == std::string::npos)
+    {
+        fail_request(server, session, HTTPD_400_BAD_REQUEST);
+
+        return false;
+    }
+
+    const std::string method = request_line.substr(0, method_end);
+    const std::string uri = request_line.substr(method_end + 1, uri_end - method_end - 1);
+
+    if (method == "GET")
+        request->method = HTTP_GET;
+    else if (method == "POST")
+        request->method = HTTP_POST;
+    else if (method == "PUT")
+        request->method = HTTP_PUT;
+    else if (method == "DELETE")
+        request->method = HTTP_DELETE;
+    else
+    {
+        fail_request(server, session, HTTPD_501_METHOD_NOT_IMPLEMENTED);
+
+        return false;
+    }
+
+    if (uri.size() > HTTPD_MAX_URI_LEN)
+    {
+        fail_request(server, session, HTTPD_414_URI_TOO_LONG);
+
+        return false;
+    }
+
+    while (line_end != std::string::npos)
+    {
+        const size_t start = line_end + 2;
+
+        line_end = head.find("\r\n", start);
+
+        const std::string line = head.substr(start, line_end == std::string::npos ? std::string::npos : line_end - start);
+        const size_t colon = line.find(':');
+
+        if (colon == std::string::npos)
+            continue;
+
+        const size_t value_start = line.find_first_not_of(' ', colon + 1);
+
+        state->headers.emplace_back(line.substr(0, colon), value_start == std::string::npos ? "" : line.substr(value_start));
+    }
+
+    consumed = header_end + 4;
+    session.input.erase(0, consumed);
+    consumed = 0;
+
+    if (const auto length = header_value(*state, "Content-Length"))
+        state->remaining = strtoul(length->c_str(), nullptr, 10);
+
+    request->handle = &server;
+    request->content_len = state->remaining;
+    request->aux = state.get();
+    strncpy(request->uri, uri.c_str(), HTTPD_MAX_URI_LEN);
+
+    bool is_other_method = false;
+    const httpd_uri_t *handler = find_handler(server, request->uri, request->method, is_other_method);
+
+    if (!handler)
+    {
+        fail_request(server, session, is_other_method ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND);
+
+        return false;
+    }
+
+    request->user_ctx = handler->user_ctx;
+
+    if (handler->is_websocket)
+    {
+        const auto upgrade = header_value(*state, "Upgrade");
+        const auto key = header_value(*state, "Sec-WebSocket-Key");
+
+        if (!upgrade || strcasecmp(upgrade->c_str(), "websocket") || !key)
+        {
+            fail_request(server, session, HTTPD_400_BAD_REQUEST);
+
+            return false;
+        }
+
+        const std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: " +
+                                     websocket_accept(*key) + "\r\n\r\n";
+
+        if (!send_raw(*state, response))
+            return false;
+
+        session.is_websocket = true;
+        session.websocket_handler = handler;
+
+        return handler->handler(request.get()) == ESP_OK;
+    }
+
+    const esp_err_t result = handler->handler(request.get());
+
+    // the copy made by httpd_req_async_handler_begin() owns the session now.
+    if (state->is_async)
+        return true;
+
+    return result == ESP_OK && !state->is_failed && drain_body(*state);
+}
+
+static void process_session(http_server &server, http_session &session)
+{
+    while (!session.is_paused && !session.input.empty())
+    {
+        const size_t size = session.input.size();
+        size_t consumed = 0;
+
+        const bool keep = session.is_websocket ? handle_frame(server, session, consumed) : handle_request(server, session, consumed);
+
+        if (!keep)
+        {
+            close_session(server, session.socket);
+
+            return;
+        }
+
+        session.input.erase(0, consumed);
+
+        if (!session.is_websocket && session.input.size() == size)
+            return;
+
+        if (session.is_websocket && !consumed)
+            return;
+    }
+}
+
+static void accept_session(http_server &server)
+{
+    const int socket = accept(server.listener, nullptr, nullptr);
+
+    if (socket < 0)
+        return;
+
+    const int enabled = 1;
+    const timeval receive_timeout = {.tv_sec = server.config.recv_wait_timeout, .tv_usec = 0};
+    const timeval send_timeout = {.tv_sec = server.config.send_wait_timeout, .tv_usec = 0};
+
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &receive_timeout, sizeof(receive_timeout));
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+    int purged = -1;
+
+    {
+        std::lock_guard lock(server.mutex);
+
+        if (server.sessions.size() >= server.config.max_open_sockets)
+        {
+            http_session *oldest = nullptr;
+
+            for (const auto &[descriptor, session] : server.sessions)
+                if (!session->is_paused && (!oldest || session->used < oldest->used))
+                    oldest = session.get();
+
+            if (!server.config.lru_purge_enable || !oldest)
+            {
+                close(socket);
+
+                return;
+            }
+
+            purged = oldest->socket;
+        }
+    }
+
+    if (purged != -1)
+        close_session(server, purged);
+
+    auto session = std::make_unique<http_session>();
+
+    session->socket = socket;
+
+    std::lock_guard lock(server.mutex);
+
+    session->opened = session->used = ++server.counter;
+    server.sessions[socket] = std::move(session);
+}
+
+static void run_server(http_server *server)
+{
+    std::vector<pollfd> descriptors;
+
+    while (server->is_running)
+    {
+        descriptors.clear();
+        descriptors.push_back({server->wake_pipe[0], POLLIN, 0});
+        descriptors.push_back({server->listener, POLLIN, 0});
+
+        {
+            std::lock_guard lock(server->mutex);
+
+            for (const auto &[socket, session] : server->sessions)
+                if (!session->is_paused)
+                    descriptors.push_back({socket, POLLIN, 0});
+        }
+
+        if (poll(descriptors.data(), descriptors.size(), -1) < 0)
+            continue;
+
+        if (descriptors[0].revents)
+        {
+            uint8_t drained[64];
+
+            while (read(server->wake_pipe[0], drained, sizeof(drained)) == sizeof(drained))
+                ;
+        }
+
+        std::vector<std::pair<httpd_work_fn_t, void *>> work;
+        std::vector<int> closing;
+        std::vector<http_session *> resumed;
+
+        {
+            std::lock_guard lock(server->mutex);
+
+            work.swap(server->work);
+            closing.swap(server->closing);
+
+            for (const auto &[socket, session] : server->sessions)
+                if (!session->is_paused && !session->input.empty())
+                    resumed.push_back(session.get());
+        }
+
+        for (const auto &[function, argument] : work)
+            function(argument);
+
+        for (const auto socket : closing)
+            close_session(*server, socket);
+
+        for (const auto session : resumed)
+        {
+            bool is_open = false;
+
+            {
+                std::lock_guard lock(server->mutex);
+
+                const auto found = server->sessions.find(session->socket);
+
+                is_open = found != server->sessions.end() && found->second.get() == session;
+            }
+
+            if (is_open)
+                process_session(*server, *session);
+        }
+
+        if (descriptors[1].revents)
+            accept_session(*server);
+
+        for (size_t i = 2; i < descriptors.size(); i++)
+        {
+            if (!descriptors[i].revents)
+                continue;
+
+            http_session *session = nullptr;
+
+            {
+                std::lock_guard lock(server->mutex);
+
+                const auto found = server->sessions.find(descriptors[i].fd);
+
+                if (found == server->sessions.end() || found->second->is_paused)
+                    continue;
+
+                session = found->second.get();
+                session->used = ++server->counter;
+            }
+
+            char buffer[RECEIVE_CHUNK_SIZE];
+            const ssize_t received = recv(session->socket, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+            {
+                close_session(*server, session->socket);
+
+                continue;
+            }
+
+            if (received > 0)
+            {
+                session->input.append(buffer, received);
+
+                process_session(*server, *session);
+            }
+        }
+    }
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    auto server = std::make_unique<http_server>();
+
+    server->config = *config;
+    server->listener = socket(AF_INET, SOCK_STREAM, 0);
+
+    const int enabled = 1;
+    sockaddr_in address = {};
+
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config->server_port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    setsockopt(server->listener, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+
+    if (server->listener < 0 ||
+        bind(server->listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) ||
+        listen(server->listener, std::max<int>(config->backlog_conn, 16)) ||
+        pipe(server->wake_pipe))
+    {
+        if (server->listener >= 0)
+            close(server->listener);
+
+        return ESP_ERR_HTTPD_TASK;
+    }
+
+    fcntl(server->wake_pipe[0], F_SETFL, O_NONBLOCK);
+
+    server->is_running = true;
+    server->thread = std::thread(run_server, server.get());
+
+    *handle = server.release();
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_stop(httpd_handle_t handle)
+{
+    auto server = static_cast<http_server *>(handle);
+
+    if (!server)
+        return ESP_ERR_INVALID_ARG;
+
+    server->is_running = false;
+
+    wake(*server);
+
+    server->thread.join();
+
+    for (auto &[socket, session] : server->sessions)
+        close(socket);
+
+    close(server->listener);
+    close(server->wake_pipe[0]);
+    close(server->wake_pipe[1]);
+
+    delete server;
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    auto server = static_cast<http_server *>(handle);
+
+    if (!server || !uri_handler)
+        return ESP_ERR_INVALID_ARG;
+
+    std::lock_guard lock(server->mutex);
+
+    if (server->handlers.size() >= server->config.max_uri_handlers)
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+
+    for (const auto &handler : server->handlers)
+        if (handler->uri == uri_handler->uri && handler->definition.method == uri_handler->method)
+            return ESP_ERR_HTTPD_HANDLER_EXISTS;
+
+    auto registered = std::make_unique<registered_handler>();
+
+    registered->uri = uri_handler->uri;
+    registered->definition = *uri_handler;
+    registered->definition.uri = registered->uri.c_str();
+
+    server->handlers.push_back(std::move(registered));
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *argument)
+{
+    auto server = static_cast<http_server *>(handle);
+
+    if (!server || !work)
+        return ESP_ERR_INVALID_ARG;
+
+    {
+        std::lock_guard lock(server->mutex);
+
+        server->work.emplace_back(work, argument);
+    }
+
+    wake(*server);
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_get_client_list(httpd_handle_t handle, size_t *fds, int *client_fds)
+{
+    auto server = static_cast<http_server *>(handle);
+
+    if (!server || !fds || !client_fds)
+        return ESP_ERR_INVALID_ARG;
+
+    std::vector<const http_session *> sessions;
+
+    {
+        std::lock_guard lock(server->mutex);
+
+        for (const auto &[socket, session] : server->sessions)
+            sessions.push_back(session.get());
+
+        std::sort(sessions.begin(), sessions.end(), [](const auto a, const auto b)
+                  { return a->opened < b->opened; });
+
+        *fds = std::min(*fds, sessions.size());
+
+        for (size_t i = 0; i < *fds; i++)
+            client_fds[i] = sessions[i]->socket;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_sess_trigger_close(httpd_handle_t handle, int socket)
+{
+    auto server = static_cast<http_server *>(handle);
+
+    {
+        std::lock_guard lock(server->mutex);
+
+        if (!server->sessions.count(socket))
+            return ESP_ERR_NOT_FOUND;
+
+        server->closing.push_back(socket);
+    }
+
+    wake(*server);
+
+    return ESP_OK;
+}
+
+int httpd_req_recv(httpd_req_t *request, char *buffer, size_t size)
+{
+    auto &state = state_of(request);
+    auto &session = *state.session;
+
+    size = std::min(size, state.remaining);
+
+    if (!size)
+        return 0;
+
+    if (!session.input.empty())
+    {
+        const size_t taken = std::min(size, session.input.size());
+
+        memcpy(buffer, session.input.data(), taken);
+        session.input.erase(0, taken);
+        state.remaining -= taken;
+
+        return taken;
+    }
+
+    const ssize_t received = recv(session.socket, buffer, size, 0);
+
+    if (received < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+
+    // a closed connection reads as zero bytes, like on the device.
+    if (!received)
+    {
+        state.is_failed = true;
+
+        return 0;
+    }
+
+    state.remaining -= received;
+
+    return received;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *request, const char *field)
+{
+    const auto value = header_value(state_of(request), field);
+
+    return value ? value->size() : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *request, const char *field, char *value, size_t size)
+{
+    const auto found = header_value(state_of(request), field);
+
+    if (!found)
+        return ESP_ERR_NOT_FOUND;
+
+    if (!size)
+        return ESP_ERR_INVALID_ARG;
+
+    strncpy(value, found->c_str(), size - 1);
+    value[std::min(size - 1, found->size())] = '\0';
+
+    return found->size() < size ? ESP_OK : ESP_ERR_HTTPD_RESULT_TRUNC;
+}
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *request, httpd_req_t **copy)
+{
+    auto &state = state_of(request);
+
+    if (!copy)
+        return ESP_ERR_INVALID_ARG;
+
+    auto copied_state = new request_state(state);
+    auto copied_request = new httpd_req_t(*request);
+
+    copied_request->aux = copied_state;
+
+    {
+        std::lock_guard lock(state.server->mutex);
+
+        state.session->is_paused = true;
+    }
+
+    state.is_async = true;
+    *copy = copied_request;
+
+    return ESP_OK;
+}
+
+// a request that left part of its body unread or failed can't be followed by another one
+// on the same connection, so its session is closed instead of resumed.
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *request)
+{
+    if (!request)
+        return ESP_ERR_INVALID_ARG;
+
+    auto state = static_cast<request_state *>(request->aux);
+    auto &server = *state->server;
+    const int socket = state->session->socket;
+    bool should_close = state->remaining || state->is_failed;
+
+    {
+        std::lock_guard lock(server.mutex);
+
+        state->session->is_paused = false;
+        should_close |= state->session->should_close;
+    }
+
+    delete state;
+    delete request;
+
+    if (should_close)
+        httpd_sess_trigger_close(&server, socket);
+    else
+        wake(server);
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *request, const char *status)
+{
+    state_of(request).status = status;
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *request, const char *type)
+{
+    state_of(request).type = type;
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *request, const char *field, const char *value)
+{
+    auto &state = state_of(request);
+
+    if (state.response_headers.size() >= state.server->config.max_resp_headers)
+        return ESP_ERR_HTTPD_RESP_SEND;
+
+    state.response_headers.emplace_back(field, value);
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *request, const char *buffer, ssize_t size)
+{
+    auto &state = state_of(request);
+
+    if (size == HTTPD_RESP_USE_STRLEN)
+        size = buffer ? strlen(buffer) : 0;
+
+    std::string response = response_head(state, ("Content-Length: " + std::to_string(size)).c_str());
+
+    if (size)
+        response.append(buffer, size);
+
+    state.is_sent = true;
+
+    return send_raw(state, response) ? ESP_OK : ESP_ERR_HTTPD_RESP_SEND;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *request, const char *buffer, ssize_t size)
+{
+    auto &state = state_of(request);
+
+    if (size == HTTPD_RESP_USE_STRLEN)
+        size = buffer ? strlen(buffer) : 0;
+
+    std::string data;
+
+    if (!state.is_chunked)
+    {
+        data = response_head(state, "Transfer-Encoding: chunked");
+        state.is_chunked = true;
+        state.is_sent = true;
+    }
+
+    char length[20];
+
+    snprintf(length, sizeof(length), "%zx\r\n", static_cast<size_t>(size));
+
+    data += length;
+
+    if (size)
+        data.append(buffer, size);
+
+    data += "\r\n";
+
+    return send_raw(state, data) ? ESP_OK : ESP_ERR_HTTPD_RESP_SEND;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *request, httpd_err_code_t error, const char *message)
+{
+    auto &state = state_of(request);
+
+    state.is_failed = true;
+
+    // a response already on its way can't be replaced, closing the connection is all that's left.
+    if (state.is_sent)
+        return ESP_OK;
+
+    state.status = status_text(error);
+    state.type = "text/plain";
+
+    const char *body = message ? message : state.status.c_str();
+
+    return httpd_resp_send(request, body, strlen(body));
+}
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *request, httpd_ws_frame_t *frame, size_t max_size)
+{
+    auto &state = state_of(request);
+
+    frame->final = state.frame_final;
+    frame->fragmented = !state.frame_final || state.frame_type == HTTPD_WS_TYPE_CONTINUE;
+    frame->type = state.frame_type;
+
+    if (!max_size)
+    {
+        frame->len = state.frame_size;
+
+        return ESP_OK;
+    }
+
+    if (!frame->payload)
+        return ESP_ERR_INVALID_ARG;
+
+    // frames arrive whole here, on the device the payload is still read off the socket.
+    if (const uint32_t delay_us = frame_payload_delay_us.load())
+        std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+
+    frame->len = std::min(max_size, state.frame_size);
+
+    memcpy(frame->payload, state.frame_payload, frame->len);
+
+    return ESP_OK;
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t handle, int socket, httpd_ws_frame_t *frame)
+{
+    auto server = static_cast<http_server *>(handle);
+    const bool is_final = frame->final || !frame->fragmented;
+    uint8_t header[10];
+    size_t header_size = 2;
+
+    header[0] = (is_final ? 0x80 : 0) | frame->type;
+
+    if (frame->len < 126)
+        header[1] = frame->len;
+    else if (frame->len <= 0xffff)
+    {
+        header[1] = 126;
+        header[2] = frame->len >> 8;
+        header[3] = frame->len;
+        header_size += 2;
+    }
+    else
+    {
+        header[1] = 127;
+
+        for (size_t i = 0; i < 8; i++)
+            header[2 + i] = static_cast<uint64_t>(frame->len) >> (8 * (7 - i));
+
+        header_size += 8;
+    }
+
+    std::unique_lock server_lock(server->mutex);
+
+    const auto found = server->sessions.find(socket);
+
+    if (found == server->sessions.end() || !found->second->is_websocket)
+        return ESP_FAIL;
+
+    auto &session = *found->second;
+    std::lock_guard lock(session.send_mutex);
+
+    server_lock.unlock();
+
+    return send_all(session, header, header_size) && send_all(session, frame->payload, frame->len) ? ESP_OK : ESP_FAIL;
+}
+
+namespace host_shim
+{
+    void set_frame_payload_delay(const uint32_t us)
+    {
+        frame_payload_delay_us = us;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+
+#include <mutex>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+#include <openssl/evp.h>
+
+#include "host_shim.h"
+
+constexpr const uint32_t PARTITION_SIZE = 2U * 1024U * 1024U;
+constexpr const uint8_t IMAGE_MAGIC = 0xe9;
+
+struct ota_slot
+{
+    esp_partition_t partition;
+    std::vector<uint8_t> image;
+};
+
+static std::mutex slots_mutex;
+static ota_slot slots[2] = {
+    {{ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x10000, PARTITION_SIZE, 0x1000, "ota_0", false, false}, {}},
+    {{ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x210000, PARTITION_SIZE, 0x1000, "ota_1", false, false}, {}},
+};
+static size_t running_slot = 0;
+static size_t boot_slot = 0;
+static esp_ota_handle_t session_handle = 0;
+static esp_ota_handle_t next_handle = 1;
+static uint32_t write_delay_us_per_kib = 0;
+
+static ota_slot *slot_of(const esp_partition_t *partition)
+{
+    for (auto &slot : slots)
+        if (&slot.partition == partition)
+            return &slot;
+
+    return nullptr;
+}
+
+static ota_slot &update_slot()
+{
+    return slots[1 - running_slot];
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, const size_t offset, void *destination, const size_t size)
+{
+    std::lock_guard lock(slots_mutex);
+
+    const auto slot = slot_of(partition);
+
+    if (!slot || offset + size > partition->size)
+        return ESP_ERR_INVALID_ARG;
+
+    // erased flash reads back as ones.
+    memset(destination, 0xff, size);
+
+    if (offset < slot->image.size())
+        memcpy(destination, slot->image.data() + offset, std::min(size, slot->image.size() - offset));
+
+    return ESP_OK;
+}
+
+// like for app partitions on the device the hash only covers the image, not the whole slot.
+esp_err_t esp_partition_get_sha256(const esp_partition_t *partition, uint8_t *sha_256)
+{
+    std::lock_guard lock(slots_mutex);
+
+    const auto slot = slot_of(partition);
+
+    if (!slot)
+        return ESP_ERR_INVALID_ARG;
+
+    unsigned int size = 0;
+
+    return EVP_Digest(slot->image.data(), slot->image.size(), sha_256, &size, EVP_sha256(), nullptr) ? ESP_OK : ESP_FAIL;
+}
+
+const esp_partition_t *esp_ota_get_running_partition()
+{
+    return &slots[running_slot].partition;
+}
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *)
+{
+    return &update_slot().partition;
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, const size_t, esp_ota_handle_t *handle)
+{
+    std::lock_guard lock(slots_mutex);
+
+    if (partition != &update_slot().partition)
+        return ESP_ERR_INVALID_ARG;
+
+    if (session_handle)
+        return ESP_ERR_INVALID_STATE;
+
+    update_slot().image.clear();
+
+    session_handle = next_handle++;
+    *handle = session_handle;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, const size_t size)
+{
+    uint32_t delay_us = 0;
+
+    {
+        std::lock_guard lock(slots_mutex);
+
+        auto &image = update_slot().image;
+
+        if (!handle || handle != session_handle)
+            return ESP_ERR_INVALID_ARG;
+
+        if (image.size() + size > PARTITION_SIZE)
+            return ESP_ERR_INVALID_SIZE;
+
+        if (image.empty() && size && *static_cast<const uint8_t *>(data) != IMAGE_MAGIC)
+            return ESP_ERR_OTA_VALIDATE_FAILED;
+
+        image.insert(image.end(), static_cast<const uint8_t *>(data), static_cast<const uint8_t *>(data) + size);
+
+        delay_us = static_cast<uint32_t>((static_cast<uint64_t>(write_delay_us_per_kib) * size) / 1024U);
+    }
+
+    if (delay_us)
+        std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle)
+{
+    std::lock_guard lock(slots_mutex);
+
+    if (!handle || handle != session_handle)
+        return ESP_ERR_INVALID_ARG;
+
+    session_handle = 0;
+
+    const auto &image = update_slot().image;
+
+    return image.empty() || image.front() != IMAGE_MAGIC ? ESP_ERR_OTA_VALIDATE_FAILED : ESP_OK;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle)
+{
+    std::lock_guard lock(slots_mutex);
+
+    if (!handle || handle != session_handle)
+        return ESP_ERR_NOT_FOUND;
+
+    session_handle = 0;
+    update_slot().image.clear();
+
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition)
+{
+    std::lock_guard lock(slots_mutex);
+
+    const auto slot = slot_of(partition);
+
+    if (!slot || slot->image.empty())
+        return ESP_ERR_INVALID_ARG;
+
+    boot_slot = slot - slots;
+
+    return ESP_OK;
+}
+
+namespace host_shim
+{
+    void set_running_image(const std::vector<uint8_t> &image)
+    {
+        std::lock_guard lock(slots_mutex);
+
+        running_slot = boot_slot;
+        slots[running_slot].image = image;
+        update_slot().image.clear();
+    }
+
+    std::vector<uint8_t> boot_image()
+    {
+        std::lock_guard lock(slots_mutex);
+
+        return slots[boot_slot].image;
+    }
+
+    void set_flash_write_delay(const uint32_t us_per_kib)
+    {
+        std::lock_guard lock(slots_mutex);
+
+        write_delay_us_per_kib = us_per_kib;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdint>
+
+#include <openssl/md5.h>
+
+typedef MD5_CTX md5_context_t;
+
+void esp_rom_md5_init(md5_context_t *context);
+void esp_rom_md5_update(md5_context_t *context, const void *data, const uint32_t size);
+void esp_rom_md5_final(uint8_t *digest, md5_context_t *context);
\ No newline at end of file
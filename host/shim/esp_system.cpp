@@ -0,0 +1,239 @@
+#include <esp_err.h>
+#include <esp_log.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <cstdio>
+#include <cstdarg>
+#include <condition_variable>
+
+#include "host_shim.h"
+
+static const auto started_at = std::chrono::steady_clock::now();
+static std::atomic<esp_log_level_t> log_level = ESP_LOG_INFO;
+static std::mutex log_mutex;
+
+const char *esp_err_to_name(const esp_err_t error)
+{
+    switch (error)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+        return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:
+        return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:
+        return "ESP_ERR_TIMEOUT";
+    default:
+        return "UNKNOWN ERROR";
+    }
+}
+
+void esp_log_level_set(const char *, const esp_log_level_t level)
+{
+    log_level = level;
+}
+
+void esp_log_write(const esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    if (level > log_level)
+        return;
+
+    constexpr const char letters[] = "NEWIDV";
+
+    va_list arguments;
+    va_start(arguments, format);
+
+    {
+        std::lock_guard lock(log_mutex);
+
+        fprintf(stderr, "%c (%lld) %s: ", letters[level], static_cast<long long>(esp_timer_get_time() / 1000), tag);
+        vfprintf(stderr, format, arguments);
+        fputc('\n', stderr);
+    }
+
+    va_end(arguments);
+}
+
+void esp_restart()
+{
+    host_shim::request_restart();
+}
+
+int64_t esp_timer_get_time()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started_at).count();
+}
+
+struct esp_timer
+{
+    esp_timer_create_args_t arguments;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::microseconds period{0};
+    bool is_armed = false;
+    bool is_deleted = false;
+    // deleted from its own callback, nobody is left to join the thread.
+    bool is_orphaned = false;
+};
+
+static void run_timer(esp_timer *timer)
+{
+    std::unique_lock lock(timer->mutex);
+
+    while (!timer->is_deleted)
+    {
+        if (!timer->is_armed)
+        {
+            timer->changed.wait(lock);
+
+            continue;
+        }
+
+        if (timer->changed.wait_until(lock, timer->deadline) != std::cv_status::timeout)
+            continue;
+
+        if (!timer->is_armed || std::chrono::steady_clock::now() < timer->deadline)
+            continue;
+
+        if (timer->period.count())
+        {
+            timer->deadline += timer->period;
+
+            // a periodic timer that fell behind skips the periods it missed.
+            if (timer->deadline < std::chrono::steady_clock::now())
+                timer->deadline = std::chrono::steady_clock::now() + timer->period;
+        }
+        else
+            timer->is_armed = false;
+
+        lock.unlock();
+
+        timer->arguments.callback(timer->arguments.arg);
+
+        lock.lock();
+    }
+
+    // the thread compares equal to itself until esp_timer_delete() joined it, only the flag
+    // tells whether anybody is going to.
+    if (timer->is_orphaned)
+    {
+        timer->thread.detach();
+
+        lock.unlock();
+
+        delete timer;
+    }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *arguments, esp_timer_handle_t *timer)
+{
+    if (!arguments || !arguments->callback || !timer)
+        return ESP_ERR_INVALID_ARG;
+
+    auto created = new esp_timer;
+
+    created->arguments = *arguments;
+
+    std::lock_guard lock(created->mutex);
+
+    created->thread = std::thread(run_timer, created);
+
+    *timer = created;
+
+    return ESP_OK;
+}
+
+static esp_err_t start(esp_timer_handle_t timer, const uint64_t timeout_us, const bool is_periodic)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+
+    {
+        std::lock_guard lock(timer->mutex);
+
+        if (timer->is_armed)
+            return ESP_ERR_INVALID_STATE;
+
+        timer->is_armed = true;
+        timer->period = std::chrono::microseconds(is_periodic ? timeout_us : 0);
+        timer->deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+    }
+
+    timer->changed.notify_all();
+
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, const uint64_t timeout_us)
+{
+    return start(timer, timeout_us, false);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, const uint64_t period_us)
+{
+    return start(timer, period_us, true);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+
+    {
+        std::lock_guard lock(timer->mutex);
+
+        if (!timer->is_armed)
+            return ESP_ERR_INVALID_STATE;
+
+        timer->is_armed = false;
+    }
+
+    timer->changed.notify_all();
+
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+
+    {
+        std::lock_guard lock(timer->mutex);
+
+        timer->is_armed = false;
+        timer->is_deleted = true;
+
+        if (timer->thread.get_id() == std::this_thread::get_id())
+        {
+            timer->is_orphaned = true;
+
+            return ESP_OK;
+        }
+    }
+
+    timer->changed.notify_all();
+    timer->thread.join();
+
+    delete timer;
+
+    return ESP_OK;
+}
\ No newline at end of file
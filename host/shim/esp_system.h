@@ -0,0 +1,4 @@
+#pragma once
+
+// only recorded, see host_shim::restart_requested().
+void esp_restart();
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+#include "esp_err.h"
+
+struct esp_timer;
+
+typedef esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *argument);
+
+typedef enum
+{
+    ESP_TIMER_TASK,
+} esp_timer_dispatch_t;
+
+typedef struct
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char *name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+// every timer runs its callbacks on a thread of its own instead of the shared timer task.
+esp_err_t esp_timer_create(const esp_timer_create_args_t *arguments, esp_timer_handle_t *timer);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, const uint64_t timeout_us);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, const uint64_t period_us);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+
+int64_t esp_timer_get_time();
\ No newline at end of file
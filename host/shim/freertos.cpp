@@ -0,0 +1,531 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <condition_variable>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host_shim.h"
+
+// deleted tasks notice within one slice of whatever they are blocked on.
+constexpr const auto WAIT_SLICE = std::chrono::milliseconds(10);
+
+struct task_deleted
+{
+};
+
+struct task_control_block
+{
+    std::thread thread;
+    char name[configMAX_TASK_NAME_LEN] = {};
+    UBaseType_t number = 0;
+    UBaseType_t priority = 0;
+    BaseType_t core = tskNO_AFFINITY;
+    uint32_t stack_size = 0;
+
+    std::mutex mutex;
+    std::condition_variable notified;
+    uint32_t notifications = 0;
+
+    clockid_t clock = 0;
+    bool has_clock = false;
+    bool finished = false;
+    bool joining = false;
+    std::atomic<bool> deleted = false;
+};
+
+struct queue_definition
+{
+    queue_definition(const UBaseType_t queue_length, const UBaseType_t queue_item_size) : length(queue_length),
+                                                                                         item_size(queue_item_size),
+                                                                                         storage(queue_length * queue_item_size)
+    {
+    }
+
+    const UBaseType_t length;
+    const UBaseType_t item_size;
+    std::vector<uint8_t> storage;
+    UBaseType_t head = 0;
+    UBaseType_t count = 0;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+static std::mutex registry_mutex;
+static std::vector<task_control_block *> registry;
+static std::atomic<UBaseType_t> task_numbers = 1;
+static std::mutex creations_mutex;
+static uint32_t skipped_creations = 0;
+static uint32_t failing_creations = 0;
+static std::atomic<bool> restart = false;
+static const auto started_at = std::chrono::steady_clock::now();
+
+static task_control_block idle_tasks[portNUM_PROCESSORS];
+
+static thread_local task_control_block *current_task = nullptr;
+
+static void register_task(task_control_block *task)
+{
+    std::lock_guard lock(registry_mutex);
+
+    registry.push_back(task);
+}
+
+static void unregister_task(task_control_block *task)
+{
+    std::lock_guard lock(registry_mutex);
+
+    registry.erase(std::remove(registry.begin(), registry.end(), task), registry.end());
+}
+
+static void attach_clock(task_control_block *task)
+{
+    std::lock_guard lock(task->mutex);
+
+    task->has_clock = !pthread_getcpuclockid(pthread_self(), &task->clock);
+}
+
+// threads freertos didn't create (main, test runners, the shimmed httpd) get a control
+// block on first use so names, notifications and the report work for them too.
+struct adopted_thread
+{
+    ~adopted_thread()
+    {
+        if (task)
+        {
+            unregister_task(task);
+
+            delete task;
+        }
+    }
+
+    task_control_block *task = nullptr;
+};
+
+static thread_local adopted_thread adopted;
+
+static task_control_block *current()
+{
+    if (current_task)
+        return current_task;
+
+    auto task = new task_control_block;
+    const bool is_main = getpid() == gettid();
+
+    strncpy(task->name, is_main ? "main" : "thread", sizeof(task->name) - 1U);
+    task->number = task_numbers++;
+    task->priority = 1;
+
+    attach_clock(task);
+    register_task(task);
+
+    adopted.task = task;
+    current_task = task;
+
+    return task;
+}
+
+static bool should_fail_creation()
+{
+    std::lock_guard lock(creations_mutex);
+
+    if (skipped_creations)
+    {
+        skipped_creations--;
+
+        return false;
+    }
+
+    if (!failing_creations)
+        return false;
+
+    failing_creations--;
+
+    return true;
+}
+
+// waits in slices so a task deleted while blocked unwinds instead of waiting forever.
+template <typename predicate_type>
+static bool wait_for(std::unique_lock<std::mutex> &lock, std::condition_variable &condition, const TickType_t ticks, predicate_type &&ready)
+{
+    task_control_block *task = current();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(ticks * portTICK_PERIOD_MS);
+
+    while (!ready())
+    {
+        if (task->deleted)
+            throw task_deleted();
+
+        if (ticks == portMAX_DELAY)
+        {
+            condition.wait_for(lock, WAIT_SLICE);
+
+            continue;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+
+        if (now >= deadline)
+            return false;
+
+        condition.wait_for(lock, std::min<std::chrono::steady_clock::duration>(deadline - now, WAIT_SLICE));
+    }
+
+    return true;
+}
+
+static void run_task(task_control_block *task, TaskFunction_t function, void *argument)
+{
+    current_task = task;
+
+    attach_clock(task);
+
+    try
+    {
+        function(argument);
+    }
+    catch (const task_deleted &)
+    {
+    }
+
+    unregister_task(task);
+
+    std::lock_guard lock(task->mutex);
+
+    task->finished = true;
+
+    if (!task->joining)
+        task->thread.detach();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, const uint32_t stack_size, void *argument, UBaseType_t priority, TaskHandle_t *created, const BaseType_t core)
+{
+    if (should_fail_creation())
+        return pdFAIL;
+
+    auto task = new task_control_block;
+
+    strncpy(task->name, name ? name : "", sizeof(task->name) - 1U);
+    task->number = task_numbers++;
+    task->priority = priority;
+    task->core = core;
+    task->stack_size = stack_size;
+
+    register_task(task);
+
+    if (created)
+        *created = task;
+
+    // held until the thread is stored, a task that ends right away finds it to detach.
+    std::lock_guard lock(task->mutex);
+
+    task->thread = std::thread(run_task, task, function, argument);
+
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, const uint32_t stack_size, void *argument, UBaseType_t priority, TaskHandle_t *created)
+{
+    return xTaskCreatePinnedToCore(function, name, stack_size, argument, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (!task || task == current())
+        throw task_deleted();
+
+    {
+        std::lock_guard lock(task->mutex);
+
+        if (task->finished)
+            return;
+
+        task->deleted = true;
+        task->joining = true;
+    }
+
+    task->notified.notify_all();
+    task->thread.join();
+}
+
+void vTaskDelay(const TickType_t ticks)
+{
+    std::mutex mutex;
+    std::condition_variable never;
+    std::unique_lock lock(mutex);
+
+    wait_for(lock, never, ticks, []()
+             { return false; });
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started_at).count() / portTICK_PERIOD_MS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return current();
+}
+
+char *pcTaskGetName(TaskHandle_t task)
+{
+    return (task ? task : current())->name;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    {
+        std::lock_guard lock(task->mutex);
+
+        task->notifications++;
+    }
+
+    task->notified.notify_all();
+
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(const BaseType_t clear, const TickType_t ticks)
+{
+    task_control_block *task = current();
+    std::unique_lock lock(task->mutex);
+
+    if (!wait_for(lock, task->notified, ticks, [task]()
+                  { return task->notifications > 0; }))
+        return 0;
+
+    const uint32_t taken = task->notifications;
+
+    task->notifications = clear ? 0 : taken - 1;
+
+    return taken;
+}
+
+static uint64_t cpu_time(task_control_block *task)
+{
+    timespec time = {};
+
+    std::lock_guard lock(task->mutex);
+
+    if (!task->has_clock || task->finished || clock_gettime(task->clock, &time))
+        return 0;
+
+    return static_cast<uint64_t>(time.tv_sec) * 1000000U + time.tv_nsec / 1000U;
+}
+
+__attribute__((weak)) UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, const UBaseType_t size, configRUN_TIME_COUNTER_TYPE *total_run_time)
+{
+    const uint64_t wall = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started_at).count();
+
+    std::lock_guard lock(registry_mutex);
+
+    if (registry.size() + portNUM_PROCESSORS > size)
+        return 0;
+
+    UBaseType_t count = 0;
+    uint64_t busy = 0;
+
+    for (const auto task : registry)
+    {
+        const uint64_t used = cpu_time(task);
+
+        busy += used;
+
+        status[count++] = {
+            .xHandle = task,
+            .pcTaskName = task->name,
+            .xTaskNumber = task->number,
+            .eCurrentState = task == current_task ? eRunning : eBlocked,
+            .uxCurrentPriority = task->priority,
+            .uxBasePriority = task->priority,
+            .ulRunTimeCounter = static_cast<configRUN_TIME_COUNTER_TYPE>(used),
+            .pxStackBase = nullptr,
+            .usStackHighWaterMark = task->stack_size,
+            .xCoreID = task->core,
+        };
+    }
+
+    const uint64_t idle = wall > busy / portNUM_PROCESSORS ? wall - busy / portNUM_PROCESSORS : 0U;
+
+    for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        auto &task = idle_tasks[core];
+
+        if (!*task.name)
+            snprintf(task.name, sizeof(task.name), "IDLE%d", core);
+
+        status[count++] = {
+            .xHandle = &task,
+            .pcTaskName = task.name,
+            .xTaskNumber = 0,
+            .eCurrentState = eReady,
+            .uxCurrentPriority = 0,
+            .uxBasePriority = 0,
+            .ulRunTimeCounter = static_cast<configRUN_TIME_COUNTER_TYPE>(idle),
+            .pxStackBase = nullptr,
+            .usStackHighWaterMark = 0,
+            .xCoreID = core,
+        };
+    }
+
+    if (total_run_time)
+        *total_run_time = static_cast<configRUN_TIME_COUNTER_TYPE>(wall);
+
+    return count;
+}
+
+__attribute__((weak)) TaskHandle_t xTaskGetIdleTaskHandleForCore(const BaseType_t core)
+{
+    return core >= 0 && core < portNUM_PROCESSORS ? &idle_tasks[core] : nullptr;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    return (task ? task : current())->stack_size;
+}
+
+QueueHandle_t xQueueCreate(const UBaseType_t length, const UBaseType_t item_size)
+{
+    if (!length || should_fail_creation())
+        return nullptr;
+
+    return new queue_definition(length, item_size);
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, const TickType_t ticks)
+{
+    {
+        std::unique_lock lock(queue->mutex);
+
+        if (!wait_for(lock, queue->changed, ticks, [queue]()
+                      { return queue->count < queue->length; }))
+            return pdFALSE;
+
+        if (queue->item_size)
+            std::memcpy(queue->storage.data() + ((queue->head + queue->count) % queue->length) * queue->item_size, item, queue->item_size);
+
+        queue->count++;
+    }
+
+    queue->changed.notify_all();
+
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, const TickType_t ticks)
+{
+    return xQueueSend(queue, item, ticks);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, const TickType_t ticks)
+{
+    {
+        std::unique_lock lock(queue->mutex);
+
+        if (!wait_for(lock, queue->changed, ticks, [queue]()
+                      { return queue->count > 0; }))
+            return pdFALSE;
+
+        if (queue->item_size)
+            std::memcpy(item, queue->storage.data() + queue->head * queue->item_size, queue->item_size);
+
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+    }
+
+    queue->changed.notify_all();
+
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t queue)
+{
+    std::lock_guard lock(queue->mutex);
+
+    return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(const QueueHandle_t queue)
+{
+    std::lock_guard lock(queue->mutex);
+
+    return queue->length - queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    SemaphoreHandle_t semaphore = xQueueCreate(1, 0);
+
+    if (semaphore)
+        xSemaphoreGive(semaphore);
+
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(const UBaseType_t maximum, const UBaseType_t initial)
+{
+    SemaphoreHandle_t semaphore = xQueueCreate(maximum, 0);
+
+    for (UBaseType_t i = 0; semaphore && i < initial; i++)
+        xSemaphoreGive(semaphore);
+
+    return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, const TickType_t ticks)
+{
+    return xQueueReceive(semaphore, nullptr, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    return xQueueSend(semaphore, nullptr, 0);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore)
+{
+    return uxQueueMessagesWaiting(semaphore);
+}
+
+namespace host_shim
+{
+    void fail_next_creations(const uint32_t count, const uint32_t skip)
+    {
+        std::lock_guard lock(creations_mutex);
+
+        skipped_creations = count ? skip : 0;
+        failing_creations = count;
+    }
+
+    void request_restart()
+    {
+        restart = true;
+    }
+
+    bool restart_requested()
+    {
+        return restart;
+    }
+}
\ No newline at end of file
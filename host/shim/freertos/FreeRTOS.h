@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <sdkconfig.h>
+
+// the subset of freertos the firmware uses, backed by std::thread. ticks are milliseconds,
+// every task is its own thread and runs whenever the host schedules it, priorities and
+// cores are only recorded for the task report.
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define configTICK_RATE_HZ 1000U
+#define configMAX_TASK_NAME_LEN 16
+#define configRUN_TIME_COUNTER_TYPE uint32_t
+
+#define portNUM_PROCESSORS 2
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS (1000U / configTICK_RATE_HZ)
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define pdMS_TO_TICKS(milliseconds) ((TickType_t)(((TickType_t)(milliseconds) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000U))
+
+#define tskNO_AFFINITY ((BaseType_t)0x7fffffff)
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct queue_definition;
+
+typedef queue_definition *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(const UBaseType_t length, const UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, const TickType_t ticks);
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, const TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, const TickType_t ticks);
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(const QueueHandle_t queue);
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+// semaphores are queues of empty items like in freertos, a mutex starts out given.
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateCounting(const UBaseType_t maximum, const UBaseType_t initial);
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, const TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore);
+
+#define vSemaphoreDelete(semaphore) vQueueDelete(semaphore)
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct task_control_block;
+
+typedef task_control_block *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum
+{
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid,
+} eTaskState;
+
+typedef struct xTASK_STATUS
+{
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    configRUN_TIME_COUNTER_TYPE ulRunTimeCounter;
+    StackType_t *pxStackBase;
+    uint32_t usStackHighWaterMark;
+    BaseType_t xCoreID;
+} TaskStatus_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, const uint32_t stack_size, void *argument, UBaseType_t priority, TaskHandle_t *created, const BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, const uint32_t stack_size, void *argument, UBaseType_t priority, TaskHandle_t *created);
+
+// deleting another task waits until it reaches its next blocking call and unwinds it from
+// there, deleting the calling task never returns.
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(const TickType_t ticks);
+
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+char *pcTaskGetName(TaskHandle_t task);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(const BaseType_t clear, const TickType_t ticks);
+
+// run time counters are the cpu time of each thread in microseconds, the idle tasks get
+// whatever is left of the wall time. both are weak so tests can fake the system state.
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, const UBaseType_t size, configRUN_TIME_COUNTER_TYPE *total_run_time);
+TaskHandle_t xTaskGetIdleTaskHandleForCore(const BaseType_t core);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
\ No newline at end of file
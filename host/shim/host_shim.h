@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// knobs the host build adds on top of the shimmed apis, only tests and benchmarks use them.
+namespace host_shim
+{
+    // the next count queue, semaphore and task creations fail like they do when the heap
+    // is exhausted on the device, after skip more of them went through.
+    void fail_next_creations(const uint32_t count, const uint32_t skip = 0);
+
+    // esp_restart() only records the request, the host process keeps running.
+    void request_restart();
+    bool restart_requested();
+
+    // the running ota slot holds image, the other one is erased. boot_image() is whatever
+    // the next boot would run.
+    void set_running_image(const std::vector<uint8_t> &image);
+    std::vector<uint8_t> boot_image();
+
+    // every esp_ota_write() blocks for this long per KiB, like a slow flash chip.
+    void set_flash_write_delay(const uint32_t us_per_kib);
+
+    // httpd_ws_recv_frame() blocks for this long before it hands out a payload, like a frame
+    // still coming in over a slow link while the handler waits for it.
+    void set_frame_payload_delay(const uint32_t us);
+
+    // how many bytes the heap_caps region caps falls into holds, internal ram is unlimited
+    // and psram 8 MiB unless a test changes them. 0 is a board without psram.
+    void set_heap_size(const uint32_t caps, const size_t size);
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+#include <openssl/sha.h>
+
+// openssl's plain context keeps mbedtls' value semantics, nothing to leak if free is skipped.
+typedef struct
+{
+    SHA256_CTX context;
+    int is224;
+} mbedtls_sha256_context;
+
+void mbedtls_sha256_init(mbedtls_sha256_context *context);
+void mbedtls_sha256_free(mbedtls_sha256_context *context);
+int mbedtls_sha256_starts(mbedtls_sha256_context *context, const int is224);
+int mbedtls_sha256_update(mbedtls_sha256_context *context, const unsigned char *data, const size_t size);
+int mbedtls_sha256_finish(mbedtls_sha256_context *context, unsigned char *digest);
+int mbedtls_sha256(const unsigned char *data, const size_t size, unsigned char *digest, const int is224);
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include <miniz.h>
+
+#include <cstring>
+
+static voidpf arena_allocate(voidpf opaque, uInt count, uInt size)
+{
+    auto decompressor = static_cast<tinfl_decompressor *>(opaque);
+    const size_t requested = (static_cast<size_t>(count) * size + 15U) & ~static_cast<size_t>(15U);
+
+    if (decompressor->arena_used + requested > sizeof(decompressor->arena))
+        return Z_NULL;
+
+    void *allocated = decompressor->arena + decompressor->arena_used;
+
+    decompressor->arena_used += requested;
+
+    return allocated;
+}
+
+static void arena_free(voidpf, voidpf)
+{
+}
+
+void tinfl_init(tinfl_decompressor *decompressor)
+{
+    decompressor->is_started = false;
+    decompressor->arena_used = 0;
+}
+
+tinfl_status tinfl_decompress(tinfl_decompressor *decompressor,
+                              const uint8_t *input,
+                              size_t *input_size,
+                              uint8_t *,
+                              uint8_t *output_next,
+                              size_t *output_size,
+                              const mz_uint32 flags)
+{
+    auto &stream = decompressor->stream;
+
+    if (!decompressor->is_started)
+    {
+        memset(&stream, 0, sizeof(stream));
+
+        stream.zalloc = arena_allocate;
+        stream.zfree = arena_free;
+        stream.opaque = decompressor;
+
+        if (inflateInit2(&stream, (flags & TINFL_FLAG_PARSE_ZLIB_HEADER) ? MAX_WBITS : -MAX_WBITS) != Z_OK)
+            return TINFL_STATUS_BAD_PARAM;
+
+        decompressor->is_started = true;
+    }
+
+    stream.next_in = const_cast<Bytef *>(input);
+    stream.avail_in = static_cast<uInt>(*input_size);
+    stream.next_out = output_next;
+    stream.avail_out = static_cast<uInt>(*output_size);
+
+    const int result = inflate(&stream, Z_NO_FLUSH);
+
+    *input_size -= stream.avail_in;
+    *output_size -= stream.avail_out;
+
+    if (result == Z_STREAM_END)
+        return TINFL_STATUS_DONE;
+
+    if (result == Z_DATA_ERROR && stream.msg && !strcmp(stream.msg, "incorrect data check"))
+        return TINFL_STATUS_ADLER32_MISMATCH;
+
+    if (result != Z_OK && result != Z_BUF_ERROR)
+        return TINFL_STATUS_FAILED;
+
+    if (!stream.avail_out)
+        return TINFL_STATUS_HAS_MORE_OUTPUT;
+
+    return (flags & TINFL_FLAG_HAS_MORE_INPUT) ? TINFL_STATUS_NEEDS_MORE_INPUT : TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <zlib.h>
+
+// tinfl's streaming interface on top of zlib. zlib allocates from an arena inside the
+// decompressor, so like tinfl's it stays trivial and needs no teardown.
+typedef uint32_t mz_uint32;
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum
+{
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+};
+
+typedef enum
+{
+    TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+struct tinfl_decompressor_tag
+{
+    z_stream stream;
+    bool is_started;
+    size_t arena_used;
+    alignas(16) uint8_t arena[48U * 1024U];
+};
+
+typedef tinfl_decompressor_tag tinfl_decompressor;
+
+void tinfl_init(tinfl_decompressor *decompressor);
+
+tinfl_status tinfl_decompress(tinfl_decompressor *decompressor,
+                              const uint8_t *input,
+                              size_t *input_size,
+                              uint8_t *output_start,
+                              uint8_t *output_next,
+                              size_t *output_size,
+                              const mz_uint32 flags);
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "tlv_tree.h"
+
+constexpr const uint8_t CONSTRUCTED_BIT = 0x20;
+constexpr const uint8_t LONG_TAG = 0x1f;
+constexpr const size_t MAX_DEPTH = 16U;
+
+namespace tlvcpp
+{
+    static void encode_tag(std::vector<uint8_t> &buffer, tag_t tag, const bool is_constructed)
+    {
+        const uint8_t first = is_constructed ? CONSTRUCTED_BIT : 0;
+
+        if (tag < LONG_TAG)
+        {
+            buffer.push_back(first | tag);
+
+            return;
+        }
+
+        uint8_t encoded[5];
+        size_t count = 0;
+
+        encoded[count++] = tag & 0x7f;
+
+        for (tag >>= 7; tag; tag >>= 7)
+            encoded[count++] = 0x80 | (tag & 0x7f);
+
+        buffer.push_back(first | LONG_TAG);
+
+        while (count)
+            buffer.push_back(encoded[--count]);
+    }
+
+    static void encode_length(std::vector<uint8_t> &buffer, const size_t length)
+    {
+        if (length < 0x80)
+        {
+            buffer.push_back(length);
+
+            return;
+        }
+
+        size_t count = 0;
+
+        for (size_t remaining = length; remaining; remaining >>= 8)
+            count++;
+
+        buffer.push_back(0x80 | count);
+
+        while (count--)
+            buffer.push_back(length >> (8 * count));
+    }
+
+    static void encode(std::vector<uint8_t> &buffer, const tlv_tree_node &node)
+    {
+        const bool is_constructed = !node.children().empty();
+
+        encode_tag(buffer, node.data().tag(), is_constructed);
+
+        if (!is_constructed)
+        {
+            encode_length(buffer, node.data().length());
+
+            buffer.insert(buffer.end(), node.data().value(), node.data().value() + node.data().length());
+
+            return;
+        }
+
+        // children are encoded first, then their length is put in front of them.
+        std::vector<uint8_t> value;
+
+        for (const auto &child : node.children())
+            encode(value, child);
+
+        encode_length(buffer, value.size());
+
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+
+    static bool decode(const uint8_t *&data, const uint8_t *end, tlv_tree_node &node, const size_t depth)
+    {
+        if (depth > MAX_DEPTH || data == end)
+            return false;
+
+        const bool is_constructed = *data & CONSTRUCTED_BIT;
+        tag_t tag = *data++ & ~CONSTRUCTED_BIT;
+
+        if (tag == LONG_TAG)
+        {
+            tag = 0;
+
+            for (size_t i = 0;; i++)
+            {
+                if (data == end || i == 5)
+                    return false;
+
+                const uint8_t byte = *data++;
+
+                tag = (tag << 7) | (byte & 0x7f);
+
+                if (!(byte & 0x80))
+                    break;
+            }
+        }
+
+        if (data == end)
+            return false;
+
+        size_t length = *data++;
+
+        if (length & 0x80)
+        {
+            const size_t count = length & 0x7f;
+
+            if (!count || count > sizeof(uint32_t) || static_cast<size_t>(end - data) < count)
+                return false;
+
+            length = 0;
+
+            for (size_t i = 0; i < count; i++)
+                length = (length << 8) | *data++;
+        }
+
+        if (static_cast<size_t>(end - data) < length)
+            return false;
+
+        const uint8_t *value_end = data + length;
+
+        if (!is_constructed)
+        {
+            node = tlv_tree_node(tag, length, data);
+            data = value_end;
+
+            return true;
+        }
+
+        node = tlv_tree_node(tag);
+
+        while (data != value_end)
+            if (!decode(data, value_end, node.add_child(), depth + 1))
+                return false;
+
+        return true;
+    }
+
+    bool tlv_tree_node::serialize(std::vector<uint8_t> &buffer, size_t *bytes_written) const
+    {
+        const size_t size = buffer.size();
+
+        encode(buffer, *this);
+
+        if (bytes_written)
+            *bytes_written = buffer.size() - size;
+
+        return true;
+    }
+
+    bool tlv_tree_node::deserialize(const uint8_t *data, const size_t size)
+    {
+        tlv_tree_node decoded;
+        const uint8_t *end = data + size;
+
+        if (!decode(data, end, decoded, 0) || data != end)
+            return false;
+
+        *this = std::move(decoded);
+
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <list>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+
+// the part of libtlvcpp the firmware uses: ber-tlv trees, constructed nodes carry children
+// and primitive nodes their own copy of the value.
+namespace tlvcpp
+{
+    typedef uint32_t tag_t;
+
+    class tlv
+    {
+    public:
+        tlv(const tag_t tag = 0, const size_t length = 0, const uint8_t *value = nullptr) : m_tag(tag),
+                                                                                             m_value(value, value + (value ? length : 0))
+        {
+        }
+
+        tag_t tag() const { return m_tag; }
+        size_t length() const { return m_value.size(); }
+        const uint8_t *value() const { return m_value.data(); }
+
+    private:
+        tag_t m_tag;
+        std::vector<uint8_t> m_value;
+    };
+
+    class tlv_tree_node
+    {
+    public:
+        tlv_tree_node() = default;
+
+        template <typename... arguments_type>
+            requires std::is_constructible_v<tlv, arguments_type...>
+        tlv_tree_node(arguments_type &&...arguments) : m_data(std::forward<arguments_type>(arguments)...)
+        {
+        }
+
+        tlv_tree_node(const tlv_tree_node &) = default;
+        tlv_tree_node(tlv_tree_node &&) = default;
+        tlv_tree_node &operator=(const tlv_tree_node &) = default;
+        tlv_tree_node &operator=(tlv_tree_node &&) = default;
+
+        tlv &data() { return m_data; }
+        const tlv &data() const { return m_data; }
+
+        std::list<tlv_tree_node> &children() { return m_children; }
+        const std::list<tlv_tree_node> &children() const { return m_children; }
+
+        template <typename... arguments_type>
+        tlv_tree_node &add_child(arguments_type &&...arguments)
+        {
+            return m_children.emplace_back(std::forward<arguments_type>(arguments)...);
+        }
+
+        // appends the encoded tree to buffer.
+        bool serialize(std::vector<uint8_t> &buffer, size_t *bytes_written = nullptr) const;
+        bool deserialize(const uint8_t *data, const size_t size);
+
+    private:
+        tlv m_data;
+        std::list<tlv_tree_node> m_children;
+    };
+}
\ No newline at end of file
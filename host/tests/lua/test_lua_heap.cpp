@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <lua.hpp>
+
+#include "scripting/lua_heap.h"
+
+constexpr const size_t LIMIT = 96U * 1024U;
+
+static memory_account test_account("lua_test");
+
+class lua_heap_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mp_state = lua_newstate(lua_heap::allocate, &m_heap);
+
+        ASSERT_TRUE(mp_state);
+
+        luaL_openlibs(mp_state);
+        m_heap.attach(mp_state);
+    }
+
+    void TearDown() override
+    {
+        lua_close(mp_state);
+    }
+
+    // the status of the call, luaL_dostring() folds it into a boolean.
+    int run(const char *source)
+    {
+        const int status = luaL_loadstring(mp_state, source);
+
+        return status == LUA_OK ? lua_pcall(mp_state, 0, 0, 0) : status;
+    }
+
+    size_t reserved() const
+    {
+        const auto &statistics = m_heap.statistics();
+
+        return statistics.slabs + statistics.large;
+    }
+
+    lua_heap m_heap{LIMIT, test_account, memory_placement::internal};
+    lua_State *mp_state = nullptr;
+};
+
+TEST_F(lua_heap_test, keeps_small_objects_within_the_limit)
+{
+    // small tables only, every one of them lives in a slab.
+    EXPECT_EQ(run("local kept = {} for i = 1, 100000 do kept[#kept % 64 + 1] = {} local t = {i} end"), LUA_OK);
+
+    EXPECT_EQ(run("kept = {} for i = 1, 100000 do kept[i] = {i} end"), LUA_ERRMEM);
+
+    EXPECT_LE(reserved(), LIMIT);
+    EXPECT_LE(m_heap.statistics().peak_reserved, LIMIT);
+    EXPECT_GT(m_heap.statistics().failures, 0U);
+}
+
+TEST_F(lua_heap_test, keeps_large_blocks_within_the_limit)
+{
+    EXPECT_EQ(run("kept = {} for i = 1, 1000 do kept[i] = string.rep('x', 4000 + i) end"), LUA_ERRMEM);
+
+    EXPECT_LE(reserved(), LIMIT);
+    EXPECT_LE(m_heap.statistics().peak_reserved, LIMIT);
+    EXPECT_GT(m_heap.statistics().large, 0U);
+}
+
+TEST_F(lua_heap_test, recovers_once_the_garbage_is_gone)
+{
+    EXPECT_EQ(run("kept = {} for i = 1, 100000 do kept[i] = {i} end"), LUA_ERRMEM);
+
+    // without any room left even loading a chunk fails, so drop it from here.
+    lua_pushnil(mp_state);
+    lua_setglobal(mp_state, "kept");
+    lua_gc(mp_state, LUA_GCCOLLECT);
+
+    // the slabs stay reserved for their size class, small objects fit in them again.
+    EXPECT_EQ(run("local kept = {} for i = 1, 100 do kept[i] = {i} end"), LUA_OK);
+    EXPECT_LE(reserved(), LIMIT);
+}
\ No newline at end of file
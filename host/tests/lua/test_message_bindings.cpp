@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include <lua.hpp>
+
+#include "scripting/message_bindings.h"
+
+// keeps whatever lua sends, nothing is ever received.
+class recording_stream : public data_stream
+{
+public:
+    data_stream &operator>>(tlvcpp::tlv_tree_node &node) override
+    {
+        return *this;
+    }
+
+    data_stream &operator<<(const tlvcpp::tlv_tree_node &node) override
+    {
+        sent.push_back(node);
+
+        return *this;
+    }
+
+    std::vector<tlvcpp::tlv_tree_node> sent;
+};
+
+class message_bindings_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mp_state = luaL_newstate();
+        luaL_openlibs(mp_state);
+
+        mp_scheduler = new scheduler(mp_state);
+        mp_bindings = new message_bindings(mp_state, m_stream, *mp_scheduler);
+    }
+
+    void TearDown() override
+    {
+        delete mp_bindings;
+        delete mp_scheduler;
+
+        lua_close(mp_state);
+    }
+
+    // returns the error message, empty when the chunk ran through.
+    std::string run(const char *source)
+    {
+        if (luaL_loadstring(mp_state, source) != LUA_OK || lua_pcall(mp_state, 0, 0, 0) != LUA_OK)
+        {
+            std::string error = lua_tostring(mp_state, -1);
+
+            lua_pop(mp_state, 1);
+
+            return error;
+        }
+
+        return {};
+    }
+
+    lua_Integer global(const char *name)
+    {
+        lua_getglobal(mp_state, name);
+
+        const lua_Integer value = lua_tointeger(mp_state, -1);
+
+        lua_pop(mp_state, 1);
+
+        return value;
+    }
+
+    void receive(tlvcpp::tlv_tree_node &&message)
+    {
+        tlvcpp::tlv_tree_node root;
+
+        root.add_child() = std::move(message);
+
+        ASSERT_TRUE(mp_bindings->post(std::move(root)));
+
+        mp_bindings->dispatch();
+    }
+
+    static tlvcpp::tlv_tree_node position(const uint16_t x, const uint16_t y)
+    {
+        const uint16_t values[] = {x, y};
+        tlvcpp::tlv_tree_node message(0x10);
+
+        message.add_child(0x01, sizeof(values[0]), reinterpret_cast<const uint8_t *>(&values[0]));
+        message.add_child(0x02, sizeof(values[1]), reinterpret_cast<const uint8_t *>(&values[1]));
+
+        return message;
+    }
+
+    lua_State *mp_state = nullptr;
+    recording_stream m_stream;
+    scheduler *mp_scheduler = nullptr;
+    message_bindings *mp_bindings = nullptr;
+};
+
+TEST_F(message_bindings_test, reads_the_received_message_in_place)
+{
+    ASSERT_EQ(run(R"(
+        on_message(0x10, function(view)
+            x = view:find(0x01):u16()
+            y = view:child(2):u16()
+            count = #view
+        end)
+    )"), "");
+
+    receive(position(120, 34));
+
+    EXPECT_EQ(mp_bindings->handled(), 1U);
+    EXPECT_EQ(global("x"), 120);
+    EXPECT_EQ(global("y"), 34);
+    EXPECT_EQ(global("count"), 2);
+}
+
+TEST_F(message_bindings_test, rejects_the_root_view_after_its_handler)
+{
+    ASSERT_EQ(run(R"(
+        on_message(0x10, function(view) kept = view end)
+    )"), "");
+
+    receive(position(1, 2));
+
+    EXPECT_NE(run("return kept:tag()").find("outside of its handler"), std::string::npos);
+
+    // the next message reuses the root view, the old reference still doesn't reach the
+    // message that's long gone.
+    receive(position(3, 4));
+
+    EXPECT_NE(run("return kept:find(0x01):u16()").find("outside of its handler"), std::string::npos);
+}
+
+TEST_F(message_bindings_test, rejects_child_views_after_their_handler)
+{
+    ASSERT_EQ(run(R"(
+        on_message(0x10, function(view) kept = view:find(0x02) end)
+    )"), "");
+
+    receive(position(1, 2));
+
+    EXPECT_NE(run("return kept:u16()").find("outside of its handler"), std::string::npos);
+}
+
+TEST_F(message_bindings_test, sends_built_messages)
+{
+    ASSERT_EQ(run(R"(
+        local reply = message(0x20)
+
+        reply:add(0x01, 'ok')
+        reply:add(message(0x21):add(0x02, 'nested'))
+
+        send(reply)
+    )"), "");
+
+    ASSERT_EQ(m_stream.sent.size(), 1U);
+    ASSERT_EQ(m_stream.sent[0].children().size(), 1U);
+
+    const auto &sent = m_stream.sent[0].children().front();
+
+    EXPECT_EQ(sent.data().tag(), 0x20U);
+    ASSERT_EQ(sent.children().size(), 2U);
+    EXPECT_EQ(sent.children().front().data().length(), 2U);
+    EXPECT_EQ(sent.children().back().data().tag(), 0x21U);
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <lua.hpp>
+
+#include "scripting/scheduler.h"
+
+constexpr const int64_t BUDGET = 200;
+constexpr const uint32_t MAX_FRAMES = 100000;
+
+class scheduler_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mp_state = luaL_newstate();
+        luaL_openlibs(mp_state);
+    }
+
+    void TearDown() override
+    {
+        lua_close(mp_state);
+    }
+
+    bool load(const char *source)
+    {
+        return luaL_dostring(mp_state, source) == LUA_OK;
+    }
+
+    lua_Integer global(const char *name)
+    {
+        lua_getglobal(mp_state, name);
+
+        const lua_Integer value = lua_tointeger(mp_state, -1);
+
+        lua_pop(mp_state, 1);
+
+        return value;
+    }
+
+    // runs frames until every task finished, returns how many it took.
+    uint32_t run_to_completion(scheduler &tasks)
+    {
+        uint32_t frames = 0;
+
+        while (tasks.size() && frames < MAX_FRAMES)
+        {
+            tasks.run(BUDGET);
+            frames++;
+        }
+
+        return frames;
+    }
+
+    lua_State *mp_state = nullptr;
+};
+
+TEST_F(scheduler_test, preempts_a_task_running_past_its_budget)
+{
+    scheduler tasks(mp_state);
+
+    ASSERT_TRUE(load(R"(
+        spawn(function()
+            local sum = 0
+            for i = 1, 2000000 do sum = sum + i end
+            total = sum
+        end)
+    )"));
+
+    uint32_t preemptions = 0;
+
+    tasks.run(BUDGET);
+    tasks.for_each_task([&preemptions](const scheduler::task_statistics &statistics)
+                        { preemptions = statistics.preemptions; });
+
+    EXPECT_GT(preemptions, 0U);
+    EXPECT_LT(run_to_completion(tasks), MAX_FRAMES);
+    EXPECT_EQ(global("total"), 2000000LL * 2000001LL / 2);
+}
+
+TEST_F(scheduler_test, preempts_a_task_iterating_a_wrapped_coroutine)
+{
+    scheduler tasks(mp_state);
+
+    // the inner coroutine inherits the hook, yielding it would end the for loop early.
+    ASSERT_TRUE(load(R"(
+        local function numbers(count)
+            return coroutine.wrap(function()
+                for i = 1, count do coroutine.yield(i) end
+            end)
+        end
+
+        spawn(function()
+            local sum = 0
+            for i in numbers(200000) do sum = sum + i end
+            total = sum
+        end)
+    )"));
+
+    EXPECT_GT(run_to_completion(tasks), 1U);
+    EXPECT_EQ(tasks.size(), 0U);
+    EXPECT_EQ(global("total"), 200000LL * 200001LL / 2);
+}
+
+TEST_F(scheduler_test, resumes_tasks_waiting_for_a_message)
+{
+    scheduler tasks(mp_state);
+
+    ASSERT_TRUE(load(R"(
+        spawn(function()
+            received = #receive(7)
+        end)
+    )"));
+
+    tasks.run(BUDGET);
+
+    EXPECT_TRUE(tasks.waiting_for(7));
+    EXPECT_FALSE(tasks.waiting_for(8));
+
+    const uint8_t data[] = {1, 2, 3};
+
+    ASSERT_TRUE(tasks.post(7, data, sizeof(data)));
+
+    tasks.run(BUDGET);
+
+    EXPECT_EQ(tasks.size(), 0U);
+    EXPECT_EQ(global("received"), 3);
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+import os
+import stat
+import subprocess
+import sys
+import tempfile
+import unittest
+
+SCRIPTS = os.environ.get('RCLINK_SCRIPTS', '')
+
+# stands in for luac, reports the version it's given and copies the source as "bytecode".
+FAKE_LUAC = '''#!{python}
+import shutil
+import sys
+
+if sys.argv[1] == '-v':
+    print('{version}  Copyright (C) 1994-2023 Lua.org, PUC-Rio')
+else:
+    shutil.copy(sys.argv[3], sys.argv[2])
+'''
+
+
+class CompileLuaTest(unittest.TestCase):
+    def setUp(self):
+        self.directory = tempfile.TemporaryDirectory()
+        self.output = tempfile.TemporaryDirectory()
+        self.script = os.path.join(self.directory.name, 'main.lua')
+        self.bytecode = os.path.join(self.output.name, 'main.luac')
+
+        with open(self.script, 'w') as file:
+            file.write('print("hello")\n')
+
+    def tearDown(self):
+        self.directory.cleanup()
+        self.output.cleanup()
+
+    def fake_luac(self, version):
+        path = os.path.join(self.directory.name, 'luac')
+
+        with open(path, 'w') as file:
+            file.write(FAKE_LUAC.format(python=sys.executable, version=version))
+
+        os.chmod(path, os.stat(path).st_mode | stat.S_IEXEC)
+
+        return path
+
+    def compile(self, luac, *scripts):
+        return subprocess.run([sys.executable, os.path.join(SCRIPTS, 'compile_lua.py'),
+                               '--luac', luac, '--directory', self.directory.name, '--output', self.output.name, *scripts],
+                              capture_output=True, text=True)
+
+    def test_compiles_with_lua_5_4(self):
+        result = self.compile(self.fake_luac('Lua 5.4.6'))
+
+        self.assertEqual(result.returncode, 0, result.stdout)
+        self.assertIn('compiled 1 scripts', result.stdout)
+        self.assertTrue(os.path.exists(self.bytecode))
+        self.assertTrue(os.path.exists(self.bytecode + '.sha256'))
+        self.assertFalse(os.path.exists(self.script + 'c'))
+
+    def test_fails_with_another_version(self):
+        for version in ('Lua 5.3.6', 'Lua 5.1.5'):
+            result = self.compile(self.fake_luac(version))
+
+            self.assertEqual(result.returncode, 1, version)
+            self.assertIn('Lua 5.4 is required', result.stdout)
+            self.assertFalse(os.path.exists(self.bytecode))
+
+    def test_leaves_placeholders_without_luac(self):
+        result = self.compile('', self.script)
+
+        self.assertEqual(result.returncode, 0, result.stdout)
+        self.assertIn('luac not found', result.stdout)
+
+        # the build gets its outputs, the empty hash never matches so the device compiles.
+        for path in (self.bytecode, self.bytecode + '.sha256'):
+            self.assertEqual(os.path.getsize(path), 0, path)
+
+        self.assertIn('compiled 1 scripts', self.compile(self.fake_luac('Lua 5.4.6'), self.script).stdout)
+
+    def test_keeps_the_layout_of_the_sources(self):
+        nested = os.path.join(self.directory.name, 'games', 'pong.lua')
+
+        os.makedirs(os.path.dirname(nested))
+
+        with open(nested, 'w') as file:
+            file.write('return {}\n')
+
+        result = self.compile(self.fake_luac('Lua 5.4.6'))
+
+        self.assertIn('compiled 2 scripts', result.stdout)
+        self.assertTrue(os.path.exists(os.path.join(self.output.name, 'games', 'pong.luac')))
+
+    def test_skips_unchanged_scripts_but_refreshes_their_timestamps(self):
+        luac = self.fake_luac('Lua 5.4.6')
+
+        self.compile(luac, self.script)
+
+        # the build saw the source change, but only its timestamp did.
+        os.utime(self.bytecode, (0, 0))
+
+        result = self.compile(luac, self.script)
+
+        self.assertIn('compiled 0 scripts', result.stdout)
+        self.assertGreater(os.path.getmtime(self.bytecode), os.path.getmtime(self.script) - 1)
+
+        with open(self.script, 'a') as file:
+            file.write('print("again")\n')
+
+        self.assertIn('compiled 1 scripts', self.compile(luac, self.script).stdout)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "render/dirty_region.h"
+
+using rect = dirty_region::rect;
+
+static bool covers(const rect &outer, const rect &inner)
+{
+    return outer.x1 <= inner.x1 && outer.y1 <= inner.y1 && inner.x2 <= outer.x2 && inner.y2 <= outer.y2;
+}
+
+static bool covered(const dirty_region &region, const rect &area)
+{
+    for (const auto &current : region.rects())
+        if (covers(current, area))
+            return true;
+
+    return false;
+}
+
+TEST(dirty_region, keeps_distant_areas_apart)
+{
+    dirty_region region;
+
+    region.add({0, 0, 29, 29});
+    region.add({200, 100, 229, 129});
+
+    EXPECT_EQ(region.rects().size(), 2U);
+    EXPECT_EQ(region.area(), 2 * 30 * 30);
+}
+
+TEST(dirty_region, merges_overlapping_areas)
+{
+    dirty_region region;
+
+    region.add({0, 0, 29, 29});
+    region.add({10, 5, 39, 34});
+
+    ASSERT_EQ(region.rects().size(), 1U);
+    EXPECT_TRUE(covers(region.rects()[0], {0, 0, 39, 34}));
+    EXPECT_EQ(region.area(), 40 * 35);
+}
+
+TEST(dirty_region, merges_neighbours_when_that_redraws_nothing_extra)
+{
+    dirty_region region;
+
+    // side by side, their bounding box is exactly both of them.
+    region.add({0, 0, 29, 29});
+    region.add({30, 0, 59, 29});
+
+    ASSERT_EQ(region.rects().size(), 1U);
+    EXPECT_EQ(region.area(), 60 * 30);
+
+    // a gap would have to be redrawn as well, so it stays a second rectangle.
+    region.add({0, 40, 29, 69});
+
+    EXPECT_EQ(region.rects().size(), 2U);
+    EXPECT_EQ(region.area(), 60 * 30 + 30 * 30);
+}
+
+TEST(dirty_region, merges_a_chain_a_new_area_connects)
+{
+    dirty_region region;
+
+    region.add({0, 0, 29, 29});
+    region.add({60, 0, 89, 29});
+
+    ASSERT_EQ(region.rects().size(), 2U);
+
+    region.add({20, 0, 69, 29});
+
+    ASSERT_EQ(region.rects().size(), 1U);
+    EXPECT_EQ(region.area(), 90 * 30);
+}
+
+TEST(dirty_region, joins_the_cheapest_pair_once_the_budget_is_spent)
+{
+    dirty_region region(2);
+
+    region.add({0, 0, 29, 29});
+    region.add({200, 0, 229, 29});
+    region.add({0, 100, 29, 129});
+
+    ASSERT_EQ(region.rects().size(), 2U);
+    EXPECT_TRUE(covered(region, {0, 0, 29, 129}));
+    EXPECT_TRUE(covered(region, {200, 0, 229, 29}));
+    EXPECT_EQ(region.area(), 30 * 130 + 30 * 30);
+}
+
+TEST(dirty_region, always_covers_everything_added_within_the_budget)
+{
+    for (const size_t max_rects : {1U, 4U, 16U})
+    {
+        std::mt19937 random(max_rects);
+        std::uniform_int_distribution<int32_t> x(0, 290);
+        std::uniform_int_distribution<int32_t> y(0, 140);
+        dirty_region region(max_rects);
+        std::vector<rect> added;
+
+        for (size_t i = 0; i < 200; i++)
+        {
+            const int32_t left = x(random);
+            const int32_t top = y(random);
+
+            added.push_back({left, top, left + 29, top + 29});
+            region.add(added.back());
+
+            ASSERT_LE(region.rects().size(), max_rects);
+        }
+
+        for (const auto &area : added)
+            EXPECT_TRUE(covered(region, area));
+    }
+}
+
+TEST(dirty_region, is_empty_once_cleared)
+{
+    dirty_region region;
+
+    region.add({0, 0, 29, 29});
+    region.clear();
+
+    EXPECT_TRUE(region.rects().empty());
+    EXPECT_EQ(region.area(), 0);
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "profile/histogram.h"
+
+// past this the last bucket catches everything and the bound no longer holds.
+constexpr const uint32_t LARGEST_BOUNDED = 1U << 25;
+
+static double relative_error(const uint32_t reported, const uint32_t value)
+{
+    return std::abs(static_cast<double>(reported) - value) / value;
+}
+
+TEST(histogram, reports_small_values_exactly)
+{
+    for (uint32_t value = 0; value < histogram::SUB_BUCKETS; value++)
+    {
+        histogram recorded;
+
+        recorded.record(value);
+
+        EXPECT_EQ(recorded.percentile(50), value);
+    }
+}
+
+TEST(histogram, buckets_are_contiguous_and_ascending)
+{
+    for (size_t bucket = 1; bucket < histogram::BUCKET_COUNT; bucket++)
+    {
+        const uint32_t lower = histogram::lower_bound(bucket);
+
+        ASSERT_GT(lower, histogram::lower_bound(bucket - 1U));
+        EXPECT_EQ(histogram::bucket_of(lower), bucket);
+        EXPECT_EQ(histogram::bucket_of(lower - 1U), bucket - 1U);
+    }
+}
+
+TEST(histogram, stays_within_an_eighth_of_a_single_value)
+{
+    // every value up to 2^20, then a sweep of the rest of the bounded range.
+    std::vector<uint32_t> values;
+
+    for (uint32_t value = 1; value < (1U << 20); value++)
+        values.push_back(value);
+
+    std::mt19937 random(1);
+    std::uniform_int_distribution<uint32_t> distribution(1U << 20, LARGEST_BOUNDED - 1U);
+
+    for (size_t i = 0; i < 100000; i++)
+        values.push_back(distribution(random));
+
+    double worst = 0;
+
+    for (const uint32_t value : values)
+    {
+        histogram recorded;
+
+        recorded.record(value);
+
+        worst = std::max(worst, relative_error(recorded.percentile(50), value));
+    }
+
+    EXPECT_LE(worst, 0.125);
+}
+
+TEST(histogram, stays_within_an_eighth_of_the_exact_percentiles)
+{
+    std::mt19937 random(2);
+    std::lognormal_distribution<double> distribution(7.0, 1.5);
+
+    histogram recorded;
+    std::vector<uint32_t> samples;
+
+    // both windows full, so the percentiles cover every sample.
+    for (uint32_t i = 0; i < 2U * histogram::WINDOW; i++)
+    {
+        const auto value = static_cast<uint32_t>(std::clamp(distribution(random), 1.0, LARGEST_BOUNDED - 1.0));
+
+        recorded.record(value);
+        samples.push_back(value);
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    for (const uint32_t percent : {1U, 10U, 50U, 90U, 99U, 100U})
+    {
+        const uint32_t rank = (samples.size() * percent + 99U) / 100U;
+        const uint32_t exact = samples[rank - 1U];
+
+        EXPECT_LE(relative_error(recorded.percentile(percent), exact), 0.125) << "p" << percent;
+    }
+}
+
+TEST(histogram, forgets_samples_older_than_the_previous_window)
+{
+    histogram recorded;
+
+    for (uint32_t i = 0; i < histogram::WINDOW; i++)
+        recorded.record(100000);
+
+    for (uint32_t i = 0; i < 2U * histogram::WINDOW; i++)
+        recorded.record(10);
+
+    EXPECT_EQ(recorded.count(), 2U * histogram::WINDOW);
+    EXPECT_EQ(recorded.max(), 10U);
+    EXPECT_LE(relative_error(recorded.percentile(100), 10), 0.125);
+    EXPECT_EQ(recorded.total(), 3U * histogram::WINDOW);
+}
\ No newline at end of file
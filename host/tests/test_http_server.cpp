@@ -0,0 +1,336 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+
+#include <sdkconfig.h>
+
+#include "host_shim.h"
+#include "server/http_server.h"
+#include "http_client.h"
+
+constexpr const uint16_t PORT = 18080;
+constexpr const size_t WORKER_COUNT = CONFIG_RCLINK_HTTP_WORKER_COUNT;
+constexpr const size_t QUEUE_LENGTH = CONFIG_RCLINK_HTTP_QUEUE_LENGTH;
+constexpr const auto QUEUE_TIMEOUT = std::chrono::seconds(5);
+
+class http_server_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        std::filesystem::remove_all(m_root);
+        std::filesystem::create_directories(m_root);
+
+        std::ofstream(m_root / "index.html") << "<html></html>";
+        std::ofstream(m_root / "app.js") << "console.log(1);";
+    }
+
+    void TearDown() override
+    {
+        host_shim::fail_next_creations(0);
+
+        std::filesystem::remove_all(m_root);
+        std::filesystem::remove_all(m_root.string() + ".old");
+    }
+
+    // one directory per test, ctest runs them as separate processes and maybe side by side.
+    std::filesystem::path m_root = std::filesystem::path(RCLINK_TEST_DIRECTORY) / testing::UnitTest::GetInstance()->current_test_info()->name();
+};
+
+TEST_F(http_server_test, serves_files_from_the_base_path)
+{
+    http_server server(PORT, m_root.string());
+    http_client client(PORT);
+    http_response response;
+
+    ASSERT_TRUE(client.get("/", response));
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.body, "<html></html>");
+    ASSERT_TRUE(response.header("Content-Type"));
+    EXPECT_EQ(*response.header("Content-Type"), "text/html");
+
+    ASSERT_TRUE(client.get("/app.js", response));
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(*response.header("Content-Type"), "application/javascript");
+
+    ASSERT_TRUE(client.get("/missing.txt", response));
+    EXPECT_EQ(response.status, 404);
+
+    ASSERT_TRUE(client.get("/index.html", response));
+    EXPECT_EQ(response.status, 307);
+}
+
+TEST_F(http_server_test, restores_the_bundle_an_interrupted_deploy_left_behind)
+{
+    const std::filesystem::path backup = m_root.string() + ".old";
+
+    std::filesystem::rename(m_root, backup);
+
+    http_server server(PORT, m_root.string());
+    http_client client(PORT);
+    http_response response;
+
+    EXPECT_FALSE(std::filesystem::exists(backup));
+    ASSERT_TRUE(client.get("/", response));
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.body, "<html></html>");
+}
+
+TEST_F(http_server_test, counts_served_requests)
+{
+    http_server server(PORT, m_root.string());
+    http_client client(PORT);
+    http_response response;
+
+    for (int i = 0; i < 10; i++)
+        ASSERT_TRUE(client.get("/app.js", response));
+
+    // the workers record a request right after its response went out.
+    auto served_files = [&server]()
+    {
+        return server.get_statistics().routes[static_cast<size_t>(http_server::route::file)].served;
+    };
+
+    const auto deadline = std::chrono::steady_clock::now() + QUEUE_TIMEOUT;
+
+    while (served_files() < 10U && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    const auto statistics = server.get_statistics();
+
+    const auto &files = statistics.routes[static_cast<size_t>(http_server::route::file)];
+
+    EXPECT_EQ(files.served, 10U);
+    EXPECT_EQ(statistics.rejected, 0U);
+    EXPECT_GT(files.service_time_p50_us, 0U);
+    EXPECT_LE(files.service_time_p50_us, files.service_time_p90_us);
+    EXPECT_LE(files.service_time_p90_us, files.service_time_p99_us);
+    EXPECT_LE(files.wait_time_p50_us, files.wait_time_p99_us);
+}
+
+// an upload that announced its body but only sent half of it, it keeps a worker busy.
+static std::unique_ptr<socket_connection> stall_upload(const std::string &path)
+{
+    auto connection = std::make_unique<socket_connection>();
+
+    if (!connection->open(PORT) ||
+        !connection->write("POST " + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Length: 4\r\n\r\nab"))
+        return nullptr;
+
+    return connection;
+}
+
+static bool finish_upload(socket_connection &connection, int &status)
+{
+    size_t offset = 0;
+
+    if (!connection.write("cd") || !connection.fill_until("\r\n", offset))
+        return false;
+
+    status = std::stoi(connection.buffer().substr(strlen("HTTP/1.1 "), 3));
+
+    return true;
+}
+
+TEST_F(http_server_test, rejects_uploads_once_the_queue_is_full)
+{
+    http_server server(PORT, m_root.string());
+    std::vector<std::unique_ptr<socket_connection>> uploads;
+
+    for (size_t i = 0; i < WORKER_COUNT; i++)
+    {
+        uploads.push_back(stall_upload("/busy_" + std::to_string(i) + ".txt"));
+        ASSERT_TRUE(uploads.back());
+    }
+
+    // the workers pick those up before the queue starts filling.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    for (size_t i = 0; i < QUEUE_LENGTH; i++)
+    {
+        uploads.push_back(stall_upload("/queued_" + std::to_string(i) + ".txt"));
+        ASSERT_TRUE(uploads.back());
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + QUEUE_TIMEOUT;
+
+    while (server.get_statistics().queue_depth < QUEUE_LENGTH && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    ASSERT_EQ(server.get_statistics().queue_depth, QUEUE_LENGTH);
+
+    http_client client(PORT);
+    http_response response;
+
+    ASSERT_TRUE(client.request("POST", "/rejected.txt", "abcd", response));
+    EXPECT_EQ(response.status, 503);
+    ASSERT_TRUE(response.header("Retry-After"));
+
+    for (auto &upload : uploads)
+    {
+        int status = 0;
+
+        ASSERT_TRUE(finish_upload(*upload, status));
+        EXPECT_EQ(status, 200);
+    }
+
+    // the workers record a request right after its response went out.
+    auto served_uploads = [&server]()
+    {
+        return server.get_statistics().routes[static_cast<size_t>(http_server::route::upload)].served;
+    };
+
+    while (served_uploads() < WORKER_COUNT + QUEUE_LENGTH && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    const auto statistics = server.get_statistics();
+
+    EXPECT_EQ(statistics.rejected, 1U);
+    EXPECT_EQ(statistics.max_queue_depth, QUEUE_LENGTH);
+    EXPECT_EQ(served_uploads(), WORKER_COUNT + QUEUE_LENGTH);
+    EXPECT_FALSE(std::filesystem::exists(m_root / "rejected.txt"));
+}
+
+static std::string read_file(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+TEST_F(http_server_test, keeps_the_original_when_an_upload_is_interrupted)
+{
+    http_server server(PORT, m_root.string());
+
+    // every worker gets an upload that stops halfway, a worker waiting on a closed
+    // connection would never serve anything again.
+    for (size_t i = 0; i < WORKER_COUNT; i++)
+    {
+        auto upload = stall_upload("/app.js");
+
+        ASSERT_TRUE(upload);
+
+        upload->close();
+    }
+
+    http_client client(PORT);
+    http_response response;
+
+    ASSERT_TRUE(client.get("/app.js", response));
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.body, "console.log(1);");
+
+    // the workers record the interrupted uploads once they gave up on them, an upload still
+    // in flight would share the temporary file with the one below.
+    auto served_uploads = [&server]()
+    {
+        return server.get_statistics().routes[static_cast<size_t>(http_server::route::upload)].served;
+    };
+
+    const auto deadline = std::chrono::steady_clock::now() + QUEUE_TIMEOUT;
+
+    while (served_uploads() < WORKER_COUNT && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    ASSERT_EQ(served_uploads(), WORKER_COUNT);
+    EXPECT_FALSE(std::filesystem::exists(m_root / "app.js.tmp"));
+    EXPECT_EQ(read_file(m_root / "app.js"), "console.log(1);");
+
+    ASSERT_TRUE(client.request("POST", "/app.js", "console.log(2);", response));
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(read_file(m_root / "app.js"), "console.log(2);");
+}
+
+TEST_F(http_server_test, aborts_an_interrupted_firmware_update)
+{
+    http_server server(PORT, m_root.string());
+    std::string firmware(8192, '\x5a');
+
+    firmware[0] = '\xe9';
+
+    host_shim::set_running_image({});
+
+    socket_connection upload;
+
+    ASSERT_TRUE(upload.open(PORT));
+    ASSERT_TRUE(upload.write("POST /firmware.bin HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Length: " + std::to_string(firmware.size()) +
+                             "\r\n\r\n" + firmware.substr(0, 4096)));
+
+    upload.close();
+
+    // the next update can only begin once the interrupted one gave up its ota session.
+    http_client client(PORT);
+    http_response response;
+    const auto deadline = std::chrono::steady_clock::now() + QUEUE_TIMEOUT;
+
+    do
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        ASSERT_TRUE(client.request("POST", "/firmware.bin", firmware, response));
+    } while (response.status != 200 && std::chrono::steady_clock::now() < deadline);
+
+    EXPECT_EQ(response.status, 200);
+
+    const auto booted = host_shim::boot_image();
+
+    EXPECT_EQ(std::string(booted.begin(), booted.end()), firmware);
+}
+
+TEST_F(http_server_test, renders_metrics)
+{
+    http_server server(PORT, m_root.string());
+    http_client client(PORT);
+    http_response response;
+
+    ASSERT_TRUE(client.get("/app.js", response));
+    ASSERT_TRUE(client.get("/metrics", response));
+    EXPECT_EQ(response.status, 200);
+    EXPECT_NE(response.body.find("rclink_http_requests_total{route=\"file\",result=\"ok\"}"), std::string::npos);
+
+    // rendered on a worker, so the scrape is served like the file before it.
+    auto served_files = [&server]()
+    {
+        return server.get_statistics().routes[static_cast<size_t>(http_server::route::file)].served;
+    };
+
+    const auto deadline = std::chrono::steady_clock::now() + QUEUE_TIMEOUT;
+
+    while (served_files() < 2U && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    EXPECT_EQ(served_files(), 2U);
+}
+
+TEST_F(http_server_test, fails_the_update_when_the_ota_pipeline_can_not_start)
+{
+    http_server server(PORT, m_root.string());
+    http_client client(PORT);
+    http_response response;
+    std::string firmware(8192, '\x5a');
+
+    firmware[0] = '\xe9';
+
+    host_shim::set_running_image({});
+
+    // the first thing the update creates is the pipeline's free buffer queue.
+    host_shim::fail_next_creations(1);
+
+    ASSERT_TRUE(client.request("POST", "/firmware.bin", firmware, response));
+    EXPECT_EQ(response.status, 500);
+
+    ASSERT_TRUE(client.request("POST", "/firmware.bin", firmware, response));
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.body.size(), 32U);
+
+    const auto booted = host_shim::boot_image();
+
+    EXPECT_EQ(std::string(booted.begin(), booted.end()), firmware);
+}
\ No newline at end of file
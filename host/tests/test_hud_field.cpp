@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "hud/hud_field.h"
+
+constexpr uint32_t INTERVAL = 100U;
+
+// a source the tests move on by hand, it counts how often the field formatted it.
+struct fake_source
+{
+    uint32_t version = 0;
+    int value = 0;
+    size_t formats = 0;
+};
+
+static hud_field make_field(fake_source &source, const uint32_t now = 0)
+{
+    auto version = [&source]()
+    {
+        return source.version;
+    };
+
+    auto format = [&source](char *text, size_t size)
+    {
+        source.formats++;
+
+        snprintf(text, size, "value: %d", source.value);
+    };
+
+    return hud_field(INTERVAL, now, version, format);
+}
+
+TEST(hud_field, waits_for_the_first_value)
+{
+    fake_source source;
+    auto field = make_field(source);
+
+    EXPECT_EQ(field.refresh(0), nullptr);
+    EXPECT_EQ(source.formats, 0U);
+}
+
+TEST(hud_field, shows_a_value_right_away)
+{
+    fake_source source;
+    auto field = make_field(source, 1000);
+
+    source.version = 1;
+    source.value = 3;
+
+    ASSERT_NE(field.refresh(1000), nullptr);
+    EXPECT_STREQ(field.text().c_str(), "value: 3");
+}
+
+TEST(hud_field, refreshes_at_most_once_per_interval)
+{
+    fake_source source;
+    auto field = make_field(source);
+
+    source.version = 1;
+
+    ASSERT_NE(field.refresh(0), nullptr);
+
+    source.version = 2;
+    source.value = 4;
+
+    EXPECT_EQ(field.refresh(INTERVAL - 1), nullptr);
+    EXPECT_EQ(source.formats, 1U);
+
+    ASSERT_NE(field.refresh(INTERVAL), nullptr);
+    EXPECT_STREQ(field.text().c_str(), "value: 4");
+}
+
+TEST(hud_field, counts_the_interval_from_the_last_check)
+{
+    fake_source source;
+    auto field = make_field(source);
+
+    // a check without a change still starts the next interval.
+    EXPECT_EQ(field.refresh(0), nullptr);
+
+    source.version = 1;
+
+    EXPECT_EQ(field.refresh(INTERVAL / 2), nullptr);
+    EXPECT_NE(field.refresh(INTERVAL), nullptr);
+}
+
+TEST(hud_field, keeps_its_interval_across_the_tick_wrapping)
+{
+    fake_source source;
+    const uint32_t now = UINT32_MAX - INTERVAL / 2;
+    auto field = make_field(source, now);
+
+    source.version = 1;
+
+    ASSERT_NE(field.refresh(now), nullptr);
+
+    source.version = 2;
+    source.value = 1;
+
+    EXPECT_EQ(field.refresh(now + INTERVAL - 1), nullptr);
+    EXPECT_NE(field.refresh(now + INTERVAL), nullptr);
+}
+
+TEST(hud_field, skips_formatting_an_unchanged_version)
+{
+    fake_source source;
+    auto field = make_field(source);
+
+    source.version = 1;
+
+    ASSERT_NE(field.refresh(0), nullptr);
+
+    EXPECT_EQ(field.refresh(INTERVAL), nullptr);
+    EXPECT_EQ(source.formats, 1U);
+}
+
+TEST(hud_field, leaves_the_label_alone_when_the_text_is_the_same)
+{
+    fake_source source;
+    auto field = make_field(source);
+
+    source.version = 1;
+
+    ASSERT_NE(field.refresh(0), nullptr);
+
+    // the source moved on but formats the same, like a voltage rounding to the same value.
+    source.version = 2;
+
+    EXPECT_EQ(field.refresh(INTERVAL), nullptr);
+    EXPECT_EQ(source.formats, 2U);
+
+    source.version = 3;
+    source.value = 5;
+
+    ASSERT_NE(field.refresh(2 * INTERVAL), nullptr);
+    EXPECT_STREQ(field.text().c_str(), "value: 5");
+}
+
+TEST(hud_field, hands_out_its_own_copy_of_the_text)
+{
+    fake_source source;
+    auto field = make_field(source);
+
+    source.version = 1;
+
+    const char *text = field.refresh(0);
+
+    ASSERT_NE(text, nullptr);
+    EXPECT_EQ(text, field.text().c_str());
+}
\ No newline at end of file
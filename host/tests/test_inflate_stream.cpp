@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include <miniz.h>
+#include <zlib.h>
+
+#include "server/inflate_stream.h"
+
+static memory_account test_memory("test_inflate");
+
+class collecting_sink : public stream_sink
+{
+public:
+    bool write(const uint8_t *data, size_t size) override
+    {
+        if (m_fail_after && m_received.size() + size > m_fail_after)
+            return false;
+
+        m_received.insert(m_received.end(), data, data + size);
+
+        return true;
+    }
+
+    bool finish() override
+    {
+        m_finished = true;
+
+        return true;
+    }
+
+    std::vector<uint8_t> m_received;
+    size_t m_fail_after = 0;
+    bool m_finished = false;
+};
+
+// compressible but not trivially, a little like firmware.
+static std::vector<uint8_t> payload(const size_t size)
+{
+    std::mt19937 random(3);
+    std::vector<uint8_t> data(size);
+
+    for (size_t i = 0; i < size; i++)
+        data[i] = static_cast<uint8_t>(random() % 16U + (i / 4096U));
+
+    return data;
+}
+
+static std::vector<uint8_t> deflate(const std::vector<uint8_t> &data, const int window_bits)
+{
+    z_stream stream = {};
+
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY);
+
+    std::vector<uint8_t> compressed(deflateBound(&stream, data.size()) + 64U);
+
+    stream.next_in = const_cast<uint8_t *>(data.data());
+    stream.avail_in = data.size();
+    stream.next_out = compressed.data();
+    stream.avail_out = compressed.size();
+
+    deflate(&stream, Z_FINISH);
+
+    compressed.resize(stream.total_out);
+
+    deflateEnd(&stream);
+
+    return compressed;
+}
+
+static std::vector<uint8_t> zlib_compress(const std::vector<uint8_t> &data)
+{
+    return deflate(data, MAX_WBITS);
+}
+
+static std::vector<uint8_t> gzip_compress(const std::vector<uint8_t> &data)
+{
+    return deflate(data, MAX_WBITS + 16);
+}
+
+static bool inflate_in_chunks(const std::vector<uint8_t> &compressed, const size_t chunk_size, collecting_sink &sink,
+                              const inflate_stream::format format = inflate_stream::format::zlib)
+{
+    inflate_stream inflater(sink, test_memory, format);
+
+    for (size_t offset = 0; offset < compressed.size(); offset += chunk_size)
+        if (!inflater.write(compressed.data() + offset, std::min(chunk_size, compressed.size() - offset)))
+            return false;
+
+    return inflater.finish();
+}
+
+TEST(inflate_stream, inflates_zlib_in_any_chunk_size)
+{
+    // past the 32 KiB window, so the dictionary wraps.
+    const auto data = payload(100000);
+    const auto compressed = zlib_compress(data);
+
+    for (const size_t chunk_size : {1U, 7U, 4096U, 1000000U})
+    {
+        collecting_sink sink;
+
+        ASSERT_TRUE(inflate_in_chunks(compressed, chunk_size, sink)) << chunk_size;
+        EXPECT_TRUE(sink.m_finished);
+        EXPECT_EQ(sink.m_received, data) << chunk_size;
+    }
+}
+
+TEST(inflate_stream, inflates_gzip)
+{
+    const auto data = payload(50000);
+    const auto compressed = gzip_compress(data);
+
+    for (const size_t chunk_size : {1U, 3U, 4096U})
+    {
+        collecting_sink sink;
+
+        ASSERT_TRUE(inflate_in_chunks(compressed, chunk_size, sink, inflate_stream::format::gzip)) << chunk_size;
+        EXPECT_EQ(sink.m_received, data) << chunk_size;
+    }
+}
+
+TEST(inflate_stream, skips_optional_gzip_header_fields)
+{
+    const auto data = payload(2000);
+    const auto compressed = deflate(data, -MAX_WBITS);
+
+    // extra field, file name, comment and header crc, which isn't checked.
+    std::vector<uint8_t> gzip = {0x1f, 0x8b, 8, 0x02 | 0x04 | 0x08 | 0x10, 0, 0, 0, 0, 0, 3};
+
+    gzip.insert(gzip.end(), {3, 0, 'a', 'b', 'c'});
+    gzip.insert(gzip.end(), {'f', 'w', '.', 'b', 'i', 'n', 0});
+    gzip.insert(gzip.end(), {'h', 'i', 0});
+    gzip.insert(gzip.end(), {0x12, 0x34});
+    gzip.insert(gzip.end(), compressed.begin(), compressed.end());
+    gzip.insert(gzip.end(), 8U, 0);
+
+    for (const size_t chunk_size : {1U, 2U, 4096U})
+    {
+        collecting_sink sink;
+
+        ASSERT_TRUE(inflate_in_chunks(gzip, chunk_size, sink, inflate_stream::format::gzip)) << chunk_size;
+        EXPECT_EQ(sink.m_received, data) << chunk_size;
+    }
+}
+
+TEST(inflate_stream, rejects_a_truncated_stream)
+{
+    const auto compressed = zlib_compress(payload(10000));
+    collecting_sink sink;
+
+    EXPECT_FALSE(inflate_in_chunks({compressed.begin(), compressed.end() - 8}, 512, sink));
+    EXPECT_FALSE(sink.m_finished);
+}
+
+TEST(inflate_stream, rejects_a_truncated_gzip_header)
+{
+    collecting_sink sink;
+
+    EXPECT_FALSE(inflate_in_chunks({0x1f, 0x8b, 8, 0}, 1, sink, inflate_stream::format::gzip));
+}
+
+TEST(inflate_stream, rejects_corrupted_data)
+{
+    auto compressed = zlib_compress(payload(10000));
+
+    // the adler32 at the end no longer matches.
+    compressed[compressed.size() - 1] ^= 0xff;
+
+    collecting_sink sink;
+
+    EXPECT_FALSE(inflate_in_chunks(compressed, 512, sink));
+}
+
+TEST(inflate_stream, rejects_what_isnt_gzip)
+{
+    collecting_sink sink;
+
+    EXPECT_FALSE(inflate_in_chunks(zlib_compress(payload(1000)), 512, sink, inflate_stream::format::gzip));
+}
+
+TEST(inflate_stream, stops_when_the_next_sink_fails)
+{
+    const auto compressed = zlib_compress(payload(100000));
+    collecting_sink sink;
+
+    sink.m_fail_after = 40000;
+
+    EXPECT_FALSE(inflate_in_chunks(compressed, 4096, sink));
+    EXPECT_LE(sink.m_received.size(), sink.m_fail_after);
+    EXPECT_FALSE(sink.m_finished);
+}
+
+TEST(inflate_stream, books_its_window_while_alive)
+{
+    const auto before = test_memory.statistics().current;
+
+    {
+        collecting_sink sink;
+        inflate_stream inflater(sink, test_memory);
+
+        EXPECT_GE(test_memory.statistics().current - before, static_cast<uint32_t>(TINFL_LZ_DICT_SIZE));
+    }
+
+    EXPECT_EQ(test_memory.statistics().current, before);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+import json
+import os
+import subprocess
+import tempfile
+import time
+import unittest
+
+TOOLS = os.environ.get('RCLINK_TOOLS', '')
+HTTP_PORT = 18380
+WEBSOCKET_PORT = 18381
+
+
+class LoadGeneratorTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.directory = tempfile.TemporaryDirectory()
+
+        with open(os.path.join(cls.directory.name, 'index.html'), 'w') as file:
+            file.write('<html></html>')
+
+        cls.upload = os.path.join(cls.directory.name, 'upload.bin')
+
+        with open(cls.upload, 'wb') as file:
+            file.write(os.urandom(8192))
+
+        cls.server = subprocess.Popen([os.path.join(TOOLS, 'host_server'),
+                                       '--http-port', str(HTTP_PORT),
+                                       '--websocket-port', str(WEBSOCKET_PORT),
+                                       '--root', cls.directory.name],
+                                      stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+        # the banner goes out once both servers listen.
+        cls.server.stdout.readline()
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.server.terminate()
+        cls.server.wait()
+        cls.directory.cleanup()
+
+    def generate(self, *arguments):
+        completed = subprocess.run([os.path.join(TOOLS, 'load_generator'), '--duration', '0.5', *arguments],
+                                   capture_output=True, text=True, timeout=30)
+
+        self.assertEqual(completed.returncode, 0, completed.stderr)
+
+        if not completed.stdout:
+            return {}
+
+        return {result['name']: result for result in json.loads(completed.stdout)['results']}
+
+    def assert_served(self, result):
+        self.assertGreater(result['requests'], 0)
+        self.assertEqual(result['errors'], 0)
+        self.assertEqual(result['responses'], result['requests'])
+        self.assertEqual(set(result['latency_ms']), {'p50', 'p90', 'p99', 'p99.9', 'max'})
+        self.assertLessEqual(result['latency_ms']['p50'], result['latency_ms']['max'])
+
+    def test_every_fragmentation_is_echoed(self):
+        # paced, as fast as possible overruns the server's receive buffer and it hangs up.
+        for fragmentation in ('none', 'split', 'coalesce', 'random'):
+            with self.subTest(fragmentation=fragmentation):
+                results = self.generate('--websocket-port', str(WEBSOCKET_PORT), '--rate', '500',
+                                        '--fragmentation', fragmentation, '--fragment-size', '8')
+
+                self.assert_served(results['websocket'])
+
+    def test_replays_a_trace(self):
+        # two messages, one with a single node and one untagged root holding two.
+        trace = bytes((3, 0, 0x01, 0x01, 0xaa)) + bytes((8, 0, 0x20, 0x06, 0x02, 0x01, 0xbb, 0x03, 0x01, 0xcc))
+        path = os.path.join(self.directory.name, 'trace.bin')
+
+        with open(path, 'wb') as file:
+            file.write(trace)
+
+        results = self.generate('--websocket-port', str(WEBSOCKET_PORT), '--rate', '500', '--trace', path)
+
+        self.assert_served(results['websocket'])
+
+    def test_fetches_and_uploads(self):
+        results = self.generate('--http-port', str(HTTP_PORT), '--get', '/', '--upload', f'/uploaded.bin={self.upload}',
+                                '--output', os.path.join(self.directory.name, 'report.json'))
+
+        self.assertEqual(results, {})
+
+        with open(os.path.join(self.directory.name, 'report.json')) as file:
+            result = json.load(file)['results'][0]
+
+        self.assertEqual(result['name'], 'http')
+        self.assert_served(result)
+        self.assertGreater(result['bytes_sent'], 0)
+
+    def test_rejects_bad_options(self):
+        completed = subprocess.run([os.path.join(TOOLS, 'load_generator'), '--fragmentation', 'sideways'],
+                                   capture_output=True, text=True, timeout=30)
+
+        self.assertNotEqual(completed.returncode, 0)
+        self.assertIn('sideways', completed.stderr)
+
+
+if __name__ == '__main__':
+    unittest.main()
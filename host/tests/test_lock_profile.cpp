@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <atomic>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "lock_guard.h"
+
+constexpr const auto HOLD_TIME = std::chrono::milliseconds(30);
+constexpr const uint32_t HOLD_TIME_US = 30000U;
+// task startup and scheduling on a loaded machine eat into the measured wait.
+constexpr const uint32_t WAIT_SLACK_US = 15000U;
+
+// mirrors lock_summary in profile/lock_profile.cpp.
+struct lock_summary
+{
+    uint32_t acquisitions;
+    uint32_t contended;
+    uint32_t timeouts;
+    uint32_t wait_p50;
+    uint32_t wait_p99;
+    uint32_t wait_max;
+    uint32_t hold_p50;
+    uint32_t hold_p99;
+    uint32_t hold_max;
+    uint32_t worst_wait;
+} __attribute__((packed));
+
+struct reported_lock
+{
+    lock_summary summary = {};
+    std::string worst_task;
+};
+
+static bool report_of(const char *name, reported_lock &reported)
+{
+    tlvcpp::tlv_tree_node root;
+
+    lock_profile::serialize_all(root);
+
+    for (const auto &lock : root.children().front().children())
+    {
+        const auto &data = lock.data();
+        const auto &lock_name = lock.children().front().data();
+
+        if (std::string(reinterpret_cast<const char *>(lock_name.value()), lock_name.length()) != name)
+            continue;
+
+        if (data.length() != sizeof(lock_summary))
+            return false;
+
+        memcpy(&reported.summary, data.value(), sizeof(lock_summary));
+
+        if (lock.children().size() > 1)
+        {
+            const auto &task = lock.children().back().data();
+
+            reported.worst_task.assign(reinterpret_cast<const char *>(task.value()), task.length());
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+class lock_profile_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_mutex = xSemaphoreCreateMutex();
+        m_done = xSemaphoreCreateBinary();
+    }
+
+    void TearDown() override
+    {
+        if (m_holder.joinable())
+            m_holder.join();
+
+        vSemaphoreDelete(m_done);
+        vSemaphoreDelete(m_mutex);
+    }
+
+    // takes the mutex on another thread for HOLD_TIME, returns once it's taken.
+    void hold()
+    {
+        std::atomic<bool> is_taken = false;
+
+        m_holder = std::thread([this, &is_taken]()
+                               {
+                                   xSemaphoreTake(m_mutex, portMAX_DELAY);
+                                   is_taken = true;
+
+                                   std::this_thread::sleep_for(HOLD_TIME);
+
+                                   xSemaphoreGive(m_mutex); });
+
+        while (!is_taken)
+            std::this_thread::yield();
+    }
+
+    // acquires through a lock_guard on a task of its own, so the profile sees its name.
+    bool acquire_on_task(lock_profile &profile, const TickType_t timeout)
+    {
+        m_profile = &profile;
+        m_timeout = timeout;
+
+        EXPECT_EQ(xTaskCreate(waiter_task, "lock_waiter", 4096, this, 1, nullptr), pdPASS);
+        EXPECT_TRUE(xSemaphoreTake(m_done, pdMS_TO_TICKS(5000)));
+
+        return m_owned;
+    }
+
+    static void waiter_task(void *argument)
+    {
+        auto &self = *static_cast<lock_profile_test *>(argument);
+
+        {
+            lock_guard guard(self.m_mutex, *self.m_profile, self.m_timeout);
+
+            self.m_owned = guard.owns_lock();
+        }
+
+        xSemaphoreGive(self.m_done);
+
+        vTaskDelete(nullptr);
+    }
+
+    SemaphoreHandle_t m_mutex = nullptr;
+    SemaphoreHandle_t m_done = nullptr;
+    std::thread m_holder;
+    lock_profile *m_profile = nullptr;
+    TickType_t m_timeout = 0;
+    bool m_owned = false;
+};
+
+TEST_F(lock_profile_test, counts_uncontended_acquisitions)
+{
+    static lock_profile profile("test_uncontended");
+
+    for (int i = 0; i < 10; i++)
+    {
+        lock_guard guard(m_mutex, profile);
+
+        ASSERT_TRUE(guard.owns_lock());
+    }
+
+    reported_lock reported;
+
+    ASSERT_TRUE(report_of("test_uncontended", reported));
+    EXPECT_EQ(reported.summary.acquisitions, 10U);
+    EXPECT_EQ(reported.summary.contended, 0U);
+    EXPECT_EQ(reported.summary.timeouts, 0U);
+    EXPECT_EQ(reported.summary.worst_wait, 0U);
+    EXPECT_TRUE(reported.worst_task.empty());
+}
+
+TEST_F(lock_profile_test, records_the_wait_of_a_contended_acquisition)
+{
+    static lock_profile profile("test_contended");
+
+    hold();
+
+    EXPECT_TRUE(acquire_on_task(profile, portMAX_DELAY));
+
+    reported_lock reported;
+
+    ASSERT_TRUE(report_of("test_contended", reported));
+    EXPECT_EQ(reported.summary.acquisitions, 1U);
+    EXPECT_EQ(reported.summary.contended, 1U);
+    EXPECT_EQ(reported.summary.timeouts, 0U);
+    EXPECT_GE(reported.summary.worst_wait, HOLD_TIME_US - WAIT_SLACK_US);
+    EXPECT_GE(reported.summary.wait_max, reported.summary.worst_wait);
+    EXPECT_EQ(reported.worst_task, "lock_waiter");
+}
+
+TEST_F(lock_profile_test, records_how_long_the_lock_was_held)
+{
+    static lock_profile profile("test_hold");
+
+    {
+        lock_guard guard(m_mutex, profile);
+
+        std::this_thread::sleep_for(HOLD_TIME);
+    }
+
+    reported_lock reported;
+
+    ASSERT_TRUE(report_of("test_hold", reported));
+    EXPECT_GE(reported.summary.hold_max, HOLD_TIME_US);
+    // a single sample, the percentile is the middle of its bucket.
+    EXPECT_GE(reported.summary.hold_p50, HOLD_TIME_US - HOLD_TIME_US / 8);
+}
+
+TEST_F(lock_profile_test, counts_timeouts_without_acquiring)
+{
+    static lock_profile profile("test_timeouts");
+
+    hold();
+
+    EXPECT_FALSE(acquire_on_task(profile, pdMS_TO_TICKS(1)));
+
+    {
+        // a zero timeout only tries once.
+        lock_guard guard(m_mutex, profile, 0);
+
+        EXPECT_FALSE(guard.owns_lock());
+    }
+
+    reported_lock reported;
+
+    ASSERT_TRUE(report_of("test_timeouts", reported));
+    EXPECT_EQ(reported.summary.timeouts, 2U);
+    EXPECT_EQ(reported.summary.acquisitions, 0U);
+    EXPECT_EQ(reported.summary.contended, 0U);
+    EXPECT_TRUE(reported.worst_task.empty());
+
+    m_holder.join();
+
+    lock_guard guard(m_mutex, profile, 0);
+
+    EXPECT_TRUE(guard.owns_lock());
+}
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <string>
+#include <cstring>
+
+#include <esp_heap_caps.h>
+
+#include "host_shim.h"
+#include "memory/memory_account.h"
+
+constexpr const size_t PSRAM_SIZE = 8U * 1024U * 1024U;
+
+static memory_account test_memory("test_memory_account");
+
+class memory_account_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_before = test_memory.statistics();
+    }
+
+    void TearDown() override
+    {
+        host_shim::set_heap_size(MALLOC_CAP_INTERNAL, std::numeric_limits<size_t>::max());
+        host_shim::set_heap_size(MALLOC_CAP_SPIRAM, PSRAM_SIZE);
+    }
+
+    // leaves only size bytes of internal ram free.
+    static void limit_internal_ram(const size_t size)
+    {
+        const size_t used = std::numeric_limits<size_t>::max() - heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+
+        host_shim::set_heap_size(MALLOC_CAP_INTERNAL, used + size);
+    }
+
+    // what the account booked since the test started.
+    memory_account::usage booked() const
+    {
+        const auto now = test_memory.statistics();
+
+        return {
+            .current = now.current - m_before.current,
+            .peak = now.peak,
+            .allocations = now.allocations - m_before.allocations,
+            .failures = now.failures - m_before.failures,
+        };
+    }
+
+    memory_account::usage m_before;
+};
+
+TEST_F(memory_account_test, books_what_is_allocated_until_it_is_released)
+{
+    void *first = test_memory.allocate(100);
+    void *second = test_memory.allocate(200);
+
+    ASSERT_TRUE(first && second);
+    EXPECT_EQ(booked().current, 300U);
+    EXPECT_EQ(booked().allocations, 2U);
+
+    test_memory.release(first, 100);
+
+    EXPECT_EQ(booked().current, 200U);
+
+    test_memory.release(second, 200);
+    test_memory.release(nullptr, 64);
+
+    EXPECT_EQ(booked().current, 0U);
+    EXPECT_EQ(booked().allocations, 2U);
+}
+
+TEST_F(memory_account_test, keeps_its_peak)
+{
+    void *first = test_memory.allocate(1000);
+    void *second = test_memory.allocate(2000);
+
+    test_memory.release(first, 1000);
+    test_memory.release(second, 2000);
+
+    void *third = test_memory.allocate(10);
+
+    EXPECT_GE(booked().peak, m_before.current + 3000U);
+    EXPECT_EQ(booked().current, 10U);
+
+    test_memory.release(third, 10);
+}
+
+TEST_F(memory_account_test, counts_failed_allocations)
+{
+    limit_internal_ram(1024);
+
+    EXPECT_EQ(test_memory.allocate(4096), nullptr);
+    EXPECT_FALSE(make_account_ptr<uint8_t[]>(test_memory, 4096));
+
+    EXPECT_EQ(booked().failures, 2U);
+    EXPECT_EQ(booked().allocations, 0U);
+    EXPECT_EQ(booked().current, 0U);
+}
+
+TEST_F(memory_account_test, places_blocks_where_they_were_asked_for)
+{
+    const size_t internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    const size_t psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+
+    void *internal = test_memory.allocate(256);
+    void *psram = test_memory.allocate(512, memory_placement::psram);
+
+    EXPECT_EQ(heap_caps_get_free_size(MALLOC_CAP_INTERNAL), internal_free - 256);
+    EXPECT_EQ(heap_caps_get_free_size(MALLOC_CAP_SPIRAM), psram_free - 512);
+
+    test_memory.release(internal, 256);
+    test_memory.release(psram, 512);
+
+    EXPECT_EQ(heap_caps_get_free_size(MALLOC_CAP_INTERNAL), internal_free);
+    EXPECT_EQ(heap_caps_get_free_size(MALLOC_CAP_SPIRAM), psram_free);
+}
+
+TEST_F(memory_account_test, falls_back_to_internal_ram_without_psram)
+{
+    host_shim::set_heap_size(MALLOC_CAP_SPIRAM, 0);
+
+    const size_t internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    void *allocated = test_memory.allocate(512, memory_placement::psram);
+
+    ASSERT_NE(allocated, nullptr);
+    EXPECT_EQ(heap_caps_get_free_size(MALLOC_CAP_INTERNAL), internal_free - 512);
+    EXPECT_EQ(booked().current, 512U);
+    EXPECT_EQ(booked().failures, 0U);
+
+    test_memory.release(allocated, 512);
+}
+
+TEST_F(memory_account_test, never_puts_internal_blocks_into_psram)
+{
+    limit_internal_ram(1024);
+
+    EXPECT_EQ(test_memory.allocate(4096), nullptr);
+    EXPECT_EQ(test_memory.allocate(4096, memory_placement::dma), nullptr);
+
+    void *psram = test_memory.allocate(4096, memory_placement::psram);
+
+    EXPECT_NE(psram, nullptr);
+    EXPECT_EQ(booked().failures, 2U);
+
+    test_memory.release(psram, 4096);
+}
+
+TEST_F(memory_account_test, reallocates_keeping_the_contents)
+{
+    auto data = static_cast<char *>(test_memory.reallocate(nullptr, 0, 16));
+
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(booked().allocations, 1U);
+
+    strcpy(data, "rclink");
+
+    data = static_cast<char *>(test_memory.reallocate(data, 16, 4096));
+
+    ASSERT_NE(data, nullptr);
+    EXPECT_STREQ(data, "rclink");
+    EXPECT_EQ(booked().current, 4096U);
+    EXPECT_EQ(booked().allocations, 1U);
+
+    data = static_cast<char *>(test_memory.reallocate(data, 4096, 8));
+
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(booked().current, 8U);
+
+    test_memory.release(data, 8);
+
+    EXPECT_EQ(booked().current, 0U);
+}
+
+TEST_F(memory_account_test, keeps_the_old_block_when_reallocating_fails)
+{
+    void *data = test_memory.allocate(64);
+
+    limit_internal_ram(1024);
+
+    EXPECT_EQ(test_memory.reallocate(data, 64, 4096), nullptr);
+    EXPECT_EQ(booked().current, 64U);
+    EXPECT_EQ(booked().failures, 1U);
+
+    test_memory.release(data, 64);
+}
+
+TEST_F(memory_account_test, tracks_memory_other_allocators_handed_out)
+{
+    test_memory.track(4096);
+
+    EXPECT_EQ(booked().current, 4096U);
+    EXPECT_EQ(booked().allocations, 1U);
+
+    test_memory.untrack(4096);
+
+    EXPECT_EQ(booked().current, 0U);
+}
+
+TEST_F(memory_account_test, serializes_every_account_with_its_name)
+{
+    void *data = test_memory.allocate(123);
+
+    tlvcpp::tlv_tree_node node;
+
+    memory_account::serialize_all(node);
+
+    ASSERT_EQ(node.children().size(), 1U);
+
+    const auto &report = node.children().front();
+
+    EXPECT_EQ(report.data().tag(), MEMORY_REPORT_TAG);
+
+    const tlvcpp::tlv_tree_node *found = nullptr;
+
+    for (const auto &account : report.children())
+    {
+        EXPECT_EQ(account.data().tag(), MEMORY_ACCOUNT_TAG);
+        ASSERT_EQ(account.data().length(), 4 * sizeof(uint32_t));
+        ASSERT_EQ(account.children().size(), 1U);
+
+        const auto &name = account.children().front().data();
+
+        EXPECT_EQ(name.tag(), MEMORY_NAME_TAG);
+
+        if (std::string(reinterpret_cast<const char *>(name.value()), name.length()) == "test_memory_account")
+            found = &account;
+    }
+
+    ASSERT_NE(found, nullptr);
+
+    // current, peak, allocations and failures, packed in the device's byte order.
+    uint32_t summary[4];
+    const auto statistics = test_memory.statistics();
+
+    memcpy(summary, found->data().value(), sizeof(summary));
+
+    EXPECT_EQ(summary[0], statistics.current);
+    EXPECT_EQ(summary[1], statistics.peak);
+    EXPECT_EQ(summary[2], statistics.allocations);
+    EXPECT_EQ(summary[3], statistics.failures);
+
+    test_memory.release(data, 123);
+}
\ No newline at end of file
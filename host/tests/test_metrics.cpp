@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics/metrics.h"
+
+static metric_counter first_counter("test_requests_total", "Requests handled.", "result=\"ok\"");
+static metric_counter second_counter("test_requests_total", "Requests handled.", "result=\"failed\"");
+static metric_gauge gauge("test_depth", "Items queued.");
+static metric_histogram<3> histogram("test_latency_us", "Request latency.", {10, 100, 1000}, "route=\"file\"");
+
+// renders every metric into a string, flushing through a buffer of size bytes.
+static bool render(std::string &rendered, const size_t size = 1024, size_t *flushes = nullptr)
+{
+    std::vector<char> buffer(size);
+    metric_writer writer(buffer.data(), buffer.size(), [&rendered, flushes](const char *data, const size_t length)
+                         {
+                             rendered.append(data, length);
+
+                             if (flushes)
+                                 (*flushes)++;
+
+                             return true; });
+
+    return metric::render_all(writer);
+}
+
+static size_t occurrences(const std::string &text, const std::string &pattern)
+{
+    size_t count = 0;
+
+    for (size_t position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1))
+        count++;
+
+    return count;
+}
+
+TEST(metrics, renders_every_registered_metric)
+{
+    first_counter.add(3);
+    second_counter.add();
+    gauge.set(-5);
+
+    std::string rendered;
+
+    ASSERT_TRUE(render(rendered));
+    EXPECT_NE(rendered.find("test_requests_total{result=\"ok\"} 3\n"), std::string::npos);
+    EXPECT_NE(rendered.find("test_requests_total{result=\"failed\"} 1\n"), std::string::npos);
+    EXPECT_NE(rendered.find("test_depth -5\n"), std::string::npos);
+    EXPECT_NE(rendered.find("# TYPE test_depth gauge\n"), std::string::npos);
+    EXPECT_NE(rendered.find("# TYPE test_latency_us histogram\n"), std::string::npos);
+}
+
+TEST(metrics, writes_help_and_type_once_per_name)
+{
+    std::string rendered;
+
+    ASSERT_TRUE(render(rendered));
+    EXPECT_EQ(occurrences(rendered, "# HELP test_requests_total "), 1U);
+    EXPECT_EQ(occurrences(rendered, "# TYPE test_requests_total counter\n"), 1U);
+}
+
+TEST(metrics, renders_cumulative_histogram_buckets)
+{
+    static metric_histogram<2> observed("test_observed_us", "Observed values.", {10, 100});
+
+    for (const uint32_t value : {5U, 10U, 50U, 500U, 5000U})
+        observed.observe(value);
+
+    std::string rendered;
+
+    ASSERT_TRUE(render(rendered));
+    EXPECT_NE(rendered.find("test_observed_us_bucket{le=\"10\"} 2\n"), std::string::npos);
+    EXPECT_NE(rendered.find("test_observed_us_bucket{le=\"100\"} 3\n"), std::string::npos);
+    EXPECT_NE(rendered.find("test_observed_us_bucket{le=\"+Inf\"} 5\n"), std::string::npos);
+    EXPECT_NE(rendered.find("test_observed_us_sum 5565\n"), std::string::npos);
+    EXPECT_NE(rendered.find("test_observed_us_count 5\n"), std::string::npos);
+}
+
+TEST(metrics, labels_histogram_series)
+{
+    histogram.observe(1);
+
+    std::string rendered;
+
+    ASSERT_TRUE(render(rendered));
+    EXPECT_NE(rendered.find("test_latency_us_bucket{route=\"file\",le=\"10\"} "), std::string::npos);
+    EXPECT_NE(rendered.find("test_latency_us_sum{route=\"file\"} "), std::string::npos);
+}
+
+TEST(metrics, flushes_a_small_buffer_without_splitting_lines)
+{
+    std::string whole;
+    std::string flushed;
+    size_t flushes = 0;
+
+    ASSERT_TRUE(render(whole, 64U * 1024U));
+    ASSERT_TRUE(render(flushed, 128, &flushes));
+    EXPECT_GT(flushes, 1U);
+    EXPECT_EQ(flushed, whole);
+}
+
+TEST(metrics, fails_on_a_line_longer_than_the_buffer)
+{
+    std::string rendered;
+
+    EXPECT_FALSE(render(rendered, 16));
+}
+
+TEST(metrics, stops_when_a_flush_fails)
+{
+    char buffer[128];
+    size_t flushes = 0;
+    metric_writer writer(buffer, sizeof(buffer), [&flushes](const char *, size_t)
+                         {
+                             flushes++;
+
+                             return false; });
+
+    EXPECT_FALSE(metric::render_all(writer));
+    EXPECT_EQ(flushes, 1U);
+}
+
+TEST(metrics, counts_concurrent_updates)
+{
+    constexpr const size_t THREAD_COUNT = 8U;
+    constexpr const uint32_t UPDATES = 10000U;
+
+    static metric_counter counter("test_concurrent_total", "Concurrent updates.");
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < THREAD_COUNT; i++)
+        threads.emplace_back([]()
+                             {
+                                 for (uint32_t update = 0; update < UPDATES; update++)
+                                     counter.add(); });
+
+    for (auto &thread : threads)
+        thread.join();
+
+    EXPECT_EQ(counter.value(), THREAD_COUNT * UPDATES);
+}
\ No newline at end of file
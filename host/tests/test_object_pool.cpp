@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "object_pool.h"
+
+static memory_account pool_memory("test_object_pool");
+
+TEST(object_pool, grows_a_chunk_at_a_time_up_to_its_capacity)
+{
+    object_pool<int> pool(10, 4, pool_memory);
+
+    EXPECT_EQ(pool.statistics(), (pool_statistics{0, 0, 0, 10}));
+
+    std::vector<int *> acquired;
+
+    acquired.push_back(pool.acquire());
+
+    EXPECT_EQ(pool.statistics().allocated, 4U);
+
+    for (size_t i = 1; i < 5; i++)
+        acquired.push_back(pool.acquire());
+
+    EXPECT_EQ(pool.statistics().allocated, 8U);
+
+    for (size_t i = 5; i < 10; i++)
+        acquired.push_back(pool.acquire());
+
+    // the last chunk only holds what's left of the capacity.
+    EXPECT_EQ(pool.statistics(), (pool_statistics{10, 10, 10, 10}));
+    EXPECT_EQ(pool.acquire(), nullptr);
+
+    for (const auto object : acquired)
+        EXPECT_NE(object, nullptr);
+}
+
+TEST(object_pool, hands_out_a_chunk_in_address_order)
+{
+    object_pool<int> pool(4, 4, pool_memory);
+
+    const auto first = pool.acquire();
+
+    for (int i = 1; i < 4; i++)
+        EXPECT_EQ(pool.acquire(), first + i);
+}
+
+TEST(object_pool, keeps_objects_where_they_are_while_growing)
+{
+    object_pool<int> pool(64, 1, pool_memory);
+    std::vector<int *> acquired;
+
+    for (int i = 0; i < 64; i++)
+    {
+        acquired.push_back(pool.acquire());
+        *acquired.back() = i;
+    }
+
+    for (int i = 0; i < 64; i++)
+        EXPECT_EQ(*acquired[i], i);
+}
+
+TEST(object_pool, recycles_released_objects_as_they_were)
+{
+    object_pool<std::vector<int>> pool(2, 2, pool_memory);
+
+    auto object = pool.acquire();
+
+    object->assign(16, 7);
+    pool.release(object);
+
+    EXPECT_EQ(pool.acquire(), object);
+    EXPECT_EQ(object->size(), 16U);
+    EXPECT_EQ(pool.statistics().allocated, 2U);
+}
+
+TEST(object_pool, tracks_what_is_in_use_and_its_high_water)
+{
+    object_pool<int> pool(8, 2, pool_memory);
+    std::vector<int *> acquired;
+
+    for (int i = 0; i < 5; i++)
+        acquired.push_back(pool.acquire());
+
+    for (int i = 0; i < 3; i++)
+    {
+        pool.release(acquired.back());
+        acquired.pop_back();
+    }
+
+    EXPECT_EQ(pool.statistics(), (pool_statistics{2, 6, 5, 8}));
+
+    // released objects are used up before the pool grows again.
+    for (int i = 0; i < 4; i++)
+        acquired.push_back(pool.acquire());
+
+    EXPECT_EQ(pool.statistics(), (pool_statistics{6, 6, 6, 8}));
+}
+
+TEST(object_pool, visits_every_allocated_object)
+{
+    object_pool<int> pool(10, 4, pool_memory);
+
+    for (int i = 0; i < 5; i++)
+        *pool.acquire() = 1;
+
+    size_t visited = 0;
+    int sum = 0;
+
+    pool.for_each([&](int &object)
+                  {
+                      visited++;
+                      sum += object; });
+
+    EXPECT_EQ(visited, 8U);
+    EXPECT_EQ(sum, 5);
+}
+
+TEST(object_pool, books_its_chunks_to_the_account)
+{
+    const auto before = pool_memory.statistics();
+
+    {
+        object_pool<uint64_t> pool(16, 4, pool_memory);
+
+        const auto reserved = pool_memory.statistics().current - before.current;
+
+        pool.acquire();
+
+        EXPECT_EQ(pool_memory.statistics().current - before.current, reserved + 4 * sizeof(uint64_t));
+    }
+
+    EXPECT_EQ(pool_memory.statistics().current, before.current);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+import io
+import os
+import random
+import subprocess
+import sys
+import tempfile
+import unittest
+import zlib
+
+SCRIPTS = os.environ.get('RCLINK_SCRIPTS', '')
+
+sys.path.insert(0, SCRIPTS)
+
+import ota_pack  # noqa: E402
+
+
+def firmware_pair(size=64 * 1024):
+    generator = random.Random(1)
+    source = bytes(generator.getrandbits(8) for _ in range(size))
+    target = bytearray(source)
+
+    # a patched function, a shifted block and a new tail, like a small code change.
+    target[1000:1100] = bytes(generator.getrandbits(8) for _ in range(100))
+    target[20000:20000] = b'inserted'
+    target += bytes(generator.getrandbits(8) for _ in range(512))
+
+    return source, bytes(target)
+
+
+class OtaPackTest(unittest.TestCase):
+    def apply(self, source, patch):
+        output = io.BytesIO()
+
+        ota_pack.apply_patch(io.BytesIO(source), io.BytesIO(patch), output)
+
+        return output.getvalue()
+
+    def test_applies_a_patch(self):
+        source, target = firmware_pair()
+        operations = ota_pack.diff(source, target)
+        patch = ota_pack.encode_patch(source, target, operations)
+
+        self.assertEqual(self.apply(source, patch), target)
+        self.assertLess(len(patch), len(target) // 4)
+
+    def test_applies_a_compressed_patch(self):
+        source, target = firmware_pair()
+        patch = ota_pack.encode_patch(source, target, ota_pack.diff(source, target))
+
+        self.assertEqual(self.apply(source, zlib.compress(patch, 9)), target)
+
+    def test_rejects_a_different_source(self):
+        source, target = firmware_pair()
+        patch = ota_pack.encode_patch(source, target, ota_pack.diff(source, target))
+
+        with self.assertRaises(ValueError):
+            self.apply(source[::-1], patch)
+
+    def test_rejects_a_truncated_patch(self):
+        source, target = firmware_pair()
+        patch = ota_pack.encode_patch(source, target, ota_pack.diff(source, target))
+
+        for truncated in (patch[:40], patch[:-1], zlib.compress(patch)[:-16]):
+            with self.assertRaises(ValueError):
+                self.apply(source, truncated)
+
+    def test_command_line_round_trip(self):
+        source, target = firmware_pair()
+
+        with tempfile.TemporaryDirectory() as directory:
+            paths = {name: os.path.join(directory, name) for name in ('source', 'target', 'patch', 'output')}
+
+            for name, data in (('source', source), ('target', target)):
+                with open(paths[name], 'wb') as file:
+                    file.write(data)
+
+            script = os.path.join(SCRIPTS, 'ota_pack.py')
+
+            subprocess.run([sys.executable, script, 'diff', '--compress', paths['source'], paths['target'], paths['patch']],
+                           check=True, stdout=subprocess.DEVNULL)
+            subprocess.run([sys.executable, script, 'apply', paths['source'], paths['patch'], paths['output']], check=True)
+
+            with open(paths['output'], 'rb') as file:
+                self.assertEqual(file.read(), target)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <esp_log.h>
+
+#include "host_shim.h"
+#include "server/ota_pipeline.h"
+
+constexpr const size_t BUFFER_SIZE = 4096;
+constexpr const size_t BUFFER_COUNT = 3;
+// both queues, the done semaphore and the writer task.
+constexpr const uint32_t CREATIONS = 4;
+
+static memory_account test_account("ota_test");
+
+// keeps everything in memory, optionally refuses writes past limit bytes.
+class memory_flash : public flash_writer
+{
+public:
+    memory_flash(const size_t limit = SIZE_MAX) : m_limit(limit) {}
+
+    bool write(const uint8_t *data, size_t size) override
+    {
+        if (written.size() + size > m_limit)
+            return false;
+
+        written.insert(written.end(), data, data + size);
+
+        return true;
+    }
+
+    std::vector<uint8_t> written;
+
+private:
+    const size_t m_limit;
+};
+
+class ota_pipeline_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        esp_log_level_set("ota_pipeline", ESP_LOG_NONE);
+    }
+
+    void TearDown() override
+    {
+        host_shim::fail_next_creations(0);
+    }
+
+    static std::vector<uint8_t> image(const size_t size)
+    {
+        std::mt19937 random(size);
+        std::vector<uint8_t> generated(size);
+
+        std::generate(generated.begin(), generated.end(), [&random]()
+                      { return static_cast<uint8_t>(random()); });
+
+        return generated;
+    }
+};
+
+TEST_F(ota_pipeline_test, writes_everything_in_order)
+{
+    const auto firmware = image(10 * BUFFER_SIZE + 123);
+    memory_flash flash;
+    ota_pipeline pipeline(flash, test_account, BUFFER_SIZE, BUFFER_COUNT);
+
+    ASSERT_FALSE(pipeline.failed());
+
+    // odd sized pieces like they come off the socket.
+    for (size_t offset = 0; offset < firmware.size(); offset += 1000)
+        ASSERT_TRUE(pipeline.write(firmware.data() + offset, std::min<size_t>(1000, firmware.size() - offset)));
+
+    EXPECT_TRUE(pipeline.finish());
+    EXPECT_EQ(pipeline.bytes_written(), firmware.size());
+    EXPECT_EQ(flash.written, firmware);
+}
+
+TEST_F(ota_pipeline_test, fails_when_anything_can_not_be_created)
+{
+    const auto firmware = image(BUFFER_SIZE);
+
+    for (uint32_t skip = 0; skip < CREATIONS; skip++)
+    {
+        SCOPED_TRACE(skip);
+
+        memory_flash flash;
+
+        host_shim::fail_next_creations(1, skip);
+
+        ota_pipeline pipeline(flash, test_account, BUFFER_SIZE, BUFFER_COUNT);
+
+        // none of this may block on a queue or a task that isn't there.
+        EXPECT_TRUE(pipeline.failed());
+        EXPECT_FALSE(pipeline.write(firmware.data(), firmware.size()));
+        EXPECT_FALSE(pipeline.finish());
+        EXPECT_TRUE(flash.written.empty());
+    }
+}
+
+TEST_F(ota_pipeline_test, stops_at_the_first_failed_flash_write)
+{
+    const auto firmware = image(8 * BUFFER_SIZE);
+    memory_flash flash(2 * BUFFER_SIZE);
+    ota_pipeline pipeline(flash, test_account, BUFFER_SIZE, BUFFER_COUNT);
+
+    bool accepted = true;
+
+    for (size_t offset = 0; offset < firmware.size() && accepted; offset += BUFFER_SIZE)
+        accepted = pipeline.write(firmware.data() + offset, BUFFER_SIZE);
+
+    EXPECT_FALSE(pipeline.finish());
+    EXPECT_TRUE(pipeline.failed());
+    EXPECT_EQ(pipeline.bytes_written(), 2 * BUFFER_SIZE);
+}
\ No newline at end of file
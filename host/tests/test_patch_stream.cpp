@@ -0,0 +1,305 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+#include <cstring>
+
+#include <mbedtls/sha256.h>
+#include <zlib.h>
+
+#include "server/inflate_stream.h"
+#include "server/patch_stream.h"
+
+static memory_account test_memory("test_patch");
+
+class memory_source : public patch_source
+{
+public:
+    memory_source(const std::vector<uint8_t> &data) : m_data(data) {}
+
+    size_t size() const override { return m_data.size(); }
+
+    bool read(size_t offset, uint8_t *data, size_t size) override
+    {
+        if (offset + size > m_data.size())
+            return false;
+
+        memcpy(data, m_data.data() + offset, size);
+
+        return true;
+    }
+
+private:
+    const std::vector<uint8_t> &m_data;
+};
+
+class collecting_sink : public stream_sink
+{
+public:
+    bool write(const uint8_t *data, size_t size) override
+    {
+        m_received.insert(m_received.end(), data, data + size);
+
+        return true;
+    }
+
+    bool finish() override
+    {
+        m_finished = true;
+
+        return true;
+    }
+
+    std::vector<uint8_t> m_received;
+    bool m_finished = false;
+};
+
+// encodes RCLD patches like scripts/ota_pack.py does.
+class patch_builder
+{
+public:
+    patch_builder(const std::vector<uint8_t> &source, const std::vector<uint8_t> &target)
+    {
+        const uint8_t header[] = {'R', 'C', 'L', 'D', 1, 0, 0, 0};
+
+        m_patch.assign(header, header + sizeof(header));
+
+        put_u32(source.size());
+        put_u32(target.size());
+        put_hash(source);
+        put_hash(target);
+    }
+
+    patch_builder &copy(const uint32_t offset, const uint32_t length)
+    {
+        m_patch.push_back(1);
+
+        put_u32(offset);
+        put_u32(length);
+
+        return *this;
+    }
+
+    patch_builder &insert(const std::vector<uint8_t> &data)
+    {
+        m_patch.push_back(2);
+
+        put_u32(data.size());
+
+        m_patch.insert(m_patch.end(), data.begin(), data.end());
+
+        return *this;
+    }
+
+    std::vector<uint8_t> end()
+    {
+        m_patch.push_back(0);
+
+        return m_patch;
+    }
+
+private:
+    void put_u32(const uint32_t value)
+    {
+        for (size_t i = 0; i < sizeof(value); i++)
+            m_patch.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void put_hash(const std::vector<uint8_t> &data)
+    {
+        uint8_t hash[32];
+
+        mbedtls_sha256(data.data(), data.size(), hash, 0);
+
+        m_patch.insert(m_patch.end(), hash, hash + sizeof(hash));
+    }
+
+    std::vector<uint8_t> m_patch;
+};
+
+static std::vector<uint8_t> random_bytes(const size_t size, const uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::vector<uint8_t> data(size);
+
+    for (auto &byte : data)
+        byte = static_cast<uint8_t>(random());
+
+    return data;
+}
+
+static bool apply_in_chunks(const std::vector<uint8_t> &source, const std::vector<uint8_t> &patch, const size_t chunk_size, collecting_sink &sink)
+{
+    memory_source reader(source);
+    patch_stream patcher(reader, sink);
+
+    for (size_t offset = 0; offset < patch.size(); offset += chunk_size)
+        if (!patcher.write(patch.data() + offset, std::min(chunk_size, patch.size() - offset)))
+            return false;
+
+    return patcher.finish();
+}
+
+class patch_stream_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_source = random_bytes(8192, 1);
+        m_inserted = random_bytes(300, 2);
+
+        // the source's second half, something new, then its first half, copies larger than
+        // the copy buffer included.
+        m_target.assign(m_source.begin() + 4096, m_source.end());
+        m_target.insert(m_target.end(), m_inserted.begin(), m_inserted.end());
+        m_target.insert(m_target.end(), m_source.begin(), m_source.begin() + 4096);
+    }
+
+    std::vector<uint8_t> patch()
+    {
+        return patch_builder(m_source, m_target).copy(4096, 4096).insert(m_inserted).copy(0, 4096).end();
+    }
+
+    std::vector<uint8_t> m_source;
+    std::vector<uint8_t> m_inserted;
+    std::vector<uint8_t> m_target;
+};
+
+TEST_F(patch_stream_test, applies_a_patch_in_any_chunk_size)
+{
+    const auto encoded = patch();
+
+    for (const size_t chunk_size : {1U, 5U, 81U, 4096U, 100000U})
+    {
+        collecting_sink sink;
+
+        ASSERT_TRUE(apply_in_chunks(m_source, encoded, chunk_size, sink)) << chunk_size;
+        EXPECT_TRUE(sink.m_finished);
+        EXPECT_EQ(sink.m_received, m_target) << chunk_size;
+    }
+}
+
+TEST_F(patch_stream_test, applies_a_compressed_patch_through_the_inflater)
+{
+    const auto encoded = patch();
+    std::vector<uint8_t> compressed(compressBound(encoded.size()));
+    uLongf compressed_size = compressed.size();
+
+    ASSERT_EQ(compress2(compressed.data(), &compressed_size, encoded.data(), encoded.size(), 9), Z_OK);
+
+    compressed.resize(compressed_size);
+
+    // the order the firmware upload chains them in.
+    collecting_sink sink;
+    memory_source reader(m_source);
+    patch_stream patcher(reader, sink);
+    inflate_stream inflater(patcher, test_memory);
+
+    for (size_t offset = 0; offset < compressed.size(); offset += 100)
+        ASSERT_TRUE(inflater.write(compressed.data() + offset, std::min<size_t>(100, compressed.size() - offset)));
+
+    ASSERT_TRUE(inflater.finish());
+    EXPECT_EQ(sink.m_received, m_target);
+}
+
+TEST_F(patch_stream_test, rejects_a_different_source)
+{
+    const auto encoded = patch();
+
+    m_source[100] ^= 1;
+
+    collecting_sink sink;
+
+    EXPECT_FALSE(apply_in_chunks(m_source, encoded, 4096, sink));
+    EXPECT_TRUE(sink.m_received.empty());
+}
+
+TEST_F(patch_stream_test, rejects_a_source_smaller_than_expected)
+{
+    const auto encoded = patch();
+
+    m_source.resize(4096);
+
+    collecting_sink sink;
+
+    EXPECT_FALSE(apply_in_chunks(m_source, encoded, 4096, sink));
+}
+
+TEST_F(patch_stream_test, rejects_what_isnt_a_patch)
+{
+    auto encoded = patch();
+
+    encoded[0] = 'X';
+
+    collecting_sink sink;
+
+    EXPECT_FALSE(apply_in_chunks(m_source, encoded, 4096, sink));
+}
+
+TEST_F(patch_stream_test, rejects_copies_out_of_the_source)
+{
+    for (const auto &[offset, length] : {std::pair<uint32_t, uint32_t>{8000, 200}, {0xfffffff0U, 0x20}, {9000, 0}})
+    {
+        const auto encoded = patch_builder(m_source, m_target).copy(offset, length).end();
+        collecting_sink sink;
+
+        EXPECT_FALSE(apply_in_chunks(m_source, encoded, 4096, sink)) << offset << " " << length;
+    }
+}
+
+TEST_F(patch_stream_test, rejects_an_invalid_opcode)
+{
+    auto encoded = patch_builder(m_source, m_target).copy(0, 16).end();
+
+    encoded.back() = 7;
+
+    collecting_sink sink;
+
+    EXPECT_FALSE(apply_in_chunks(m_source, encoded, 4096, sink));
+}
+
+TEST_F(patch_stream_test, rejects_a_truncated_patch)
+{
+    const auto encoded = patch();
+
+    for (const size_t size : {size_t{40}, size_t{81}, size_t{100}, encoded.size() - 1U})
+    {
+        collecting_sink sink;
+
+        EXPECT_FALSE(apply_in_chunks(m_source, {encoded.begin(), encoded.begin() + size}, 4096, sink)) << size;
+        EXPECT_FALSE(sink.m_finished);
+    }
+}
+
+TEST_F(patch_stream_test, rejects_data_after_the_end)
+{
+    auto encoded = patch();
+
+    encoded.push_back(0);
+
+    collecting_sink sink;
+
+    EXPECT_FALSE(apply_in_chunks(m_source, encoded, 4096, sink));
+}
+
+TEST_F(patch_stream_test, rejects_output_that_doesnt_match_the_target)
+{
+    // one byte short.
+    auto short_target = patch_builder(m_source, m_target).copy(4096, 4096).insert(m_inserted).copy(0, 4095).end();
+    // more than the target size.
+    auto long_target = patch_builder(m_source, m_target).copy(4096, 4096).insert(m_inserted).copy(0, 4097).end();
+    // the right size, the wrong bytes.
+    auto inserted = m_inserted;
+
+    inserted[0] ^= 1;
+
+    auto wrong_bytes = patch_builder(m_source, m_target).copy(4096, 4096).insert(inserted).copy(0, 4096).end();
+
+    for (const auto &encoded : {short_target, long_target, wrong_bytes})
+    {
+        collecting_sink sink;
+
+        EXPECT_FALSE(apply_in_chunks(m_source, encoded, 4096, sink));
+        EXPECT_FALSE(sink.m_finished);
+    }
+}
\ No newline at end of file
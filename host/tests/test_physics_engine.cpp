@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "physics/engine.h"
+
+constexpr const float WIDTH = 320.0f;
+constexpr const float HEIGHT = 170.0f;
+constexpr const float TIMESTEP = 1.0f / 120;
+constexpr const uint64_t SEED = 1;
+constexpr const size_t BALL_COUNT = 100;
+constexpr const uint32_t CHECKPOINT_STEPS = 500;
+
+struct checkpoint
+{
+    uint64_t digest;
+    uint64_t contacts;
+};
+
+// recorded from a build with -ffp-contract=off, any change to the physics or to how its
+// floats are rounded changes these.
+constexpr const checkpoint GOLDEN_TRAJECTORY[] = {
+    {0x43f57c077e8740c1ULL, 39736U},
+    {0x6b8a2a3c786ad147ULL, 73170U},
+    {0xd64aa19e3cf1ab93ULL, 107106U},
+    {0x19734de7c8adc6d2ULL, 141458U},
+};
+
+// fnv-1a over the bits of every position and velocity.
+static uint64_t digest(const engine &simulated)
+{
+    const auto &balls = simulated.balls();
+    const float *components[] = {balls.x(), balls.y(), balls.vx(), balls.vy()};
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (const float *component : components)
+        for (size_t i = 0; i < balls.size(); i++)
+        {
+            uint32_t bits;
+
+            memcpy(&bits, &component[i], sizeof(bits));
+
+            for (size_t byte = 0; byte < sizeof(bits); byte++)
+            {
+                hash ^= (bits >> (byte * 8)) & 0xffU;
+                hash *= 0x100000001b3ULL;
+            }
+        }
+
+    return hash;
+}
+
+// one ball per step like a user holding the add button, then the world runs on its own.
+static void populate(engine &simulated)
+{
+    simulated.reserve(BALL_COUNT);
+
+    for (size_t i = 0; i < BALL_COUNT; i++)
+    {
+        simulated.spawn_ball();
+        simulated.step();
+    }
+}
+
+TEST(physics_engine, replays_the_same_trajectory_from_the_same_seed)
+{
+    engine first(WIDTH, HEIGHT, TIMESTEP, SEED);
+    engine second(WIDTH, HEIGHT, TIMESTEP, SEED);
+
+    populate(first);
+    populate(second);
+
+    first.step(CHECKPOINT_STEPS);
+    second.step(CHECKPOINT_STEPS);
+
+    EXPECT_EQ(digest(first), digest(second));
+    EXPECT_EQ(first.statistics().contacts, second.statistics().contacts);
+}
+
+TEST(physics_engine, diverges_with_another_seed)
+{
+    engine first(WIDTH, HEIGHT, TIMESTEP, SEED);
+    engine second(WIDTH, HEIGHT, TIMESTEP, SEED + 1);
+
+    populate(first);
+    populate(second);
+
+    EXPECT_NE(digest(first), digest(second));
+}
+
+// also built with fma enabled, see CMakeLists.txt, contracting a multiply and an add into
+// one rounding would change the digests.
+TEST(physics_engine, matches_the_golden_trajectory)
+{
+#if defined(__FMA__)
+    if (!__builtin_cpu_supports("fma"))
+        GTEST_SKIP() << "built for fma but the cpu has none";
+#endif
+
+    engine simulated(WIDTH, HEIGHT, TIMESTEP, SEED);
+
+    populate(simulated);
+
+    for (const auto &expected : GOLDEN_TRAJECTORY)
+    {
+        simulated.step(CHECKPOINT_STEPS);
+
+        EXPECT_EQ(digest(simulated), expected.digest);
+        EXPECT_EQ(simulated.statistics().contacts, expected.contacts);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "sensors/sensor_service.h"
+
+constexpr const auto UPDATE_TIMEOUT = std::chrono::seconds(5);
+constexpr const int32_t GLITCH = 3000;
+
+TEST(sensor_filter, starts_at_the_first_sample)
+{
+    sensor_filter filter(0.1f);
+
+    EXPECT_EQ(filter.apply(4000.0f), 4000.0f);
+    EXPECT_EQ(filter.apply(4000.0f), 4000.0f);
+}
+
+TEST(sensor_filter, passes_samples_through_with_a_weight_of_one)
+{
+    sensor_filter filter;
+
+    for (const float sample : {1.0f, -7.5f, 3000.0f, 0.0f})
+        EXPECT_EQ(filter.apply(sample), sample);
+}
+
+TEST(sensor_filter, closes_the_same_share_of_a_step_with_every_sample)
+{
+    sensor_filter filter(0.1f);
+
+    filter.apply(0.0f);
+
+    for (int i = 1; i <= 50; i++)
+        EXPECT_NEAR(filter.apply(1000.0f), 1000.0f * (1.0f - std::pow(0.9f, i)), 0.01f) << i;
+}
+
+TEST(sensor_filter, follows_the_average_the_hud_used_to_keep)
+{
+    sensor_filter filter(0.1f);
+    float previous = 3700.0f;
+
+    filter.apply(previous);
+
+    for (const float sample : {3710.0f, 3650.0f, 3900.0f, 3400.0f, 3705.0f})
+    {
+        previous = 0.9f * previous + 0.1f * sample;
+
+        EXPECT_NEAR(filter.apply(sample), previous, 0.01f);
+    }
+}
+
+// remembers the sensor samples published on it, they come in on the sensor task.
+class fake_stream : public data_stream
+{
+public:
+    data_stream &operator>>(tlvcpp::tlv_tree_node &) override { return *this; }
+
+    data_stream &operator<<(const tlvcpp::tlv_tree_node &node) override
+    {
+        std::lock_guard lock(m_mutex);
+
+        for (const auto &child : node.children())
+        {
+            EXPECT_EQ(child.data().tag(), SENSOR_TAG);
+            EXPECT_EQ(child.data().length(), 5U);
+
+            int32_t value;
+
+            std::memcpy(&value, child.data().value() + 1, sizeof(value));
+
+            m_published.push_back({child.data().value()[0], value});
+        }
+
+        return *this;
+    }
+
+    std::vector<std::pair<uint8_t, int32_t>> published()
+    {
+        std::lock_guard lock(m_mutex);
+
+        return m_published;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::pair<uint8_t, int32_t>> m_published;
+};
+
+class sensor_service_test : public testing::Test
+{
+protected:
+    void start(const float weight, const int32_t threshold)
+    {
+        auto read = [this]()
+        {
+            m_reads++;
+
+            if (m_glitch.exchange(false))
+                return GLITCH;
+
+            return m_reading.load();
+        };
+
+        m_service.add(sensor::battery, {.interval = 1, .weight = weight, .threshold = threshold, .read = read});
+        m_service.start();
+    }
+
+    // samples taken after this call have seen the current reading.
+    bool wait_for_samples(const uint32_t count)
+    {
+        const uint32_t target = m_reads + count;
+        const auto deadline = std::chrono::steady_clock::now() + UPDATE_TIMEOUT;
+
+        while (m_reads < target)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return true;
+    }
+
+    std::atomic<int32_t> m_reading = 0;
+    std::atomic<bool> m_glitch = false;
+    std::atomic<uint32_t> m_reads = 0;
+    fake_stream m_stream;
+    sensor_service m_service{m_stream};
+};
+
+TEST_F(sensor_service_test, is_not_ready_before_the_first_sample)
+{
+    EXPECT_FALSE(m_service.ready(sensor::battery));
+    EXPECT_EQ(m_service.latest(sensor::battery), 0);
+}
+
+TEST_F(sensor_service_test, keeps_the_latest_filtered_value)
+{
+    m_reading = 4000;
+
+    start(1.0f, 1);
+
+    ASSERT_TRUE(wait_for_samples(2));
+    EXPECT_TRUE(m_service.ready(sensor::battery));
+    EXPECT_EQ(m_service.latest(sensor::battery), 4000);
+
+    m_reading = 3600;
+
+    ASSERT_TRUE(wait_for_samples(2));
+    EXPECT_EQ(m_service.latest(sensor::battery), 3600);
+}
+
+TEST_F(sensor_service_test, publishes_only_changes_beyond_the_threshold)
+{
+    m_reading = 4000;
+
+    start(1.0f, 20);
+
+    ASSERT_TRUE(wait_for_samples(2));
+
+    m_reading = 4019;
+
+    ASSERT_TRUE(wait_for_samples(5));
+
+    m_reading = 3980;
+
+    ASSERT_TRUE(wait_for_samples(5));
+
+    const uint8_t battery = static_cast<uint8_t>(sensor::battery);
+    const std::vector<std::pair<uint8_t, int32_t>> expected = {{battery, 4000}, {battery, 3980}};
+
+    EXPECT_EQ(m_stream.published(), expected);
+    EXPECT_EQ(m_service.latest(sensor::battery), 3980);
+}
+
+TEST_F(sensor_service_test, smooths_a_glitch)
+{
+    m_reading = 4000;
+
+    start(0.1f, 50);
+
+    ASSERT_TRUE(wait_for_samples(2));
+
+    m_glitch = true;
+
+    ASSERT_TRUE(wait_for_samples(100));
+    EXPECT_NEAR(m_service.latest(sensor::battery), 4000, 1);
+
+    // the bad read only moved the value by a tenth of its jump.
+    const auto published = m_stream.published();
+
+    ASSERT_GE(published.size(), 2U);
+    EXPECT_EQ(published[0].second, 4000);
+    EXPECT_EQ(published[1].second, 3900);
+}
\ No newline at end of file
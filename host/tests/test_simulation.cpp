@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include <esp_log.h>
+
+#include "physics/simulation.h"
+
+constexpr const float WIDTH = 320.0f;
+constexpr const float HEIGHT = 170.0f;
+constexpr const size_t CAPACITY = 256;
+// well past the command queue, the physics task only drains it once per step.
+constexpr const size_t BURST = 200;
+constexpr const auto TIMEOUT = std::chrono::seconds(5);
+
+class simulation_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        esp_log_level_set("simulation", ESP_LOG_NONE);
+    }
+
+    // waits for the physics task to publish a snapshot with count balls in it.
+    static bool wait_for_count(simulation &simulated, const size_t count)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            if (simulated.latest().count == count)
+                return true;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return false;
+    }
+};
+
+TEST_F(simulation_test, publishes_exactly_the_accepted_balls)
+{
+    simulation simulated(WIDTH, HEIGHT, CAPACITY);
+    size_t accepted = 0;
+
+    for (size_t i = 0; i < BURST; i++)
+        accepted += simulated.add_ball();
+
+    // the burst outran the queue, whatever was refused must not show up on the other side.
+    EXPECT_GT(accepted, 0U);
+    EXPECT_LT(accepted, BURST);
+    EXPECT_TRUE(wait_for_count(simulated, accepted));
+
+    // and it stays there once the queue is drained.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    EXPECT_EQ(simulated.latest().count, accepted);
+}
+
+TEST_F(simulation_test, removes_only_the_accepted_balls)
+{
+    simulation simulated(WIDTH, HEIGHT, CAPACITY);
+    size_t count = 0;
+
+    // one at a time so every add goes through.
+    while (count < CAPACITY / 2)
+        if (simulated.add_ball())
+            count++;
+        else
+            std::this_thread::yield();
+
+    ASSERT_TRUE(wait_for_count(simulated, count));
+
+    size_t removed = 0;
+
+    for (size_t i = 0; i < BURST && count; i++)
+        if (simulated.remove_ball())
+        {
+            removed++;
+            count--;
+        }
+
+    EXPECT_GT(removed, 0U);
+    EXPECT_TRUE(wait_for_count(simulated, count));
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <set>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <utility>
+
+#include "physics/spatial_grid.h"
+
+constexpr const float WIDTH = 320.0f;
+constexpr const float HEIGHT = 170.0f;
+constexpr const float RADIUS = 15.0f;
+
+struct point
+{
+    float x;
+    float y;
+};
+
+using pair_set = std::set<std::pair<size_t, size_t>>;
+
+static std::vector<point> random_points(const size_t count, const uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> x(0.0f, WIDTH);
+    std::uniform_real_distribution<float> y(0.0f, HEIGHT);
+    std::vector<point> points(count);
+
+    for (auto &current : points)
+        current = {x(random), y(random)};
+
+    return points;
+}
+
+static bool overlap(const point &first, const point &second)
+{
+    const float dx = first.x - second.x;
+    const float dy = first.y - second.y;
+
+    return dx * dx + dy * dy < 4 * RADIUS * RADIUS;
+}
+
+// what the broad phase replaced, every pair against every other.
+static pair_set overlapping_pairs(const std::vector<point> &points)
+{
+    pair_set pairs;
+
+    for (size_t first = 0; first < points.size(); first++)
+        for (size_t second = first + 1; second < points.size(); second++)
+            if (overlap(points[first], points[second]))
+                pairs.emplace(first, second);
+
+    return pairs;
+}
+
+// the grid's candidates narrowed down the same way, checking every candidate comes up once.
+static pair_set grid_pairs(const spatial_grid &grid, const std::vector<point> &points)
+{
+    pair_set candidates;
+    pair_set pairs;
+
+    grid.for_each_pair([&](const size_t first, const size_t second)
+                       {
+                           const auto ordered = std::minmax(first, second);
+
+                           EXPECT_NE(first, second);
+                           EXPECT_TRUE(candidates.insert(ordered).second) << first << ", " << second << " visited twice";
+
+                           if (overlap(points[first], points[second]))
+                               pairs.insert(ordered); });
+
+    return pairs;
+}
+
+static spatial_grid grid_of(const std::vector<point> &points)
+{
+    spatial_grid grid(WIDTH, HEIGHT, 2 * RADIUS);
+
+    for (size_t i = 0; i < points.size(); i++)
+        grid.insert(i, points[i].x, points[i].y);
+
+    return grid;
+}
+
+TEST(spatial_grid, finds_the_same_pairs_as_checking_every_pair)
+{
+    for (const size_t count : {2U, 16U, 64U, 256U, 1024U})
+        for (uint32_t seed = 1; seed <= 5; seed++)
+        {
+            const auto points = random_points(count, seed);
+
+            EXPECT_EQ(grid_pairs(grid_of(points), points), overlapping_pairs(points)) << count << " points, seed " << seed;
+        }
+}
+
+TEST(spatial_grid, finds_pairs_across_cell_borders_and_at_the_edges)
+{
+    // straddling a vertical, a horizontal and a diagonal cell border, and outside the
+    // world where positions clamp to the border cells.
+    const std::vector<point> points = {
+        {29.0f, 10.0f}, {31.0f, 10.0f},
+        {100.0f, 59.0f}, {100.0f, 61.0f},
+        {149.0f, 89.0f}, {151.0f, 91.0f},
+        {-5.0f, 169.0f}, {10.0f, 175.0f},
+        {319.0f, 1.0f}, {330.0f, -3.0f},
+    };
+
+    const auto expected = overlapping_pairs(points);
+
+    EXPECT_EQ(expected.size(), 5U);
+    EXPECT_EQ(grid_pairs(grid_of(points), points), expected);
+}
+
+TEST(spatial_grid, follows_updates_and_removals)
+{
+    auto points = random_points(300, 7);
+    auto grid = grid_of(points);
+
+    std::mt19937 random(8);
+    std::normal_distribution<float> step(0.0f, 20.0f);
+
+    for (size_t round = 0; round < 20; round++)
+    {
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            points[i].x = std::clamp(points[i].x + step(random), 0.0f, WIDTH);
+            points[i].y = std::clamp(points[i].y + step(random), 0.0f, HEIGHT);
+
+            grid.update(i, points[i].x, points[i].y);
+        }
+
+        // like the world, the last ball goes first.
+        for (size_t removed = 0; removed < 5; removed++)
+        {
+            points.pop_back();
+            grid.remove(points.size());
+        }
+
+        ASSERT_EQ(grid_pairs(grid, points), overlapping_pairs(points)) << "round " << round;
+    }
+}
+
+TEST(spatial_grid, reports_nothing_once_cleared)
+{
+    auto grid = grid_of(random_points(100, 9));
+    size_t visited = 0;
+
+    grid.clear();
+    grid.for_each_pair([&visited](size_t, size_t)
+                       { visited++; });
+
+    EXPECT_EQ(visited, 0U);
+}
\ No newline at end of file
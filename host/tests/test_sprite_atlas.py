@@ -0,0 +1,136 @@
+import glob
+import os
+import random
+import re
+import struct
+import sys
+import tempfile
+import unittest
+import zlib
+
+SCRIPTS = os.environ.get('RCLINK_SCRIPTS', '')
+
+sys.path.insert(0, SCRIPTS)
+
+import sprite_atlas  # noqa: E402
+
+SPRITES = sorted(glob.glob(os.path.join(SCRIPTS, '../main/sprites/ball_*.png')))
+
+
+def chunk(kind, data):
+    return struct.pack('>I', len(data)) + kind + data + struct.pack('>I', zlib.crc32(kind + data))
+
+
+def predict(kind, left, up, up_left):
+    if kind == 1:
+        return left
+    if kind == 2:
+        return up
+    if kind == 3:
+        return (left + up) >> 1
+    if kind == 4:
+        return sprite_atlas.paeth(left, up, up_left)
+
+    return 0
+
+
+# rgba pixels as an 8 bit rgba png, each row with the filter it's given.
+def encode_png(width, height, pixels, filters):
+    stride = 4
+    previous = bytes(width * stride)
+    data = b''
+
+    for y in range(height):
+        row = bytes(value for pixel in pixels[y * width:(y + 1) * width] for value in pixel)
+        kind = filters[y % len(filters)]
+        filtered = bytearray([kind])
+
+        for i in range(len(row)):
+            left = row[i - stride] if i >= stride else 0
+            up_left = previous[i - stride] if i >= stride else 0
+            filtered.append((row[i] - predict(kind, left, previous[i], up_left)) & 0xff)
+
+        data += filtered
+        previous = row
+
+    return (sprite_atlas.PNG_SIGNATURE +
+            chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 8, 6, 0, 0, 0)) +
+            chunk(b'IDAT', zlib.compress(data)) +
+            chunk(b'IEND', b''))
+
+
+# the bytes of one variant of a generated atlas.
+def atlas_bytes(source, condition):
+    match = re.search(r'#(?:el)?if ' + re.escape(condition) + r'\nstatic const uint8_t atlas\[\] = \{\n(.*?)\n\};', source, re.S)
+
+    return bytes(int(value, 16) for value in re.findall(r'0x[0-9a-f]{2}', match.group(1)))
+
+
+class SpriteAtlasTest(unittest.TestCase):
+    def setUp(self):
+        self.directory = tempfile.TemporaryDirectory()
+        self.random = random.Random(1)
+
+    def tearDown(self):
+        self.directory.cleanup()
+
+    def write_png(self, name, width, height, pixels, filters):
+        path = os.path.join(self.directory.name, name)
+
+        with open(path, 'wb') as file:
+            file.write(encode_png(width, height, pixels, filters))
+
+        return path
+
+    def random_pixels(self, count):
+        return [tuple(self.random.randrange(256) for _ in range(4)) for _ in range(count)]
+
+    def test_decodes_every_filter_type(self):
+        pixels = self.random_pixels(7 * 5)
+
+        for kind in range(5):
+            path = self.write_png(f'filter_{kind}.png', 7, 5, pixels, [kind])
+
+            self.assertEqual(sprite_atlas.decode_png(path), (7, 5, pixels), f'filter {kind}')
+
+        path = self.write_png('mixed.png', 7, 5, pixels, [0, 1, 2, 3, 4])
+
+        self.assertEqual(sprite_atlas.decode_png(path), (7, 5, pixels))
+
+    def test_converts_pixels_into_every_color_depth(self):
+        first = self.random_pixels(4 * 4)
+        second = self.random_pixels(4 * 4)
+        paths = [self.write_png('a.png', 4, 4, first, [4]), self.write_png('b.png', 4, 4, second, [1])]
+
+        source = sprite_atlas.generate(paths)
+
+        for condition, convert in sprite_atlas.VARIANTS:
+            expected = b''.join(convert(*pixel) for pixel in first + second)
+
+            self.assertEqual(atlas_bytes(source, condition), expected, condition)
+
+        # the 16 bit layouts, worked out by hand for one pixel.
+        self.assertEqual(sprite_atlas.VARIANTS[1][1](0xff, 0x80, 0x08, 0x7f), b'\xfc\x01\x7f')
+        self.assertEqual(sprite_atlas.VARIANTS[2][1](0xff, 0x80, 0x08, 0x7f), b'\x01\xfc\x7f')
+
+    def test_rejects_sprites_of_different_sizes(self):
+        paths = [self.write_png('a.png', 4, 4, self.random_pixels(16), [0]),
+                 self.write_png('b.png', 2, 8, self.random_pixels(16), [0])]
+
+        with self.assertRaises(ValueError):
+            sprite_atlas.generate(paths)
+
+    def test_packs_the_firmware_sprites(self):
+        self.assertEqual(len(SPRITES), 8)
+
+        images = [sprite_atlas.decode_png(path) for path in SPRITES]
+        source = sprite_atlas.generate(SPRITES)
+        expected = b''.join(bytes((b, g, r, a)) for image in images for r, g, b, a in image[2])
+
+        self.assertEqual(atlas_bytes(source, 'LV_COLOR_DEPTH == 32'), expected)
+        self.assertIn('BALL_SPRITE_COUNT == 8', source)
+        self.assertIn('BALL_SPRITE_SIZE == 30 && BALL_SPRITE_SIZE == 30', source)
+
+
+if __name__ == '__main__':
+    unittest.main()
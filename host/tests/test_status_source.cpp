@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "hud/status_source.h"
+
+TEST(status_source, moves_its_version_on_with_every_change)
+{
+    status_source<int> source;
+
+    EXPECT_EQ(source.version(), 0U);
+    EXPECT_EQ(source.value(), 0);
+
+    EXPECT_TRUE(source.set(3));
+    EXPECT_EQ(source.version(), 1U);
+    EXPECT_EQ(source.value(), 3);
+
+    EXPECT_TRUE(source.set(4));
+    EXPECT_EQ(source.version(), 2U);
+    EXPECT_EQ(source.value(), 4);
+}
+
+TEST(status_source, ignores_the_value_it_already_has)
+{
+    status_source<int> source;
+
+    source.set(3);
+
+    EXPECT_FALSE(source.set(3));
+    EXPECT_EQ(source.version(), 1U);
+}
+
+TEST(status_source, takes_the_first_value_even_when_it_is_the_default)
+{
+    status_source<int> source;
+
+    // a field waits for version 1 before it shows anything, a zero still has to get there.
+    EXPECT_TRUE(source.set(0));
+    EXPECT_EQ(source.version(), 1U);
+}
+
+TEST(status_source, compares_texts_by_content)
+{
+    status_source<status_text> source;
+
+    source.set(make_status_text("rclink"));
+
+    EXPECT_FALSE(source.set(make_status_text("rclink")));
+    EXPECT_TRUE(source.set(make_status_text("rclink-2")));
+    EXPECT_STREQ(source.value().data(), "rclink-2");
+}
+
+TEST(status_source, notifies_subscribers_of_changes_only)
+{
+    status_source<int> source;
+    std::vector<int> first;
+    std::vector<int> second;
+
+    source.subscribe([&first](const int &value)
+                     { first.push_back(value); });
+    source.subscribe([&second](const int &value)
+                     { second.push_back(value); });
+
+    source.set(3);
+    source.set(3);
+    source.set(4);
+
+    EXPECT_EQ(first, (std::vector<int>{3, 4}));
+    EXPECT_EQ(second, (std::vector<int>{3, 4}));
+}
+
+TEST(status_source, has_the_new_value_in_place_when_it_notifies)
+{
+    status_source<int> source;
+    uint32_t version = 0;
+    int value = 0;
+
+    source.subscribe([&](const int &)
+                     {
+                         version = source.version();
+                         value = source.value(); });
+
+    source.set(7);
+
+    EXPECT_EQ(version, 1U);
+    EXPECT_EQ(value, 7);
+}
+
+TEST(status_text, keeps_a_whole_ssid)
+{
+    const std::string ssid(32, 's');
+
+    EXPECT_EQ(make_status_text(ssid.c_str()).data(), ssid);
+}
+
+TEST(status_text, truncates_anything_longer)
+{
+    const std::string text(40, 't');
+
+    EXPECT_EQ(make_status_text(text.c_str()).data(), text.substr(0, 32));
+}
+
+TEST(status_text, is_empty_without_text)
+{
+    EXPECT_STREQ(make_status_text(nullptr).data(), "");
+    EXPECT_STREQ(make_status_text("").data(), "");
+}
\ No newline at end of file
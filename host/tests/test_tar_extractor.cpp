@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+#include <mbedtls/sha256.h>
+
+#include "server/tar_extractor.h"
+
+class tar_extractor_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        std::filesystem::remove_all(m_root);
+        std::filesystem::create_directories(m_root);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(m_root);
+    }
+
+    void add_file(const std::string &name, const std::string &content)
+    {
+        uint8_t header[512] = {};
+
+        memcpy(header, name.data(), std::min(name.size(), size_t(100)));
+        snprintf(reinterpret_cast<char *>(header + 100), 8, "%07o", 0644);
+        snprintf(reinterpret_cast<char *>(header + 108), 8, "%07o", 0);
+        snprintf(reinterpret_cast<char *>(header + 116), 8, "%07o", 0);
+        snprintf(reinterpret_cast<char *>(header + 124), 12, "%011o", static_cast<unsigned>(content.size()));
+        snprintf(reinterpret_cast<char *>(header + 136), 12, "%011o", 0);
+        header[156] = '0';
+        memcpy(header + 257, "ustar", 6);
+        memcpy(header + 263, "00", 2);
+        memset(header + 148, ' ', 8);
+
+        unsigned checksum = 0;
+
+        for (const uint8_t byte : header)
+            checksum += byte;
+
+        snprintf(reinterpret_cast<char *>(header + 148), 8, "%06o", checksum);
+        header[155] = ' ';
+
+        m_archive.insert(m_archive.end(), header, header + sizeof(header));
+        m_archive.insert(m_archive.end(), content.begin(), content.end());
+        m_archive.resize((m_archive.size() + 511) / 512 * 512, 0);
+    }
+
+    // a sha256sum style manifest line for content stored as name.
+    static std::string manifest_line(const std::string &name, const std::string &content)
+    {
+        mbedtls_sha256_context context;
+        uint8_t digest[32];
+        char hex[3];
+        std::string line;
+
+        mbedtls_sha256_init(&context);
+        mbedtls_sha256_starts(&context, 0);
+        mbedtls_sha256_update(&context, reinterpret_cast<const uint8_t *>(content.data()), content.size());
+        mbedtls_sha256_finish(&context, digest);
+        mbedtls_sha256_free(&context);
+
+        for (const uint8_t byte : digest)
+        {
+            snprintf(hex, sizeof(hex), "%02x", byte);
+            line += hex;
+        }
+
+        return line + "  " + name + "\n";
+    }
+
+    std::vector<uint8_t> archive() const
+    {
+        auto archive = m_archive;
+
+        archive.resize(archive.size() + 1024, 0);
+
+        return archive;
+    }
+
+    bool extract(tar_extractor &extractor, const std::vector<uint8_t> &archive, const size_t chunk_size = 100)
+    {
+        for (size_t offset = 0; offset < archive.size(); offset += chunk_size)
+            if (!extractor.write(archive.data() + offset, std::min(chunk_size, archive.size() - offset)))
+                return false;
+
+        return extractor.finish();
+    }
+
+    std::string read(const std::string &name) const
+    {
+        std::ifstream file(m_root / name);
+        std::stringstream content;
+
+        content << file.rdbuf();
+
+        return content.str();
+    }
+
+    // one directory per test, ctest runs them as separate processes and maybe side by side.
+    std::filesystem::path m_root = std::filesystem::path(RCLINK_TEST_DIRECTORY) / testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::vector<uint8_t> m_archive;
+};
+
+TEST_F(tar_extractor_test, extracts_files_listed_in_the_manifest)
+{
+    add_file("index.html", "<html></html>");
+    add_file("assets/app.js", "console.log(1);");
+    add_file(tar_extractor::MANIFEST_NAME, manifest_line("index.html", "<html></html>") + manifest_line("./assets/app.js", "console.log(1);"));
+
+    tar_extractor extractor(m_root.string());
+
+    ASSERT_TRUE(extract(extractor, archive()));
+    EXPECT_EQ(extractor.file_count(), 3U);
+    EXPECT_EQ(read("index.html"), "<html></html>");
+    EXPECT_EQ(read("assets/app.js"), "console.log(1);");
+    EXPECT_TRUE(extractor.file_digest(tar_extractor::MANIFEST_NAME));
+}
+
+TEST_F(tar_extractor_test, rejects_a_file_the_manifest_lists_twice_instead_of_another)
+{
+    add_file("index.html", "<html></html>");
+    add_file("unlisted.js", "alert(1);");
+    add_file(tar_extractor::MANIFEST_NAME, manifest_line("index.html", "<html></html>") + manifest_line("index.html", "<html></html>"));
+
+    tar_extractor extractor(m_root.string());
+
+    EXPECT_FALSE(extract(extractor, archive()));
+    EXPECT_FALSE(extractor.io_failed());
+}
+
+TEST_F(tar_extractor_test, rejects_a_digest_mismatch)
+{
+    add_file("index.html", "<html></html>");
+    add_file(tar_extractor::MANIFEST_NAME, manifest_line("index.html", "<html>tampered</html>"));
+
+    tar_extractor extractor(m_root.string());
+
+    EXPECT_FALSE(extract(extractor, archive()));
+    EXPECT_FALSE(extractor.io_failed());
+}
+
+TEST_F(tar_extractor_test, rejects_paths_outside_the_directory)
+{
+    add_file("../escaped.html", "<html></html>");
+
+    tar_extractor extractor(m_root.string());
+
+    EXPECT_FALSE(extract(extractor, archive()));
+    EXPECT_FALSE(std::filesystem::exists(m_root.parent_path() / "escaped.html"));
+}
+
+TEST_F(tar_extractor_test, rejects_a_truncated_archive)
+{
+    add_file("index.html", std::string(2000, 'x'));
+
+    auto truncated = archive();
+
+    truncated.resize(1024);
+
+    tar_extractor extractor(m_root.string());
+
+    EXPECT_FALSE(extract(extractor, truncated));
+    EXPECT_FALSE(extractor.io_failed());
+}
+
+TEST_F(tar_extractor_test, reports_filesystem_failures)
+{
+    add_file("index.html", "<html></html>");
+
+    tar_extractor extractor((m_root / "missing").string());
+
+    EXPECT_FALSE(extract(extractor, archive()));
+    EXPECT_TRUE(extractor.io_failed());
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <regex>
+#include <string>
+#include <fstream>
+
+#include <sdkconfig.h>
+
+#include "task_config.h"
+
+struct kconfig_symbol
+{
+    long minimum = 0;
+    long maximum = 0;
+    long value = 0;
+    bool has_range = false;
+    bool has_default = false;
+};
+
+// the int symbols of main/Kconfig.projbuild with their range and default.
+static std::map<std::string, kconfig_symbol> parse_kconfig()
+{
+    std::ifstream kconfig(RCLINK_SOURCE_DIRECTORY "/main/Kconfig.projbuild");
+    const std::regex config_line(R"(^\s*config ([A-Z0-9_]+)\s*$)");
+    const std::regex range_line(R"(^\s*range (-?[0-9]+) (-?[0-9]+)\s*$)");
+    const std::regex default_line(R"(^\s*default (-?[0-9]+)\s*$)");
+
+    std::map<std::string, kconfig_symbol> symbols;
+    kconfig_symbol *current = nullptr;
+    std::string line;
+    std::smatch match;
+
+    while (std::getline(kconfig, line))
+    {
+        if (std::regex_match(line, match, config_line))
+            current = &symbols[match[1]];
+        else if (current && std::regex_match(line, match, range_line))
+        {
+            current->minimum = std::stol(match[1]);
+            current->maximum = std::stol(match[2]);
+            current->has_range = true;
+        }
+        else if (current && !current->has_default && std::regex_match(line, match, default_line))
+        {
+            current->value = std::stol(match[1]);
+            current->has_default = true;
+        }
+    }
+
+    return symbols;
+}
+
+static void expect_configured(const std::map<std::string, kconfig_symbol> &symbols, const std::string &prefix, const task_config &task)
+{
+    const std::pair<const char *, long> fields[] = {
+        {"_CORE", task.core},
+        {"_PRIORITY", static_cast<long>(task.priority)},
+        {"_STACK_SIZE", static_cast<long>(task.stack_size)},
+    };
+
+    for (const auto &[suffix, value] : fields)
+    {
+        const auto symbol = symbols.find(prefix + suffix);
+
+        ASSERT_NE(symbol, symbols.end()) << prefix << suffix;
+        ASSERT_TRUE(symbol->second.has_range && symbol->second.has_default) << prefix << suffix;
+
+        // the host build doesn't override any placement, so every task sits at its default.
+        EXPECT_EQ(value, symbol->second.value) << prefix << suffix;
+        EXPECT_GE(value, symbol->second.minimum) << prefix << suffix;
+        EXPECT_LE(value, symbol->second.maximum) << prefix << suffix;
+    }
+}
+
+TEST(task_config, follows_the_tasks_menu)
+{
+    const auto symbols = parse_kconfig();
+
+    ASSERT_FALSE(symbols.empty());
+
+    expect_configured(symbols, "RCLINK_HTTP_SERVER", HTTP_SERVER_TASK);
+    expect_configured(symbols, "RCLINK_HTTP_WORKER", HTTP_WORKER_TASK);
+    expect_configured(symbols, "RCLINK_WEBSOCKET", WEBSOCKET_TASK);
+    expect_configured(symbols, "RCLINK_DISPATCH", DISPATCH_TASK);
+    expect_configured(symbols, "RCLINK_OTA_WRITER", OTA_WRITER_TASK);
+    expect_configured(symbols, "RCLINK_PHYSICS", PHYSICS_TASK);
+    expect_configured(symbols, "RCLINK_SENSOR", SENSOR_TASK);
+}
+
+TEST(task_config, pins_every_task_to_an_existing_core)
+{
+    for (const auto &task : {HTTP_SERVER_TASK, HTTP_WORKER_TASK, WEBSOCKET_TASK, DISPATCH_TASK, OTA_WRITER_TASK, PHYSICS_TASK, SENSOR_TASK})
+    {
+        EXPECT_GE(task.core, 0);
+        EXPECT_LT(task.core, portNUM_PROCESSORS);
+    }
+}
+
+TEST(task_config, generates_overrides_and_dependencies)
+{
+    // RCLINK_HOST_CONFIG turns these on, the defaults have them off or unset.
+    EXPECT_EQ(CONFIG_RCLINK_TASK_REPORT, 1);
+    EXPECT_EQ(CONFIG_LITTLEFS_OBJ_NAME_LEN, 256);
+
+    // defaults to y but depends on SPIRAM, which the host doesn't have.
+#ifdef CONFIG_RCLINK_LUA_HEAP_PSRAM
+    ADD_FAILURE() << "a symbol whose dependency is off was generated";
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sdkconfig.h>
+
+#include "profile/task_report.h"
+
+// mirrors task_summary in profile/task_report.cpp.
+struct task_summary
+{
+    uint8_t core;
+    uint8_t priority;
+    uint8_t state;
+    uint16_t load;
+    uint32_t stack_free;
+} __attribute__((packed));
+
+static TaskHandle_t fake_handle(const uintptr_t number)
+{
+    return reinterpret_cast<TaskHandle_t>(number * 16U);
+}
+
+static const TaskHandle_t IDLE_HANDLES[portNUM_PROCESSORS] = {fake_handle(1), fake_handle(2)};
+
+static std::vector<TaskStatus_t> fake_tasks;
+static configRUN_TIME_COUNTER_TYPE fake_total_run_time = 0;
+
+// the shim's versions are weak, these report whatever the test set up instead of the host's
+// threads.
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *status, const UBaseType_t size, configRUN_TIME_COUNTER_TYPE *total_run_time)
+{
+    if (fake_tasks.size() > size)
+        return 0;
+
+    std::copy(fake_tasks.begin(), fake_tasks.end(), status);
+
+    *total_run_time = fake_total_run_time;
+
+    return fake_tasks.size();
+}
+
+TaskHandle_t xTaskGetIdleTaskHandleForCore(const BaseType_t core)
+{
+    return core >= 0 && core < portNUM_PROCESSORS ? IDLE_HANDLES[core] : nullptr;
+}
+
+static TaskStatus_t fake_task(const uintptr_t number, const char *name, const BaseType_t core, const UBaseType_t priority,
+                              const configRUN_TIME_COUNTER_TYPE run_time, const uint32_t stack_free, const eTaskState state = eBlocked)
+{
+    return {
+        .xHandle = fake_handle(number),
+        .pcTaskName = name,
+        .xTaskNumber = static_cast<UBaseType_t>(number),
+        .eCurrentState = state,
+        .uxCurrentPriority = priority,
+        .uxBasePriority = priority,
+        .ulRunTimeCounter = run_time,
+        .pxStackBase = nullptr,
+        .usStackHighWaterMark = stack_free,
+        .xCoreID = core,
+    };
+}
+
+// two idle tasks and three others after a window of 1000, the loads in tenths of a percent
+// are their run times.
+static void set_tasks(const configRUN_TIME_COUNTER_TYPE scale)
+{
+    fake_tasks = {
+        fake_task(1, "IDLE0", 0, 0, 600 * scale, 900, eReady),
+        fake_task(2, "IDLE1", 1, 0, 200 * scale, 900, eReady),
+        fake_task(3, "physics", 1, 10, 800 * scale, 1200, eRunning),
+        fake_task(4, "dispatch", 0, 5, 400 * scale, 2048),
+        fake_task(5, "sensors", tskNO_AFFINITY, 3, 0, 512, eSuspended),
+    };
+    fake_total_run_time = 1000 * scale;
+}
+
+struct reported_task
+{
+    task_summary summary;
+    std::string name;
+};
+
+static bool report(std::vector<uint16_t> &core_load, std::vector<reported_task> &tasks)
+{
+    tlvcpp::tlv_tree_node root;
+
+    task_report::get().serialize(root);
+
+    const auto &report = root.children().front();
+
+    if (report.data().tag() != TASK_REPORT_TAG || report.children().empty())
+        return false;
+
+    const auto &loads = report.children().front().data();
+
+    core_load.resize(loads.length() / sizeof(uint16_t));
+    memcpy(core_load.data(), loads.value(), loads.length());
+
+    tasks.clear();
+
+    for (auto task = std::next(report.children().begin()); task != report.children().end(); task++)
+    {
+        const auto &name = task->children().front().data();
+        reported_task reported = {};
+
+        if (task->data().tag() != TASK_TAG || task->data().length() != sizeof(task_summary))
+            return false;
+
+        memcpy(&reported.summary, task->data().value(), sizeof(task_summary));
+        reported.name.assign(reinterpret_cast<const char *>(name.value()), name.length());
+
+        tasks.push_back(reported);
+    }
+
+    return true;
+}
+
+class task_report_test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // every report measures from the previous one, whichever test took it.
+        set_tasks(0);
+
+        char text[64];
+
+        task_report::get().format(text, sizeof(text));
+    }
+};
+
+TEST_F(task_report_test, reports_the_load_of_every_task_and_core)
+{
+    set_tasks(1);
+
+    std::vector<uint16_t> core_load;
+    std::vector<reported_task> tasks;
+
+    ASSERT_TRUE(report(core_load, tasks));
+    ASSERT_EQ(core_load.size(), 2U);
+    EXPECT_EQ(core_load[0], 400U);
+    EXPECT_EQ(core_load[1], 800U);
+
+    ASSERT_EQ(tasks.size(), 5U);
+
+    const std::vector<std::string> busiest_first = {"physics", "IDLE0", "dispatch", "IDLE1", "sensors"};
+
+    for (size_t i = 0; i < tasks.size(); i++)
+        EXPECT_EQ(tasks[i].name, busiest_first[i]);
+
+    EXPECT_EQ(tasks[0].summary.load, 800U);
+    EXPECT_EQ(tasks[0].summary.core, 1U);
+    EXPECT_EQ(tasks[0].summary.priority, 10U);
+    EXPECT_EQ(tasks[0].summary.state, eRunning);
+    EXPECT_EQ(tasks[0].summary.stack_free, 1200U);
+    EXPECT_EQ(tasks[4].summary.core, task_report::ANY_CORE);
+    EXPECT_EQ(tasks[4].summary.load, 0U);
+}
+
+TEST_F(task_report_test, measures_the_load_since_the_previous_report)
+{
+    set_tasks(1);
+
+    std::vector<uint16_t> core_load;
+    std::vector<reported_task> tasks;
+
+    ASSERT_TRUE(report(core_load, tasks));
+
+    // the dispatch task takes the whole next window on core 0.
+    fake_tasks[1].ulRunTimeCounter += 1000;
+    fake_tasks[3].ulRunTimeCounter += 1000;
+    fake_total_run_time += 1000;
+
+    ASSERT_TRUE(report(core_load, tasks));
+    EXPECT_EQ(core_load[0], 1000U);
+    EXPECT_EQ(core_load[1], 0U);
+
+    // the two fully loaded tasks tie for first place.
+    for (const auto &task : tasks)
+        EXPECT_EQ(task.summary.load, task.name == "dispatch" || task.name == "IDLE1" ? 1000U : 0U) << task.name;
+}
+
+TEST_F(task_report_test, counts_tasks_new_since_the_previous_report_from_zero)
+{
+    set_tasks(1);
+
+    std::vector<uint16_t> core_load;
+    std::vector<reported_task> tasks;
+
+    ASSERT_TRUE(report(core_load, tasks));
+
+    fake_tasks.push_back(fake_task(6, "ota_writer", 0, 4, 250, 3000));
+    fake_tasks[0].ulRunTimeCounter += 750;
+    fake_total_run_time += 1000;
+
+    ASSERT_TRUE(report(core_load, tasks));
+    ASSERT_EQ(tasks.size(), 6U);
+    EXPECT_EQ(tasks[1].name, "ota_writer");
+    EXPECT_EQ(tasks[1].summary.load, 250U);
+    EXPECT_EQ(core_load[0], 250U);
+}
+
+TEST_F(task_report_test, formats_a_table_busiest_task_first)
+{
+    set_tasks(1);
+
+    char text[1024];
+    const size_t length = task_report::get().format(text, sizeof(text));
+
+    EXPECT_EQ(std::string(text, length),
+              "core 0    40.0%\n"
+              "core 1    80.0%\n"
+              "\n"
+              "task             core prio state    cpu  stack\n"
+              "physics             1   10     X   80.0%   1200\n"
+              "IDLE0               0    0     R   60.0%    900\n"
+              "dispatch            0    5     B   40.0%   2048\n"
+              "IDLE1               1    0     R   20.0%    900\n"
+              "sensors             -    3     S    0.0%    512\n");
+}
+
+TEST_F(task_report_test, truncates_the_table_to_the_buffer)
+{
+    set_tasks(1);
+
+    char text[32];
+
+    memset(text, 'x', sizeof(text));
+
+    const size_t length = task_report::get().format(text, sizeof(text));
+
+    EXPECT_EQ(length, sizeof(text) - 1U);
+    EXPECT_EQ(text[length], '\0');
+    EXPECT_EQ(std::string(text, length), std::string("core 0    40.0%\ncore 1    80.0%\n").substr(0, length));
+}
+
+TEST_F(task_report_test, reports_nothing_with_more_tasks_than_it_has_room_for)
+{
+    set_tasks(1);
+
+    fake_tasks.resize(task_report::MAX_TASKS + 1U, fake_tasks.back());
+
+    tlvcpp::tlv_tree_node root;
+
+    task_report::get().serialize(root);
+
+    ASSERT_EQ(root.children().size(), 1U);
+    EXPECT_EQ(root.children().front().data().tag(), TASK_REPORT_TAG);
+    EXPECT_TRUE(root.children().front().children().empty());
+
+    char text[64];
+
+    EXPECT_EQ(task_report::get().format(text, sizeof(text)), 0U);
+}
\ No newline at end of file
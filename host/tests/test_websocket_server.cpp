@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "host_shim.h"
+#include "profile/lock_profile.h"
+#include "server/websocket_server.h"
+#include "websocket_client.h"
+
+constexpr const uint16_t PORT = 18081;
+constexpr const auto RECEIVE_TIMEOUT = std::chrono::seconds(5);
+
+static tlvcpp::tlv_tree_node message(const uint32_t tag, const std::vector<uint8_t> &value)
+{
+    tlvcpp::tlv_tree_node root;
+
+    root.add_child(tag, value.size(), value.data());
+
+    return root;
+}
+
+// polls like the dispatch worker does until count children arrived.
+static tlvcpp::tlv_tree_node receive(websocket_server &server, const size_t count)
+{
+    tlvcpp::tlv_tree_node received;
+    const auto deadline = std::chrono::steady_clock::now() + RECEIVE_TIMEOUT;
+
+    while (received.children().size() < count && std::chrono::steady_clock::now() < deadline)
+    {
+        server >> received;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return received;
+}
+
+// timeouts of the receive lock so far, from its lock profile report.
+static uint32_t receive_lock_timeouts()
+{
+    tlvcpp::tlv_tree_node root;
+
+    lock_profile::serialize_all(root);
+
+    for (const auto &lock : root.children().front().children())
+    {
+        const auto &name = lock.children().front().data();
+
+        if (std::string(reinterpret_cast<const char *>(name.value()), name.length()) != "websocket_receive")
+            continue;
+
+        // acquisitions, contended and then timeouts lead the packed summary.
+        uint32_t timeouts = 0;
+
+        memcpy(&timeouts, lock.data().value() + 2 * sizeof(uint32_t), sizeof(timeouts));
+
+        return timeouts;
+    }
+
+    return 0;
+}
+
+static bool connect(websocket_client &client)
+{
+    if (!client.connect(PORT))
+        return false;
+
+    // the handshake is answered before the handler switches to the client.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    return true;
+}
+
+TEST(websocket_server, receives_a_message_split_across_frames)
+{
+    websocket_server server(PORT);
+    websocket_client client;
+
+    ASSERT_TRUE(connect(client));
+    ASSERT_TRUE(client.send(websocket_client::frame(message(0x42, {1, 2, 3, 4, 5, 6, 7, 8})), 3));
+
+    const auto received = receive(server, 1);
+
+    ASSERT_EQ(received.children().size(), 1U);
+    EXPECT_EQ(received.children().front().data().tag(), 0x42U);
+    EXPECT_EQ(received.children().front().data().length(), 8U);
+}
+
+TEST(websocket_server, receives_messages_coalesced_into_one_frame)
+{
+    websocket_server server(PORT);
+    websocket_client client;
+
+    ASSERT_TRUE(connect(client));
+
+    std::vector<uint8_t> stream;
+
+    for (uint32_t tag = 1; tag <= 3; tag++)
+    {
+        const auto framed = websocket_client::frame(message(tag, {static_cast<uint8_t>(tag)}));
+
+        stream.insert(stream.end(), framed.begin(), framed.end());
+    }
+
+    ASSERT_TRUE(client.send(stream));
+
+    const auto received = receive(server, 3);
+
+    ASSERT_EQ(received.children().size(), 3U);
+
+    uint32_t tag = 1;
+
+    for (const auto &child : received.children())
+        EXPECT_EQ(child.data().tag(), tag++);
+}
+
+TEST(websocket_server, sends_messages_larger_than_a_frame)
+{
+    websocket_server server(PORT);
+    websocket_client client;
+
+    ASSERT_TRUE(connect(client));
+
+    std::vector<uint8_t> value(3000);
+
+    for (size_t i = 0; i < value.size(); i++)
+        value[i] = static_cast<uint8_t>(i);
+
+    server << message(0x7, value);
+
+    tlvcpp::tlv_tree_node received;
+
+    ASSERT_TRUE(client.receive(received));
+    ASSERT_EQ(received.children().size(), 1U);
+
+    const auto &child = received.children().front().data();
+
+    EXPECT_EQ(child.tag(), 0x7U);
+    ASSERT_EQ(child.length(), value.size());
+    EXPECT_TRUE(std::equal(value.begin(), value.end(), child.value()));
+}
+
+TEST(websocket_server, a_new_client_replaces_the_previous_one)
+{
+    websocket_server server(PORT);
+    websocket_client first;
+    websocket_client second;
+
+    ASSERT_TRUE(connect(first));
+    ASSERT_TRUE(connect(second));
+
+    tlvcpp::tlv_tree_node received;
+
+    EXPECT_FALSE(first.receive(received));
+
+    server << message(0x9, {9});
+
+    ASSERT_TRUE(second.receive(received));
+    EXPECT_EQ(received.children().front().data().tag(), 0x9U);
+}
+
+TEST(websocket_server, polling_gives_up_while_a_frame_is_being_received)
+{
+    constexpr const uint32_t PAYLOAD_DELAY_US = 200000U;
+
+    websocket_server server(PORT);
+    websocket_client client;
+
+    ASSERT_TRUE(connect(client));
+
+    const auto timeouts = receive_lock_timeouts();
+
+    host_shim::set_frame_payload_delay(PAYLOAD_DELAY_US);
+
+    std::thread sender([&client]()
+                       { client.send(websocket_client::frame(message(0x42, {1, 2, 3, 4}))); });
+
+    // the handler is waiting for the payload with the receive lock held by now.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    tlvcpp::tlv_tree_node received;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    server >> received;
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    host_shim::set_frame_payload_delay(0);
+    sender.join();
+
+    EXPECT_LT(elapsed, std::chrono::milliseconds(100));
+    EXPECT_TRUE(received.children().empty());
+    EXPECT_GT(receive_lock_timeouts(), timeouts);
+
+    received = receive(server, 1);
+
+    ASSERT_EQ(received.children().size(), 1U);
+    EXPECT_EQ(received.children().front().data().tag(), 0x42U);
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include <atomic>
+#include <string>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "server/http_server.h"
+#include "server/websocket_server.h"
+
+// the firmware's http and websocket servers on loopback, websocket messages are echoed back.
+// a target for scripts/ and tools/load_generator when no device is around.
+//
+//   host_server [--http-port 8080] [--websocket-port 8081] [--root directory]
+
+static std::atomic<bool> is_running = true;
+
+static void stop(int)
+{
+    is_running = false;
+}
+
+int main(int argc, char **argv)
+{
+    uint16_t http_port = 8080;
+    uint16_t websocket_port = 8081;
+    std::string root = ".";
+
+    for (int i = 1; i + 1 < argc; i += 2)
+        if (!strcmp(argv[i], "--http-port"))
+            http_port = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--websocket-port"))
+            websocket_port = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--root"))
+            root = argv[i + 1];
+        else
+        {
+            fprintf(stderr, "unknown option: %s\n", argv[i]);
+
+            return 1;
+        }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    http_server http(http_port, root);
+    websocket_server websocket(websocket_port);
+    size_t echoed = 0;
+
+    printf("serving %s on http://127.0.0.1:%u, websocket on ws://127.0.0.1:%u\n", root.c_str(), http_port, websocket_port);
+    fflush(stdout);
+
+    while (is_running)
+    {
+        tlvcpp::tlv_tree_node received;
+
+        websocket >> received;
+
+        if (received.children().size())
+        {
+            echoed += received.children().size();
+
+            websocket << received;
+        }
+        else
+            vTaskDelay(1);
+    }
+
+    const auto statistics = http.get_statistics();
+
+    printf("echoed %zu messages, rejected %u requests, max queue depth %zu\n", echoed, statistics.rejected, statistics.max_queue_depth);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,636 @@
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+#include <tlvcpp/tlv_tree.h>
+
+#include "http_client.h"
+#include "websocket_client.h"
+
+// drives the firmware's websocket and http servers, on a device or host_server, with
+// concurrent clients and prints a json report with rates and latency percentiles.
+//
+//   load_generator [--address 127.0.0.1] [--duration 10] [--output report.json]
+//     websocket: --websocket-port 81 [--clients 1] [--rate 0] [--drain 1]
+//                [--trace file | --messages 64 --tag 0x01 --size 16 --seed 1]
+//                [--fragmentation none|split|coalesce|random] [--fragment-size 64]
+//     http:      --http-port 80 [--http-clients 1] [--get /path] [--upload /path=file]
+//
+// the websocket stream is a sequence of messages, a u16 length followed by a serialized tlv
+// tree, recorded traces hold them back to back like they went over the wire. fragmentation
+// none sends a message per frame, split cuts them into continuation frames of fragment size
+// bytes, coalesce puts fragment size messages in a frame and random cuts the stream at random
+// offsets up to fragment size.
+//
+// the firmware serves a single websocket client, a new one takes over and the others are
+// closed, more than one client exercises that and the closed ones count as errors. replies
+// are matched to requests in order, counting nodes since the server merges messages.
+
+using header_type = uint16_t;
+using load_clock = std::chrono::steady_clock;
+
+constexpr const size_t MAX_MESSAGE_SIZE = 4U * 1024U - sizeof(header_type);
+constexpr const double PERCENTILES[] = {50.0, 90.0, 99.0, 99.9};
+
+enum class fragmentation
+{
+    none,
+    split,
+    coalesce,
+    random,
+};
+
+struct options
+{
+    std::string address = "127.0.0.1";
+    double duration = 10.0;
+    std::string output;
+
+    uint16_t websocket_port = 0;
+    size_t clients = 1;
+    double rate = 0.0;
+    double drain = 1.0;
+    std::string trace;
+    size_t messages = 64;
+    std::vector<uint32_t> tags;
+    size_t size = 16;
+    uint32_t seed = 1;
+    fragmentation pattern = fragmentation::none;
+    size_t fragment_size = 64;
+
+    uint16_t http_port = 0;
+    size_t http_clients = 1;
+    std::vector<std::string> gets;
+    std::vector<std::string> uploads;
+};
+
+struct statistics
+{
+    uint64_t requests = 0;
+    uint64_t responses = 0;
+    uint64_t errors = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    std::vector<double> latencies;
+
+    void merge(const statistics &other)
+    {
+        requests += other.requests;
+        responses += other.responses;
+        errors += other.errors;
+        bytes_sent += other.bytes_sent;
+        bytes_received += other.bytes_received;
+        latencies.insert(latencies.end(), other.latencies.begin(), other.latencies.end());
+    }
+};
+
+struct framed_message
+{
+    std::vector<uint8_t> data;
+    // nodes the server hands on, an untagged root stands for its children.
+    size_t nodes;
+};
+
+// what goes out as one websocket message and how many nodes it completes.
+struct send_unit
+{
+    std::vector<uint8_t> data;
+    size_t fragment_size;
+    size_t nodes;
+};
+
+struct http_request
+{
+    const char *method;
+    std::string path;
+    std::string body;
+};
+
+static double elapsed_since(const load_clock::time_point started_at)
+{
+    return std::chrono::duration<double>(load_clock::now() - started_at).count();
+}
+
+static bool parse_fragmentation(const char *name, fragmentation &pattern)
+{
+    const char *names[] = {"none", "split", "coalesce", "random"};
+
+    for (size_t i = 0; i < std::size(names); i++)
+        if (!strcmp(name, names[i]))
+        {
+            pattern = static_cast<fragmentation>(i);
+
+            return true;
+        }
+
+    return false;
+}
+
+static bool parse_options(int argc, char **argv, options &parsed)
+{
+    for (int i = 1; i < argc; i += 2)
+    {
+        const char *option = argv[i];
+
+        if (i + 1 >= argc)
+        {
+            fprintf(stderr, "missing value for %s\n", option);
+
+            return false;
+        }
+
+        const char *value = argv[i + 1];
+
+        if (!strcmp(option, "--address"))
+            parsed.address = value;
+        else if (!strcmp(option, "--duration"))
+            parsed.duration = atof(value);
+        else if (!strcmp(option, "--output"))
+            parsed.output = value;
+        else if (!strcmp(option, "--websocket-port"))
+            parsed.websocket_port = atoi(value);
+        else if (!strcmp(option, "--clients"))
+            parsed.clients = strtoul(value, nullptr, 0);
+        else if (!strcmp(option, "--rate"))
+            parsed.rate = atof(value);
+        else if (!strcmp(option, "--drain"))
+            parsed.drain = atof(value);
+        else if (!strcmp(option, "--trace"))
+            parsed.trace = value;
+        else if (!strcmp(option, "--messages"))
+            parsed.messages = strtoul(value, nullptr, 0);
+        else if (!strcmp(option, "--tag"))
+            parsed.tags.push_back(strtoul(value, nullptr, 0));
+        else if (!strcmp(option, "--size"))
+            parsed.size = strtoul(value, nullptr, 0);
+        else if (!strcmp(option, "--seed"))
+            parsed.seed = strtoul(value, nullptr, 0);
+        else if (!strcmp(option, "--fragmentation"))
+        {
+            if (!parse_fragmentation(value, parsed.pattern))
+            {
+                fprintf(stderr, "unknown fragmentation: %s\n", value);
+
+                return false;
+            }
+        }
+        else if (!strcmp(option, "--fragment-size"))
+            parsed.fragment_size = std::max<size_t>(1, strtoul(value, nullptr, 0));
+        else if (!strcmp(option, "--http-port"))
+            parsed.http_port = atoi(value);
+        else if (!strcmp(option, "--http-clients"))
+            parsed.http_clients = strtoul(value, nullptr, 0);
+        else if (!strcmp(option, "--get"))
+            parsed.gets.push_back(value);
+        else if (!strcmp(option, "--upload"))
+            parsed.uploads.push_back(value);
+        else
+        {
+            fprintf(stderr, "unknown option: %s\n", option);
+
+            return false;
+        }
+    }
+
+    if (parsed.tags.empty())
+        parsed.tags.push_back(0x01);
+
+    if (!parsed.websocket_port && !parsed.http_port)
+    {
+        fprintf(stderr, "nothing to do, pass --websocket-port and/or --http-port\n");
+
+        return false;
+    }
+
+    return true;
+}
+
+static size_t count_nodes(const uint8_t *data, const size_t size)
+{
+    tlvcpp::tlv_tree_node node;
+
+    if (!node.deserialize(data, size))
+        return 0;
+
+    return node.data().tag() ? 1 : node.children().size();
+}
+
+static bool synthetic_trace(const options &parsed, std::vector<framed_message> &messages)
+{
+    std::mt19937 generator(parsed.seed);
+
+    for (size_t i = 0; i < parsed.messages; i++)
+    {
+        std::vector<uint8_t> value(parsed.size);
+
+        std::generate(value.begin(), value.end(), [&generator]()
+                      { return static_cast<uint8_t>(generator()); });
+
+        tlvcpp::tlv_tree_node root;
+
+        root.add_child(parsed.tags[generator() % parsed.tags.size()], value.size(), value.data());
+
+        auto framed = websocket_client::frame(root);
+
+        if (framed.size() - sizeof(header_type) > MAX_MESSAGE_SIZE)
+        {
+            fprintf(stderr, "messages of %zu bytes don't fit the receive buffer\n", framed.size() - sizeof(header_type));
+
+            return false;
+        }
+
+        messages.push_back({std::move(framed), 1});
+    }
+
+    return true;
+}
+
+static bool load_trace(const std::string &path, std::vector<framed_message> &messages)
+{
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t offset = 0;
+
+    while (offset + sizeof(header_type) <= data.size())
+    {
+        header_type size;
+
+        memcpy(&size, data.data() + offset, sizeof(size));
+
+        const size_t end = offset + sizeof(size) + size;
+
+        if (end > data.size())
+            break;
+
+        messages.push_back({std::vector<uint8_t>(data.begin() + offset, data.begin() + end), count_nodes(data.data() + offset + sizeof(size), size)});
+
+        offset = end;
+    }
+
+    if (offset != data.size() || messages.empty())
+    {
+        fprintf(stderr, "%s: not a framed message trace\n", path.c_str());
+
+        return false;
+    }
+
+    return true;
+}
+
+// one pass over the trace, random cuts differ from pass to pass.
+static std::vector<send_unit> schedule(const options &parsed, const std::vector<framed_message> &messages, std::mt19937 &generator)
+{
+    std::vector<send_unit> units;
+
+    if (parsed.pattern == fragmentation::coalesce)
+    {
+        for (size_t i = 0; i < messages.size(); i += parsed.fragment_size)
+        {
+            send_unit unit = {{}, SIZE_MAX, 0};
+
+            for (size_t j = i; j < std::min(messages.size(), i + parsed.fragment_size); j++)
+            {
+                unit.data.insert(unit.data.end(), messages[j].data.begin(), messages[j].data.end());
+                unit.nodes += messages[j].nodes;
+            }
+
+            units.push_back(std::move(unit));
+        }
+    }
+    else if (parsed.pattern == fragmentation::random)
+    {
+        std::vector<uint8_t> stream;
+        std::vector<std::pair<size_t, size_t>> ends;
+
+        for (const auto &message : messages)
+        {
+            stream.insert(stream.end(), message.data.begin(), message.data.end());
+            ends.emplace_back(stream.size(), message.nodes);
+        }
+
+        auto end = ends.begin();
+
+        for (size_t offset = 0; offset < stream.size();)
+        {
+            const size_t step = std::min<size_t>(std::uniform_int_distribution<size_t>(1, parsed.fragment_size)(generator), stream.size() - offset);
+            send_unit unit = {std::vector<uint8_t>(stream.begin() + offset, stream.begin() + offset + step), SIZE_MAX, 0};
+
+            offset += step;
+
+            for (; end != ends.end() && end->first <= offset; end++)
+                unit.nodes += end->second;
+
+            units.push_back(std::move(unit));
+        }
+    }
+    else
+        for (const auto &message : messages)
+            units.push_back({message.data, parsed.pattern == fragmentation::split ? parsed.fragment_size : SIZE_MAX, message.nodes});
+
+    return units;
+}
+
+static void run_websocket_client(const options &parsed, const std::vector<framed_message> &messages, const uint32_t seed,
+                                 const load_clock::time_point deadline, statistics &result)
+{
+    websocket_client client;
+
+    if (!client.connect(parsed.websocket_port, "/", parsed.address.c_str()))
+    {
+        result.errors++;
+
+        return;
+    }
+
+    std::mutex mutex;
+    std::deque<load_clock::time_point> pending;
+    statistics received;
+    std::atomic<bool> is_receiving = true;
+
+    // the firmware never pings, so only this thread reads and only the sender writes.
+    std::thread receiver([&]()
+                         {
+                             tlvcpp::tlv_tree_node node;
+
+                             while (client.receive(node))
+                             {
+                                 const auto now = load_clock::now();
+                                 const size_t nodes = node.data().tag() ? 1 : node.children().size();
+                                 size_t size = 0;
+                                 std::vector<uint8_t> serialized;
+
+                                 node.serialize(serialized, &size);
+
+                                 std::lock_guard lock(mutex);
+
+                                 received.responses += nodes;
+                                 received.bytes_received += sizeof(header_type) + size;
+
+                                 for (size_t i = 0; i < nodes && !pending.empty(); i++)
+                                 {
+                                     received.latencies.push_back(std::chrono::duration<double>(now - pending.front()).count());
+                                     pending.pop_front();
+                                 }
+                             }
+
+                             is_receiving = false; });
+
+    std::mt19937 generator(seed);
+    const auto interval = parsed.rate > 0.0 ? std::chrono::duration<double>(1.0 / parsed.rate) : std::chrono::duration<double>(0.0);
+    auto next_send = load_clock::now();
+    bool is_sending = true;
+
+    while (is_sending && load_clock::now() < deadline)
+        for (const auto &unit : schedule(parsed, messages, generator))
+        {
+            if (load_clock::now() >= deadline)
+                break;
+
+            // closed by the server, most likely because another client took over.
+            if (!is_receiving || !client.send(unit.data, unit.fragment_size))
+            {
+                result.errors++;
+                is_sending = false;
+
+                break;
+            }
+
+            {
+                std::lock_guard lock(mutex);
+
+                pending.insert(pending.end(), unit.nodes, load_clock::now());
+            }
+
+            result.requests += unit.nodes;
+            result.bytes_sent += unit.data.size();
+
+            // paced per node, fragments that don't complete one go right out.
+            if (interval.count() && unit.nodes)
+            {
+                next_send += std::chrono::duration_cast<load_clock::duration>(interval * unit.nodes);
+
+                std::this_thread::sleep_until(next_send);
+            }
+        }
+
+    // replies still on their way count, as long as they show up in time.
+    const auto drained_at = load_clock::now() + std::chrono::duration_cast<load_clock::duration>(std::chrono::duration<double>(parsed.drain));
+
+    while (load_clock::now() < drained_at)
+    {
+        {
+            std::lock_guard lock(mutex);
+
+            if (pending.empty())
+                break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    client.shutdown();
+    receiver.join();
+    client.close();
+
+    result.merge(received);
+}
+
+static bool http_requests(const options &parsed, std::vector<http_request> &requests)
+{
+    for (const auto &path : parsed.gets)
+        requests.push_back({"GET", path, {}});
+
+    for (const auto &upload : parsed.uploads)
+    {
+        const size_t separator = upload.find('=');
+
+        if (separator == std::string::npos)
+        {
+            fprintf(stderr, "uploads are path=file: %s\n", upload.c_str());
+
+            return false;
+        }
+
+        std::ifstream file(upload.substr(separator + 1), std::ios::binary);
+
+        if (!file)
+        {
+            fprintf(stderr, "couldn't open %s\n", upload.c_str() + separator + 1);
+
+            return false;
+        }
+
+        requests.push_back({"POST", upload.substr(0, separator), std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>())});
+    }
+
+    return true;
+}
+
+static void run_http_client(const options &parsed, const std::vector<http_request> &requests, const size_t first,
+                            const load_clock::time_point deadline, statistics &result)
+{
+    http_client client(parsed.http_port, parsed.address);
+    http_response response;
+
+    for (size_t index = first; load_clock::now() < deadline; index++)
+    {
+        const auto &request = requests[index % requests.size()];
+        const auto started_at = load_clock::now();
+
+        result.requests++;
+        result.bytes_sent += request.body.size();
+
+        if (!client.request(request.method, request.path, request.body, response))
+        {
+            result.errors++;
+
+            continue;
+        }
+
+        result.bytes_received += response.body.size();
+
+        if (response.status >= 200 && response.status < 400)
+        {
+            result.responses++;
+            result.latencies.push_back(elapsed_since(started_at));
+        }
+        else
+            result.errors++;
+    }
+}
+
+static std::string summarize(const char *name, statistics &result, const double elapsed)
+{
+    char line[512];
+    std::string summary;
+
+    snprintf(line, sizeof(line),
+             "    {\n"
+             "      \"name\": \"%s\",\n"
+             "      \"elapsed_s\": %.3f,\n"
+             "      \"requests\": %llu,\n"
+             "      \"responses\": %llu,\n"
+             "      \"errors\": %llu,\n"
+             "      \"bytes_sent\": %llu,\n"
+             "      \"bytes_received\": %llu,\n"
+             "      \"requests_per_s\": %.1f,\n"
+             "      \"responses_per_s\": %.1f,\n"
+             "      \"latency_ms\": {",
+             name,
+             elapsed,
+             static_cast<unsigned long long>(result.requests),
+             static_cast<unsigned long long>(result.responses),
+             static_cast<unsigned long long>(result.errors),
+             static_cast<unsigned long long>(result.bytes_sent),
+             static_cast<unsigned long long>(result.bytes_received),
+             elapsed > 0.0 ? result.requests / elapsed : 0.0,
+             elapsed > 0.0 ? result.responses / elapsed : 0.0);
+
+    summary += line;
+
+    auto &latencies = result.latencies;
+
+    if (!latencies.empty())
+    {
+        std::sort(latencies.begin(), latencies.end());
+
+        for (const double percentile : PERCENTILES)
+        {
+            const size_t index = std::min(latencies.size() - 1, static_cast<size_t>(latencies.size() * percentile / 100.0));
+
+            snprintf(line, sizeof(line), "\"p%g\": %.3f, ", percentile, latencies[index] * 1000.0);
+
+            summary += line;
+        }
+
+        snprintf(line, sizeof(line), "\"max\": %.3f", latencies.back() * 1000.0);
+
+        summary += line;
+    }
+
+    summary += "}\n    }";
+
+    return summary;
+}
+
+int main(int argc, char **argv)
+{
+    options parsed;
+    std::vector<framed_message> messages;
+    std::vector<http_request> requests;
+
+    if (!parse_options(argc, argv, parsed))
+        return 1;
+
+    if (parsed.websocket_port && !(parsed.trace.empty() ? synthetic_trace(parsed, messages) : load_trace(parsed.trace, messages)))
+        return 1;
+
+    if (parsed.http_port && (!http_requests(parsed, requests) || requests.empty()))
+    {
+        fprintf(stderr, "no http requests, pass --get and/or --upload\n");
+
+        return 1;
+    }
+
+    const auto started_at = load_clock::now();
+    const auto deadline = started_at + std::chrono::duration_cast<load_clock::duration>(std::chrono::duration<double>(parsed.duration));
+    const size_t websocket_clients = parsed.websocket_port ? parsed.clients : 0;
+    const size_t http_clients = parsed.http_port ? parsed.http_clients : 0;
+    std::vector<statistics> results(websocket_clients + http_clients);
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < websocket_clients; i++)
+        threads.emplace_back(run_websocket_client, std::cref(parsed), std::cref(messages), parsed.seed + i, deadline, std::ref(results[i]));
+
+    // spread out over the requests, so uploads and fetches run side by side.
+    for (size_t i = 0; i < http_clients; i++)
+        threads.emplace_back(run_http_client, std::cref(parsed), std::cref(requests), i, deadline, std::ref(results[websocket_clients + i]));
+
+    for (auto &thread : threads)
+        thread.join();
+
+    // replies that trickle in while draining still count, the time spent waiting for them doesn't.
+    const double elapsed = std::min(elapsed_since(started_at), parsed.duration);
+    statistics websocket_result;
+    statistics http_result;
+    std::vector<std::string> summaries;
+
+    for (size_t i = 0; i < results.size(); i++)
+        (i < websocket_clients ? websocket_result : http_result).merge(results[i]);
+
+    if (websocket_clients)
+        summaries.push_back(summarize("websocket", websocket_result, elapsed));
+
+    if (http_clients)
+        summaries.push_back(summarize("http", http_result, elapsed));
+
+    std::string report = "{\n  \"results\": [\n";
+
+    for (size_t i = 0; i < summaries.size(); i++)
+        report += summaries[i] + (i + 1 < summaries.size() ? ",\n" : "\n");
+
+    report += "  ]\n}\n";
+
+    if (parsed.output.empty())
+        fputs(report.c_str(), stdout);
+    else if (!(std::ofstream(parsed.output) << report))
+    {
+        fprintf(stderr, "couldn't write %s\n", parsed.output.c_str());
+
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "hud.h"
+
+#include "profile/profiler.h"
+
+constexpr uint32_t RATE_WINDOW = 1000U;
+
+hud::hud(lv_obj_t *parent, const uint32_t period) : m_parent(parent)
+{
+    auto refresh_timer = [](lv_timer_t *timer)
+    {
+        static_cast<hud *>(timer->user_data)->refresh();
+    };
+
+    m_timer = lv_timer_create(refresh_timer, period, this);
+    m_rate_start = lv_tick_get();
+}
+
+hud::~hud()
+{
+    lv_timer_del(m_timer);
+
+    for (auto &entry : m_fields)
+        lv_obj_del(entry.label);
+}
+
+void hud::add_field(const lv_align_t align, const lv_coord_t x, const lv_coord_t y, const uint32_t interval, version_getter version, formatter format)
+{
+    auto label = lv_label_create(m_parent);
+
+    lv_obj_set_style_text_color(label, lv_color_white(), LV_STATE_DEFAULT);
+    lv_obj_align(label, align, x, y);
+    lv_label_set_text_static(label, "");
+
+    m_fields.emplace_back(field{
+        .label = label,
+        .state = hud_field(interval, lv_tick_get(), std::move(version), std::move(format)),
+    });
+}
+
+void hud::refresh()
+{
+    PROFILE_SCOPE(hud);
+
+    const auto now = lv_tick_get();
+
+    for (auto &entry : m_fields)
+    {
+        const auto text = entry.state.refresh(now);
+
+        if (!text)
+            continue;
+
+        lv_label_set_text(entry.label, text);
+
+        m_label_updates++;
+    }
+
+    if (now - m_rate_start >= RATE_WINDOW)
+    {
+        m_label_rate = (m_label_updates - m_rate_updates) * RATE_WINDOW / (now - m_rate_start);
+        m_rate_updates = m_label_updates;
+        m_rate_start = now;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <lvgl.h>
+
+#include "hud_field.h"
+#include "status_source.h"
+
+// retained labels, each field is refreshed at its own rate and only touches lvgl when
+// its source moved on and the formatted text actually differs.
+class hud
+{
+public:
+    using version_getter = hud_field::version_getter;
+    using formatter = hud_field::formatter;
+
+    hud(lv_obj_t *parent, const uint32_t period);
+    ~hud();
+
+    void add_field(const lv_align_t align, const lv_coord_t x, const lv_coord_t y, const uint32_t interval, version_getter version, formatter format);
+
+    template <typename T, typename format_type>
+    void add_field(const lv_align_t align, const lv_coord_t x, const lv_coord_t y, const uint32_t interval, const status_source<T> &source, format_type &&format)
+    {
+        auto version = [&source]()
+        {
+            return source.version();
+        };
+
+        auto bound = [&source, format](char *text, size_t size)
+        {
+            format(text, size, source.value());
+        };
+
+        add_field(align, x, y, interval, version, bound);
+    }
+
+    void refresh();
+
+    uint32_t label_updates() const { return m_label_updates; }
+    uint32_t label_updates_per_second() const { return m_label_rate; }
+
+private:
+    struct field
+    {
+        lv_obj_t *label;
+        hud_field state;
+    };
+
+    lv_obj_t *m_parent;
+    lv_timer_t *m_timer;
+    std::vector<field> m_fields;
+
+    uint32_t m_label_updates = 0;
+    uint32_t m_label_rate = 0;
+    uint32_t m_rate_updates = 0;
+    uint32_t m_rate_start = 0;
+};
\ No newline at end of file
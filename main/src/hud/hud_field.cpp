@@ -0,0 +1,38 @@
+#include "hud_field.h"
+
+constexpr size_t TEXT_SIZE = 256U;
+
+hud_field::hud_field(const uint32_t interval, const uint32_t now, version_getter version, formatter format) : m_interval(interval),
+                                                                                                            m_last_refresh(now - interval),
+                                                                                                            m_version(std::move(version)),
+                                                                                                            m_format(std::move(format))
+{
+    m_text.reserve(TEXT_SIZE);
+}
+
+const char *hud_field::refresh(const uint32_t now)
+{
+    if (now - m_last_refresh < m_interval)
+        return nullptr;
+
+    m_last_refresh = now;
+
+    const auto version = m_version();
+
+    // version 0 means the source never produced a value yet.
+    if (!version || version == m_rendered_version)
+        return nullptr;
+
+    m_rendered_version = version;
+
+    char text[TEXT_SIZE];
+
+    m_format(text, sizeof(text));
+
+    if (m_text == text)
+        return nullptr;
+
+    m_text = text;
+
+    return m_text.c_str();
+}
\ No newline at end of file
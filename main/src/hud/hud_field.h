@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <functional>
+
+// decides when a hud label needs new text: at most once per interval, only after its source
+// moved on and only when the formatted text differs. it knows nothing about lvgl.
+class hud_field
+{
+public:
+    using version_getter = std::function<uint32_t()>;
+    using formatter = std::function<void(char *text, size_t size)>;
+
+    hud_field(const uint32_t interval, const uint32_t now, version_getter version, formatter format);
+
+    // the text the label has to show now, nullptr when it can stay as it is.
+    const char *refresh(const uint32_t now);
+
+    const std::string &text() const { return m_text; }
+
+private:
+    uint32_t m_interval;
+    uint32_t m_last_refresh;
+    uint32_t m_rendered_version = 0;
+    version_getter m_version;
+    formatter m_format;
+    std::string m_text;
+};
\ No newline at end of file
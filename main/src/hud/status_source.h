@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+// fits the longest of the network fields, a 32 character ssid, and its terminator.
+using status_text = std::array<char, 33>;
+
+inline status_text make_status_text(const char *text)
+{
+    status_text result = {};
+
+    if (text)
+        std::strncpy(result.data(), text, result.size() - 1);
+
+    return result;
+}
+
+// the latest value of something worth showing, set() is cheap to call every tick since
+// readers and subscribers only hear about real changes.
+template <typename T>
+class status_source
+{
+public:
+    using subscriber = std::function<void(const T &)>;
+
+    bool set(const T &value)
+    {
+        if (m_version && value == m_value)
+            return false;
+
+        m_value = value;
+        m_version++;
+
+        for (const auto &notify : m_subscribers)
+            notify(m_value);
+
+        return true;
+    }
+
+    // called on whichever task set() the new value.
+    void subscribe(subscriber callback) { m_subscribers.push_back(std::move(callback)); }
+
+    const T &value() const { return m_value; }
+    uint32_t version() const { return m_version; }
+
+private:
+    T m_value = {};
+    uint32_t m_version = 0;
+    std::vector<subscriber> m_subscribers;
+};
\ No newline at end of file
@@ -1,21 +1,78 @@
 #pragma once
 
+#include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 
+#include "profile/lock_profile.h"
+
+#if CONFIG_RCLINK_LOCK_PROFILER
+#include "profile/profiler.h"
+#endif
+
 template <typename T>
 class lock_guard
 {
 public:
     lock_guard(T &semaphore) : m_semaphore(semaphore)
     {
-        xSemaphoreTake(m_semaphore, portMAX_DELAY);
+        m_owns_lock = xSemaphoreTake(m_semaphore, portMAX_DELAY);
+    }
+
+    // gives up after timeout ticks, callers check owns_lock() and fall back.
+    lock_guard(T &semaphore, const TickType_t timeout) : m_semaphore(semaphore)
+    {
+        m_owns_lock = xSemaphoreTake(m_semaphore, timeout);
+    }
+
+    // the profile only records anything with CONFIG_RCLINK_LOCK_PROFILER.
+    lock_guard(T &semaphore, [[maybe_unused]] lock_profile &profile, const TickType_t timeout = portMAX_DELAY) : m_semaphore(semaphore)
+    {
+#if CONFIG_RCLINK_LOCK_PROFILER
+        const int64_t started_at = profiler::now();
+        const bool contended = !xSemaphoreTake(m_semaphore, 0);
+
+        m_owns_lock = !contended || (timeout && xSemaphoreTake(m_semaphore, timeout));
+
+        if (!m_owns_lock)
+        {
+            profile.timed_out();
+
+            return;
+        }
+
+        mp_profile = &profile;
+        m_acquired_at = profiler::now();
+
+        profile.acquired(static_cast<uint32_t>(m_acquired_at - started_at), contended);
+#else
+        m_owns_lock = xSemaphoreTake(m_semaphore, timeout);
+#endif
     }
 
     ~lock_guard()
     {
+        if (!m_owns_lock)
+            return;
+
+#if CONFIG_RCLINK_LOCK_PROFILER
+        if (mp_profile)
+            mp_profile->released(static_cast<uint32_t>(profiler::now() - m_acquired_at));
+#endif
+
         xSemaphoreGive(m_semaphore);
     }
 
+    lock_guard(const lock_guard &) = delete;
+    lock_guard &operator=(const lock_guard &) = delete;
+
+    bool owns_lock() const { return m_owns_lock; }
+
 private:
     T &m_semaphore;
-};
+    bool m_owns_lock;
+
+#if CONFIG_RCLINK_LOCK_PROFILER
+    lock_profile *mp_profile = nullptr;
+    int64_t m_acquired_at = 0;
+#endif
+};
\ No newline at end of file
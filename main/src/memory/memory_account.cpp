@@ -0,0 +1,160 @@
+#include "memory_account.h"
+
+#include <cstring>
+
+#include <esp_heap_caps.h>
+
+struct account_summary
+{
+    uint32_t current;
+    uint32_t peak;
+    uint32_t allocations;
+    uint32_t failures;
+} __attribute__((packed));
+
+static constinit std::atomic<memory_account *> accounts_head = nullptr;
+
+static uint32_t placement_caps(const memory_placement placement)
+{
+    switch (placement)
+    {
+    case memory_placement::dma:
+        return MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+
+    case memory_placement::psram:
+        return MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+    default:
+        return MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    }
+}
+
+static void *heap_allocate(const size_t size, const memory_placement placement)
+{
+    if (placement == memory_placement::psram)
+        return heap_caps_malloc_prefer(size, 2, placement_caps(placement), placement_caps(memory_placement::internal));
+
+    return heap_caps_malloc(size, placement_caps(placement));
+}
+
+static void *heap_reallocate(void *pointer, const size_t size, const memory_placement placement)
+{
+    if (placement == memory_placement::psram)
+        return heap_caps_realloc_prefer(pointer, size, 2, placement_caps(placement), placement_caps(memory_placement::internal));
+
+    return heap_caps_realloc(pointer, size, placement_caps(placement));
+}
+
+static void heap_free(void *pointer)
+{
+    heap_caps_free(pointer);
+}
+
+memory_account::memory_account(const char *name) : m_name(name)
+{
+    mp_next = accounts_head.load(std::memory_order_relaxed);
+
+    while (!accounts_head.compare_exchange_weak(mp_next, this, std::memory_order_release, std::memory_order_relaxed))
+        ;
+}
+
+void *memory_account::allocate(const size_t size, const memory_placement placement)
+{
+    void *allocated = heap_allocate(size, placement);
+
+    if (!allocated)
+    {
+        m_failures.fetch_add(1, std::memory_order_relaxed);
+
+        return nullptr;
+    }
+
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    booked(size);
+
+    return allocated;
+}
+
+void *memory_account::reallocate(void *pointer, const size_t old_size, const size_t new_size, const memory_placement placement)
+{
+    if (!pointer)
+        return allocate(new_size, placement);
+
+    void *allocated = heap_reallocate(pointer, new_size, placement);
+
+    // the old block is still valid and still booked.
+    if (!allocated)
+    {
+        m_failures.fetch_add(1, std::memory_order_relaxed);
+
+        return nullptr;
+    }
+
+    m_current.fetch_sub(old_size, std::memory_order_relaxed);
+
+    booked(new_size);
+
+    return allocated;
+}
+
+void memory_account::release(void *pointer, const size_t size)
+{
+    if (!pointer)
+        return;
+
+    heap_free(pointer);
+
+    m_current.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void memory_account::track(const size_t size)
+{
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    booked(size);
+}
+
+void memory_account::untrack(const size_t size)
+{
+    m_current.fetch_sub(size, std::memory_order_relaxed);
+}
+
+memory_account::usage memory_account::statistics() const
+{
+    return {
+        .current = m_current.load(std::memory_order_relaxed),
+        .peak = m_peak.load(std::memory_order_relaxed),
+        .allocations = m_allocations.load(std::memory_order_relaxed),
+        .failures = m_failures.load(std::memory_order_relaxed),
+    };
+}
+
+void memory_account::serialize_all(tlvcpp::tlv_tree_node &node)
+{
+    auto &accounts = node.add_child(MEMORY_REPORT_TAG);
+
+    for (const memory_account *current = accounts_head.load(std::memory_order_acquire); current; current = current->mp_next)
+    {
+        const usage statistics = current->statistics();
+        const account_summary summary = {
+            .current = statistics.current,
+            .peak = statistics.peak,
+            .allocations = statistics.allocations,
+            .failures = statistics.failures,
+        };
+
+        auto &account = accounts.add_child(MEMORY_ACCOUNT_TAG, sizeof(summary), reinterpret_cast<const uint8_t *>(&summary));
+
+        account.add_child(MEMORY_NAME_TAG, strlen(current->m_name), reinterpret_cast<const uint8_t *>(current->m_name));
+    }
+}
+
+void memory_account::booked(const size_t size)
+{
+    const uint32_t current = m_current.fetch_add(size, std::memory_order_relaxed) + size;
+    uint32_t peak = m_peak.load(std::memory_order_relaxed);
+
+    while (current > peak && !m_peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+        ;
+}
\ No newline at end of file
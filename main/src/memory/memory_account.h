@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <type_traits>
+
+#include <tlvcpp/tlv_tree.h>
+
+constexpr uint32_t MEMORY_REPORT_TAG = 0x1b;
+constexpr uint32_t MEMORY_ACCOUNT_TAG = 0x1c;
+constexpr uint32_t MEMORY_NAME_TAG = 0x1d;
+
+// where a block should live. psram falls back to internal ram when there is none or it's
+// full, the others never fall back.
+enum class memory_placement : uint8_t
+{
+    internal,
+    dma,
+    psram,
+};
+
+// books every block a subsystem allocates, defined as a static next to its owner and linked
+// into a global list when constructed. callers pass the size back on release, so nothing
+// is stored next to the blocks. on the host they come from the shim's heap regions.
+class memory_account
+{
+public:
+    struct usage
+    {
+        uint32_t current;
+        uint32_t peak;
+        uint32_t allocations;
+        uint32_t failures;
+    };
+
+    memory_account(const char *name);
+
+    memory_account(const memory_account &) = delete;
+    memory_account &operator=(const memory_account &) = delete;
+
+    void *allocate(const size_t size, const memory_placement placement = memory_placement::internal);
+    void *reallocate(void *pointer, const size_t old_size, const size_t new_size, const memory_placement placement = memory_placement::internal);
+    void release(void *pointer, const size_t size);
+
+    // books memory another allocator handed out, like a container tlvcpp has to serialize into.
+    void track(const size_t size);
+    void untrack(const size_t size);
+
+    usage statistics() const;
+
+    // adds a MEMORY_REPORT_TAG child holding every registered account.
+    static void serialize_all(tlvcpp::tlv_tree_node &node);
+
+private:
+    void booked(const size_t size);
+
+    const char *m_name;
+    std::atomic<uint32_t> m_current = 0;
+    std::atomic<uint32_t> m_peak = 0;
+    std::atomic<uint32_t> m_allocations = 0;
+    std::atomic<uint32_t> m_failures = 0;
+    memory_account *mp_next = nullptr;
+};
+
+struct memory_deleter
+{
+    memory_account *account;
+    size_t size;
+
+    void operator()(void *pointer) const { account->release(pointer, size); }
+};
+
+template <typename T>
+using account_ptr = std::unique_ptr<T, memory_deleter>;
+
+// uninitialized storage for count trivial objects (T or T[]), empty when the allocation failed.
+template <typename T>
+account_ptr<T> make_account_ptr(memory_account &account, const size_t count, const memory_placement placement = memory_placement::internal)
+{
+    using element = std::remove_extent_t<T>;
+
+    static_assert(std::is_trivially_default_constructible_v<element> && std::is_trivially_destructible_v<element>);
+
+    const size_t size = sizeof(element) * count;
+
+    return account_ptr<T>(static_cast<element *>(account.allocate(size, placement)), memory_deleter{&account, size});
+}
+
+// lets containers allocate from an account, running out aborts like the default allocator
+// does without exceptions.
+template <typename T>
+class account_allocator
+{
+public:
+    using value_type = T;
+
+    account_allocator(memory_account &account, const memory_placement placement = memory_placement::internal) : mp_account(&account),
+                                                                                                                m_placement(placement)
+    {
+    }
+
+    template <typename U>
+    account_allocator(const account_allocator<U> &other) : mp_account(other.mp_account),
+                                                           m_placement(other.m_placement)
+    {
+    }
+
+    T *allocate(const size_t count)
+    {
+        void *allocated = mp_account->allocate(count * sizeof(T), m_placement);
+
+        if (!allocated)
+            std::abort();
+
+        return static_cast<T *>(allocated);
+    }
+
+    void deallocate(T *pointer, const size_t count) { mp_account->release(pointer, count * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const account_allocator<U> &other) const { return mp_account == other.mp_account && m_placement == other.m_placement; }
+
+private:
+    template <typename U>
+    friend class account_allocator;
+
+    memory_account *mp_account;
+    memory_placement m_placement;
+};
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "metrics.h"
+
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <cinttypes>
+
+// constant initialized, so metrics constructed during static initialization can link in.
+static constinit std::atomic<metric *> metrics_head = nullptr;
+
+static const char *type_name(const metric_type type)
+{
+    switch (type)
+    {
+    case metric_type::counter:
+        return "counter";
+    case metric_type::gauge:
+        return "gauge";
+    default:
+        return "histogram";
+    }
+}
+
+metric_writer::metric_writer(char *buffer, const size_t size, flush_function flush) : mp_buffer(buffer),
+                                                                                     m_size(size),
+                                                                                     m_flush(std::move(flush))
+{
+}
+
+bool metric_writer::print(const char *format, ...)
+{
+    // a line that doesn't fit what's left flushes the buffer and is written again.
+    for (size_t attempt = 0; attempt < 2; attempt++)
+    {
+        va_list arguments;
+
+        va_start(arguments, format);
+        const int length = vsnprintf(mp_buffer + m_length, m_size - m_length, format, arguments);
+        va_end(arguments);
+
+        if (length < 0)
+            return false;
+
+        if (m_length + length < m_size)
+        {
+            m_length += length;
+
+            return true;
+        }
+
+        if (!m_length || !finish())
+            return false;
+    }
+
+    return false;
+}
+
+bool metric_writer::finish()
+{
+    if (!m_length)
+        return true;
+
+    const bool flushed = m_flush(mp_buffer, m_length);
+
+    m_length = 0;
+
+    return flushed;
+}
+
+metric::metric(const metric_type type, const char *name, const char *help, const char *labels) : m_type(type),
+                                                                                              m_name(name),
+                                                                                              m_help(help),
+                                                                                              m_labels(labels)
+{
+    mp_next = metrics_head.load(std::memory_order_relaxed);
+
+    while (!metrics_head.compare_exchange_weak(mp_next, this, std::memory_order_release, std::memory_order_relaxed))
+        ;
+}
+
+bool metric::render_all(metric_writer &writer)
+{
+    const char *previous = nullptr;
+
+    for (const metric *current = metrics_head.load(std::memory_order_acquire); current; current = current->mp_next)
+    {
+        if (!previous || strcmp(previous, current->m_name))
+            if (!writer.print("# HELP %s %s\n", current->m_name, current->m_help) ||
+                !writer.print("# TYPE %s %s\n", current->m_name, type_name(current->m_type)))
+                return false;
+
+        if (!current->render(writer))
+            return false;
+
+        previous = current->m_name;
+    }
+
+    return writer.finish();
+}
+
+bool metric::render_histogram(metric_writer &writer, const uint32_t *bounds, const uint32_t *counts, const size_t count, const uint32_t sum) const
+{
+    const char *separator = m_labels ? "," : "";
+    const char *labels = m_labels ? m_labels : "";
+    uint32_t cumulative = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        cumulative += counts[i];
+
+        if (!writer.print("%s_bucket{%s%sle=\"%" PRIu32 "\"} %" PRIu32 "\n", m_name, labels, separator, bounds[i], cumulative))
+            return false;
+    }
+
+    cumulative += counts[count];
+
+    return writer.print("%s_bucket{%s%sle=\"+Inf\"} %" PRIu32 "\n", m_name, labels, separator, cumulative) &&
+           writer.print("%s_sum%s%s%s %" PRIu32 "\n", m_name, m_labels ? "{" : "", labels, m_labels ? "}" : "", sum) &&
+           writer.print("%s_count%s%s%s %" PRIu32 "\n", m_name, m_labels ? "{" : "", labels, m_labels ? "}" : "", cumulative);
+}
+
+bool metric_counter::render(metric_writer &writer) const
+{
+    return writer.print("%s%s%s%s %" PRIu32 "\n", m_name, m_labels ? "{" : "", m_labels ? m_labels : "", m_labels ? "}" : "", value());
+}
+
+bool metric_gauge::render(metric_writer &writer) const
+{
+    return writer.print("%s%s%s%s %" PRId32 "\n", m_name, m_labels ? "{" : "", m_labels ? m_labels : "", m_labels ? "}" : "", value());
+}
\ No newline at end of file
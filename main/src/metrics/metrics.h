@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+// prometheus style metrics. every metric is a static object that links itself into a
+// global list when constructed, updates are relaxed atomics and nothing allocates after
+// startup. metrics sharing a name (e.g. one per label value) must be defined next to each
+// other so the renderer writes their help and type once.
+enum class metric_type : uint8_t
+{
+    counter,
+    gauge,
+    histogram,
+};
+
+// updates have to stay a single instruction on the esp32, not a libatomic lock.
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free);
+
+class metric_writer
+{
+public:
+    using flush_function = std::function<bool(const char *data, size_t size)>;
+
+    metric_writer(char *buffer, const size_t size, flush_function flush);
+
+    bool print(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    bool finish();
+
+private:
+    char *mp_buffer;
+    const size_t m_size;
+    size_t m_length = 0;
+    flush_function m_flush;
+};
+
+class metric
+{
+public:
+    metric(const metric_type type, const char *name, const char *help, const char *labels);
+    virtual ~metric() = default;
+
+    metric(const metric &) = delete;
+    metric &operator=(const metric &) = delete;
+
+    // writes every registered metric in the text exposition format.
+    static bool render_all(metric_writer &writer);
+
+protected:
+    virtual bool render(metric_writer &writer) const = 0;
+
+    bool render_histogram(metric_writer &writer, const uint32_t *bounds, const uint32_t *counts, const size_t count, const uint32_t sum) const;
+
+    const metric_type m_type;
+    const char *m_name;
+    const char *m_help;
+    const char *m_labels;
+
+private:
+    metric *mp_next = nullptr;
+};
+
+class metric_counter : public metric
+{
+public:
+    metric_counter(const char *name, const char *help, const char *labels = nullptr) : metric(metric_type::counter, name, help, labels) {}
+
+    void add(const uint32_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    uint32_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+protected:
+    bool render(metric_writer &writer) const override;
+
+private:
+    std::atomic<uint32_t> m_value = 0;
+};
+
+class metric_gauge : public metric
+{
+public:
+    metric_gauge(const char *name, const char *help, const char *labels = nullptr) : metric(metric_type::gauge, name, help, labels) {}
+
+    void set(const int32_t value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(const int32_t amount) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+    int32_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+protected:
+    bool render(metric_writer &writer) const override;
+
+private:
+    std::atomic<int32_t> m_value = 0;
+};
+
+// fixed upper bounds in ascending order, observations above the last one only land in +Inf.
+template <size_t bucket_count>
+class metric_histogram : public metric
+{
+public:
+    metric_histogram(const char *name, const char *help, const std::array<uint32_t, bucket_count> &bounds, const char *labels = nullptr)
+        : metric(metric_type::histogram, name, help, labels), m_bounds(bounds)
+    {
+    }
+
+    void observe(const uint32_t value)
+    {
+        size_t index = 0;
+
+        while (index < bucket_count && value > m_bounds[index])
+            index++;
+
+        m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+protected:
+    bool render(metric_writer &writer) const override
+    {
+        uint32_t counts[bucket_count + 1];
+
+        for (size_t i = 0; i <= bucket_count; i++)
+            counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+
+        return render_histogram(writer, m_bounds.data(), counts, bucket_count, m_sum.load(std::memory_order_relaxed));
+    }
+
+private:
+    const std::array<uint32_t, bucket_count> m_bounds;
+    std::array<std::atomic<uint32_t>, bucket_count + 1> m_buckets = {};
+    // 64 bit atomics aren't lock free on the esp32, the sum wraps like a counter reset instead.
+    std::atomic<uint32_t> m_sum = 0;
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <memory>
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+
+#include "memory/memory_account.h"
+
+struct pool_statistics
+{
+    size_t in_use;
+    size_t allocated;
+    size_t high_water;
+    size_t capacity;
+
+    bool operator==(const pool_statistics &) const = default;
+};
+
+// fixed capacity pool that grows in chunks, released objects are kept as they are so
+// expensive state (e.g. an lvgl widget) can be recycled by the next acquire. the chunks
+// and the bookkeeping are allocated from the owner's account.
+template <typename T>
+class object_pool
+{
+public:
+    object_pool(const size_t capacity, const size_t chunk_size, memory_account &account) : m_account(account),
+                                                                                            m_chunk_size(chunk_size),
+                                                                                            m_chunks(account_allocator<chunk>(account)),
+                                                                                            m_free(account_allocator<T *>(account)),
+                                                                                            m_statistics{0, 0, 0, capacity}
+    {
+        m_chunks.reserve((capacity + chunk_size - 1) / chunk_size);
+        m_free.reserve(capacity);
+    }
+
+    ~object_pool()
+    {
+        for (auto &chunk : m_chunks)
+        {
+            std::destroy_n(chunk.objects, chunk.size);
+
+            m_account.release(chunk.objects, chunk.size * sizeof(T));
+        }
+    }
+
+    object_pool(const object_pool &) = delete;
+    object_pool &operator=(const object_pool &) = delete;
+
+    T *acquire()
+    {
+        if (!m_free.size() && !grow())
+            return nullptr;
+
+        auto object = m_free.back();
+
+        m_free.pop_back();
+
+        if (++m_statistics.in_use > m_statistics.high_water)
+            m_statistics.high_water = m_statistics.in_use;
+
+        return object;
+    }
+
+    void release(T *object)
+    {
+        m_free.push_back(object);
+
+        m_statistics.in_use--;
+    }
+
+    template <typename callback_type>
+    void for_each(callback_type &&callback)
+    {
+        for (auto &chunk : m_chunks)
+            for (size_t i = 0; i < chunk.size; i++)
+                callback(chunk.objects[i]);
+    }
+
+    const pool_statistics &statistics() const { return m_statistics; }
+
+private:
+    struct chunk
+    {
+        T *objects;
+        size_t size;
+    };
+
+    bool grow()
+    {
+        const size_t size = std::min(m_chunk_size, m_statistics.capacity - m_statistics.allocated);
+
+        if (!size)
+            return false;
+
+        const auto objects = static_cast<T *>(m_account.allocate(size * sizeof(T)));
+
+        if (!objects)
+            return false;
+
+        // value initialized like new T[size](), a recycled widget handle starts out null.
+        std::uninitialized_value_construct_n(objects, size);
+
+        auto &added = m_chunks.emplace_back(chunk{objects, size});
+
+        // pushed in reverse so objects are handed out in address order.
+        for (size_t i = size; i > 0; i--)
+            m_free.push_back(&added.objects[i - 1]);
+
+        m_statistics.allocated += size;
+
+        return true;
+    }
+
+    memory_account &m_account;
+    const size_t m_chunk_size;
+    std::vector<chunk, account_allocator<chunk>> m_chunks;
+    std::vector<T *, account_allocator<T *>> m_free;
+    pool_statistics m_statistics;
+};
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// structure of arrays, keeps each component contiguous for the integration kernels.
+class ball_storage
+{
+public:
+    size_t size() const { return m_x.size(); }
+
+    void reserve(const size_t capacity)
+    {
+        m_x.reserve(capacity);
+        m_y.reserve(capacity);
+        m_vx.reserve(capacity);
+        m_vy.reserve(capacity);
+    }
+
+    size_t push_back(const float x, const float y, const float vx, const float vy)
+    {
+        m_x.push_back(x);
+        m_y.push_back(y);
+        m_vx.push_back(vx);
+        m_vy.push_back(vy);
+
+        return m_x.size() - 1;
+    }
+
+    void pop_back()
+    {
+        m_x.pop_back();
+        m_y.pop_back();
+        m_vx.pop_back();
+        m_vy.pop_back();
+    }
+
+    float *x() { return m_x.data(); }
+    float *y() { return m_y.data(); }
+    float *vx() { return m_vx.data(); }
+    float *vy() { return m_vy.data(); }
+
+    const float *x() const { return m_x.data(); }
+    const float *y() const { return m_y.data(); }
+    const float *vx() const { return m_vx.data(); }
+    const float *vy() const { return m_vy.data(); }
+
+private:
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_vx;
+    std::vector<float> m_vy;
+};
\ No newline at end of file
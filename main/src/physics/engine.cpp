@@ -0,0 +1,60 @@
+#include "engine.h"
+
+constexpr int32_t MIN_SPEED = 50;
+constexpr int32_t MAX_SPEED = 150;
+
+engine::engine(const float width, const float height, const float timestep, const uint64_t seed) : m_width(width),
+                                                                                                   m_height(height),
+                                                                                                   m_timestep(timestep),
+                                                                                                   m_world(width, height),
+                                                                                                   m_random(seed)
+{
+}
+
+void engine::reserve(const size_t capacity)
+{
+    m_world.reserve(capacity);
+}
+
+void engine::spawn_ball()
+{
+    float vx = m_random.range(MIN_SPEED, MAX_SPEED);
+    float vy = m_random.range(MIN_SPEED, MAX_SPEED);
+
+    if (m_random.range(0, 1))
+        vx = -vx;
+
+    if (m_random.range(0, 1))
+        vy = -vy;
+
+    m_world.add_ball(m_width / 2, m_height / 2, vx, vy);
+}
+
+void engine::remove_ball()
+{
+    m_world.remove_ball();
+}
+
+void engine::step(const uint32_t steps)
+{
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        m_counters.last_contacts = m_world.step(m_timestep);
+        m_counters.contacts += m_counters.last_contacts;
+        m_counters.steps++;
+    }
+}
+
+float engine::kinetic_energy() const
+{
+    const auto &balls = m_world.balls();
+    const auto vx = balls.vx();
+    const auto vy = balls.vy();
+
+    float energy = 0.0f;
+
+    for (size_t i = 0; i < balls.size(); i++)
+        energy += vx[i] * vx[i] + vy[i] * vy[i];
+
+    return energy / 2;
+}
\ No newline at end of file
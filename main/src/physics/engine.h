@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include "world.h"
+#include "random_generator.h"
+
+// the ui free simulation, every input goes through this api so the same seed and the
+// same calls always produce the same trajectory. the sources are built without floating
+// point contraction so the device and a host round alike, see main/CMakeLists.txt.
+class engine
+{
+public:
+    struct counters
+    {
+        uint64_t steps;
+        uint64_t contacts;
+        uint32_t last_contacts;
+    };
+
+    engine(const float width, const float height, const float timestep, const uint64_t seed);
+
+    size_t size() const { return m_world.size(); }
+    float timestep() const { return m_timestep; }
+    const ball_storage &balls() const { return m_world.balls(); }
+    const counters &statistics() const { return m_counters; }
+
+    void reserve(const size_t capacity);
+    void spawn_ball();
+    void remove_ball();
+    void step(const uint32_t steps = 1);
+    float kinetic_energy() const;
+
+private:
+    const float m_width;
+    const float m_height;
+    const float m_timestep;
+
+    world m_world;
+    random_generator m_random;
+    counters m_counters = {};
+};
\ No newline at end of file
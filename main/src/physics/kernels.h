@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+// loops are kept free of branches and aliasing so the compiler can vectorize them.
+
+inline void reflect(const float *__restrict position, float *__restrict velocity, const size_t count, const float min, const float max)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const float p = position[i];
+        const float v = velocity[i];
+        const bool flip = ((p < min) & (v < 0.0f)) | ((p > max) & (v > 0.0f));
+
+        velocity[i] = flip ? -v : v;
+    }
+}
+
+inline void integrate(float *__restrict position, const float *__restrict velocity, const size_t count, const float timestep)
+{
+    for (size_t i = 0; i < count; i++)
+        position[i] += velocity[i] * timestep;
+}
\ No newline at end of file
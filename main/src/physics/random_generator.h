@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+// pcg32, small and bit exact on every platform so a seed always replays the same run.
+class random_generator
+{
+public:
+    random_generator(const uint64_t seed)
+    {
+        next();
+        m_state += seed;
+        next();
+    }
+
+    uint32_t next()
+    {
+        const uint64_t state = m_state;
+
+        m_state = state * 6364136223846793005ULL + INCREMENT;
+
+        const uint32_t shifted = ((state >> 18U) ^ state) >> 27U;
+        const uint32_t rotation = state >> 59U;
+
+        return (shifted >> rotation) | (shifted << ((-rotation) & 31U));
+    }
+
+    // inclusive on both ends, like lv_rand.
+    int32_t range(const int32_t min, const int32_t max)
+    {
+        return min + static_cast<int32_t>(next() % static_cast<uint32_t>(max - min + 1));
+    }
+
+private:
+    static constexpr uint64_t INCREMENT = 1442695040888963407ULL;
+
+    uint64_t m_state = 0;
+};
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "simulation.h"
+
+#include <algorithm>
+
+#include <esp_log.h>
+
+#include "profile/profiler.h"
+#include "task_config.h"
+
+constexpr const char *TAG = "simulation";
+constexpr const int64_t STEP_INTERVAL = 1000000LL / CONFIG_RCLINK_PHYSICS_RATE;
+constexpr const float STEP = 1.0f / CONFIG_RCLINK_PHYSICS_RATE;
+constexpr const uint32_t MAX_CATCH_UP_STEPS = 4U;
+constexpr const UBaseType_t COMMAND_QUEUE_LENGTH = 16U;
+
+simulation::simulation(const float width, const float height, const size_t capacity) : m_engine(width, height, STEP, CONFIG_RCLINK_PHYSICS_SEED),
+                                                                                       m_commands(xQueueCreate(COMMAND_QUEUE_LENGTH, sizeof(command)))
+{
+    // sized up front so adding balls never reallocates while the simulation is running.
+    m_engine.reserve(capacity);
+    m_snapshots.reserve(capacity);
+
+    xTaskCreatePinnedToCore(simulation_task, "physics_worker", PHYSICS_TASK.stack_size, this, PHYSICS_TASK.priority, &m_task, PHYSICS_TASK.core);
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = [](void *argument)
+        {
+            xTaskNotifyGive(static_cast<simulation *>(argument)->m_task);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "physics_step",
+        .skip_unhandled_events = true,
+    };
+
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &m_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(m_timer, STEP_INTERVAL));
+}
+
+simulation::~simulation()
+{
+    esp_timer_stop(m_timer);
+    esp_timer_delete(m_timer);
+
+    vTaskDelete(m_task);
+    vQueueDelete(m_commands);
+}
+
+bool simulation::add_ball()
+{
+    const command add = {
+        .type = command::ADD_BALL,
+    };
+
+    if (!xQueueSend(m_commands, &add, 0))
+    {
+        ESP_LOGW(TAG, "command queue full!");
+
+        return false;
+    }
+
+    return true;
+}
+
+bool simulation::remove_ball()
+{
+    const command remove = {
+        .type = command::REMOVE_BALL,
+    };
+
+    if (!xQueueSend(m_commands, &remove, 0))
+    {
+        ESP_LOGW(TAG, "command queue full!");
+
+        return false;
+    }
+
+    return true;
+}
+
+int64_t simulation::step_interval() const
+{
+    return STEP_INTERVAL;
+}
+
+void simulation::simulation_task(void *argument)
+{
+    auto &sim = *static_cast<simulation *>(argument);
+
+    while (true)
+    {
+        const uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (!pending)
+            continue;
+
+        sim.apply_commands();
+        sim.publish(std::min(pending, MAX_CATCH_UP_STEPS));
+    }
+}
+
+void simulation::apply_commands()
+{
+    command received;
+
+    while (xQueueReceive(m_commands, &received, 0))
+        if (received.type == command::ADD_BALL)
+            m_engine.spawn_ball();
+        else
+            m_engine.remove_ball();
+}
+
+void simulation::publish(const uint32_t steps)
+{
+    PROFILE_SCOPE(physics);
+
+    auto &back = m_snapshots.back();
+    const auto &balls = m_engine.balls();
+
+    if (steps > 1)
+        m_engine.step(steps - 1);
+
+    back.previous_x.assign(balls.x(), balls.x() + balls.size());
+    back.previous_y.assign(balls.y(), balls.y() + balls.size());
+
+    m_engine.step();
+
+    back.x.assign(balls.x(), balls.x() + balls.size());
+    back.y.assign(balls.y(), balls.y() + balls.size());
+    back.count = balls.size();
+    back.steps = m_engine.statistics().steps;
+    back.contacts = m_engine.statistics().last_contacts;
+    back.timestamp = esp_timer_get_time();
+
+    m_snapshots.publish();
+}
\ No newline at end of file
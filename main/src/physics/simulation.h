@@ -0,0 +1,46 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+#include "engine.h"
+#include "snapshot_buffer.h"
+
+// runs the world at a fixed rate on its own task, the ui only talks to it through
+// the command queue and reads back published snapshots.
+class simulation
+{
+public:
+    simulation(const float width, const float height, const size_t capacity);
+    ~simulation();
+
+    // false when the command queue is full, the simulation then keeps the balls it has.
+    bool add_ball();
+    bool remove_ball();
+
+    const snapshot &latest() { return m_snapshots.front(); }
+    int64_t step_interval() const;
+
+private:
+    struct command
+    {
+        enum type : uint8_t
+        {
+            ADD_BALL,
+            REMOVE_BALL,
+        } type;
+    };
+
+    static void simulation_task(void *argument);
+
+    void apply_commands();
+    void publish(const uint32_t steps);
+
+    engine m_engine;
+    snapshot_buffer m_snapshots;
+    QueueHandle_t m_commands;
+    TaskHandle_t m_task;
+    esp_timer_handle_t m_timer;
+};
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+struct snapshot
+{
+    int64_t timestamp = 0;
+    size_t count = 0;
+    uint64_t steps = 0;
+    uint32_t contacts = 0;
+    std::vector<float> previous_x;
+    std::vector<float> previous_y;
+    std::vector<float> x;
+    std::vector<float> y;
+};
+
+// triple buffered so neither the simulation nor the renderer ever waits, the renderer
+// always picks up the latest published snapshot and the simulation always has one to fill.
+class snapshot_buffer
+{
+public:
+    void reserve(const size_t capacity)
+    {
+        for (auto &buffered : m_snapshots)
+        {
+            buffered.previous_x.reserve(capacity);
+            buffered.previous_y.reserve(capacity);
+            buffered.x.reserve(capacity);
+            buffered.y.reserve(capacity);
+        }
+    }
+
+    snapshot &back() { return m_snapshots[m_back]; }
+
+    void publish()
+    {
+        m_back = m_middle.exchange(m_back | FRESH) & INDEX;
+    }
+
+    const snapshot &front()
+    {
+        if (m_middle.load() & FRESH)
+            m_front = m_middle.exchange(m_front) & INDEX;
+
+        return m_snapshots[m_front];
+    }
+
+private:
+    static constexpr uint8_t INDEX = 0x03;
+    static constexpr uint8_t FRESH = 0x04;
+
+    snapshot m_snapshots[3];
+    uint8_t m_back = 0;
+    std::atomic<uint8_t> m_middle = 1;
+    uint8_t m_front = 2;
+};
\ No newline at end of file
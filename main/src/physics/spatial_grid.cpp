@@ -0,0 +1,86 @@
+#include "spatial_grid.h"
+
+#include <cmath>
+#include <algorithm>
+
+spatial_grid::spatial_grid(const float width, const float height, const float cell_size) : m_inverse_cell_size(1.0f / cell_size),
+                                                                                           m_columns(std::max(1.0f, std::ceil(width / cell_size))),
+                                                                                           m_rows(std::max(1.0f, std::ceil(height / cell_size))),
+                                                                                           m_heads(m_columns * m_rows, NONE)
+{
+}
+
+void spatial_grid::insert(const size_t index, const float x, const float y)
+{
+    if (m_nodes.size() <= index)
+        m_nodes.resize(index + 1, {NONE, NONE, UINT32_MAX});
+
+    link(index, cell_of(x, y));
+}
+
+void spatial_grid::update(const size_t index, const float x, const float y)
+{
+    const uint32_t cell = cell_of(x, y);
+
+    if (m_nodes[index].cell == cell)
+        return;
+
+    unlink(index);
+    link(index, cell);
+}
+
+void spatial_grid::remove(const size_t index)
+{
+    unlink(index);
+
+    while (m_nodes.size() && m_nodes.back().cell == UINT32_MAX)
+        m_nodes.pop_back();
+}
+
+void spatial_grid::clear()
+{
+    std::fill(m_heads.begin(), m_heads.end(), NONE);
+
+    m_nodes.clear();
+}
+
+uint32_t spatial_grid::cell_of(const float x, const float y) const
+{
+    const auto column = std::clamp(static_cast<int32_t>(x * m_inverse_cell_size), 0, static_cast<int32_t>(m_columns) - 1);
+    const auto row = std::clamp(static_cast<int32_t>(y * m_inverse_cell_size), 0, static_cast<int32_t>(m_rows) - 1);
+
+    return row * m_columns + column;
+}
+
+void spatial_grid::link(const size_t index, const uint32_t cell)
+{
+    auto &node = m_nodes[index];
+    auto &head = m_heads[cell];
+
+    node.previous = NONE;
+    node.next = head;
+    node.cell = cell;
+
+    if (head != NONE)
+        m_nodes[head].previous = index;
+
+    head = index;
+}
+
+void spatial_grid::unlink(const size_t index)
+{
+    auto &node = m_nodes[index];
+
+    if (node.cell == UINT32_MAX)
+        return;
+
+    if (node.previous != NONE)
+        m_nodes[node.previous].next = node.next;
+    else
+        m_heads[node.cell] = node.next;
+
+    if (node.next != NONE)
+        m_nodes[node.next].previous = node.previous;
+
+    node = {NONE, NONE, UINT32_MAX};
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// uniform grid broad phase, cells are as large as the objects so only the
+// eight neighbouring cells can hold overlapping candidates.
+class spatial_grid
+{
+public:
+    spatial_grid(const float width, const float height, const float cell_size);
+
+    void reserve(const size_t capacity) { m_nodes.reserve(capacity); }
+    void insert(const size_t index, const float x, const float y);
+    void update(const size_t index, const float x, const float y);
+    void remove(const size_t index);
+    void clear();
+
+    template <typename callback_type>
+    void for_each_pair(callback_type &&callback) const
+    {
+        for (size_t row = 0; row < m_rows; row++)
+            for (size_t column = 0; column < m_columns; column++)
+                for (int32_t first = m_heads[row * m_columns + column]; first != NONE; first = m_nodes[first].next)
+                {
+                    for (int32_t second = m_nodes[first].next; second != NONE; second = m_nodes[second].next)
+                        callback(first, second);
+
+                    for (const auto &offset : NEIGHBOURS)
+                    {
+                        const size_t neighbour_column = column + offset.column;
+                        const size_t neighbour_row = row + offset.row;
+
+                        if (neighbour_column >= m_columns || neighbour_row >= m_rows)
+                            continue;
+
+                        for (int32_t second = m_heads[neighbour_row * m_columns + neighbour_column]; second != NONE; second = m_nodes[second].next)
+                            callback(first, second);
+                    }
+                }
+    }
+
+private:
+    static constexpr int32_t NONE = -1;
+
+    struct node
+    {
+        int32_t previous;
+        int32_t next;
+        uint32_t cell;
+    };
+
+    struct neighbour
+    {
+        int8_t column;
+        int8_t row;
+    };
+
+    // half of the neighbourhood, the other half visits this cell from its side.
+    static constexpr neighbour NEIGHBOURS[] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    uint32_t cell_of(const float x, const float y) const;
+    void link(const size_t index, const uint32_t cell);
+    void unlink(const size_t index);
+
+    const float m_inverse_cell_size;
+    const size_t m_columns;
+    const size_t m_rows;
+    std::vector<int32_t> m_heads;
+    std::vector<node> m_nodes;
+};
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "world.h"
+
+#include <cmath>
+
+#include "kernels.h"
+#include "profile/profiler.h"
+
+world::world(const float width, const float height) : m_width(width),
+                                                      m_height(height),
+                                                      m_grid(width, height, 2 * BALL_RADIUS)
+{
+}
+
+void world::reserve(const size_t capacity)
+{
+    m_balls.reserve(capacity);
+    m_grid.reserve(capacity);
+}
+
+void world::add_ball(const float x, const float y, const float vx, const float vy)
+{
+    m_grid.insert(m_balls.push_back(x, y, vx, vy), x, y);
+}
+
+void world::remove_ball()
+{
+    if (!m_balls.size())
+        return;
+
+    m_balls.pop_back();
+    m_grid.remove(m_balls.size());
+}
+
+uint32_t world::step(const float timestep)
+{
+    const auto count = m_balls.size();
+    const auto x = m_balls.x();
+    const auto y = m_balls.y();
+
+    reflect(x, m_balls.vx(), count, BALL_RADIUS, m_width - BALL_RADIUS);
+    reflect(y, m_balls.vy(), count, BALL_RADIUS, m_height - BALL_RADIUS);
+
+    uint32_t contacts = 0;
+
+    auto collide = [this, x, y, &contacts](const size_t first, const size_t second)
+    {
+        const auto dx = x[second] - x[first];
+        const auto dy = y[second] - y[first];
+
+        if ((dx * dx + dy * dy) < (4 * BALL_RADIUS * BALL_RADIUS))
+        {
+            resolve_collision(first, second);
+
+            contacts++;
+        }
+    };
+
+    {
+        PROFILE_SCOPE(collisions);
+
+        m_grid.for_each_pair(collide);
+    }
+
+    integrate(x, m_balls.vx(), count, timestep);
+    integrate(y, m_balls.vy(), count, timestep);
+
+    for (size_t i = 0; i < count; i++)
+        m_grid.update(i, x[i], y[i]);
+
+    return contacts;
+}
+
+void world::resolve_collision(const size_t first, const size_t second)
+{
+    const auto x = m_balls.x();
+    const auto y = m_balls.y();
+    const auto vx = m_balls.vx();
+    const auto vy = m_balls.vy();
+
+    const float dx = x[second] - x[first];
+    const float dy = y[second] - y[first];
+    const float distance = std::sqrt(dx * dx + dy * dy);
+
+    // exactly on top of each other, e.g. two balls spawned in the same step, there is
+    // no normal to push along and dividing by zero would poison the whole world.
+    if (distance == 0.0f)
+        return;
+
+    const float penetration_depth = (BALL_RADIUS + BALL_RADIUS) - distance;
+    const float normal_x = dx / distance;
+    const float normal_y = dy / distance;
+    const float resolution_distance = penetration_depth / 2;
+
+    x[first] -= normal_x * resolution_distance;
+    y[first] -= normal_y * resolution_distance;
+    x[second] += normal_x * resolution_distance;
+    y[second] += normal_y * resolution_distance;
+
+    const float relative_vx = vx[second] - vx[first];
+    const float relative_vy = vy[second] - vy[first];
+    const float v_along_normal = relative_vx * normal_x + relative_vy * normal_y;
+
+    if (v_along_normal > 0)
+        return;
+
+    const float j = -(1 + 0.99f) * v_along_normal / 2;
+    const float impulse_x = j * normal_x;
+    const float impulse_y = j * normal_y;
+
+    vx[first] -= impulse_x;
+    vy[first] -= impulse_y;
+    vx[second] += impulse_x;
+    vy[second] += impulse_y;
+}
\ No newline at end of file
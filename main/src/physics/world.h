@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ball_storage.h"
+#include "spatial_grid.h"
+
+class world
+{
+public:
+    static constexpr float BALL_RADIUS = 15.0f;
+
+    world(const float width, const float height);
+
+    size_t size() const { return m_balls.size(); }
+    const ball_storage &balls() const { return m_balls; }
+
+    void reserve(const size_t capacity);
+    void add_ball(const float x, const float y, const float vx, const float vy);
+    void remove_ball();
+    uint32_t step(const float timestep);
+
+private:
+    void resolve_collision(const size_t first, const size_t second);
+
+    const float m_width;
+    const float m_height;
+
+    ball_storage m_balls;
+    spatial_grid m_grid;
+};
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "display_probes.h"
+
+#include "profiler.h"
+
+#if CONFIG_RCLINK_PROFILER
+static lv_timer_cb_t refresh_callback = nullptr;
+static void (*flush_callback)(lv_disp_drv_t *, const lv_area_t *, lv_color_t *) = nullptr;
+
+static void profiled_refresh(lv_timer_t *timer)
+{
+    PROFILE_SCOPE(render);
+
+    refresh_callback(timer);
+}
+
+static void profiled_flush(lv_disp_drv_t *driver, const lv_area_t *area, lv_color_t *pixels)
+{
+    PROFILE_SCOPE(flush);
+
+    flush_callback(driver, area, pixels);
+}
+#endif
+
+void profile_display(lv_disp_t *display)
+{
+#if CONFIG_RCLINK_PROFILER
+    if (!display || refresh_callback)
+        return;
+
+    refresh_callback = display->refr_timer->timer_cb;
+    display->refr_timer->timer_cb = profiled_refresh;
+
+    flush_callback = display->driver->flush_cb;
+    display->driver->flush_cb = profiled_flush;
+#else
+    (void)display;
+#endif
+}
\ No newline at end of file
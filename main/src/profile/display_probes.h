@@ -0,0 +1,7 @@
+#pragma once
+
+#include <lvgl.h>
+
+// times lvgl's refresh and the driver's flush by wrapping their callbacks, a no-op when
+// the profiler is disabled.
+void profile_display(lv_disp_t *display);
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// log-linear histogram of durations in microseconds, four buckets per power of two so
+// any percentile is off by at most 12.5%. it rolls over two windows of WINDOW samples,
+// percentiles always cover the previous and the current window.
+class histogram
+{
+public:
+    static constexpr size_t SUB_BUCKETS = 4U;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS * 24U;
+    static constexpr uint32_t WINDOW = 128U;
+
+    static size_t bucket_of(const uint32_t value)
+    {
+        if (value < SUB_BUCKETS)
+            return value;
+
+        const size_t exponent = 31U - __builtin_clz(value);
+        const size_t bucket = SUB_BUCKETS * (exponent - 1U) + ((value >> (exponent - 2U)) & (SUB_BUCKETS - 1U));
+
+        return bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1U;
+    }
+
+    static uint32_t lower_bound(const size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+            return bucket;
+
+        const size_t exponent = bucket / SUB_BUCKETS + 1U;
+
+        return (SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - 2U);
+    }
+
+    void record(const uint32_t value)
+    {
+        if (m_current_count == WINDOW)
+        {
+            std::memcpy(m_previous, m_current, sizeof(m_current));
+            std::memset(m_current, 0, sizeof(m_current));
+
+            m_previous_count = m_current_count;
+            m_current_count = 0;
+            m_previous_max = m_current_max;
+            m_current_max = 0;
+        }
+
+        m_current[bucket_of(value)]++;
+        m_current_count++;
+        m_total++;
+
+        if (value > m_current_max)
+            m_current_max = value;
+    }
+
+    uint32_t percentile(const uint32_t percent) const
+    {
+        const uint32_t samples = count();
+
+        if (!samples)
+            return 0;
+
+        const uint32_t rank = (samples * percent + 99U) / 100U;
+        uint32_t seen = 0;
+
+        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            seen += bucket(i);
+
+            // middle of the bucket, halves the worst case error.
+            if (seen >= rank && seen)
+                return i + 1U < BUCKET_COUNT ? (lower_bound(i) + lower_bound(i + 1U)) / 2U : lower_bound(i);
+        }
+
+        return max();
+    }
+
+    uint32_t bucket(const size_t index) const { return m_previous[index] + m_current[index]; }
+    uint32_t count() const { return m_previous_count + m_current_count; }
+    uint32_t max() const { return m_previous_max > m_current_max ? m_previous_max : m_current_max; }
+    uint64_t total() const { return m_total; }
+
+private:
+    uint16_t m_previous[BUCKET_COUNT] = {};
+    uint16_t m_current[BUCKET_COUNT] = {};
+    uint32_t m_previous_count = 0;
+    uint32_t m_current_count = 0;
+    uint32_t m_previous_max = 0;
+    uint32_t m_current_max = 0;
+    uint64_t m_total = 0;
+};
\ No newline at end of file
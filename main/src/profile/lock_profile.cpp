@@ -0,0 +1,86 @@
+#include "lock_profile.h"
+
+#if CONFIG_RCLINK_LOCK_PROFILER
+#include <cstring>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+struct lock_summary
+{
+    uint32_t acquisitions;
+    uint32_t contended;
+    uint32_t timeouts;
+    uint32_t wait_p50;
+    uint32_t wait_p99;
+    uint32_t wait_max;
+    uint32_t hold_p50;
+    uint32_t hold_p99;
+    uint32_t hold_max;
+    uint32_t worst_wait;
+} __attribute__((packed));
+
+static constinit std::atomic<lock_profile *> profiles_head = nullptr;
+
+lock_profile::lock_profile(const char *name) : m_name(name)
+{
+    mp_next = profiles_head.load(std::memory_order_relaxed);
+
+    while (!profiles_head.compare_exchange_weak(mp_next, this, std::memory_order_release, std::memory_order_relaxed))
+        ;
+}
+
+void lock_profile::acquired(const uint32_t wait, const bool contended)
+{
+    m_acquisitions++;
+    m_wait.record(wait);
+
+    if (!contended)
+        return;
+
+    m_contended++;
+
+    if (wait > m_worst_wait)
+    {
+        m_worst_wait = wait;
+
+        strncpy(m_worst_task, pcTaskGetName(nullptr), sizeof(m_worst_task) - 1U);
+    }
+}
+
+void lock_profile::released(const uint32_t hold)
+{
+    m_hold.record(hold);
+}
+
+void lock_profile::serialize_all(tlvcpp::tlv_tree_node &node)
+{
+    auto &locks = node.add_child(LOCK_PROFILE_TAG);
+
+    for (const lock_profile *current = profiles_head.load(std::memory_order_acquire); current; current = current->mp_next)
+        current->serialize(locks);
+}
+
+void lock_profile::serialize(tlvcpp::tlv_tree_node &node) const
+{
+    const lock_summary summary = {
+        .acquisitions = m_acquisitions,
+        .contended = m_contended,
+        .timeouts = m_timeouts.load(std::memory_order_relaxed),
+        .wait_p50 = m_wait.percentile(50),
+        .wait_p99 = m_wait.percentile(99),
+        .wait_max = m_wait.max(),
+        .hold_p50 = m_hold.percentile(50),
+        .hold_p99 = m_hold.percentile(99),
+        .hold_max = m_hold.max(),
+        .worst_wait = m_worst_wait,
+    };
+
+    auto &lock = node.add_child(LOCK_TAG, sizeof(summary), reinterpret_cast<const uint8_t *>(&summary));
+
+    lock.add_child(LOCK_NAME_TAG, strlen(m_name), reinterpret_cast<const uint8_t *>(m_name));
+
+    if (*m_worst_task)
+        lock.add_child(LOCK_TASK_TAG, strnlen(m_worst_task, sizeof(m_worst_task)), reinterpret_cast<const uint8_t *>(m_worst_task));
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <sdkconfig.h>
+#include <tlvcpp/tlv_tree.h>
+
+#include "histogram.h"
+
+constexpr uint32_t LOCK_PROFILE_TAG = 0x13;
+constexpr uint32_t LOCK_TAG = 0x14;
+constexpr uint32_t LOCK_NAME_TAG = 0x15;
+constexpr uint32_t LOCK_TASK_TAG = 0x16;
+
+#if CONFIG_RCLINK_LOCK_PROFILER
+// statistics of one lock, defined as a static next to the semaphore it describes. apart
+// from timeouts everything is recorded by the task holding the lock, so the lock itself
+// serializes the updates, readers may see a little tearing.
+class lock_profile
+{
+public:
+    static constexpr size_t TASK_NAME_SIZE = 16U;
+
+    lock_profile(const char *name);
+
+    lock_profile(const lock_profile &) = delete;
+    lock_profile &operator=(const lock_profile &) = delete;
+
+    void acquired(const uint32_t wait, const bool contended);
+    void released(const uint32_t hold);
+    void timed_out() { m_timeouts.fetch_add(1, std::memory_order_relaxed); }
+
+    // adds a LOCK_PROFILE_TAG child holding every registered lock.
+    static void serialize_all(tlvcpp::tlv_tree_node &node);
+
+private:
+    void serialize(tlvcpp::tlv_tree_node &node) const;
+
+    const char *m_name;
+    uint32_t m_acquisitions = 0;
+    uint32_t m_contended = 0;
+    std::atomic<uint32_t> m_timeouts = 0;
+    uint32_t m_worst_wait = 0;
+    char m_worst_task[TASK_NAME_SIZE] = {};
+    histogram m_wait;
+    histogram m_hold;
+    lock_profile *mp_next = nullptr;
+};
+#else
+class lock_profile
+{
+public:
+    constexpr lock_profile(const char *) {}
+
+    static void serialize_all(tlvcpp::tlv_tree_node &) {}
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "profiler.h"
+
+#ifdef ESP_PLATFORM
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+struct section_summary
+{
+    uint8_t section;
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+} __attribute__((packed));
+
+profiler &profiler::get()
+{
+    static profiler instance;
+
+    return instance;
+}
+
+int64_t profiler::now()
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const char *profiler::name(const profile_section section)
+{
+    static constexpr const char *names[] = {
+        "frame",
+        "update",
+        "physics",
+        "collide",
+        "render",
+        "flush",
+        "hud",
+        "lua",
+        "gc",
+    };
+
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(profile_section::count));
+
+    return names[static_cast<size_t>(section)];
+}
+
+void profiler::record(const profile_section section, const uint32_t duration)
+{
+    m_sections[static_cast<size_t>(section)].record(duration);
+}
+
+void profiler::frame()
+{
+    const auto time = now();
+
+    if (m_last_frame)
+        record(profile_section::frame, time - m_last_frame);
+
+    m_last_frame = time;
+}
+
+float profiler::fps() const
+{
+    const auto interval = section(profile_section::frame).percentile(50);
+
+    return interval ? 1000000.0f / interval : 0.0f;
+}
+
+void profiler::serialize(tlvcpp::tlv_tree_node &node) const
+{
+    auto &profile = node.add_child(PROFILE_TAG);
+
+    for (size_t i = 0; i < static_cast<size_t>(profile_section::count); i++)
+    {
+        const auto &measured = m_sections[i];
+
+        const section_summary summary = {
+            .section = static_cast<uint8_t>(i),
+            .count = measured.count(),
+            .p50 = measured.percentile(50),
+            .p90 = measured.percentile(90),
+            .p99 = measured.percentile(99),
+            .max = measured.max(),
+        };
+
+        uint16_t buckets[histogram::BUCKET_COUNT];
+
+        for (size_t j = 0; j < histogram::BUCKET_COUNT; j++)
+            buckets[j] = measured.bucket(j);
+
+        auto &child = profile.add_child(PROFILE_SECTION_TAG, sizeof(summary), reinterpret_cast<const uint8_t *>(&summary));
+
+        child.add_child(PROFILE_BUCKETS_TAG, sizeof(buckets), reinterpret_cast<const uint8_t *>(buckets));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <sdkconfig.h>
+#include <tlvcpp/tlv_tree.h>
+
+#include "histogram.h"
+
+enum class profile_section : uint8_t
+{
+    frame,
+    update,
+    physics,
+    collisions,
+    render,
+    flush,
+    hud,
+    scripts,
+    gc,
+    count,
+};
+
+constexpr uint32_t PROFILE_TAG = 0x10;
+constexpr uint32_t PROFILE_SECTION_TAG = 0x11;
+constexpr uint32_t PROFILE_BUCKETS_TAG = 0x12;
+
+// every section is recorded from a single task, readers may see a sample or two of
+// tearing which is fine for statistics.
+class profiler
+{
+public:
+    static profiler &get();
+    static int64_t now();
+    static const char *name(const profile_section section);
+
+    void record(const profile_section section, const uint32_t duration);
+    void frame();
+
+    const histogram &section(const profile_section section) const { return m_sections[static_cast<size_t>(section)]; }
+    float fps() const;
+
+    void serialize(tlvcpp::tlv_tree_node &node) const;
+
+private:
+    profiler() = default;
+
+    histogram m_sections[static_cast<size_t>(profile_section::count)];
+    int64_t m_last_frame = 0;
+};
+
+class profile_probe
+{
+public:
+    profile_probe(const profile_section section) : m_section(section), m_start(profiler::now()) {}
+    ~profile_probe() { profiler::get().record(m_section, profiler::now() - m_start); }
+
+private:
+    const profile_section m_section;
+    const int64_t m_start;
+};
+
+#if CONFIG_RCLINK_PROFILER
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(section) profile_probe PROFILE_CONCAT(profile_probe_, __LINE__)(profile_section::section)
+#define PROFILE_FRAME() profiler::get().frame()
+#else
+#define PROFILE_SCOPE(section)
+#define PROFILE_FRAME()
+#endif
\ No newline at end of file
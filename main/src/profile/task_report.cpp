@@ -0,0 +1,173 @@
+#include "task_report.h"
+
+#if CONFIG_RCLINK_TASK_REPORT
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include <esp_log.h>
+
+#include "lock_guard.h"
+
+constexpr const char *TAG = "task_report";
+constexpr const uint32_t FULL_LOAD = 1000U;
+
+struct task_summary
+{
+    uint8_t core;
+    uint8_t priority;
+    uint8_t state;
+    uint16_t load;
+    uint32_t stack_free;
+} __attribute__((packed));
+
+static lock_profile report_lock("task_report");
+
+task_report &task_report::get()
+{
+    static task_report instance;
+
+    return instance;
+}
+
+task_report::task_report() : m_semaphore(xSemaphoreCreateMutex())
+{
+}
+
+bool task_report::sample()
+{
+    configRUN_TIME_COUNTER_TYPE total_run_time = 0;
+    const size_t count = uxTaskGetSystemState(m_status.data(), m_status.size(), &total_run_time);
+
+    if (!count)
+    {
+        ESP_LOGW(TAG, "more than %zu tasks", MAX_TASKS);
+
+        return false;
+    }
+
+    for (size_t i = 0; i < m_task_count; i++)
+        m_previous[i] = {m_tasks[i].handle, m_tasks[i].run_time};
+
+    m_previous_count = m_task_count;
+    m_task_count = count;
+
+    // the run time counter is wall time, so a core is fully loaded when one of its tasks
+    // ran for the whole window.
+    const uint64_t elapsed = std::max<uint64_t>(total_run_time - m_total_run_time, 1U);
+
+    m_total_run_time = total_run_time;
+
+    auto load_since = [this, elapsed](const TaskHandle_t handle, const configRUN_TIME_COUNTER_TYPE run_time)
+    {
+        const auto end = m_previous.begin() + m_previous_count;
+        const auto last = std::find_if(m_previous.begin(), end, [handle](const task_run_time &previous)
+                                       { return previous.handle == handle; });
+        const configRUN_TIME_COUNTER_TYPE ran = run_time - (last != end ? last->run_time : 0U);
+
+        return static_cast<uint16_t>(std::min<uint64_t>(ran * static_cast<uint64_t>(FULL_LOAD) / elapsed, FULL_LOAD));
+    };
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const TaskStatus_t &status = m_status[i];
+        task_entry &task = m_tasks[i];
+
+        task.handle = status.xHandle;
+        task.run_time = status.ulRunTimeCounter;
+        task.core = status.xCoreID < portNUM_PROCESSORS ? static_cast<uint8_t>(status.xCoreID) : ANY_CORE;
+        task.priority = static_cast<uint8_t>(status.uxCurrentPriority);
+        task.state = static_cast<uint8_t>(status.eCurrentState);
+        task.load = load_since(status.xHandle, status.ulRunTimeCounter);
+        task.stack_free = status.usStackHighWaterMark;
+
+        strncpy(task.name, status.pcTaskName, sizeof(task.name) - 1U);
+    }
+
+    // each core is idle for exactly as long as its idle task ran.
+    for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        const TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(core);
+        const auto found = std::find_if(m_tasks.begin(), m_tasks.begin() + m_task_count, [idle](const task_entry &task)
+                                        { return task.handle == idle; });
+
+        m_core_load[core] = found != m_tasks.begin() + m_task_count ? FULL_LOAD - found->load : 0U;
+    }
+
+    std::sort(m_tasks.begin(), m_tasks.begin() + m_task_count, [](const task_entry &left, const task_entry &right)
+              { return left.load > right.load; });
+
+    return true;
+}
+
+void task_report::serialize(tlvcpp::tlv_tree_node &node)
+{
+    lock_guard guard(m_semaphore, report_lock);
+
+    auto &report = node.add_child(TASK_REPORT_TAG);
+
+    if (!sample())
+        return;
+
+    report.add_child(CORE_LOAD_TAG, sizeof(m_core_load), reinterpret_cast<const uint8_t *>(m_core_load.data()));
+
+    for (size_t i = 0; i < m_task_count; i++)
+    {
+        const task_entry &task = m_tasks[i];
+        const task_summary summary = {
+            .core = task.core,
+            .priority = task.priority,
+            .state = task.state,
+            .load = task.load,
+            .stack_free = task.stack_free,
+        };
+
+        auto &child = report.add_child(TASK_TAG, sizeof(summary), reinterpret_cast<const uint8_t *>(&summary));
+
+        child.add_child(TASK_NAME_TAG, strnlen(task.name, sizeof(task.name)), reinterpret_cast<const uint8_t *>(task.name));
+    }
+}
+
+size_t task_report::format(char *text, const size_t size)
+{
+    lock_guard guard(m_semaphore, report_lock);
+
+    size_t length = 0;
+
+    auto print = [text, size, &length](const char *format, auto... arguments)
+    {
+        if (length >= size)
+            return;
+
+        const int written = snprintf(text + length, size - length, format, arguments...);
+
+        length = written < 0 ? size : std::min(length + written, size);
+    };
+
+    if (!sample())
+        return 0;
+
+    // same letters as vTaskList.
+    constexpr const char states[] = {'X', 'R', 'B', 'S', 'D', '?'};
+
+    for (size_t core = 0; core < m_core_load.size(); core++)
+        print("core %zu %5u.%u%%\n", core, m_core_load[core] / 10U, m_core_load[core] % 10U);
+
+    print("\n%-*s core prio state    cpu  stack\n", static_cast<int>(TASK_NAME_SIZE), "task");
+
+    for (size_t i = 0; i < m_task_count; i++)
+    {
+        const task_entry &task = m_tasks[i];
+        const char state = states[std::min<size_t>(task.state, sizeof(states) - 1U)];
+
+        if (task.core == ANY_CORE)
+            print("%-*s    - ", static_cast<int>(TASK_NAME_SIZE), task.name);
+        else
+            print("%-*s %4u ", static_cast<int>(TASK_NAME_SIZE), task.name, task.core);
+
+        print("%4u %5c %4u.%u%% %6lu\n", task.priority, state, task.load / 10U, task.load % 10U, static_cast<unsigned long>(task.stack_free));
+    }
+
+    return std::min(length, size - 1U);
+}
+#endif
\ No newline at end of file
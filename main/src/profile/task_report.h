@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <tlvcpp/tlv_tree.h>
+
+constexpr uint32_t TASK_REPORT_TAG = 0x17;
+constexpr uint32_t CORE_LOAD_TAG = 0x18;
+constexpr uint32_t TASK_TAG = 0x19;
+constexpr uint32_t TASK_NAME_TAG = 0x1a;
+
+#if CONFIG_RCLINK_TASK_REPORT
+// cpu load, stack high water mark, priority and core of every task. each report takes a
+// new sample, so the load covers the time since the previous report, whoever asked for it.
+class task_report
+{
+public:
+    static constexpr size_t MAX_TASKS = 32U;
+    static constexpr size_t TASK_NAME_SIZE = configMAX_TASK_NAME_LEN;
+    static constexpr uint8_t ANY_CORE = 0xffU;
+
+    static task_report &get();
+
+    task_report(const task_report &) = delete;
+    task_report &operator=(const task_report &) = delete;
+
+    // adds a TASK_REPORT_TAG child with the load of every core and a TASK_TAG per task.
+    void serialize(tlvcpp::tlv_tree_node &node);
+
+    // a plain text table, busiest task first. returns the length written, truncated to size.
+    size_t format(char *text, const size_t size);
+
+private:
+    struct task_run_time
+    {
+        TaskHandle_t handle;
+        configRUN_TIME_COUNTER_TYPE run_time;
+    };
+
+    struct task_entry
+    {
+        TaskHandle_t handle;
+        configRUN_TIME_COUNTER_TYPE run_time;
+        char name[TASK_NAME_SIZE];
+        uint8_t core;
+        uint8_t priority;
+        uint8_t state;
+        uint16_t load;
+        uint32_t stack_free;
+    };
+
+    task_report();
+
+    bool sample();
+
+    SemaphoreHandle_t m_semaphore;
+    std::array<TaskStatus_t, MAX_TASKS> m_status = {};
+    std::array<task_entry, MAX_TASKS> m_tasks = {};
+    std::array<task_run_time, MAX_TASKS> m_previous = {};
+    size_t m_task_count = 0;
+    size_t m_previous_count = 0;
+    std::array<uint16_t, portNUM_PROCESSORS> m_core_load = {};
+    configRUN_TIME_COUNTER_TYPE m_total_run_time = 0;
+};
+#endif
\ No newline at end of file
@@ -1,74 +1,136 @@
 #include "application/application.h"
 
-#include <sys/stat.h>
+#include <array>
 #include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdio>
 
 #include <esp_log.h>
 #include <freertos/FreeRTOS.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
 #include <sol/sol.hpp>
 
 #include "hardware/display.h"
 #include "hardware/wifi.h"
 #include "hardware/battery.h"
+#include "hud/hud.h"
+#include "memory/memory_account.h"
+#include "metrics/metrics.h"
+#include "physics/simulation.h"
+#include "profile/display_probes.h"
+#include "profile/lock_profile.h"
+#include "profile/profiler.h"
+#include "profile/task_report.h"
+#include "render/ball_layer.h"
+#include "render/ball_widgets.h"
+#include "render/sprites.h"
+#include "scripting/lua_heap.h"
+#include "scripting/message_bindings.h"
+#include "scripting/scheduler.h"
+#include "scripting/script_loader.h"
+#include "sensors/sensor_service.h"
+#include "server/dispatch_worker.h"
 #include "server/http_server.h"
 #include "server/websocket_server.h"
 
 constexpr size_t initial_balls = 25;
+constexpr size_t ball_capacity = CONFIG_RCLINK_BALL_CAPACITY;
 
-struct ball
-{
-    lv_obj_t *obj_handle;
+// a uint32_t ball count, published over the data stream whenever it changes.
+constexpr uint32_t BALL_COUNT_TAG = 0x21;
 
-    struct
-    {
-        float x;
-        float y;
-    } position;
+constexpr size_t lua_memory_limit = CONFIG_RCLINK_LUA_MEMORY_LIMIT * 1024U;
 
-    struct
-    {
-        float x;
-        float y;
-    } velocity;
-};
+#if CONFIG_RCLINK_LUA_HEAP_PSRAM
+constexpr memory_placement lua_heap_placement = memory_placement::psram;
+#else
+constexpr memory_placement lua_heap_placement = memory_placement::internal;
+#endif
+
+constexpr uint32_t hud_period = 100U;
+constexpr uint32_t balls_interval = 100U;
+constexpr uint32_t profile_interval = 200U;
+constexpr uint32_t battery_interval = 1000U;
+constexpr uint32_t wifi_interval = 1000U;
+constexpr uint32_t lua_interval = 1000U;
+
+constexpr std::array<uint32_t, 6> frame_time_bounds = {8000U, 17000U, 34000U, 50000U, 100000U, 250000U};
+
+static memory_account lua_account("lua");
+static memory_account render_account("render");
+
+static metric_histogram frame_time("rclink_frame_time_us", "Time between two ui frames.", frame_time_bounds);
+static metric_gauge heap_free_internal("rclink_heap_free_bytes", "Free heap per region.", "region=\"internal\"");
+static metric_gauge heap_free_psram("rclink_heap_free_bytes", "Free heap per region.", "region=\"psram\"");
+static metric_gauge lua_memory("rclink_lua_memory_bytes", "Bytes allocated by the lua state.");
+static metric_gauge ball_count("rclink_balls", "Balls in the simulation.");
+
+#if CONFIG_RCLINK_BALL_LAYER
+using ball_renderer = ball_layer;
+#else
+using ball_renderer = ball_widgets;
+#endif
 
 class rc_link : public application
 {
 public:
-    rc_link() : mp_http_server(std::make_unique<http_server>(80, LV_FS_POSIX_PATH "/web")),
+    rc_link() : m_lua_heap(lua_memory_limit, lua_account, lua_heap_placement),
+                m_sol_state(sol::default_at_panic, lua_heap::allocate, &m_lua_heap),
+                m_scheduler(m_sol_state.lua_state()),
+                mp_http_server(std::make_unique<http_server>(80, LV_FS_POSIX_PATH "/web")),
                 mp_websocket_server(std::make_unique<websocket_server>(81)),
+                m_messages(m_sol_state.lua_state(), *mp_websocket_server, m_scheduler),
+                m_dispatch(*mp_websocket_server, std::bind_front(&rc_link::on_received, this)),
+                m_sensors(*mp_websocket_server),
                 m_width(hardware::display::get().width()),
                 m_height(hardware::display::get().height()),
+                m_simulation(m_width, m_height, ball_capacity),
                 m_group(lv_group_create()),
-                m_screen(lv_scr_act())
+                m_screen(lv_scr_act()),
+                m_balls(m_screen, ball_capacity, render_account),
+                m_hud(lv_layer_top(), hud_period),
+                m_render_x(account_allocator<float>(render_account)),
+                m_render_y(account_allocator<float>(render_account))
     {
-        m_sol_state.open_libraries();
+        m_render_x.reserve(ball_capacity);
+        m_render_y.reserve(ball_capacity);
 
-        struct stat file_stat;
+        m_lua_heap.attach(m_sol_state.lua_state());
+        m_sol_state.open_libraries(sol::lib::base, sol::lib::coroutine, sol::lib::string, sol::lib::table, sol::lib::math, sol::lib::utf8);
 
-        if (!stat("/scripts/main.lua", &file_stat))
-            m_sol_state.script_file("/scripts/main.lua");
+        run_script(m_sol_state, "/scripts/main.lua");
 
-        auto websocket_task = [](void *argument)
+        m_dispatch.start();
+
+        auto read_battery = []()
         {
-            auto &server = *static_cast<websocket_server *>(argument);
+            return static_cast<int32_t>(hardware::battery::get().voltage_level());
+        };
 
-            while (true)
-            {
-                tlvcpp::tlv_tree_node node;
+        const sensor_service::config battery = {
+            .interval = CONFIG_RCLINK_BATTERY_INTERVAL,
+            .weight = CONFIG_RCLINK_BATTERY_WEIGHT / 100.0f,
+            .threshold = CONFIG_RCLINK_BATTERY_THRESHOLD,
+            .read = read_battery,
+        };
 
-                server >> node;
+        m_sensors.add(sensor::battery, battery);
+        m_sensors.start();
 
-                if (node.data().tag() || node.children().size())
-                    server << node;
+        auto publish_ball_count = [this](const size_t &count)
+        {
+            const uint32_t balls = count;
 
-                vTaskDelay(pdMS_TO_TICKS(100));
-            }
+            tlvcpp::tlv_tree_node node;
+
+            node.add_child(BALL_COUNT_TAG, sizeof(balls), reinterpret_cast<const uint8_t *>(&balls));
 
-            vTaskDelete(nullptr);
+            *mp_websocket_server << node;
         };
 
-        xTaskCreatePinnedToCore(websocket_task, "dispatch_worker", 4U * 1024U, mp_websocket_server.get(), 5, &m_websocket_task, 0);
+        m_ball_count.subscribe(publish_ball_count);
 
         lv_indev_t *indev = nullptr;
 
@@ -104,12 +166,11 @@ public:
 
     ~rc_link()
     {
+        // the simulation goes away with the app, only the sprites need removing.
         while (m_balls.size())
-            remove_ball();
+            m_balls.remove_ball();
 
         lv_group_del(m_group);
-
-        vTaskDelete(m_websocket_task);
     }
 
 private:
@@ -118,128 +179,216 @@ private:
         lv_obj_clear_flag(m_screen, LV_OBJ_FLAG_SCROLLABLE);
         lv_obj_set_style_bg_color(m_screen, lv_color_black(), LV_STATE_DEFAULT);
 
-        m_ssid = lv_label_create(lv_layer_top());
+        auto text_field = [](const char *prefix)
+        {
+            return [prefix](char *text, size_t size, const status_text &value)
+            {
+                snprintf(text, size, "%s: %s", prefix, value.data());
+            };
+        };
 
-        lv_obj_set_style_text_color(m_ssid, lv_color_white(), LV_STATE_DEFAULT);
-        lv_obj_align(m_ssid, LV_ALIGN_BOTTOM_LEFT, 4, -94);
+        auto lua_memory_field = [](char *text, size_t size, const size_t &kilobytes)
+        {
+            snprintf(text, size, "Lua: %zu/%zukb", kilobytes, static_cast<size_t>(CONFIG_RCLINK_LUA_MEMORY_LIMIT));
+        };
 
-        m_ip = lv_label_create(lv_layer_top());
+        m_hud.add_field(LV_ALIGN_BOTTOM_LEFT, 4, -130, lua_interval, m_lua_memory, lua_memory_field);
+        m_hud.add_field(LV_ALIGN_BOTTOM_LEFT, 4, -112, wifi_interval, m_ssid, text_field("SSID"));
+        m_hud.add_field(LV_ALIGN_BOTTOM_LEFT, 4, -94, wifi_interval, m_ip, text_field("IP"));
+        m_hud.add_field(LV_ALIGN_BOTTOM_LEFT, 4, -76, wifi_interval, m_netmask, text_field("Netmask"));
+        m_hud.add_field(LV_ALIGN_BOTTOM_LEFT, 4, -58, wifi_interval, m_gateway, text_field("Gateway"));
 
-        lv_obj_set_style_text_color(m_ip, lv_color_white(), LV_STATE_DEFAULT);
-        lv_obj_align(m_ip, LV_ALIGN_BOTTOM_LEFT, 4, -76);
+        auto battery_field = [](char *text, size_t size, const uint32_t &voltage)
+        {
+            snprintf(text, size, "Battery: %lumv", voltage);
+        };
 
-        m_netmask = lv_label_create(lv_layer_top());
+        m_hud.add_field(LV_ALIGN_BOTTOM_LEFT, 4, -40, battery_interval, m_battery_voltage, battery_field);
 
-        lv_obj_set_style_text_color(m_netmask, lv_color_white(), LV_STATE_DEFAULT);
-        lv_obj_align(m_netmask, LV_ALIGN_BOTTOM_LEFT, 4, -58);
+        auto ball_count_field = [](char *text, size_t size, const size_t &count)
+        {
+            snprintf(text, size, "Balls: %zu", count);
+        };
 
-        m_gatway = lv_label_create(lv_layer_top());
+        m_hud.add_field(LV_ALIGN_BOTTOM_LEFT, 4, -22, balls_interval, m_ball_count, ball_count_field);
 
-        lv_obj_set_style_text_color(m_gatway, lv_color_white(), LV_STATE_DEFAULT);
-        lv_obj_align(m_gatway, LV_ALIGN_BOTTOM_LEFT, 4, -40);
+        auto ball_pool_field = [](char *text, size_t size, const pool_statistics &pool)
+        {
+            snprintf(text, size, "Pool: %zu/%zu, peak %zu", pool.in_use, pool.allocated, pool.high_water);
+        };
 
-        m_battery_voltage = lv_label_create(lv_layer_top());
+        m_hud.add_field(LV_ALIGN_BOTTOM_LEFT, 4, -4, balls_interval, m_ball_pool, ball_pool_field);
 
-        lv_obj_set_style_text_color(m_battery_voltage, lv_color_white(), LV_STATE_DEFAULT);
-        lv_obj_align(m_battery_voltage, LV_ALIGN_BOTTOM_LEFT, 4, -22);
+#if CONFIG_RCLINK_PROFILER
+        auto frames = []()
+        {
+            return static_cast<uint32_t>(profiler::get().section(profile_section::frame).total());
+        };
 
-        m_ball_count = lv_label_create(lv_layer_top());
+        auto profile_field = [this](char *text, size_t size)
+        {
+            format_profile(text, size);
+        };
 
-        lv_obj_set_style_text_color(m_ball_count, lv_color_white(), LV_STATE_DEFAULT);
-        lv_obj_align(m_ball_count, LV_ALIGN_BOTTOM_LEFT, 4, -4);
+        m_hud.add_field(LV_ALIGN_TOP_LEFT, 4, 4, profile_interval, frames, profile_field);
+#endif
 
-        m_balls.reserve(initial_balls);
+        profile_display(lv_disp_get_default());
 
         reset_balls();
 
-        for (size_t i = 0; i < 10; i++)
-            m_voltage_level = 0.9f * m_voltage_level + 0.1f * hardware::battery::get().voltage_level();
-
-        auto hud_update = [](lv_timer_t *timer)
+        auto status_update = [](lv_timer_t *timer)
         {
-            static_cast<rc_link *>(timer->user_data)->update_hud();
+            static_cast<rc_link *>(timer->user_data)->update_status();
         };
 
-        lv_timer_create(hud_update, 200, this);
+        lv_timer_create(status_update, 200, this);
+
+        update_status();
     }
 
-    void on_update(float timestep) override
+#if CONFIG_RCLINK_PROFILER || CONFIG_RCLINK_LOCK_PROFILER || CONFIG_RCLINK_TASK_REPORT || CONFIG_RCLINK_MEMORY_REPORT
+    static bool is_report(const tlvcpp::tlv_tree_node &child)
     {
-        const auto min_x = 15;
-        const auto min_y = 15;
-        const auto max_x = m_width - 15;
-        const auto max_y = m_height - 15;
+        switch (child.data().tag())
+        {
+#if CONFIG_RCLINK_PROFILER
+        case PROFILE_TAG:
+#endif
+#if CONFIG_RCLINK_LOCK_PROFILER
+        case LOCK_PROFILE_TAG:
+#endif
+#if CONFIG_RCLINK_TASK_REPORT
+        case TASK_REPORT_TAG:
+#endif
+#if CONFIG_RCLINK_MEMORY_REPORT
+        case MEMORY_REPORT_TAG:
+#endif
+            return true;
+        default:
+            return false;
+        }
+    }
+#endif
 
-        for (const auto ball : m_balls)
+    // runs on the dispatch worker task.
+    void on_received(tlvcpp::tlv_tree_node &&node, data_stream &stream)
+    {
+#if CONFIG_RCLINK_PROFILER || CONFIG_RCLINK_LOCK_PROFILER || CONFIG_RCLINK_TASK_REPORT || CONFIG_RCLINK_MEMORY_REPORT
+        // only enabled reports are answered, a message asking for none is echoed untouched.
+        if (std::none_of(node.children().begin(), node.children().end(), is_report))
+            stream << node;
+        else
         {
-            const auto flip_vx = (ball->position.x < min_x && ball->velocity.x < 0) || (ball->position.x > max_x && ball->velocity.x > 0);
-            const auto flip_vy = (ball->position.y < min_y && ball->velocity.y < 0) || (ball->position.y > max_y && ball->velocity.y > 0);
+            tlvcpp::tlv_tree_node reply(node.data());
+
+            for (const auto &child : node.children())
+                switch (child.data().tag())
+                {
+#if CONFIG_RCLINK_PROFILER
+                case PROFILE_TAG:
+                    profiler::get().serialize(reply);
+                    break;
+#endif
+#if CONFIG_RCLINK_LOCK_PROFILER
+                case LOCK_PROFILE_TAG:
+                    lock_profile::serialize_all(reply);
+                    break;
+#endif
+#if CONFIG_RCLINK_TASK_REPORT
+                case TASK_REPORT_TAG:
+                    task_report::get().serialize(reply);
+                    break;
+#endif
+#if CONFIG_RCLINK_MEMORY_REPORT
+                case MEMORY_REPORT_TAG:
+                    memory_account::serialize_all(reply);
+                    break;
+#endif
+                default:
+                    reply.add_child() = child;
+                    break;
+                }
+
+            stream << reply;
+        }
+#else
+        stream << node;
+#endif
 
-            ball->velocity.x = flip_vx ? -ball->velocity.x : ball->velocity.x;
-            ball->velocity.y = flip_vy ? -ball->velocity.y : ball->velocity.y;
+        // lua reads the tree in place on the ui task, nothing is copied or serialized.
+        if (node.children().size())
+            m_messages.post(std::move(node));
+    }
 
-            for (const auto b : m_balls)
-            {
-                if (b == ball)
-                    continue;
+    void on_update(float) override
+    {
+        PROFILE_FRAME();
 
-                const auto dx = ball->position.x - b->position.x;
-                const auto dy = ball->position.y - b->position.y;
+        const int64_t frame_started_at = esp_timer_get_time();
 
-                if ((dx * dx + dy * dy) < 900)
-                    resolve_collision(*b, *ball);
-            }
+        if (m_last_frame_at)
+            frame_time.observe(static_cast<uint32_t>(frame_started_at - m_last_frame_at));
 
-            ball->position.x += ball->velocity.x * timestep;
-            ball->position.y += ball->velocity.y * timestep;
+        m_last_frame_at = frame_started_at;
 
-            lv_obj_set_pos(ball->obj_handle, ball->position.x - 15, ball->position.y - 15);
-        }
-    }
+        m_messages.dispatch();
 
-    void add_ball()
-    {
-        auto b = static_cast<ball *>(lv_mem_alloc(sizeof(ball)));
+        const int64_t scripts_started_at = profiler::now();
 
-        b->obj_handle = lv_img_create(m_screen);
+        m_scheduler.run(CONFIG_RCLINK_LUA_BUDGET);
 
-        b->position.x = (m_width / 2);
-        b->position.y = (m_height / 2);
-        b->velocity.x = lv_rand(50, 150);
-        b->velocity.y = lv_rand(50, 150);
+        // the collector gets whatever the scripts left of their budget, but never less than its minimum.
+        const int64_t scripts_left = CONFIG_RCLINK_LUA_BUDGET - (profiler::now() - scripts_started_at);
 
-        if (lv_rand(0, 1))
-            b->velocity.x = -b->velocity.x;
+        m_lua_heap.collect(std::max<int64_t>(scripts_left, CONFIG_RCLINK_LUA_GC_BUDGET));
 
-        if (lv_rand(0, 1))
-            b->velocity.y = -b->velocity.y;
+        PROFILE_SCOPE(update);
 
-        lv_obj_set_size(b->obj_handle, 30, 30);
-        lv_obj_set_pos(b->obj_handle, b->position.x - 15, b->position.y - 15);
+        const auto &latest = m_simulation.latest();
+        const auto count = std::min(latest.count, m_balls.size());
+        const auto elapsed = static_cast<float>(esp_timer_get_time() - latest.timestamp);
+        const auto alpha = std::clamp(elapsed / m_simulation.step_interval(), 0.0f, 1.0f);
 
-        lv_obj_set_style_radius(b->obj_handle, 15, LV_STATE_DEFAULT);
-        lv_obj_set_style_border_width(b->obj_handle, 0, LV_STATE_DEFAULT);
+        m_render_x.resize(count);
+        m_render_y.resize(count);
 
-        char path[] = "F:/images/ball_0.png";
+        for (size_t i = 0; i < count; i++)
+        {
+            m_render_x[i] = latest.previous_x[i] + (latest.x[i] - latest.previous_x[i]) * alpha;
+            m_render_y[i] = latest.previous_y[i] + (latest.y[i] - latest.previous_y[i]) * alpha;
+        }
 
-        path[15] = '0' + lv_rand(0, 7);
+        m_balls.update(m_render_x.data(), m_render_y.data(), count);
+    }
 
-        lv_img_set_src(b->obj_handle, path);
+    void add_ball()
+    {
+        // spawned in the middle, the simulation picks the velocity from its seeded generator.
+        if (!m_balls.add_ball(m_width / 2, m_height / 2, lv_rand(0, BALL_SPRITE_COUNT - 1)))
+            return;
 
-        m_balls.push_back(b);
+        // both sides have to agree on the count, the sprite goes again if physics didn't take it.
+        if (!m_simulation.add_ball())
+        {
+            m_balls.remove_ball();
+
+            return;
+        }
+
+        m_ball_count.set(m_balls.size());
+        m_ball_pool.set(m_balls.statistics());
     }
 
     void remove_ball()
     {
-        if (!m_balls.size())
+        if (!m_balls.size() || !m_simulation.remove_ball())
             return;
 
-        auto b = m_balls.back();
+        m_balls.remove_ball();
 
-        m_balls.pop_back();
-
-        lv_obj_del(b->obj_handle);
-        lv_mem_free(b);
+        m_ball_count.set(m_balls.size());
+        m_ball_pool.set(m_balls.statistics());
     }
 
     void reset_balls()
@@ -269,75 +418,83 @@ private:
         m_timer = lv_timer_create(timer_cb, 100, this);
     }
 
-    void update_hud()
+    // polled sources, the hud only redraws what changed.
+    void update_status()
     {
         auto &wifi = hardware::wifi::get();
 
-        lv_label_set_text_fmt(m_ssid, "SSID: %s", wifi.get_ssid());
-        lv_label_set_text_fmt(m_ip, "IP: %s", wifi.get_ip());
-        lv_label_set_text_fmt(m_netmask, "Netmask: %s", wifi.get_netmask());
-        lv_label_set_text_fmt(m_gatway, "Gateway: %s", wifi.get_gateway());
+        m_ssid.set(make_status_text(wifi.get_ssid()));
+        m_ip.set(make_status_text(wifi.get_ip()));
+        m_netmask.set(make_status_text(wifi.get_netmask()));
+        m_gateway.set(make_status_text(wifi.get_gateway()));
+
+        if (m_sensors.ready(sensor::battery))
+            m_battery_voltage.set(m_sensors.latest(sensor::battery));
 
-        m_voltage_level = 0.9f * m_voltage_level + 0.1f * hardware::battery::get().voltage_level();
+        m_lua_memory.set(m_lua_heap.statistics().in_use / 1024U);
 
-        lv_label_set_text_fmt(m_battery_voltage, "Battery: %lumv", m_voltage_level);
-        lv_label_set_text_fmt(m_ball_count, "Balls: %zu", m_balls.size());
+        heap_free_internal.set(heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+        heap_free_psram.set(heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+        lua_memory.set(m_lua_heap.statistics().in_use);
+        ball_count.set(m_balls.size());
     }
 
-    void resolve_collision(ball &b1, ball &b2)
+#if CONFIG_RCLINK_PROFILER
+    void format_profile(char *text, const size_t size)
     {
-        const float dx = b2.position.x - b1.position.x;
-        const float dy = b2.position.y - b1.position.y;
-        const float distance = std::sqrt(dx * dx + dy * dy);
-        const float penetration_depth = (15 + 15) - distance;
-        const float normal_x = dx / distance;
-        const float normal_y = dy / distance;
-        const float resolution_distance = penetration_depth / 2;
-
-        b1.position.x -= normal_x * resolution_distance;
-        b1.position.y -= normal_y * resolution_distance;
-        b2.position.x += normal_x * resolution_distance;
-        b2.position.y += normal_y * resolution_distance;
-
-        const float relative_vx = b2.velocity.x - b1.velocity.x;
-        const float relative_vy = b2.velocity.y - b1.velocity.y;
-        const float v_along_normal = relative_vx * normal_x + relative_vy * normal_y;
-
-        if (v_along_normal > 0)
-            return;
+        auto &profile = profiler::get();
 
-        const float j = -(1 + 0.99f) * v_along_normal / 2;
-        const float impulse_x = j * normal_x;
-        const float impulse_y = j * normal_y;
+        int length = snprintf(text, size, "FPS: %.1f, labels: %lu/s", profile.fps(), m_hud.label_updates_per_second());
 
-        b1.velocity.x -= impulse_x;
-        b1.velocity.y -= impulse_y;
-        b2.velocity.x += impulse_x;
-        b2.velocity.y += impulse_y;
+        for (size_t i = static_cast<size_t>(profile_section::update); i < static_cast<size_t>(profile_section::count); i++)
+        {
+            const auto section = static_cast<profile_section>(i);
+            const auto &measured = profile.section(section);
+
+            if (length < 0 || static_cast<size_t>(length) >= size)
+                break;
+
+            length += snprintf(text + length, size - length, "\n%s: %lu/%luus", profiler::name(section), measured.percentile(50), measured.percentile(99));
+        }
     }
+#endif
 
+    lua_heap m_lua_heap;
     sol::state m_sol_state;
+    scheduler m_scheduler;
     std::unique_ptr<http_server> mp_http_server;
     std::unique_ptr<websocket_server> mp_websocket_server;
-    TaskHandle_t m_websocket_task;
+    message_bindings m_messages;
+    dispatch_worker m_dispatch;
+    sensor_service m_sensors;
 
     const uint16_t m_width;
     const uint16_t m_height;
 
+    simulation m_simulation;
+
     lv_group_t *m_group;
     lv_obj_t *m_screen;
 
-    lv_obj_t *m_ssid;
-    lv_obj_t *m_ip;
-    lv_obj_t *m_netmask;
-    lv_obj_t *m_gatway;
-    lv_obj_t *m_battery_voltage;
-    lv_obj_t *m_ball_count;
+    ball_renderer m_balls;
+
+    status_source<status_text> m_ssid;
+    status_source<status_text> m_ip;
+    status_source<status_text> m_netmask;
+    status_source<status_text> m_gateway;
+    status_source<uint32_t> m_battery_voltage;
+    status_source<size_t> m_ball_count;
+    status_source<pool_statistics> m_ball_pool;
+    status_source<size_t> m_lua_memory;
+
+    hud m_hud;
 
     lv_timer_t *m_timer = nullptr;
 
-    std::vector<ball *> m_balls;
-    uint32_t m_voltage_level = 0;
+    int64_t m_last_frame_at = 0;
+
+    std::vector<float, account_allocator<float>> m_render_x;
+    std::vector<float, account_allocator<float>> m_render_y;
 };
 
 std::unique_ptr<application> create_application()
@@ -0,0 +1,145 @@
+#include "ball_layer.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "sprites.h"
+
+constexpr lv_coord_t RADIUS = BALL_SPRITE_SIZE / 2;
+
+ball_layer::ball_layer(lv_obj_t *parent, const size_t capacity, memory_account &account) : m_object(lv_obj_create(parent)),
+                                                                                            m_pool(capacity, CONFIG_RCLINK_BALL_POOL_CHUNK, account),
+                                                                                            m_balls(account_allocator<ball *>(account))
+{
+    lv_obj_remove_style_all(m_object);
+    lv_obj_set_size(m_object, LV_PCT(100), LV_PCT(100));
+    lv_obj_clear_flag(m_object, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(m_object, draw_event, LV_EVENT_DRAW_MAIN, this);
+
+    m_balls.reserve(capacity);
+}
+
+ball_layer::~ball_layer()
+{
+    lv_obj_del(m_object);
+}
+
+bool ball_layer::add_ball(const float x, const float y, const uint8_t sprite)
+{
+    auto added = m_pool.acquire();
+
+    if (!added)
+        return false;
+
+    added->location = to_position(x, y);
+    added->sprite = sprite;
+
+    m_balls.push_back(added);
+
+    invalidate(added->location);
+    flush();
+
+    return true;
+}
+
+void ball_layer::remove_ball()
+{
+    if (!m_balls.size())
+        return;
+
+    invalidate(m_balls.back()->location);
+    flush();
+
+    m_pool.release(m_balls.back());
+    m_balls.pop_back();
+}
+
+void ball_layer::update(const float *x, const float *y, size_t count)
+{
+    count = std::min(count, m_balls.size());
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const position next = to_position(x[i], y[i]);
+        auto &current = m_balls[i]->location;
+
+        if (next.x == current.x && next.y == current.y)
+            continue;
+
+        invalidate(current);
+        invalidate(next);
+
+        current = next;
+    }
+
+    flush();
+}
+
+void ball_layer::draw_event(lv_event_t *e)
+{
+    const auto layer = static_cast<ball_layer *>(lv_event_get_user_data(e));
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+
+    lv_area_t coords;
+
+    lv_obj_get_coords(layer->m_object, &coords);
+
+    lv_draw_img_dsc_t image_dsc;
+
+    lv_draw_img_dsc_init(&image_dsc);
+
+    for (const auto drawn : layer->m_balls)
+    {
+        const auto &ball_position = drawn->location;
+
+        const lv_area_t area = {
+            .x1 = static_cast<lv_coord_t>(coords.x1 + ball_position.x),
+            .y1 = static_cast<lv_coord_t>(coords.y1 + ball_position.y),
+            .x2 = static_cast<lv_coord_t>(coords.x1 + ball_position.x + BALL_SPRITE_SIZE - 1),
+            .y2 = static_cast<lv_coord_t>(coords.y1 + ball_position.y + BALL_SPRITE_SIZE - 1),
+        };
+
+        if (_lv_area_is_on(&area, draw_ctx->clip_area))
+            lv_draw_img(draw_ctx, &image_dsc, &area, ball_sprite(drawn->sprite));
+    }
+}
+
+ball_layer::position ball_layer::to_position(const float x, const float y)
+{
+    return {
+        .x = static_cast<lv_coord_t>(std::lround(x) - RADIUS),
+        .y = static_cast<lv_coord_t>(std::lround(y) - RADIUS),
+    };
+}
+
+void ball_layer::invalidate(const position &ball_position)
+{
+    m_dirty_region.add({
+        .x1 = ball_position.x,
+        .y1 = ball_position.y,
+        .x2 = ball_position.x + BALL_SPRITE_SIZE - 1,
+        .y2 = ball_position.y + BALL_SPRITE_SIZE - 1,
+    });
+}
+
+void ball_layer::flush()
+{
+    lv_area_t coords;
+
+    lv_obj_get_coords(m_object, &coords);
+
+    for (const auto &rect : m_dirty_region.rects())
+    {
+        const lv_area_t area = {
+            .x1 = static_cast<lv_coord_t>(coords.x1 + rect.x1),
+            .y1 = static_cast<lv_coord_t>(coords.y1 + rect.y1),
+            .x2 = static_cast<lv_coord_t>(coords.x1 + rect.x2),
+            .y2 = static_cast<lv_coord_t>(coords.y1 + rect.y2),
+        };
+
+        lv_obj_invalidate_area(m_object, &area);
+    }
+
+    m_invalidated_area = m_dirty_region.area();
+    m_dirty_region.clear();
+}
\ No newline at end of file
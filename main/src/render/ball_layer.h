@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <lvgl.h>
+
+#include "dirty_region.h"
+#include "object_pool.h"
+
+// draws every ball from a single object, only invalidating the merged areas the balls
+// actually moved through.
+class ball_layer
+{
+public:
+    ball_layer(lv_obj_t *parent, const size_t capacity, memory_account &account);
+    ~ball_layer();
+
+    size_t size() const { return m_balls.size(); }
+    const pool_statistics &statistics() const { return m_pool.statistics(); }
+    int32_t invalidated_area() const { return m_invalidated_area; }
+
+    bool add_ball(const float x, const float y, const uint8_t sprite);
+    void remove_ball();
+    void update(const float *x, const float *y, size_t count);
+
+private:
+    struct position
+    {
+        lv_coord_t x;
+        lv_coord_t y;
+    };
+
+    struct ball
+    {
+        position location;
+        uint8_t sprite;
+    };
+
+    static void draw_event(lv_event_t *e);
+    static position to_position(const float x, const float y);
+
+    void invalidate(const position &ball_position);
+    void flush();
+
+    lv_obj_t *m_object;
+    object_pool<ball> m_pool;
+    std::vector<ball *, account_allocator<ball *>> m_balls;
+    dirty_region m_dirty_region;
+    int32_t m_invalidated_area = 0;
+};
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "ball_widgets.h"
+
+#include <algorithm>
+
+#include "sprites.h"
+
+constexpr lv_coord_t RADIUS = BALL_SPRITE_SIZE / 2;
+
+ball_widgets::ball_widgets(lv_obj_t *parent, const size_t capacity, memory_account &account) : m_parent(parent),
+                                                                                                m_pool(capacity, CONFIG_RCLINK_BALL_POOL_CHUNK, account),
+                                                                                                m_handles(account_allocator<lv_obj_t **>(account))
+{
+    m_handles.reserve(capacity);
+}
+
+ball_widgets::~ball_widgets()
+{
+    auto delete_widget = [](lv_obj_t *handle)
+    {
+        if (handle)
+            lv_obj_del(handle);
+    };
+
+    m_pool.for_each(delete_widget);
+}
+
+bool ball_widgets::add_ball(const float x, const float y, const uint8_t sprite)
+{
+    auto slot = m_pool.acquire();
+
+    if (!slot)
+        return false;
+
+    auto &handle = *slot;
+
+    if (!handle)
+    {
+        handle = lv_img_create(m_parent);
+
+        lv_obj_set_size(handle, BALL_SPRITE_SIZE, BALL_SPRITE_SIZE);
+
+        lv_obj_set_style_radius(handle, RADIUS, LV_STATE_DEFAULT);
+        lv_obj_set_style_border_width(handle, 0, LV_STATE_DEFAULT);
+    }
+    else
+        lv_obj_clear_flag(handle, LV_OBJ_FLAG_HIDDEN);
+
+    lv_obj_set_pos(handle, x - RADIUS, y - RADIUS);
+    lv_img_set_src(handle, ball_sprite(sprite));
+
+    m_handles.push_back(slot);
+
+    return true;
+}
+
+void ball_widgets::remove_ball()
+{
+    if (!m_handles.size())
+        return;
+
+    lv_obj_add_flag(*m_handles.back(), LV_OBJ_FLAG_HIDDEN);
+
+    m_pool.release(m_handles.back());
+    m_handles.pop_back();
+}
+
+void ball_widgets::update(const float *x, const float *y, size_t count)
+{
+    count = std::min(count, m_handles.size());
+
+    for (size_t i = 0; i < count; i++)
+        lv_obj_set_pos(*m_handles[i], x[i] - RADIUS, y[i] - RADIUS);
+}
\ No newline at end of file
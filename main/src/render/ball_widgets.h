@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include <lvgl.h>
+
+#include "object_pool.h"
+
+// one lv_img per ball, removed balls are only hidden and their widgets are reused.
+class ball_widgets
+{
+public:
+    ball_widgets(lv_obj_t *parent, const size_t capacity, memory_account &account);
+    ~ball_widgets();
+
+    size_t size() const { return m_handles.size(); }
+    const pool_statistics &statistics() const { return m_pool.statistics(); }
+
+    bool add_ball(const float x, const float y, const uint8_t sprite);
+    void remove_ball();
+    void update(const float *x, const float *y, size_t count);
+
+private:
+    lv_obj_t *m_parent;
+    object_pool<lv_obj_t *> m_pool;
+    std::vector<lv_obj_t **, account_allocator<lv_obj_t **>> m_handles;
+};
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "dirty_region.h"
+
+#include <limits>
+#include <algorithm>
+
+dirty_region::dirty_region(const size_t max_rects) : m_max_rects(std::max(max_rects, static_cast<size_t>(1U)))
+{
+    m_rects.reserve(m_max_rects);
+}
+
+void dirty_region::add(rect area)
+{
+    bool merged = true;
+
+    while (merged)
+    {
+        merged = false;
+
+        for (size_t i = 0; i < m_rects.size(); i++)
+        {
+            const rect joined = join(m_rects[i], area);
+
+            if (!overlaps(m_rects[i], area) && joined.area() > m_rects[i].area() + area.area())
+                continue;
+
+            area = joined;
+
+            m_rects[i] = m_rects.back();
+            m_rects.pop_back();
+
+            merged = true;
+
+            break;
+        }
+    }
+
+    if (m_rects.size() < m_max_rects)
+    {
+        m_rects.push_back(area);
+
+        return;
+    }
+
+    size_t cheapest = 0;
+    int32_t cheapest_growth = std::numeric_limits<int32_t>::max();
+
+    for (size_t i = 0; i < m_rects.size(); i++)
+    {
+        const int32_t growth = join(m_rects[i], area).area() - m_rects[i].area();
+
+        if (growth < cheapest_growth)
+        {
+            cheapest = i;
+            cheapest_growth = growth;
+        }
+    }
+
+    rect joined = join(m_rects[cheapest], area);
+
+    m_rects[cheapest] = m_rects.back();
+    m_rects.pop_back();
+
+    add(joined);
+}
+
+int32_t dirty_region::area() const
+{
+    int32_t total = 0;
+
+    for (const auto &area : m_rects)
+        total += area.area();
+
+    return total;
+}
+
+dirty_region::rect dirty_region::join(const rect &first, const rect &second)
+{
+    return {
+        .x1 = std::min(first.x1, second.x1),
+        .y1 = std::min(first.y1, second.y1),
+        .x2 = std::max(first.x2, second.x2),
+        .y2 = std::max(first.y2, second.y2),
+    };
+}
+
+bool dirty_region::overlaps(const rect &first, const rect &second)
+{
+    return first.x1 <= second.x2 && second.x1 <= first.x2 && first.y1 <= second.y2 && second.y1 <= first.y2;
+}
\ No newline at end of file
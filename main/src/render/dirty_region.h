@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// collects invalidated rectangles, merging them while that doesn't redraw more than
+// it saves and collapsing the cheapest pair once the rectangle budget runs out.
+class dirty_region
+{
+public:
+    struct rect
+    {
+        int32_t x1;
+        int32_t y1;
+        int32_t x2;
+        int32_t y2;
+
+        int32_t area() const { return (x2 - x1 + 1) * (y2 - y1 + 1); }
+    };
+
+    dirty_region(const size_t max_rects = 16U);
+
+    void add(rect area);
+    void clear() { m_rects.clear(); }
+
+    const std::vector<rect> &rects() const { return m_rects; }
+    int32_t area() const;
+
+private:
+    static rect join(const rect &first, const rect &second);
+    static bool overlaps(const rect &first, const rect &second);
+
+    const size_t m_max_rects;
+    std::vector<rect> m_rects;
+};
\ No newline at end of file
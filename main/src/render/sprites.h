@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <lvgl.h>
+
+constexpr size_t BALL_SPRITE_COUNT = 8U;
+constexpr int32_t BALL_SPRITE_SIZE = 30;
+
+// pre-decoded in the display's native format, generated from main/sprites/ball_*.png at
+// build time by scripts/sprite_atlas.py.
+extern const lv_img_dsc_t ball_sprites[BALL_SPRITE_COUNT];
+
+inline const void *ball_sprite(const uint8_t index)
+{
+    return &ball_sprites[index % BALL_SPRITE_COUNT];
+}
\ No newline at end of file
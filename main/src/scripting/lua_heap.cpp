@@ -0,0 +1,228 @@
+#include "lua_heap.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "profile/profiler.h"
+
+constexpr const size_t SLAB_SIZE = 4096U;
+constexpr const size_t SLAB_HEADER = 8U;
+constexpr const int GC_PAUSE = 200;
+constexpr const int GC_STEP_SIZE = 10;
+constexpr const size_t GC_MINIMUM_GROWTH = 16U * 1024U;
+
+lua_heap::lua_heap(const size_t limit, memory_account &memory, const memory_placement placement) : m_memory(memory),
+                                                                                                   m_placement(placement)
+{
+    m_counters.limit = limit;
+}
+
+lua_heap::~lua_heap()
+{
+    while (mp_slabs)
+    {
+        void *next = *static_cast<void **>(mp_slabs);
+
+        m_memory.release(mp_slabs, SLAB_SIZE);
+
+        mp_slabs = next;
+    }
+}
+
+void *lua_heap::allocate(void *user_data, void *pointer, size_t old_size, size_t new_size)
+{
+    auto &heap = *static_cast<lua_heap *>(user_data);
+    auto &counters = heap.m_counters;
+
+    // without a block old_size only tells the type of object being created.
+    if (!pointer)
+        old_size = 0;
+
+    if (!new_size)
+    {
+        if (pointer)
+        {
+            heap.release(pointer, old_size);
+
+            counters.in_use -= old_size;
+        }
+
+        return nullptr;
+    }
+
+    const size_t old_class = class_index(old_size);
+    const size_t new_class = class_index(new_size);
+    void *allocated = nullptr;
+
+    if (pointer && old_class == new_class && new_class < CLASS_COUNT)
+        allocated = pointer;
+    else if (pointer && old_class == CLASS_COUNT && new_class == CLASS_COUNT)
+    {
+        if (new_size <= old_size || heap.reserve(new_size - old_size))
+            allocated = heap.m_memory.reallocate(pointer, old_size, new_size, heap.m_placement);
+
+        if (allocated)
+        {
+            counters.large += new_size - old_size;
+            counters.peak_reserved = std::max(counters.peak_reserved, heap.reserved());
+        }
+    }
+    // lua expects shrinking to always succeed, even when that takes a new slab.
+    else if ((allocated = heap.acquire(new_size, pointer && new_size < old_size)) && pointer)
+    {
+        memcpy(allocated, pointer, std::min(old_size, new_size));
+
+        heap.release(pointer, old_size);
+    }
+
+    if (!allocated)
+    {
+        counters.failures++;
+
+        return nullptr;
+    }
+
+    if (!pointer)
+        counters.allocations++;
+
+    counters.in_use += new_size - old_size;
+    counters.peak = std::max(counters.peak, counters.in_use);
+
+    return allocated;
+}
+
+void lua_heap::attach(lua_State *state)
+{
+    m_state = state;
+
+    // small incremental steps so collect() can check the time often.
+    lua_gc(m_state, LUA_GCINC, GC_PAUSE, 0, GC_STEP_SIZE);
+    lua_gc(m_state, LUA_GCSTOP);
+
+    m_collect_at = m_counters.in_use + GC_MINIMUM_GROWTH;
+}
+
+void lua_heap::collect(const int64_t budget)
+{
+    if (!m_state || budget <= 0)
+        return;
+
+    if (!m_collecting)
+    {
+        if (m_counters.in_use < m_collect_at)
+            return;
+
+        m_collecting = true;
+    }
+
+    PROFILE_SCOPE(gc);
+
+    const int64_t started_at = profiler::now();
+    int64_t now = started_at;
+
+    do
+    {
+        // steps still run while automatic collection is stopped.
+        const bool finished = lua_gc(m_state, LUA_GCSTEP, 0);
+
+        now = profiler::now();
+
+        if (finished)
+        {
+            m_collecting = false;
+            m_collect_at = std::max(m_counters.in_use / 100U * GC_PAUSE, m_counters.in_use + GC_MINIMUM_GROWTH);
+            m_counters.cycles++;
+
+            break;
+        }
+    } while (now - started_at < budget);
+
+    m_counters.last_pause = now - started_at;
+    m_counters.max_pause = std::max(m_counters.max_pause, m_counters.last_pause);
+}
+
+bool lua_heap::reserve(const size_t size)
+{
+    return reserved() + size <= m_counters.limit;
+}
+
+size_t lua_heap::class_index(const size_t size)
+{
+    for (size_t i = 0; i < CLASS_COUNT; i++)
+        if (size <= CLASS_SIZES[i])
+            return i;
+
+    return CLASS_COUNT;
+}
+
+void *lua_heap::acquire(const size_t size, const bool is_shrinking)
+{
+    const size_t index = class_index(size);
+
+    if (index == CLASS_COUNT)
+    {
+        void *allocated = reserve(size) ? m_memory.allocate(size, m_placement) : nullptr;
+
+        if (allocated)
+        {
+            m_counters.large += size;
+            m_counters.peak_reserved = std::max(m_counters.peak_reserved, reserved());
+        }
+
+        return allocated;
+    }
+
+    if (!m_free[index] && !grow(index, is_shrinking))
+        return nullptr;
+
+    block *acquired = m_free[index];
+
+    m_free[index] = acquired->next;
+
+    return acquired;
+}
+
+void lua_heap::release(void *pointer, const size_t size)
+{
+    const size_t index = class_index(size);
+
+    if (index == CLASS_COUNT)
+    {
+        m_memory.release(pointer, size);
+
+        m_counters.large -= size;
+
+        return;
+    }
+
+    auto released = static_cast<block *>(pointer);
+
+    released->next = m_free[index];
+    m_free[index] = released;
+}
+
+bool lua_heap::grow(const size_t index, const bool is_shrinking)
+{
+    const size_t block_size = CLASS_SIZES[index];
+    auto slab = is_shrinking || reserve(SLAB_SIZE) ? static_cast<uint8_t *>(m_memory.allocate(SLAB_SIZE, m_placement)) : nullptr;
+
+    if (!slab)
+        return false;
+
+    // slabs are chained through their header and only returned when the heap goes away.
+    *reinterpret_cast<void **>(slab) = mp_slabs;
+    mp_slabs = slab;
+
+    m_counters.slabs += SLAB_SIZE;
+    m_counters.peak_reserved = std::max(m_counters.peak_reserved, reserved());
+
+    for (size_t offset = SLAB_HEADER; offset + block_size <= SLAB_SIZE; offset += block_size)
+    {
+        auto added = reinterpret_cast<block *>(slab + offset);
+
+        added->next = m_free[index];
+        m_free[index] = added;
+    }
+
+    return true;
+}
\ No newline at end of file
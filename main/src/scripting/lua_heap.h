@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include <lua.hpp>
+
+#include "memory/memory_account.h"
+
+// dedicated heap for one lua state. small blocks come from size class pools carved out
+// of slabs booked to the given account, larger ones straight from that account. the limit
+// applies to what it took from the account, slabs are never given back, so a new slab or
+// large block that doesn't fit fails, lua then runs an emergency collection to refill the
+// pools before raising a memory error. the collector never runs on its own, collect()
+// steps it from idle time.
+class lua_heap
+{
+public:
+    struct counters
+    {
+        size_t in_use;
+        size_t peak;
+        size_t limit;
+        size_t slabs;
+        size_t large;
+        size_t peak_reserved;
+        uint32_t allocations;
+        uint32_t failures;
+        uint32_t cycles;
+        int64_t last_pause;
+        int64_t max_pause;
+    };
+
+    lua_heap(const size_t limit, memory_account &memory, const memory_placement placement);
+    ~lua_heap();
+
+    lua_heap(const lua_heap &) = delete;
+    lua_heap &operator=(const lua_heap &) = delete;
+
+    static void *allocate(void *user_data, void *pointer, size_t old_size, size_t new_size);
+
+    // stops automatic collection, must be called once the state exists.
+    void attach(lua_State *state);
+
+    // steps the collector for at most budget microseconds, a new cycle only starts once
+    // the heap grew well past what survived the last one.
+    void collect(const int64_t budget);
+
+    const counters &statistics() const { return m_counters; }
+
+private:
+    static constexpr size_t CLASS_COUNT = 8U;
+    static constexpr std::array<size_t, CLASS_COUNT> CLASS_SIZES = {16U, 24U, 32U, 48U, 64U, 96U, 128U, 256U};
+
+    struct block
+    {
+        block *next;
+    };
+
+    static size_t class_index(const size_t size);
+
+    // bytes taken from the account, what the limit applies to.
+    size_t reserved() const { return m_counters.slabs + m_counters.large; }
+    bool reserve(const size_t size);
+
+    void *acquire(const size_t size, const bool is_shrinking);
+    void release(void *pointer, const size_t size);
+    bool grow(const size_t index, const bool is_shrinking);
+
+    memory_account &m_memory;
+    const memory_placement m_placement;
+    std::array<block *, CLASS_COUNT> m_free = {};
+    void *mp_slabs = nullptr;
+    lua_State *m_state = nullptr;
+    bool m_collecting = false;
+    size_t m_collect_at = 0;
+    counters m_counters = {};
+};
\ No newline at end of file
@@ -0,0 +1,411 @@
+#include "message_bindings.h"
+
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#include <esp_log.h>
+
+constexpr const char *TAG = "message_bindings";
+constexpr const char *VIEW_METATABLE = "rclink.message_view";
+constexpr const char *BUILDER_METATABLE = "rclink.message_builder";
+constexpr const UBaseType_t INBOX_LENGTH = 8U;
+
+message_bindings::message_bindings(lua_State *state, data_stream &stream, scheduler &tasks) : m_state(state),
+                                                                                           m_stream(stream),
+                                                                                           m_scheduler(tasks),
+                                                                                           m_inbox(xQueueCreate(INBOX_LENGTH, sizeof(tlvcpp::tlv_tree_node *)))
+{
+    // every function gets this object as its only upvalue.
+    const luaL_Reg view_methods[] = {
+        {"tag", view_tag},
+        {"length", view_length},
+        {"value", view_value},
+        {"u8", view_u8},
+        {"u16", view_u16},
+        {"u32", view_u32},
+        {"i32", view_i32},
+        {"f32", view_f32},
+        {"child", view_child},
+        {"find", view_find},
+        {"__len", view_count},
+        {nullptr, nullptr},
+    };
+
+    luaL_newmetatable(m_state, VIEW_METATABLE);
+    lua_pushlightuserdata(m_state, this);
+    luaL_setfuncs(m_state, view_methods, 1);
+    lua_pushvalue(m_state, -1);
+    lua_setfield(m_state, -2, "__index");
+    lua_pop(m_state, 1);
+
+    const luaL_Reg builder_methods[] = {
+        {"add", builder_add},
+        {"__gc", builder_gc},
+        {nullptr, nullptr},
+    };
+
+    luaL_newmetatable(m_state, BUILDER_METATABLE);
+    lua_pushlightuserdata(m_state, this);
+    luaL_setfuncs(m_state, builder_methods, 1);
+    lua_pushvalue(m_state, -1);
+    lua_setfield(m_state, -2, "__index");
+    lua_pop(m_state, 1);
+
+    const luaL_Reg functions[] = {
+        {"on_message", on_message},
+        {"message", message},
+        {"send", send},
+        {nullptr, nullptr},
+    };
+
+    lua_pushglobaltable(m_state);
+    lua_pushlightuserdata(m_state, this);
+    luaL_setfuncs(m_state, functions, 1);
+    lua_pop(m_state, 1);
+
+    // the top level view is reused for every message, handlers that only look at the
+    // top level node don't allocate at all.
+    auto root = static_cast<view *>(lua_newuserdatauv(m_state, sizeof(view), 0));
+
+    *root = {nullptr, 0};
+
+    luaL_setmetatable(m_state, VIEW_METATABLE);
+
+    m_root_view = luaL_ref(m_state, LUA_REGISTRYINDEX);
+}
+
+message_bindings::~message_bindings()
+{
+    tlvcpp::tlv_tree_node *pending = nullptr;
+
+    while (xQueueReceive(m_inbox, &pending, 0))
+        delete pending;
+
+    for (const auto &handler : m_handlers)
+        luaL_unref(m_state, LUA_REGISTRYINDEX, handler.second);
+
+    luaL_unref(m_state, LUA_REGISTRYINDEX, m_root_view);
+
+    vQueueDelete(m_inbox);
+}
+
+bool message_bindings::post(tlvcpp::tlv_tree_node &&node)
+{
+    auto received = new tlvcpp::tlv_tree_node(std::move(node));
+
+    if (!xQueueSend(m_inbox, &received, 0))
+    {
+        delete received;
+
+        m_dropped++;
+
+        return false;
+    }
+
+    return true;
+}
+
+void message_bindings::dispatch()
+{
+    tlvcpp::tlv_tree_node *received = nullptr;
+
+    while (xQueueReceive(m_inbox, &received, 0))
+    {
+        for (const auto &child : received->children())
+            handle(child);
+
+        delete received;
+    }
+}
+
+void message_bindings::handle(const tlvcpp::tlv_tree_node &node)
+{
+    const uint32_t tag = node.data().tag();
+
+    if (m_scheduler.waiting_for(tag))
+    {
+        size_t size = 0;
+
+        m_serialized.clear();
+
+        if (node.serialize(m_serialized, &size))
+            m_scheduler.post(tag, m_serialized.data(), m_serialized.size());
+    }
+
+    const auto handler = m_handlers.find(tag);
+
+    if (handler == m_handlers.end())
+        return;
+
+    lua_rawgeti(m_state, LUA_REGISTRYINDEX, handler->second);
+    lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_root_view);
+
+    // the registry keeps the root view alive, its memory doesn't move.
+    auto root = static_cast<view *>(lua_touserdata(m_state, -1));
+
+    *root = {&node, m_generation};
+
+    if (lua_pcall(m_state, 1, 0, 0) != LUA_OK)
+    {
+        const char *error = lua_tostring(m_state, -1);
+
+        ESP_LOGE(TAG, "handler for tag %lu: %s", tag, error ? error : "unknown error");
+
+        lua_pop(m_state, 1);
+    }
+
+    // every view handed out for this node is stale from here on, the root view doesn't even
+    // keep pointing at it in case the generation wraps around.
+    *root = {nullptr, 0};
+    m_generation++;
+    m_handled++;
+}
+
+message_bindings &message_bindings::from(lua_State *state)
+{
+    return *static_cast<message_bindings *>(lua_touserdata(state, lua_upvalueindex(1)));
+}
+
+const tlvcpp::tlv_tree_node &message_bindings::check_view(lua_State *state, const int index)
+{
+    const auto checked = static_cast<view *>(luaL_checkudata(state, index, VIEW_METATABLE));
+
+    if (!checked->node || checked->generation != from(state).m_generation)
+        luaL_error(state, "message view used outside of its handler");
+
+    return *checked->node;
+}
+
+tlvcpp::tlv_tree_node &message_bindings::check_builder(lua_State *state, const int index)
+{
+    const auto checked = static_cast<builder *>(luaL_checkudata(state, index, BUILDER_METATABLE));
+
+    if (!checked->node)
+        luaL_error(state, "message builder was already used");
+
+    return *checked->node;
+}
+
+void message_bindings::push_view(lua_State *state, const tlvcpp::tlv_tree_node &node)
+{
+    auto pushed = static_cast<view *>(lua_newuserdatauv(state, sizeof(view), 0));
+
+    *pushed = {&node, from(state).m_generation};
+
+    luaL_setmetatable(state, VIEW_METATABLE);
+}
+
+int message_bindings::on_message(lua_State *state)
+{
+    auto &self = from(state);
+    const auto tag = static_cast<uint32_t>(luaL_checkinteger(state, 1));
+    const auto existing = self.m_handlers.find(tag);
+
+    if (existing != self.m_handlers.end())
+    {
+        luaL_unref(state, LUA_REGISTRYINDEX, existing->second);
+
+        self.m_handlers.erase(existing);
+    }
+
+    if (lua_isnoneornil(state, 2))
+        return 0;
+
+    luaL_checktype(state, 2, LUA_TFUNCTION);
+    lua_settop(state, 2);
+
+    self.m_handlers[tag] = luaL_ref(state, LUA_REGISTRYINDEX);
+
+    return 0;
+}
+
+int message_bindings::message(lua_State *state)
+{
+    const auto tag = static_cast<uint32_t>(luaL_checkinteger(state, 1));
+    size_t length = 0;
+    const char *value = luaL_optlstring(state, 2, "", &length);
+
+    auto created = static_cast<builder *>(lua_newuserdatauv(state, sizeof(builder), 0));
+
+    created->node = nullptr;
+
+    luaL_setmetatable(state, BUILDER_METATABLE);
+
+    created->node = new tlvcpp::tlv_tree_node(tag, length, reinterpret_cast<const uint8_t *>(value));
+
+    return 1;
+}
+
+int message_bindings::send(lua_State *state)
+{
+    auto &node = check_builder(state, 1);
+    auto &self = from(state);
+
+    // sent as a child of an untagged root like every other message, the node is moved
+    // back afterwards so the builder can be sent again.
+    tlvcpp::tlv_tree_node root;
+    auto &child = root.add_child();
+
+    child = std::move(node);
+
+    self.m_stream << root;
+
+    node = std::move(child);
+
+    return 0;
+}
+
+int message_bindings::view_tag(lua_State *state)
+{
+    lua_pushinteger(state, check_view(state, 1).data().tag());
+
+    return 1;
+}
+
+int message_bindings::view_length(lua_State *state)
+{
+    lua_pushinteger(state, check_view(state, 1).data().length());
+
+    return 1;
+}
+
+int message_bindings::view_value(lua_State *state)
+{
+    const auto &data = check_view(state, 1).data();
+
+    lua_pushlstring(state, reinterpret_cast<const char *>(data.value()), data.length());
+
+    return 1;
+}
+
+template <typename T>
+static int read_value(lua_State *state, const tlvcpp::tlv &data)
+{
+    // offsets are 1 based like the rest of lua.
+    const lua_Integer offset = luaL_optinteger(state, 2, 1) - 1;
+
+    if (offset < 0 || static_cast<size_t>(offset) + sizeof(T) > data.length())
+        return luaL_argerror(state, 2, "out of range");
+
+    T value;
+
+    memcpy(&value, data.value() + offset, sizeof(T));
+
+    if constexpr (std::is_floating_point_v<T>)
+        lua_pushnumber(state, value);
+    else
+        lua_pushinteger(state, value);
+
+    return 1;
+}
+
+int message_bindings::view_u8(lua_State *state)
+{
+    return read_value<uint8_t>(state, check_view(state, 1).data());
+}
+
+int message_bindings::view_u16(lua_State *state)
+{
+    return read_value<uint16_t>(state, check_view(state, 1).data());
+}
+
+int message_bindings::view_u32(lua_State *state)
+{
+    return read_value<uint32_t>(state, check_view(state, 1).data());
+}
+
+int message_bindings::view_i32(lua_State *state)
+{
+    return read_value<int32_t>(state, check_view(state, 1).data());
+}
+
+int message_bindings::view_f32(lua_State *state)
+{
+    return read_value<float>(state, check_view(state, 1).data());
+}
+
+int message_bindings::view_count(lua_State *state)
+{
+    lua_pushinteger(state, check_view(state, 1).children().size());
+
+    return 1;
+}
+
+int message_bindings::view_child(lua_State *state)
+{
+    const auto &node = check_view(state, 1);
+    const lua_Integer index = luaL_checkinteger(state, 2);
+
+    if (index < 1 || static_cast<size_t>(index) > node.children().size())
+    {
+        lua_pushnil(state);
+
+        return 1;
+    }
+
+    push_view(state, *std::next(node.children().begin(), index - 1));
+
+    return 1;
+}
+
+int message_bindings::view_find(lua_State *state)
+{
+    const auto &node = check_view(state, 1);
+    const auto tag = static_cast<uint32_t>(luaL_checkinteger(state, 2));
+
+    for (const auto &child : node.children())
+        if (child.data().tag() == tag)
+        {
+            push_view(state, child);
+
+            return 1;
+        }
+
+    lua_pushnil(state);
+
+    return 1;
+}
+
+int message_bindings::builder_add(lua_State *state)
+{
+    auto &node = check_builder(state, 1);
+
+    // a nested builder is moved in with its own tag and can't be used on its own anymore.
+    if (luaL_testudata(state, 2, BUILDER_METATABLE))
+    {
+        auto nested = static_cast<builder *>(lua_touserdata(state, 2));
+
+        if (!nested->node || nested->node == &node)
+            return luaL_argerror(state, 2, "builder can't be nested");
+
+        node.add_child() = std::move(*nested->node);
+
+        delete nested->node;
+
+        nested->node = nullptr;
+    }
+    else
+    {
+        const auto tag = static_cast<uint32_t>(luaL_checkinteger(state, 2));
+        size_t length = 0;
+        const char *value = luaL_checklstring(state, 3, &length);
+
+        node.add_child(tag, length, reinterpret_cast<const uint8_t *>(value));
+    }
+
+    lua_settop(state, 1);
+
+    return 1;
+}
+
+int message_bindings::builder_gc(lua_State *state)
+{
+    auto collected = static_cast<builder *>(luaL_checkudata(state, 1, BUILDER_METATABLE));
+
+    delete collected->node;
+
+    collected->node = nullptr;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <lua.hpp>
+#include <tlvcpp/tlv_tree.h>
+
+#include "data_stream.h"
+#include "scheduler.h"
+
+// lua side of the data stream. on_message(tag, handler) registers a handler that gets a
+// view over the received node, the view reads tags and values in place and is only valid
+// during the call. message(tag, value) returns a builder, builder:add(tag, value) or
+// builder:add(nested) appends children and send(builder) serializes it into the stream.
+class message_bindings
+{
+public:
+    message_bindings(lua_State *state, data_stream &stream, scheduler &tasks);
+    ~message_bindings();
+
+    // takes over a received tree from any task, handlers run on the next dispatch().
+    bool post(tlvcpp::tlv_tree_node &&node);
+
+    void dispatch();
+
+    uint32_t handled() const { return m_handled; }
+    uint32_t dropped() const { return m_dropped.load(); }
+
+private:
+    struct view
+    {
+        const tlvcpp::tlv_tree_node *node;
+        uint32_t generation;
+    };
+
+    struct builder
+    {
+        tlvcpp::tlv_tree_node *node;
+    };
+
+    static message_bindings &from(lua_State *state);
+    static const tlvcpp::tlv_tree_node &check_view(lua_State *state, const int index);
+    static tlvcpp::tlv_tree_node &check_builder(lua_State *state, const int index);
+    static void push_view(lua_State *state, const tlvcpp::tlv_tree_node &node);
+
+    static int on_message(lua_State *state);
+    static int message(lua_State *state);
+    static int send(lua_State *state);
+
+    static int view_tag(lua_State *state);
+    static int view_length(lua_State *state);
+    static int view_value(lua_State *state);
+    static int view_u8(lua_State *state);
+    static int view_u16(lua_State *state);
+    static int view_u32(lua_State *state);
+    static int view_i32(lua_State *state);
+    static int view_f32(lua_State *state);
+    static int view_count(lua_State *state);
+    static int view_child(lua_State *state);
+    static int view_find(lua_State *state);
+
+    static int builder_add(lua_State *state);
+    static int builder_gc(lua_State *state);
+
+    void handle(const tlvcpp::tlv_tree_node &node);
+
+    lua_State *m_state;
+    data_stream &m_stream;
+    scheduler &m_scheduler;
+    QueueHandle_t m_inbox;
+    std::unordered_map<uint32_t, int> m_handlers;
+    int m_root_view = LUA_NOREF;
+    uint32_t m_generation = 1;
+    uint32_t m_handled = 0;
+    std::atomic<uint32_t> m_dropped = 0;
+    std::vector<uint8_t> m_serialized;
+};
\ No newline at end of file
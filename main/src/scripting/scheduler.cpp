@@ -0,0 +1,285 @@
+#include "scheduler.h"
+
+#include <cstring>
+
+#include <esp_log.h>
+
+#include "profile/profiler.h"
+
+constexpr const char *TAG = "scheduler";
+constexpr const UBaseType_t MAILBOX_LENGTH = 16U;
+constexpr const int HOOK_INSTRUCTIONS = 1000;
+
+scheduler::scheduler(lua_State *state) : m_state(state),
+                                         m_mailbox(xQueueCreate(MAILBOX_LENGTH, sizeof(message)))
+{
+    // threads copy the main thread's extra space, so every coroutine can find us.
+    *static_cast<scheduler **>(lua_getextraspace(m_state)) = this;
+
+    lua_register(m_state, "spawn", spawn);
+    lua_register(m_state, "wait", wait);
+    lua_register(m_state, "next_frame", next_frame);
+    lua_register(m_state, "receive", receive);
+}
+
+scheduler::~scheduler()
+{
+    for (const auto &entry : m_tasks)
+        luaL_unref(m_state, LUA_REGISTRYINDEX, entry.reference);
+
+    vQueueDelete(m_mailbox);
+}
+
+bool scheduler::post(const uint32_t tag, const uint8_t *data, const size_t size)
+{
+    if (size > MESSAGE_SIZE)
+        return false;
+
+    message posted = {
+        .tag = tag,
+        .size = static_cast<uint16_t>(size),
+        .data = {},
+    };
+
+    memcpy(posted.data, data, size);
+
+    if (!xQueueSend(m_mailbox, &posted, 0))
+    {
+        m_dropped_messages++;
+
+        return false;
+    }
+
+    return true;
+}
+
+bool scheduler::waiting_for(const uint32_t tag) const
+{
+    for (const auto &entry : m_tasks)
+        if (!entry.dead && entry.waiting == wait_type::message && entry.tag == tag)
+            return true;
+
+    return false;
+}
+
+void scheduler::run(const int64_t budget)
+{
+    PROFILE_SCOPE(scripts);
+
+    const int64_t started_at = profiler::now();
+
+    m_deadline = started_at + budget;
+    m_frame++;
+
+    deliver_messages();
+    wake(started_at);
+
+    const size_t count = m_tasks.size();
+
+    // round robin from where the last frame ran out of budget.
+    for (size_t i = 0; i < count && profiler::now() < m_deadline; i++)
+    {
+        const size_t index = (m_next + i) % count;
+
+        if (!m_tasks[index].dead && m_tasks[index].waiting == wait_type::none)
+        {
+            resume(index);
+
+            m_next = index + 1;
+        }
+    }
+
+    collect();
+}
+
+scheduler &scheduler::from(lua_State *state)
+{
+    return **static_cast<scheduler **>(lua_getextraspace(state));
+}
+
+int scheduler::spawn(lua_State *state)
+{
+    luaL_checktype(state, 1, LUA_TFUNCTION);
+
+    auto &self = from(state);
+    const int arguments = lua_gettop(state) - 1;
+    lua_State *thread = lua_newthread(state);
+
+    lua_insert(state, 1);
+    lua_xmove(state, thread, arguments + 1);
+
+    const task spawned = {
+        .thread = thread,
+        .reference = luaL_ref(state, LUA_REGISTRYINDEX),
+        .arguments = arguments,
+        .dead = false,
+        .waiting = wait_type::none,
+        .wake_at = 0,
+        .frame = 0,
+        .tag = 0,
+        .statistics = {
+            .id = self.m_next_id++,
+            .resumes = 0,
+            .preemptions = 0,
+            .cpu_time = 0,
+        },
+    };
+
+    self.m_tasks.push_back(spawned);
+
+    lua_pushinteger(state, spawned.statistics.id);
+
+    return 1;
+}
+
+int scheduler::wait(lua_State *state)
+{
+    const lua_Integer milliseconds = luaL_checkinteger(state, 1);
+
+    lua_pushinteger(state, static_cast<lua_Integer>(wait_type::timer));
+    lua_pushinteger(state, milliseconds);
+
+    return lua_yield(state, 2);
+}
+
+int scheduler::next_frame(lua_State *state)
+{
+    lua_pushinteger(state, static_cast<lua_Integer>(wait_type::frame));
+
+    return lua_yield(state, 1);
+}
+
+int scheduler::receive(lua_State *state)
+{
+    const lua_Integer tag = luaL_checkinteger(state, 1);
+
+    lua_pushinteger(state, static_cast<lua_Integer>(wait_type::message));
+    lua_pushinteger(state, tag);
+
+    return lua_yield(state, 2);
+}
+
+void scheduler::budget_hook(lua_State *state, lua_Debug *)
+{
+    auto &self = from(state);
+
+    // coroutines a task creates inherit the hook, yielding those would hand the preemption
+    // to the task's own coroutine.resume() or wrap() iterator instead of to us.
+    if (state != self.m_running)
+        return;
+
+    // e.g. inside a pcall or a c function, the task gets stopped at the next chance.
+    if (profiler::now() < self.m_deadline || !lua_isyieldable(state))
+        return;
+
+    self.m_preempted = true;
+
+    lua_yield(state, 0);
+}
+
+void scheduler::deliver_messages()
+{
+    message received;
+
+    // messages nobody is waiting for are discarded.
+    while (xQueueReceive(m_mailbox, &received, 0))
+        for (auto &entry : m_tasks)
+            if (!entry.dead && entry.waiting == wait_type::message && entry.tag == received.tag)
+            {
+                lua_pushlstring(entry.thread, reinterpret_cast<const char *>(received.data), received.size);
+
+                entry.arguments = 1;
+                entry.waiting = wait_type::none;
+            }
+}
+
+void scheduler::wake(const int64_t now)
+{
+    for (auto &entry : m_tasks)
+        if ((entry.waiting == wait_type::timer && now >= entry.wake_at) ||
+            (entry.waiting == wait_type::frame && m_frame != entry.frame))
+            entry.waiting = wait_type::none;
+}
+
+void scheduler::resume(const size_t index)
+{
+    lua_State *thread = m_tasks[index].thread;
+    const int arguments = m_tasks[index].arguments;
+
+    m_preempted = false;
+    m_running = thread;
+
+    lua_sethook(thread, budget_hook, LUA_MASKCOUNT, HOOK_INSTRUCTIONS);
+
+    const int64_t started_at = profiler::now();
+    int results = 0;
+    const int status = lua_resume(thread, m_state, arguments, &results);
+
+    m_running = nullptr;
+
+    // spawn() may have grown the vector while the task was running.
+    auto &resumed = m_tasks[index];
+
+    resumed.arguments = 0;
+    resumed.statistics.cpu_time += profiler::now() - started_at;
+    resumed.statistics.resumes++;
+
+    if (status == LUA_OK)
+    {
+        resumed.dead = true;
+
+        return;
+    }
+
+    if (status != LUA_YIELD)
+    {
+        const char *error = lua_tostring(thread, -1);
+
+        ESP_LOGE(TAG, "task %lu: %s", resumed.statistics.id, error ? error : "unknown error");
+
+        resumed.dead = true;
+
+        return;
+    }
+
+    if (m_preempted)
+    {
+        resumed.statistics.preemptions++;
+
+        return;
+    }
+
+    // a bare coroutine.yield() just waits for the next frame.
+    const auto waiting = results ? static_cast<wait_type>(lua_tointeger(thread, -results)) : wait_type::frame;
+    const lua_Integer argument = results > 1 ? lua_tointeger(thread, -results + 1) : 0;
+
+    lua_pop(thread, results);
+
+    resumed.waiting = waiting;
+
+    if (waiting == wait_type::timer)
+        resumed.wake_at = profiler::now() + argument * 1000;
+    else if (waiting == wait_type::frame)
+        resumed.frame = m_frame;
+    else if (waiting == wait_type::message)
+        resumed.tag = argument;
+    else
+    {
+        resumed.waiting = wait_type::frame;
+        resumed.frame = m_frame;
+    }
+}
+
+void scheduler::collect()
+{
+    for (size_t i = m_tasks.size(); i > 0; i--)
+        if (m_tasks[i - 1].dead)
+        {
+            luaL_unref(m_state, LUA_REGISTRYINDEX, m_tasks[i - 1].reference);
+
+            m_tasks.erase(m_tasks.begin() + (i - 1));
+
+            if (m_next >= i)
+                m_next--;
+        }
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <lua.hpp>
+
+// cooperative scheduler for lua coroutines. scripts spawn() tasks that wait(ms),
+// next_frame() or receive(tag), run() resumes whatever is ready until the frame budget
+// is spent, an instruction count hook preempts tasks that overrun it and they carry on
+// first thing next frame.
+class scheduler
+{
+public:
+    struct task_statistics
+    {
+        uint32_t id;
+        uint32_t resumes;
+        uint32_t preemptions;
+        int64_t cpu_time;
+    };
+
+    static constexpr size_t MESSAGE_SIZE = 128U;
+
+    scheduler(lua_State *state);
+    ~scheduler();
+
+    // safe from any task, the message is handed to lua on the next run().
+    bool post(const uint32_t tag, const uint8_t *data, const size_t size);
+
+    // whether any task is blocked in receive(tag), lets callers skip serializing for nobody.
+    bool waiting_for(const uint32_t tag) const;
+
+    void run(const int64_t budget);
+
+    size_t size() const { return m_tasks.size(); }
+    uint32_t dropped_messages() const { return m_dropped_messages; }
+
+    template <typename callback_type>
+    void for_each_task(callback_type &&callback) const
+    {
+        for (const auto &entry : m_tasks)
+            callback(entry.statistics);
+    }
+
+private:
+    enum class wait_type : uint8_t
+    {
+        none,
+        timer,
+        frame,
+        message,
+    };
+
+    struct task
+    {
+        lua_State *thread;
+        int reference;
+        int arguments;
+        bool dead;
+        wait_type waiting;
+        int64_t wake_at;
+        uint32_t frame;
+        uint32_t tag;
+        task_statistics statistics;
+    };
+
+    struct message
+    {
+        uint32_t tag;
+        uint16_t size;
+        uint8_t data[MESSAGE_SIZE];
+    };
+
+    static scheduler &from(lua_State *state);
+    static int spawn(lua_State *state);
+    static int wait(lua_State *state);
+    static int next_frame(lua_State *state);
+    static int receive(lua_State *state);
+    static void budget_hook(lua_State *state, lua_Debug *debug);
+
+    void deliver_messages();
+    void wake(const int64_t now);
+    void resume(const size_t index);
+    void collect();
+
+    lua_State *m_state;
+    QueueHandle_t m_mailbox;
+    std::vector<task> m_tasks;
+    size_t m_next = 0;
+    uint32_t m_next_id = 1;
+    uint32_t m_frame = 0;
+    int64_t m_deadline = 0;
+    lua_State *m_running = nullptr;
+    bool m_preempted = false;
+    std::atomic<uint32_t> m_dropped_messages = 0;
+};
\ No newline at end of file
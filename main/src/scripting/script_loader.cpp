@@ -0,0 +1,174 @@
+#include "script_loader.h"
+
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <mbedtls/sha256.h>
+
+constexpr const char *TAG = "script_loader";
+constexpr const size_t SHA256_SIZE = 32U;
+constexpr const size_t HASH_HEX_SIZE = 2U * SHA256_SIZE + 1U;
+
+static bool read_file(const std::string &path, std::string &content)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+
+    if (!file)
+        return false;
+
+    char buffer[512];
+    size_t read = 0;
+
+    content.clear();
+
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        content.append(buffer, read);
+
+    fclose(file);
+
+    return true;
+}
+
+static bool write_file(const std::string &path, const void *data, const size_t size)
+{
+    const std::string temporary_path = path + ".tmp";
+
+    FILE *file = fopen(temporary_path.c_str(), "wb");
+
+    if (!file)
+        return false;
+
+    const bool written = fwrite(data, 1, size, file) == size;
+
+    if (fclose(file) || !written || rename(temporary_path.c_str(), path.c_str()))
+    {
+        remove(temporary_path.c_str());
+
+        return false;
+    }
+
+    return true;
+}
+
+// streams the file through the hash, the source itself is never held in memory.
+static bool hash_file(const char *path, char *hex)
+{
+    constexpr const char digits[] = "0123456789abcdef";
+
+    FILE *file = fopen(path, "rb");
+
+    if (!file)
+        return false;
+
+    mbedtls_sha256_context context;
+    unsigned char buffer[512];
+    uint8_t digest[SHA256_SIZE];
+    size_t read = 0;
+
+    mbedtls_sha256_init(&context);
+    mbedtls_sha256_starts(&context, 0);
+
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        mbedtls_sha256_update(&context, buffer, read);
+
+    const bool failed = ferror(file);
+
+    fclose(file);
+
+    mbedtls_sha256_finish(&context, digest);
+    mbedtls_sha256_free(&context);
+
+    if (failed)
+        return false;
+
+    for (size_t i = 0; i < SHA256_SIZE; i++)
+    {
+        hex[2 * i] = digits[digest[i] >> 4];
+        hex[2 * i + 1] = digits[digest[i] & 0x0F];
+    }
+
+    hex[2 * SHA256_SIZE] = '\0';
+
+    return true;
+}
+
+static void update_cache(const sol::protected_function &chunk, const std::string &bytecode_path, const std::string &hash_path, const char *hash)
+{
+    const sol::bytecode bytecode = chunk.dump();
+    const auto view = bytecode.as_string_view();
+
+    // the hash goes last, a cache without a matching hash is never trusted.
+    remove(hash_path.c_str());
+
+    if (!write_file(bytecode_path, view.data(), view.size()) || !write_file(hash_path, hash, strlen(hash)))
+        ESP_LOGW(TAG, "failed to cache %s!", bytecode_path.c_str());
+}
+
+bool run_script(sol::state &state, const char *path)
+{
+    const int64_t started_at = esp_timer_get_time();
+    const std::string bytecode_path = std::string(path) + "c";
+    const std::string hash_path = bytecode_path + ".sha256";
+
+    std::string cached_hash;
+    char hash[HASH_HEX_SIZE] = "";
+
+    const bool has_source = hash_file(path, hash);
+    const bool fresh = read_file(hash_path, cached_hash) && cached_hash == hash;
+
+    sol::protected_function chunk;
+    bool from_cache = false;
+
+    if (fresh || !has_source)
+    {
+        sol::load_result loaded = state.load_file(bytecode_path, sol::load_mode::binary);
+
+        if (loaded.valid())
+        {
+            chunk = loaded;
+            from_cache = true;
+        }
+        else if (has_source)
+            ESP_LOGW(TAG, "stale or incompatible %s, falling back to source.", bytecode_path.c_str());
+    }
+
+    if (!from_cache)
+    {
+        if (!has_source)
+            return false;
+
+        // lua streams the source in through a buffer of its own.
+        sol::load_result loaded = state.load_file(path, sol::load_mode::text);
+
+        if (!loaded.valid())
+        {
+            const sol::error error = loaded;
+
+            ESP_LOGE(TAG, "%s", error.what());
+
+            return false;
+        }
+
+        chunk = loaded;
+
+        update_cache(chunk, bytecode_path, hash_path, hash);
+    }
+
+    ESP_LOGI(TAG, "loaded %s from %s in %lld us", path, from_cache ? "bytecode" : "source", esp_timer_get_time() - started_at);
+
+    const sol::protected_function_result result = chunk();
+
+    if (!result.valid())
+    {
+        const sol::error error = result;
+
+        ESP_LOGE(TAG, "%s", error.what());
+
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <sol/sol.hpp>
+
+// runs a lua script from its bytecode cache (<path>c) when the cache was compiled from the
+// current source, otherwise compiles the source and refreshes the cache for the next boot.
+bool run_script(sol::state &state, const char *path);
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+// exponential moving average seeded with the first sample, so there is no warm up and
+// no need for a burst of reads at startup. a weight of 1 passes samples through.
+class sensor_filter
+{
+public:
+    sensor_filter(const float weight = 1.0f) : m_weight(weight) {}
+
+    float apply(const float sample)
+    {
+        if (!m_seeded)
+        {
+            m_state = sample;
+            m_seeded = true;
+        }
+        else
+            m_state += m_weight * (sample - m_state);
+
+        return m_state;
+    }
+
+private:
+    float m_weight;
+    float m_state = 0.0f;
+    bool m_seeded = false;
+};
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "sensor_service.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "task_config.h"
+
+struct sensor_sample
+{
+    uint8_t sensor;
+    int32_t value;
+} __attribute__((packed));
+
+sensor_service::sensor_service(data_stream &stream) : m_stream(stream)
+{
+}
+
+sensor_service::~sensor_service()
+{
+    if (m_task)
+        vTaskDelete(m_task);
+}
+
+void sensor_service::add(const sensor id, config configuration)
+{
+    auto &added = m_slots[static_cast<size_t>(id)];
+
+    added.filter = sensor_filter(configuration.weight);
+    added.configuration = std::move(configuration);
+}
+
+void sensor_service::start()
+{
+    if (!m_task)
+        xTaskCreatePinnedToCore(sensor_task, "sensor_worker", SENSOR_TASK.stack_size, this, SENSOR_TASK.priority, &m_task, SENSOR_TASK.core);
+}
+
+void sensor_service::sensor_task(void *argument)
+{
+    auto &service = *static_cast<sensor_service *>(argument);
+
+    while (true)
+    {
+        const TickType_t now = xTaskGetTickCount();
+        const TickType_t next = service.sample(now);
+
+        vTaskDelay(next - now);
+    }
+}
+
+TickType_t sensor_service::sample(const TickType_t now)
+{
+    TickType_t next = now + portMAX_DELAY / 2;
+
+    for (size_t i = 0; i < static_cast<size_t>(sensor::count); i++)
+    {
+        auto &current = m_slots[i];
+
+        if (!current.configuration.read)
+            continue;
+
+        if (static_cast<int32_t>(now - current.next_sample) >= 0)
+        {
+            const auto value = static_cast<int32_t>(std::lround(current.filter.apply(current.configuration.read())));
+
+            current.value.store(value, std::memory_order_relaxed);
+            current.updates.fetch_add(1, std::memory_order_release);
+
+            if (!current.has_published || std::abs(value - current.published) >= current.configuration.threshold)
+            {
+                current.published = value;
+                current.has_published = true;
+
+                publish(static_cast<sensor>(i), value);
+            }
+
+            current.next_sample = now + std::max<TickType_t>(pdMS_TO_TICKS(current.configuration.interval), 1);
+        }
+
+        if (static_cast<int32_t>(current.next_sample - next) < 0)
+            next = current.next_sample;
+    }
+
+    return next;
+}
+
+void sensor_service::publish(const sensor id, const int32_t value)
+{
+    const sensor_sample sample = {
+        .sensor = static_cast<uint8_t>(id),
+        .value = value,
+    };
+
+    tlvcpp::tlv_tree_node node;
+
+    node.add_child(SENSOR_TAG, sizeof(sample), reinterpret_cast<const uint8_t *>(&sample));
+
+    m_stream << node;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "data_stream.h"
+#include "sensor_filter.h"
+
+enum class sensor : uint8_t
+{
+    battery,
+    count,
+};
+
+constexpr uint32_t SENSOR_TAG = 0x20;
+
+// samples every sensor on a low priority task, the latest filtered value of each one is
+// readable from any task without locking and changes beyond a threshold are published.
+class sensor_service
+{
+public:
+    struct config
+    {
+        uint32_t interval;
+        float weight;
+        int32_t threshold;
+        std::function<int32_t()> read;
+    };
+
+    sensor_service(data_stream &stream);
+    ~sensor_service();
+
+    void add(const sensor id, config configuration);
+    void start();
+
+    bool ready(const sensor id) const { return slot(id).updates.load(std::memory_order_acquire); }
+    int32_t latest(const sensor id) const { return slot(id).value.load(std::memory_order_relaxed); }
+
+private:
+    struct sensor_slot
+    {
+        std::atomic<int32_t> value = 0;
+        std::atomic<uint32_t> updates = 0;
+
+        config configuration;
+        sensor_filter filter;
+        TickType_t next_sample = 0;
+        int32_t published = 0;
+        bool has_published = false;
+    };
+
+    static void sensor_task(void *argument);
+
+    const sensor_slot &slot(const sensor id) const { return m_slots[static_cast<size_t>(id)]; }
+
+    TickType_t sample(const TickType_t now);
+    void publish(const sensor id, const int32_t value);
+
+    data_stream &m_stream;
+    sensor_slot m_slots[static_cast<size_t>(sensor::count)];
+    TaskHandle_t m_task = nullptr;
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "dispatch_worker.h"
+
+#include "task_config.h"
+
+constexpr const uint32_t DISPATCH_POLL_INTERVAL = 100U;
+
+dispatch_worker::dispatch_worker(data_stream &stream, handler on_received) : m_stream(stream),
+                                                                            m_on_received(std::move(on_received))
+{
+}
+
+dispatch_worker::~dispatch_worker()
+{
+    if (m_task)
+        vTaskDelete(m_task);
+}
+
+void dispatch_worker::start()
+{
+    if (!m_task)
+        xTaskCreatePinnedToCore(dispatch_task, "dispatch_worker", DISPATCH_TASK.stack_size, this, DISPATCH_TASK.priority, &m_task, DISPATCH_TASK.core);
+}
+
+void dispatch_worker::poll()
+{
+    tlvcpp::tlv_tree_node received;
+
+    m_stream >> received;
+
+    if (received.data().tag() || received.children().size())
+        m_on_received(std::move(received), m_stream);
+}
+
+void dispatch_worker::dispatch_task(void *argument)
+{
+    auto &worker = *static_cast<dispatch_worker *>(argument);
+
+    while (true)
+    {
+        worker.poll();
+
+        vTaskDelay(pdMS_TO_TICKS(DISPATCH_POLL_INTERVAL));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <functional>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <tlvcpp/tlv_tree.h>
+
+#include "data_stream.h"
+
+// polls a data stream on its own task and hands every received tree to the handler along
+// with the stream to answer on. only depends on freertos and the data_stream interface,
+// so it runs against any stream, not just the websocket.
+class dispatch_worker
+{
+public:
+    using handler = std::function<void(tlvcpp::tlv_tree_node &&received, data_stream &stream)>;
+
+    dispatch_worker(data_stream &stream, handler on_received);
+    ~dispatch_worker();
+
+    void start();
+
+    // one receive and handle round, what the task runs every poll interval.
+    void poll();
+
+private:
+    static void dispatch_task(void *argument);
+
+    data_stream &m_stream;
+    handler m_on_received;
+    TaskHandle_t m_task = nullptr;
+};
\ No newline at end of file
@@ -1,5 +1,11 @@
 #include "http_server.h"
 
+#include <array>
+#include <atomic>
+#include <vector>
+#include <cerrno>
+#include <dirent.h>
+#include <strings.h>
 #include <sys/stat.h>
 
 #include <esp_err.h>
@@ -9,65 +15,194 @@
 #include <esp_ota_ops.h>
 #include <esp_timer.h>
 #include <esp_rom_md5.h>
+#include <mbedtls/sha256.h>
+
+#include "lock_guard.h"
+#include "memory/memory_account.h"
+#include "metrics/metrics.h"
+#include "ota_pipeline.h"
+#include "inflate_stream.h"
+#include "patch_stream.h"
+#include "profile/histogram.h"
+#include "profile/task_report.h"
+#include "tar_extractor.h"
+#include "task_config.h"
+
+#define STRINGIFY_VALUE(value) #value
+#define STRINGIFY(value) STRINGIFY_VALUE(value)
 
 constexpr const char *TAG = "http_server";
-constexpr const UBaseType_t SERVER_CORE_ID = 1U;
-constexpr const UBaseType_t SERVER_PRIORITY = 5U;
-constexpr const uint32_t SERVER_STACK_SIZE = 8U * 1024U;
-constexpr const UBaseType_t WORKER_COUNT = 4U;
-constexpr const uint32_t WORKER_STACK_SIZE = 4U * 1024U;
+constexpr const UBaseType_t WORKER_COUNT = CONFIG_RCLINK_HTTP_WORKER_COUNT;
+constexpr const UBaseType_t QUEUE_LENGTH = CONFIG_RCLINK_HTTP_QUEUE_LENGTH;
+constexpr const char *RETRY_AFTER = STRINGIFY(CONFIG_RCLINK_HTTP_RETRY_AFTER);
+constexpr const size_t OTA_BUFFER_SIZE = CONFIG_RCLINK_OTA_BUFFER_SIZE;
+constexpr const size_t OTA_BUFFER_COUNT = CONFIG_RCLINK_OTA_BUFFER_COUNT;
+constexpr const size_t OTA_PROGRESS_STEPS = 10U;
+constexpr const size_t FLASH_SECTOR_SIZE = 4U * 1024U;
+constexpr const size_t METRICS_CHUNK_SIZE = 512U;
+constexpr const size_t TASK_REPORT_TEXT_SIZE = 2U * 1024U;
+constexpr const std::array<uint32_t, 7> LATENCY_BOUNDS = {1000U, 5000U, 20000U, 100000U, 500000U, 2000000U, 10000000U};
+
+static_assert(OTA_BUFFER_SIZE % FLASH_SECTOR_SIZE == 0, "ota buffers should be flash sector aligned");
+
+enum request_priority : uint8_t
+{
+    PRIORITY_HIGH,
+    PRIORITY_LOW,
+    PRIORITY_COUNT,
+};
+
+constexpr const request_priority ROUTE_PRIORITIES[] = {
+    PRIORITY_HIGH, // route::file
+    PRIORITY_LOW,  // route::upload
+    PRIORITY_LOW,  // route::firmware
+};
+
+static_assert(sizeof(ROUTE_PRIORITIES) / sizeof(ROUTE_PRIORITIES[0]) == static_cast<size_t>(http_server::route::count));
+
+constexpr const char *REQUESTS_HELP = "Requests handled by the workers.";
+
+// indexed by route, then by whether the handler succeeded.
+static metric_counter requests_handled[][2] = {
+    {{"rclink_http_requests_total", REQUESTS_HELP, "route=\"file\",result=\"ok\""},
+     {"rclink_http_requests_total", REQUESTS_HELP, "route=\"file\",result=\"error\""}},
+    {{"rclink_http_requests_total", REQUESTS_HELP, "route=\"upload\",result=\"ok\""},
+     {"rclink_http_requests_total", REQUESTS_HELP, "route=\"upload\",result=\"error\""}},
+    {{"rclink_http_requests_total", REQUESTS_HELP, "route=\"firmware\",result=\"ok\""},
+     {"rclink_http_requests_total", REQUESTS_HELP, "route=\"firmware\",result=\"error\""}},
+};
+
+static_assert(sizeof(requests_handled) / sizeof(requests_handled[0]) == static_cast<size_t>(http_server::route::count));
+
+static memory_account http_memory("http");
+static lock_profile statistics_lock("http_statistics");
+static metric_counter requests_rejected("rclink_http_rejected_total", "Requests answered with 503 because the queue was full.");
+static metric_gauge queue_depth_gauge("rclink_http_queue_depth", "Requests waiting for a worker.");
+static metric_histogram wait_time_histogram("rclink_http_queue_wait_us", "Time requests spent queued for a worker.", LATENCY_BOUNDS);
+static metric_histogram service_time_histogram("rclink_http_service_us", "Time workers spent handling a request.", LATENCY_BOUNDS);
+static metric_counter ota_bytes("rclink_ota_received_bytes_total", "Firmware bytes received.");
+static metric_gauge ota_throughput("rclink_ota_throughput_kib_per_second", "Throughput of the running or last firmware update.");
 
 struct http_server_implementation
 {
-    SemaphoreHandle_t workers_semaphore;
-    QueueHandle_t requests_queue;
+    SemaphoreHandle_t pending_semaphore;
+    SemaphoreHandle_t statistics_semaphore;
+    QueueHandle_t requests_queues[PRIORITY_COUNT];
     TaskHandle_t workers[WORKER_COUNT];
+    std::atomic<size_t> busy_workers;
     bool is_running;
     httpd_handle_t handle;
     std::string base_path;
+    http_server::statistics statistics;
+    histogram wait_times[static_cast<size_t>(http_server::route::count)];
+    histogram service_times[static_cast<size_t>(http_server::route::count)];
 };
 
 using request_handler = esp_err_t (*)(httpd_req_t *);
 
+enum class firmware_format : uint8_t
+{
+    image,
+    patch,
+};
+
 struct request_context
 {
     httpd_req_t *request;
     request_handler handler;
+    http_server::route route;
+    int64_t submitted_at;
 };
 
+static void record_served(http_server_implementation &server_impl, const request_context &request, const esp_err_t result, const int64_t started_at, const int64_t finished_at)
+{
+    const auto wait_time = static_cast<uint32_t>(started_at - request.submitted_at);
+    const auto service_time = static_cast<uint32_t>(finished_at - started_at);
+
+    requests_handled[static_cast<size_t>(request.route)][result != ESP_OK].add();
+    wait_time_histogram.observe(wait_time);
+    service_time_histogram.observe(service_time);
+
+    lock_guard guard(server_impl.statistics_semaphore, statistics_lock);
+
+    const auto route = static_cast<size_t>(request.route);
+    auto &route_stats = server_impl.statistics.routes[route];
+
+    server_impl.wait_times[route].record(wait_time);
+    server_impl.service_times[route].record(service_time);
+
+    route_stats.served++;
+    route_stats.wait_time_us += wait_time;
+    route_stats.max_wait_time_us = std::max(route_stats.max_wait_time_us, wait_time);
+    route_stats.service_time_us += service_time;
+    route_stats.max_service_time_us = std::max(route_stats.max_service_time_us, service_time);
+}
+
+static bool receive_request(http_server_implementation &server_impl, request_context &request)
+{
+    for (const auto queue : server_impl.requests_queues)
+        if (xQueueReceive(queue, &request, 0))
+            return true;
+
+    return false;
+}
+
 static void request_worker_task(void *argument)
 {
     const auto server_impl = static_cast<http_server_implementation *>(argument);
 
     while (true)
     {
-        xSemaphoreGive(server_impl->workers_semaphore);
+        if (!xSemaphoreTake(server_impl->pending_semaphore, portMAX_DELAY))
+            continue;
+
+        server_impl->busy_workers++;
 
         request_context request;
 
-        if (xQueueReceive(server_impl->requests_queue, &request, portMAX_DELAY))
+        if (receive_request(*server_impl, request))
         {
-            request.handler(request.request);
+            const auto started_at = esp_timer_get_time();
+
+            queue_depth_gauge.add(-1);
+
+            const esp_err_t result = request.handler(request.request);
 
             httpd_req_async_handler_complete(request.request);
+
+            record_served(*server_impl, request, result, started_at, esp_timer_get_time());
         }
+
+        server_impl->busy_workers--;
     }
 }
 
 static void start_workers(http_server_implementation &server_impl)
 {
     server_impl.is_running = true;
-    server_impl.workers_semaphore = xSemaphoreCreateCounting(WORKER_COUNT, 0);
-    server_impl.requests_queue = xQueueCreate(WORKER_COUNT, sizeof(request_context));
+    server_impl.busy_workers = 0;
+    server_impl.statistics = {};
+
+    for (size_t i = 0; i < static_cast<size_t>(http_server::route::count); i++)
+    {
+        server_impl.wait_times[i] = {};
+        server_impl.service_times[i] = {};
+    }
+
+    server_impl.pending_semaphore = xSemaphoreCreateCounting(PRIORITY_COUNT * QUEUE_LENGTH, 0);
+    server_impl.statistics_semaphore = xSemaphoreCreateMutex();
+
+    for (auto &queue : server_impl.requests_queues)
+        queue = xQueueCreate(QUEUE_LENGTH, sizeof(request_context));
 
     for (size_t i = 0; i < WORKER_COUNT; i++)
         xTaskCreatePinnedToCore(request_worker_task,
                                 "request_worker",
-                                WORKER_STACK_SIZE,
+                                HTTP_WORKER_TASK.stack_size,
                                 &server_impl,
-                                SERVER_PRIORITY,
+                                HTTP_WORKER_TASK.priority,
                                 &server_impl.workers[i],
-                                SERVER_CORE_ID);
+                                HTTP_WORKER_TASK.core);
 }
 
 static void stop_workers(http_server_implementation &server_impl)
@@ -76,17 +211,20 @@ static void stop_workers(http_server_implementation &server_impl)
 
     request_context request;
 
-    while (xQueueReceive(server_impl.requests_queue, &request, pdMS_TO_TICKS(100)))
+    while (receive_request(server_impl, request))
         httpd_req_async_handler_complete(request.request);
 
-    while (uxSemaphoreGetCount(server_impl.workers_semaphore) != WORKER_COUNT)
+    while (server_impl.busy_workers)
         vTaskDelay(pdMS_TO_TICKS(100));
 
     for (size_t i = 0; i < WORKER_COUNT; i++)
         vTaskDelete(server_impl.workers[i]);
 
-    vQueueDelete(server_impl.requests_queue);
-    vSemaphoreDelete(server_impl.workers_semaphore);
+    for (const auto queue : server_impl.requests_queues)
+        vQueueDelete(queue);
+
+    vSemaphoreDelete(server_impl.statistics_semaphore);
+    vSemaphoreDelete(server_impl.pending_semaphore);
 }
 
 static bool is_on_worker(const http_server_implementation &server_impl)
@@ -100,19 +238,63 @@ static bool is_on_worker(const http_server_implementation &server_impl)
     return false;
 }
 
-static esp_err_t submit_work(const http_server_implementation &server_impl, httpd_req_t *request, request_handler handler)
+static size_t queue_depth(const http_server_implementation &server_impl)
+{
+    size_t depth = 0;
+
+    for (const auto queue : server_impl.requests_queues)
+        depth += uxQueueMessagesWaiting(queue);
+
+    return depth;
+}
+
+static esp_err_t reject_request(http_server_implementation &server_impl, httpd_req_t *request)
+{
+    requests_rejected.add();
+
+    {
+        lock_guard guard(server_impl.statistics_semaphore, statistics_lock);
+
+        server_impl.statistics.rejected++;
+    }
+
+    httpd_resp_set_status(request, "503 Service Unavailable");
+    httpd_resp_set_hdr(request, "Retry-After", RETRY_AFTER);
+    httpd_resp_send(request, nullptr, 0);
+
+    return ESP_OK;
+}
+
+// runs on the httpd task only, so checking for space and sending can't race with another submitter.
+static esp_err_t submit_work(http_server_implementation &server_impl, httpd_req_t *request, request_handler handler, const http_server::route route)
 {
-    xSemaphoreTake(server_impl.workers_semaphore, portMAX_DELAY);
+    const auto queue = server_impl.requests_queues[ROUTE_PRIORITIES[static_cast<size_t>(route)]];
+
+    if (!uxQueueSpacesAvailable(queue))
+        return reject_request(server_impl, request);
 
     request_context request_ctx = {
         .request = nullptr,
         .handler = handler,
+        .route = route,
+        .submitted_at = esp_timer_get_time(),
     };
 
-    if (auto error = httpd_req_async_handler_begin(request, &request_ctx.request) != ESP_OK)
+    if (esp_err_t error = httpd_req_async_handler_begin(request, &request_ctx.request); error != ESP_OK)
         return error;
 
-    xQueueSend(server_impl.requests_queue, &request_ctx, portMAX_DELAY);
+    xQueueSend(queue, &request_ctx, 0);
+    xSemaphoreGive(server_impl.pending_semaphore);
+
+    queue_depth_gauge.add(1);
+
+    {
+        lock_guard guard(server_impl.statistics_semaphore, statistics_lock);
+
+        auto &statistics = server_impl.statistics;
+
+        statistics.max_queue_depth = std::max(statistics.max_queue_depth, queue_depth(server_impl));
+    }
 
     return ESP_OK;
 }
@@ -150,14 +332,14 @@ static esp_err_t get_index_handler(httpd_req_t *request)
 
 static esp_err_t add_content_type(httpd_req_t *request, const char *file_path)
 {
-    char *file_name = strrchr(file_path, '/');
+    const char *file_name = strrchr(file_path, '/');
 
     if (!file_name)
         return ESP_FAIL;
 
     file_name++;
 
-    char *file_extension = strchr(file_name, '.');
+    const char *file_extension = strchr(file_name, '.');
 
     if (!file_extension)
         return httpd_resp_set_type(request, "application/octet-stream");
@@ -193,7 +375,7 @@ static esp_err_t get_handler(httpd_req_t *request)
     if (!is_on_worker(*server_impl))
     {
         if (server_impl->is_running)
-            return submit_work(*server_impl, request, get_handler);
+            return submit_work(*server_impl, request, get_handler, http_server::route::file);
         else
             return ESP_FAIL;
     }
@@ -270,32 +452,117 @@ static esp_err_t get_handler(httpd_req_t *request)
     return ESP_OK;
 }
 
-static bool calculate_md5(const char *file_path, uint8_t *digest)
+class ota_flash_writer : public flash_writer
 {
-    FILE *file = fopen(file_path, "r");
+public:
+    ota_flash_writer(esp_ota_handle_t handle) : m_handle(handle) {}
 
-    if (!file)
-        return false;
+    bool write(const uint8_t *data, size_t size) override
+    {
+        return esp_ota_write(m_handle, data, size) == ESP_OK;
+    }
+
+private:
+    esp_ota_handle_t m_handle;
+};
+
+class partition_source : public patch_source
+{
+public:
+    partition_source(const esp_partition_t *partition) : mp_partition(partition) {}
+
+    size_t size() const override
+    {
+        return mp_partition->size;
+    }
 
-    md5_context_t context;
+    bool read(size_t offset, uint8_t *data, size_t size) override
+    {
+        return esp_partition_read(mp_partition, offset, data, size) == ESP_OK;
+    }
 
-    esp_rom_md5_init(&context);
+private:
+    const esp_partition_t *mp_partition;
+};
 
+static bool receive_firmware(httpd_req_t *request, stream_sink &head, ota_pipeline &pipeline)
+{
     uint8_t buffer[1024U];
-    size_t read_bytes = 0;
+    const bool is_direct = &head == &pipeline;
+    const size_t total_bytes = request->content_len;
+    const int64_t started_at = esp_timer_get_time();
+    size_t remaining_bytes = total_bytes;
+    size_t reported_steps = 0;
 
-    while ((read_bytes = fread(buffer, 1, sizeof(buffer), file)))
-        esp_rom_md5_update(&context, buffer, read_bytes);
+    while (remaining_bytes)
+    {
+        size_t available = sizeof(buffer);
+        uint8_t *destination = is_direct ? pipeline.acquire(available) : buffer;
 
-    esp_rom_md5_final(digest, &context);
+        int received_bytes = httpd_req_recv(request, reinterpret_cast<char *>(destination), std::min(remaining_bytes, available));
 
-    fclose(file);
+        // zero bytes means the client closed the connection, it won't send the rest.
+        if (received_bytes <= 0)
+        {
+            if (received_bytes == HTTPD_SOCK_ERR_TIMEOUT)
+                continue;
+
+            ESP_LOGE(TAG, "error while receiving: %d", received_bytes);
+
+            return false;
+        }
+
+        if (!(is_direct ? pipeline.commit(received_bytes) : head.write(buffer, received_bytes)))
+        {
+            ESP_LOGE(TAG, "error while writing firmware!");
+
+            return false;
+        }
+
+        remaining_bytes -= received_bytes;
+
+        ota_bytes.add(received_bytes);
+
+        const size_t steps = ((total_bytes - remaining_bytes) * OTA_PROGRESS_STEPS) / total_bytes;
+
+        if (steps != reported_steps)
+        {
+            const int64_t elapsed = std::max(esp_timer_get_time() - started_at, static_cast<int64_t>(1));
+            const int64_t throughput = ((total_bytes - remaining_bytes) * 1000000LL) / (elapsed * 1024LL);
+
+            ota_throughput.set(static_cast<int32_t>(throughput));
+
+            ESP_LOGI(TAG, "firmware update: %zu%%, received: %zu, written: %zu, %lld KiB/s",
+                     (steps * 100U) / OTA_PROGRESS_STEPS,
+                     total_bytes - remaining_bytes,
+                     pipeline.bytes_written(),
+                     throughput);
+
+            reported_steps = steps;
+        }
+    }
 
     return true;
 }
 
-static esp_err_t update_firmware(httpd_req_t *request)
+static esp_err_t update_firmware(httpd_req_t *request, const firmware_format format)
 {
+    char content_encoding[16] = {};
+
+    httpd_req_get_hdr_value_str(request, "Content-Encoding", content_encoding, sizeof(content_encoding));
+
+    const bool is_deflated = !strcmp(content_encoding, "deflate");
+
+    if (*content_encoding && !is_deflated && strcmp(content_encoding, "identity"))
+    {
+        httpd_resp_set_status(request, "415 Unsupported Media Type");
+        httpd_resp_send(request, nullptr, 0);
+
+        ESP_LOGE(TAG, "unsupported content encoding: %s", content_encoding);
+
+        return ESP_FAIL;
+    }
+
     const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
 
     if (!update_partition)
@@ -321,43 +588,50 @@ static esp_err_t update_firmware(httpd_req_t *request)
     }
 
     {
-        uint8_t buffer[1024U];
-        size_t remaining_bytes = request->content_len;
+        ota_flash_writer writer(update_handle);
+        ota_pipeline pipeline(writer, http_memory, OTA_BUFFER_SIZE, OTA_BUFFER_COUNT);
+        partition_source source(esp_ota_get_running_partition());
 
-        while (remaining_bytes)
+        if (pipeline.failed())
         {
-            int received_bytes = httpd_req_recv(request, reinterpret_cast<char *>(buffer), std::min(remaining_bytes, static_cast<size_t>(sizeof(buffer))));
+            httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
 
-            if (received_bytes < 0)
-            {
-                if (received_bytes == HTTPD_SOCK_ERR_TIMEOUT)
-                    continue;
+            esp_ota_abort(update_handle);
 
-                httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
+            return ESP_FAIL;
+        }
 
-                ESP_LOGE(TAG, "error while receiving: %d", received_bytes);
+        stream_sink *head = &pipeline;
+        std::unique_ptr<patch_stream> patcher;
+        std::unique_ptr<inflate_stream> inflater;
 
-                esp_ota_abort(update_handle);
+        if (format == firmware_format::patch)
+        {
+            patcher = std::make_unique<patch_stream>(source, *head);
+            head = patcher.get();
+        }
 
-                return ESP_FAIL;
-            }
+        if (is_deflated)
+        {
+            inflater = std::make_unique<inflate_stream>(*head, http_memory);
+            head = inflater.get();
+        }
 
-            if (received_bytes && (esp_ota_write(update_handle, buffer, received_bytes) != ESP_OK))
-            {
-                httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
+        const bool received = receive_firmware(request, *head, pipeline) && head->finish();
 
-                ESP_LOGE(TAG, "error while writing firmware, aborting update...");
+        if (!pipeline.finish() || !received)
+        {
+            httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
 
-                esp_ota_abort(update_handle);
+            ESP_LOGE(TAG, "firmware wasn't received completely, aborting update...");
 
-                return ESP_FAIL;
-            }
+            esp_ota_abort(update_handle);
 
-            remaining_bytes -= received_bytes;
+            return ESP_FAIL;
         }
     }
 
-    if (esp_err_t error = esp_ota_end(update_handle) != ESP_OK)
+    if (esp_err_t error = esp_ota_end(update_handle); error != ESP_OK)
     {
         httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
 
@@ -417,9 +691,70 @@ static esp_err_t update_firmware(httpd_req_t *request)
     return ESP_OK;
 }
 
+static void to_hex(const uint8_t *data, const size_t size, char *hex)
+{
+    constexpr const char digits[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hex[2 * i] = digits[data[i] >> 4];
+        hex[2 * i + 1] = digits[data[i] & 0x0F];
+    }
+
+    hex[2 * size] = '\0';
+}
+
+static bool receive_file(httpd_req_t *request, FILE *file, md5_context_t &md5_context, mbedtls_sha256_context &sha256_context)
+{
+    uint8_t buffer[1024U];
+    size_t remaining_bytes = request->content_len;
+
+    while (remaining_bytes)
+    {
+        int received_bytes = httpd_req_recv(request, reinterpret_cast<char *>(buffer), std::min(remaining_bytes, static_cast<size_t>(sizeof(buffer))));
+
+        if (received_bytes <= 0)
+        {
+            if (received_bytes == HTTPD_SOCK_ERR_TIMEOUT)
+                continue;
+
+            ESP_LOGE(TAG, "error while receiving: %d", received_bytes);
+
+            return false;
+        }
+
+        if (fwrite(buffer, 1, received_bytes, file) != received_bytes)
+        {
+            ESP_LOGE(TAG, "error while writing file!");
+
+            return false;
+        }
+
+        esp_rom_md5_update(&md5_context, buffer, received_bytes);
+        mbedtls_sha256_update(&sha256_context, buffer, received_bytes);
+
+        remaining_bytes -= received_bytes;
+    }
+
+    return true;
+}
+
+// the upload goes to a temporary file which replaces the original only once it's complete,
+// so readers never see a partial file and a failed upload leaves the original intact.
 static esp_err_t persist_file(httpd_req_t *request, const char *file_path)
 {
-    FILE *file = fopen(file_path, "w");
+    char temporary_path[CONFIG_LITTLEFS_OBJ_NAME_LEN];
+
+    if (snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", file_path) >= static_cast<int>(sizeof(temporary_path)))
+    {
+        httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
+
+        ESP_LOGE(TAG, "file path is too long: %s", file_path);
+
+        return ESP_FAIL;
+    }
+
+    FILE *file = fopen(temporary_path, "w");
 
     if (!file)
     {
@@ -428,70 +763,306 @@ static esp_err_t persist_file(httpd_req_t *request, const char *file_path)
         return ESP_FAIL;
     }
 
+    const int64_t started_at = esp_timer_get_time();
+
+    md5_context_t md5_context;
+    mbedtls_sha256_context sha256_context;
+
+    esp_rom_md5_init(&md5_context);
+    mbedtls_sha256_init(&sha256_context);
+    mbedtls_sha256_starts(&sha256_context, 0);
+
+    const bool received = receive_file(request, file, md5_context, sha256_context);
+
+    if (fclose(file) || !received || rename(temporary_path, file_path))
     {
-        uint8_t buffer[1024U];
-        size_t remaining_bytes = request->content_len;
+        mbedtls_sha256_free(&sha256_context);
+        unlink(temporary_path);
 
-        while (remaining_bytes)
+        httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
+
+        ESP_LOGE(TAG, "couldn't persist file: %s", file_path);
+
+        return ESP_FAIL;
+    }
+
+    uint8_t md5_digest[16];
+    uint8_t sha256_digest[32];
+    char sha256_hex[2 * sizeof(sha256_digest) + 1];
+
+    esp_rom_md5_final(md5_digest, &md5_context);
+    mbedtls_sha256_finish(&sha256_context, sha256_digest);
+    mbedtls_sha256_free(&sha256_context);
+
+    to_hex(sha256_digest, sizeof(sha256_digest), sha256_hex);
+
+    ESP_LOGI(TAG, "persisted %s, %zu bytes in %lld ms", file_path, request->content_len, (esp_timer_get_time() - started_at) / 1000);
+
+    httpd_resp_set_type(request, "application/octet-stream");
+    httpd_resp_set_hdr(request, "X-Content-SHA256", sha256_hex);
+    httpd_resp_send(request, reinterpret_cast<char *>(md5_digest), sizeof(md5_digest));
+
+    return ESP_OK;
+}
+
+static bool receive_stream(httpd_req_t *request, stream_sink &sink)
+{
+    uint8_t buffer[1024U];
+    size_t remaining_bytes = request->content_len;
+
+    while (remaining_bytes)
+    {
+        int received_bytes = httpd_req_recv(request, reinterpret_cast<char *>(buffer), std::min(remaining_bytes, static_cast<size_t>(sizeof(buffer))));
+
+        if (received_bytes <= 0)
         {
-            int received_bytes = httpd_req_recv(request, reinterpret_cast<char *>(buffer), std::min(remaining_bytes, static_cast<size_t>(sizeof(buffer))));
+            if (received_bytes == HTTPD_SOCK_ERR_TIMEOUT)
+                continue;
+
+            ESP_LOGE(TAG, "error while receiving: %d", received_bytes);
+
+            return false;
+        }
 
-            if (received_bytes < 0)
-            {
-                if (received_bytes == HTTPD_SOCK_ERR_TIMEOUT)
-                    continue;
+        if (!sink.write(buffer, received_bytes))
+            return false;
 
-                fclose(file);
-                unlink(file_path);
+        remaining_bytes -= received_bytes;
+    }
+
+    return true;
+}
+
+static bool remove_directory(const std::string &path)
+{
+    DIR *directory = opendir(path.c_str());
+
+    if (!directory)
+        return errno == ENOENT;
+
+    std::vector<std::string> entries;
+
+    while (const dirent *entry = readdir(directory))
+        if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, ".."))
+            entries.emplace_back(path + '/' + entry->d_name);
+
+    closedir(directory);
 
-                httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
+    bool removed = true;
 
-                ESP_LOGE(TAG, "error while receiving: %d", received_bytes);
+    for (const auto &entry : entries)
+    {
+        struct stat entry_stat;
 
-                return ESP_FAIL;
-            }
+        if (stat(entry.c_str(), &entry_stat) || (S_ISDIR(entry_stat.st_mode) ? !remove_directory(entry) : unlink(entry.c_str())))
+            removed = false;
+    }
 
-            if (received_bytes && (fwrite(buffer, 1, received_bytes, file) != received_bytes))
-            {
-                fclose(file);
-                unlink(file_path);
+    return !rmdir(path.c_str()) && removed;
+}
+
+// a power loss between the two renames of a deploy leaves only the backup, it's put back
+// before anything is served.
+static void restore_bundle(const std::string &base_path)
+{
+    if (base_path.empty())
+        return;
 
-                httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
+    const std::string backup_path = base_path + ".old";
+    struct stat path_stat;
 
-                ESP_LOGE(TAG, "error while writing file: %s", file_path);
+    if (!stat(base_path.c_str(), &path_stat) || stat(backup_path.c_str(), &path_stat))
+        return;
 
-                return ESP_FAIL;
-            }
+    if (rename(backup_path.c_str(), base_path.c_str()))
+        ESP_LOGE(TAG, "couldn't restore the previous bundle: %s", backup_path.c_str());
+    else
+        ESP_LOGW(TAG, "restored the previous bundle from an interrupted deploy");
+}
 
-            remaining_bytes -= received_bytes;
+// extracts the bundle next to the web root and swaps it in once the manifest checks out.
+// littlefs can't rename over a non-empty directory, so the swap is two renames and the
+// previous root is put back if the second one fails.
+static esp_err_t deploy_bundle(httpd_req_t *request, const std::string &base_path, const bool is_gzip_file)
+{
+    char content_encoding[16] = {};
+    char manifest_hash[2 * sizeof(tar_extractor::digest) + 1] = {};
+
+    httpd_req_get_hdr_value_str(request, "Content-Encoding", content_encoding, sizeof(content_encoding));
+    httpd_req_get_hdr_value_str(request, "X-Manifest-SHA256", manifest_hash, sizeof(manifest_hash));
+
+    const bool is_gzip = is_gzip_file || !strcmp(content_encoding, "gzip");
+    const bool is_deflate = !strcmp(content_encoding, "deflate");
+
+    if (*content_encoding && !is_gzip && !is_deflate && strcmp(content_encoding, "identity"))
+    {
+        httpd_resp_set_status(request, "415 Unsupported Media Type");
+        httpd_resp_send(request, nullptr, 0);
+
+        ESP_LOGE(TAG, "unsupported content encoding: %s", content_encoding);
+
+        return ESP_FAIL;
+    }
+
+    const std::string staging_path = base_path + ".staging";
+    const std::string backup_path = base_path + ".old";
+
+    if (!remove_directory(staging_path) || mkdir(staging_path.c_str(), 0755))
+    {
+        httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
+
+        ESP_LOGE(TAG, "couldn't prepare the staging directory: %s", staging_path.c_str());
+
+        return ESP_FAIL;
+    }
+
+    const int64_t started_at = esp_timer_get_time();
+    tar_extractor::digest manifest_digest = {};
+    size_t file_count = 0;
+    bool is_extracted = false;
+    bool is_io_failure = false;
+
+    {
+        // its block buffer and hashing state would take a good part of the worker's stack.
+        auto extractor = std::make_unique<tar_extractor>(staging_path);
+        std::unique_ptr<inflate_stream> inflater;
+        stream_sink *head = extractor.get();
+
+        if (is_gzip || is_deflate)
+        {
+            inflater = std::make_unique<inflate_stream>(*extractor, http_memory, is_gzip ? inflate_stream::format::gzip : inflate_stream::format::zlib);
+            head = inflater.get();
         }
+
+        is_extracted = receive_stream(request, *head) && head->finish();
+        is_io_failure = extractor->io_failed();
+
+        if (const auto digest = extractor->file_digest(tar_extractor::MANIFEST_NAME))
+            manifest_digest = *digest;
+
+        file_count = extractor->file_count();
     }
 
-    fclose(file);
+    if (is_extracted && *manifest_hash)
+    {
+        char actual_hash[sizeof(manifest_hash)];
 
-    uint8_t md5_digest[16];
+        to_hex(manifest_digest.data(), manifest_digest.size(), actual_hash);
+
+        if (strcasecmp(actual_hash, manifest_hash))
+        {
+            ESP_LOGE(TAG, "manifest hash mismatch!");
+
+            is_extracted = false;
+        }
+    }
+
+    if (!is_extracted)
+    {
+        remove_directory(staging_path);
+
+        // a full or broken filesystem isn't the client's fault.
+        httpd_resp_send_err(request, is_io_failure ? HTTPD_500_INTERNAL_SERVER_ERROR : HTTPD_400_BAD_REQUEST, nullptr);
+
+        return ESP_FAIL;
+    }
+
+    remove_directory(backup_path);
 
-    if (!calculate_md5(file_path, md5_digest))
+    const bool has_previous = !rename(base_path.c_str(), backup_path.c_str());
+
+    if (rename(staging_path.c_str(), base_path.c_str()))
     {
-        unlink(file_path);
+        if (has_previous)
+            rename(backup_path.c_str(), base_path.c_str());
+
+        remove_directory(staging_path);
 
         httpd_resp_send_err(request, HTTPD_500_INTERNAL_SERVER_ERROR, nullptr);
 
-        ESP_LOGE(TAG, "error while calculating md5! file: %s", file_path);
+        ESP_LOGE(TAG, "couldn't swap in the new bundle!");
 
         return ESP_FAIL;
     }
 
+    remove_directory(backup_path);
+
+    ESP_LOGI(TAG, "deployed %zu files, %zu bytes in %lld ms", file_count, request->content_len, (esp_timer_get_time() - started_at) / 1000);
+
     httpd_resp_set_type(request, "application/octet-stream");
-    httpd_resp_send(request, reinterpret_cast<char *>(md5_digest), sizeof(md5_digest));
+    httpd_resp_send(request, reinterpret_cast<char *>(manifest_digest.data()), manifest_digest.size());
+
+    return ESP_OK;
+}
+
+// rendered on a worker straight into chunks like any other get, a slow scraper doesn't hold
+// up the httpd task.
+static esp_err_t metrics_handler(httpd_req_t *request)
+{
+    const auto server_impl = static_cast<http_server_implementation *>(request->user_ctx);
+
+    if (!is_on_worker(*server_impl))
+    {
+        if (server_impl->is_running)
+            return submit_work(*server_impl, request, metrics_handler, http_server::route::file);
+        else
+            return ESP_FAIL;
+    }
+
+    char buffer[METRICS_CHUNK_SIZE];
+
+    auto send_chunk = [request](const char *data, size_t size)
+    {
+        return httpd_resp_send_chunk(request, data, size) == ESP_OK;
+    };
+
+    metric_writer writer(buffer, sizeof(buffer), send_chunk);
+
+    httpd_resp_set_type(request, "text/plain; version=0.0.4");
+
+    if (!metric::render_all(writer))
+    {
+        httpd_resp_send_chunk(request, nullptr, 0);
+
+        return ESP_FAIL;
+    }
+
+    httpd_resp_send_chunk(request, nullptr, 0);
 
     return ESP_OK;
 }
 
+#if CONFIG_RCLINK_TASK_REPORT
+// the load shown is since the previous report, polling at a fixed rate gives steady numbers.
+static esp_err_t tasks_handler(httpd_req_t *request)
+{
+    char text[TASK_REPORT_TEXT_SIZE];
+
+    const size_t length = task_report::get().format(text, sizeof(text));
+
+    httpd_resp_set_type(request, "text/plain");
+
+    return httpd_resp_send(request, text, length);
+}
+#endif
+
+static http_server::route post_route(const char *uri)
+{
+    return strncmp(uri, "/firmware.", strlen("/firmware.")) ? http_server::route::upload : http_server::route::firmware;
+}
+
 static esp_err_t post_handler(httpd_req_t *request)
 {
     const auto server_impl = static_cast<http_server_implementation *>(request->user_ctx);
 
+    if (!is_on_worker(*server_impl))
+    {
+        if (server_impl->is_running)
+            return submit_work(*server_impl, request, post_handler, post_route(request->uri));
+        else
+            return ESP_FAIL;
+    }
+
     const auto base_path_length = server_impl->base_path.size();
     char file_path[CONFIG_LITTLEFS_OBJ_NAME_LEN] = {0};
 
@@ -517,7 +1088,11 @@ static esp_err_t post_handler(httpd_req_t *request)
     }
 
     if (!strcmp(file_name, "/firmware.bin"))
-        return update_firmware(request);
+        return update_firmware(request, firmware_format::image);
+    else if (!strcmp(file_name, "/firmware.patch"))
+        return update_firmware(request, firmware_format::patch);
+    else if (!strcmp(file_name, "/bundle.tar") || !strcmp(file_name, "/bundle.tar.gz"))
+        return deploy_bundle(request, server_impl->base_path, !strcmp(file_name, "/bundle.tar.gz"));
     else
         return persist_file(request, file_path);
 }
@@ -528,11 +1103,13 @@ http_server::http_server(const uint16_t port, const std::string &base_path) : mp
 
     mp_implementation->base_path = base_path;
 
+    restore_bundle(base_path);
+
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
 
-    config.task_priority = SERVER_PRIORITY;
-    config.stack_size = SERVER_STACK_SIZE;
-    config.core_id = SERVER_CORE_ID;
+    config.task_priority = HTTP_SERVER_TASK.priority;
+    config.stack_size = HTTP_SERVER_TASK.stack_size;
+    config.core_id = HTTP_SERVER_TASK.core;
     config.server_port = port;
     config.ctrl_port += port;
     config.max_open_sockets = std::min((2U * WORKER_COUNT) + 3U, 11U);
@@ -541,6 +1118,33 @@ http_server::http_server(const uint16_t port, const std::string &base_path) : mp
 
     ESP_ERROR_CHECK(httpd_start(&mp_implementation->handle, &config));
 
+    // registered ahead of the wildcard so it's matched first.
+    const httpd_uri_t metrics = {
+        .uri = "/metrics",
+        .method = HTTP_GET,
+        .handler = metrics_handler,
+        .user_ctx = mp_implementation.get(),
+        .is_websocket = false,
+        .handle_ws_control_frames = false,
+        .supported_subprotocol = nullptr,
+    };
+
+    ESP_ERROR_CHECK(httpd_register_uri_handler(mp_implementation->handle, &metrics));
+
+#if CONFIG_RCLINK_TASK_REPORT
+    const httpd_uri_t tasks = {
+        .uri = "/tasks",
+        .method = HTTP_GET,
+        .handler = tasks_handler,
+        .user_ctx = mp_implementation.get(),
+        .is_websocket = false,
+        .handle_ws_control_frames = false,
+        .supported_subprotocol = nullptr,
+    };
+
+    ESP_ERROR_CHECK(httpd_register_uri_handler(mp_implementation->handle, &tasks));
+#endif
+
     const httpd_uri_t get = {
         .uri = "/*",
         .method = HTTP_GET,
@@ -557,6 +1161,19 @@ http_server::http_server(const uint16_t port, const std::string &base_path) : mp
     // enables uploading file on debug builds.
     //
     // curl -X POST --data-binary @main/app/web/index.html http://192.168.4.1/index.html
+    //
+    // firmware can be sent as is, compressed or as a patch against the running image.
+    //
+    // curl -X POST --data-binary @build/RCLink.bin http://192.168.4.1/firmware.bin
+    // python3 scripts/ota_pack.py compress build/RCLink.bin RCLink.bin.z
+    // curl -X POST -H "Content-Encoding: deflate" --data-binary @RCLink.bin.z http://192.168.4.1/firmware.bin
+    // python3 scripts/ota_pack.py diff running.bin build/RCLink.bin RCLink.patch --compress
+    // curl -X POST -H "Content-Encoding: deflate" --data-binary @RCLink.patch http://192.168.4.1/firmware.patch
+    //
+    // the whole web ui can be replaced at once with a bundle.
+    //
+    // python3 scripts/pack_webui.py webui.tar.gz
+    // curl -X POST --data-binary @webui.tar.gz http://192.168.4.1/bundle.tar.gz
 
     const httpd_uri_t post = {
         .uri = "/*",
@@ -577,4 +1194,29 @@ http_server::~http_server()
     stop_workers(*mp_implementation);
 
     ESP_ERROR_CHECK(httpd_stop(mp_implementation->handle));
+}
+
+http_server::statistics http_server::get_statistics() const
+{
+    lock_guard guard(mp_implementation->statistics_semaphore, statistics_lock);
+
+    auto statistics = mp_implementation->statistics;
+
+    statistics.queue_depth = queue_depth(*mp_implementation);
+
+    for (size_t i = 0; i < static_cast<size_t>(route::count); i++)
+    {
+        const auto &wait_times = mp_implementation->wait_times[i];
+        const auto &service_times = mp_implementation->service_times[i];
+        auto &route_stats = statistics.routes[i];
+
+        route_stats.wait_time_p50_us = wait_times.percentile(50);
+        route_stats.wait_time_p90_us = wait_times.percentile(90);
+        route_stats.wait_time_p99_us = wait_times.percentile(99);
+        route_stats.service_time_p50_us = service_times.percentile(50);
+        route_stats.service_time_p90_us = service_times.percentile(90);
+        route_stats.service_time_p99_us = service_times.percentile(99);
+    }
+
+    return statistics;
 }
\ No newline at end of file
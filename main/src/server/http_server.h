@@ -2,15 +2,50 @@
 
 #include <string>
 #include <memory>
+#include <cstdint>
 
 struct http_server_implementation;
 
 class http_server
 {
 public:
+    enum class route : uint8_t
+    {
+        file,
+        upload,
+        firmware,
+        count,
+    };
+
+    // the percentiles cover the last 128 to 256 requests of the route.
+    struct route_statistics
+    {
+        uint32_t served;
+        uint64_t wait_time_us;
+        uint32_t max_wait_time_us;
+        uint32_t wait_time_p50_us;
+        uint32_t wait_time_p90_us;
+        uint32_t wait_time_p99_us;
+        uint64_t service_time_us;
+        uint32_t max_service_time_us;
+        uint32_t service_time_p50_us;
+        uint32_t service_time_p90_us;
+        uint32_t service_time_p99_us;
+    };
+
+    struct statistics
+    {
+        size_t queue_depth;
+        size_t max_queue_depth;
+        uint32_t rejected;
+        route_statistics routes[static_cast<size_t>(route::count)];
+    };
+
     http_server(const uint16_t port = 80, const std::string &base_path = "");
     ~http_server();
 
+    statistics get_statistics() const;
+
 private:
     std::unique_ptr<http_server_implementation> mp_implementation;
 };
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "inflate_stream.h"
+
+#include <algorithm>
+
+#include <esp_log.h>
+#include <miniz.h>
+
+constexpr const char *TAG = "inflate_stream";
+constexpr const size_t GZIP_TRAILER_SIZE = 8U;
+
+enum gzip_flag : uint8_t
+{
+    GZIP_FLAG_HCRC = 0x02,
+    GZIP_FLAG_EXTRA = 0x04,
+    GZIP_FLAG_NAME = 0x08,
+    GZIP_FLAG_COMMENT = 0x10,
+};
+
+inflate_stream::inflate_stream(stream_sink &next, memory_account &memory, const format stream_format) : m_next(next),
+                                                                                                          m_format(stream_format),
+                                                                                                          mp_decompressor(make_account_ptr<tinfl_decompressor>(memory, 1U, memory_placement::psram)),
+                                                                                                          mp_dictionary(make_account_ptr<uint8_t[]>(memory, TINFL_LZ_DICT_SIZE, memory_placement::psram))
+{
+    if (!mp_decompressor || !mp_dictionary)
+    {
+        ESP_LOGE(TAG, "couldn't allocate the decompressor!");
+
+        m_failed = true;
+
+        return;
+    }
+
+    tinfl_init(mp_decompressor.get());
+
+    if (m_format == format::zlib)
+        m_gzip_state = gzip_state::done;
+}
+
+inflate_stream::~inflate_stream()
+{
+}
+
+bool inflate_stream::write(const uint8_t *data, size_t size)
+{
+    if (m_gzip_state != gzip_state::done)
+    {
+        const size_t parsed = parse_gzip_header(data, size);
+
+        data += parsed;
+        size -= parsed;
+
+        if (m_failed)
+            return false;
+
+        if (!size)
+            return true;
+    }
+
+    return inflate(data, size, true);
+}
+
+bool inflate_stream::finish()
+{
+    if (m_gzip_state != gzip_state::done)
+    {
+        ESP_LOGE(TAG, "gzip header is truncated!");
+
+        return false;
+    }
+
+    if (!inflate(nullptr, 0, false))
+        return false;
+
+    return m_next.finish();
+}
+
+bool inflate_stream::inflate(const uint8_t *data, size_t size, const bool more_input)
+{
+    if (m_failed)
+        return false;
+
+    const mz_uint32 flags = (m_format == format::zlib ? TINFL_FLAG_PARSE_ZLIB_HEADER : 0) |
+                            (more_input ? TINFL_FLAG_HAS_MORE_INPUT : 0);
+
+    while (!m_done)
+    {
+        size_t input_size = size;
+        size_t output_size = TINFL_LZ_DICT_SIZE - m_dictionary_offset;
+
+        const tinfl_status status = tinfl_decompress(mp_decompressor.get(),
+                                                     data,
+                                                     &input_size,
+                                                     mp_dictionary.get(),
+                                                     mp_dictionary.get() + m_dictionary_offset,
+                                                     &output_size,
+                                                     flags);
+
+        data += input_size;
+        size -= input_size;
+
+        if (output_size && !m_next.write(mp_dictionary.get() + m_dictionary_offset, output_size))
+        {
+            m_failed = true;
+
+            return false;
+        }
+
+        m_dictionary_offset = (m_dictionary_offset + output_size) & (TINFL_LZ_DICT_SIZE - 1);
+
+        if (status == TINFL_STATUS_DONE)
+            m_done = true;
+        else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && more_input)
+            return true;
+        else if (status != TINFL_STATUS_HAS_MORE_OUTPUT)
+        {
+            ESP_LOGE(TAG, "decompression failed: %d", status);
+
+            m_failed = true;
+
+            return false;
+        }
+    }
+
+    if (size > (m_format == format::gzip ? GZIP_TRAILER_SIZE : 0))
+        ESP_LOGW(TAG, "ignoring %zu bytes after the end of the stream!", size);
+
+    return true;
+}
+
+size_t inflate_stream::parse_gzip_header(const uint8_t *data, size_t size)
+{
+    size_t parsed = 0;
+
+    while (m_gzip_state != gzip_state::done)
+    {
+        const uint8_t flags = m_gzip_header[3];
+
+        switch (m_gzip_state)
+        {
+        case gzip_state::fixed:
+            if (parsed == size)
+                return parsed;
+
+            m_gzip_header[m_gzip_filled++] = data[parsed++];
+
+            if (m_gzip_filled < sizeof(m_gzip_header))
+                break;
+
+            if (m_gzip_header[0] != 0x1F || m_gzip_header[1] != 0x8B || m_gzip_header[2] != 8)
+            {
+                ESP_LOGE(TAG, "not a gzip stream!");
+
+                m_failed = true;
+
+                return parsed;
+            }
+
+            m_gzip_filled = 0;
+            m_gzip_state = gzip_state::extra_length;
+
+            break;
+
+        case gzip_state::extra_length:
+            if (!(flags & GZIP_FLAG_EXTRA))
+            {
+                m_gzip_state = gzip_state::name;
+
+                break;
+            }
+
+            if (parsed == size)
+                return parsed;
+
+            m_gzip_skip |= static_cast<size_t>(data[parsed++]) << (8 * m_gzip_filled++);
+
+            if (m_gzip_filled == 2)
+                m_gzip_state = gzip_state::extra;
+
+            break;
+
+        case gzip_state::extra:
+        case gzip_state::header_crc:
+        {
+            const size_t skipped = std::min(m_gzip_skip, size - parsed);
+
+            parsed += skipped;
+            m_gzip_skip -= skipped;
+
+            if (m_gzip_skip)
+                return parsed;
+
+            m_gzip_state = m_gzip_state == gzip_state::extra ? gzip_state::name : gzip_state::done;
+
+            break;
+        }
+
+        case gzip_state::name:
+        case gzip_state::comment:
+        {
+            const bool is_name = m_gzip_state == gzip_state::name;
+
+            if (flags & (is_name ? GZIP_FLAG_NAME : GZIP_FLAG_COMMENT))
+            {
+                if (parsed == size)
+                    return parsed;
+
+                if (data[parsed++])
+                    break;
+            }
+
+            if (is_name)
+                m_gzip_state = gzip_state::comment;
+            else
+            {
+                m_gzip_skip = (flags & GZIP_FLAG_HCRC) ? 2U : 0U;
+                m_gzip_state = gzip_state::header_crc;
+            }
+
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    return parsed;
+}
\ No newline at end of file
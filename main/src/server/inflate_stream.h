@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+
+#include "memory/memory_account.h"
+#include "stream_sink.h"
+
+struct tinfl_decompressor_tag;
+
+class inflate_stream : public stream_sink
+{
+public:
+    enum class format : uint8_t
+    {
+        zlib,
+        gzip,
+    };
+
+    // the decompressor state and its 32 KiB window are bulk data and prefer psram.
+    inflate_stream(stream_sink &next, memory_account &memory, const format stream_format = format::zlib);
+    ~inflate_stream();
+
+    bool write(const uint8_t *data, size_t size) override;
+    bool finish() override;
+
+private:
+    enum class gzip_state : uint8_t
+    {
+        fixed,
+        extra_length,
+        extra,
+        name,
+        comment,
+        header_crc,
+        done,
+    };
+
+    size_t parse_gzip_header(const uint8_t *data, size_t size);
+    bool inflate(const uint8_t *data, size_t size, const bool more_input);
+
+    stream_sink &m_next;
+    const format m_format;
+    account_ptr<tinfl_decompressor_tag> mp_decompressor;
+    account_ptr<uint8_t[]> mp_dictionary;
+    size_t m_dictionary_offset = 0;
+    bool m_done = false;
+    bool m_failed = false;
+
+    gzip_state m_gzip_state = gzip_state::fixed;
+    uint8_t m_gzip_header[10] = {};
+    size_t m_gzip_filled = 0;
+    size_t m_gzip_skip = 0;
+};
\ No newline at end of file
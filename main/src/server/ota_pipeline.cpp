@@ -0,0 +1,195 @@
+#include "ota_pipeline.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include <esp_log.h>
+
+#include "task_config.h"
+
+constexpr const char *TAG = "ota_pipeline";
+constexpr const size_t STOP_INDEX = SIZE_MAX;
+
+ota_pipeline::ota_pipeline(flash_writer &writer, memory_account &memory, const size_t buffer_size, const size_t buffer_count) : m_writer(writer),
+                                                                                                                                m_buffer_size(buffer_size),
+                                                                                                                                m_buffer_count(buffer_count),
+                                                                                                                                mp_storage(make_account_ptr<uint8_t[]>(memory, buffer_size * buffer_count)),
+                                                                                                                                m_free_queue(xQueueCreate(buffer_count, sizeof(size_t))),
+                                                                                                                                m_write_queue(xQueueCreate(buffer_count + 1, sizeof(chunk))),
+                                                                                                                                m_done_semaphore(xSemaphoreCreateBinary())
+{
+    if (!mp_storage)
+    {
+        ESP_LOGE(TAG, "couldn't allocate %zu bytes of buffers!", buffer_size * buffer_count);
+
+        m_failed = true;
+
+        return;
+    }
+
+    if (!m_free_queue || !m_write_queue || !m_done_semaphore)
+    {
+        ESP_LOGE(TAG, "couldn't create the buffer queues!");
+
+        m_failed = true;
+
+        return;
+    }
+
+    for (size_t i = 0; i < m_buffer_count; i++)
+        xQueueSend(m_free_queue, &i, 0);
+
+    if (!xTaskCreatePinnedToCore(writer_task, "ota_writer", OTA_WRITER_TASK.stack_size, this, OTA_WRITER_TASK.priority, &m_writer_task, OTA_WRITER_TASK.core))
+    {
+        ESP_LOGE(TAG, "couldn't start the writer task!");
+
+        m_writer_task = nullptr;
+        m_failed = true;
+    }
+}
+
+ota_pipeline::~ota_pipeline()
+{
+    finish();
+
+    if (m_done_semaphore)
+        vSemaphoreDelete(m_done_semaphore);
+
+    if (m_write_queue)
+        vQueueDelete(m_write_queue);
+
+    if (m_free_queue)
+        vQueueDelete(m_free_queue);
+}
+
+uint8_t *ota_pipeline::acquire(size_t &available)
+{
+    if (!m_acquired)
+    {
+        xQueueReceive(m_free_queue, &m_current, portMAX_DELAY);
+
+        m_filled = 0;
+        m_acquired = true;
+    }
+
+    available = m_buffer_size - m_filled;
+
+    return mp_storage.get() + (m_current * m_buffer_size) + m_filled;
+}
+
+bool ota_pipeline::commit(const size_t size)
+{
+    m_filled += size;
+
+    if (m_filled == m_buffer_size)
+        dispatch();
+
+    return !m_failed;
+}
+
+bool ota_pipeline::write(const uint8_t *data, size_t size)
+{
+    if (!m_writer_task)
+        return false;
+
+    while (size)
+    {
+        size_t available = 0;
+        uint8_t *buffer = acquire(available);
+        const size_t length = std::min(size, available);
+
+        std::memcpy(buffer, data, length);
+
+        if (!commit(length))
+            return false;
+
+        data += length;
+        size -= length;
+    }
+
+    return !m_failed;
+}
+
+bool ota_pipeline::finish()
+{
+    if (m_finished)
+        return !m_failed;
+
+    // nothing was ever started that would have to be stopped.
+    if (!m_writer_task)
+    {
+        m_finished = true;
+
+        return false;
+    }
+
+    if (m_acquired)
+    {
+        if (m_filled)
+            dispatch();
+        else
+        {
+            xQueueSend(m_free_queue, &m_current, 0);
+
+            m_acquired = false;
+        }
+    }
+
+    const chunk stop = {
+        .index = STOP_INDEX,
+        .size = 0,
+    };
+
+    xQueueSend(m_write_queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(m_done_semaphore, portMAX_DELAY);
+
+    m_finished = true;
+
+    return !m_failed;
+}
+
+void ota_pipeline::dispatch()
+{
+    const chunk filled = {
+        .index = m_current,
+        .size = m_filled,
+    };
+
+    xQueueSend(m_write_queue, &filled, portMAX_DELAY);
+
+    m_acquired = false;
+}
+
+void ota_pipeline::writer_task(void *argument)
+{
+    auto &pipeline = *static_cast<ota_pipeline *>(argument);
+
+    while (true)
+    {
+        chunk filled;
+
+        if (!xQueueReceive(pipeline.m_write_queue, &filled, portMAX_DELAY))
+            continue;
+
+        if (filled.index == STOP_INDEX)
+            break;
+
+        if (!pipeline.m_failed)
+        {
+            if (pipeline.m_writer.write(pipeline.mp_storage.get() + (filled.index * pipeline.m_buffer_size), filled.size))
+                pipeline.m_bytes_written += filled.size;
+            else
+            {
+                ESP_LOGE(TAG, "flash write failed at offset: %zu", pipeline.m_bytes_written.load());
+
+                pipeline.m_failed = true;
+            }
+        }
+
+        xQueueSend(pipeline.m_free_queue, &filled.index, 0);
+    }
+
+    xSemaphoreGive(pipeline.m_done_semaphore);
+
+    vTaskDelete(nullptr);
+}
\ No newline at end of file
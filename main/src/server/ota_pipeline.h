@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "memory/memory_account.h"
+#include "stream_sink.h"
+
+class flash_writer
+{
+public:
+    virtual ~flash_writer() {}
+
+    virtual bool write(const uint8_t *data, size_t size) = 0;
+};
+
+class ota_pipeline : public stream_sink
+{
+public:
+    // failed() right away when the buffers, their queues or the writer task couldn't be
+    // created, nothing can be written then.
+    ota_pipeline(flash_writer &writer, memory_account &memory, const size_t buffer_size, const size_t buffer_count);
+    ~ota_pipeline();
+
+    uint8_t *acquire(size_t &available);
+    bool commit(const size_t size);
+    bool write(const uint8_t *data, size_t size) override;
+    bool finish() override;
+
+    bool failed() const { return m_failed; }
+    size_t bytes_written() const { return m_bytes_written; }
+
+private:
+    struct chunk
+    {
+        size_t index;
+        size_t size;
+    };
+
+    static void writer_task(void *argument);
+
+    void dispatch();
+
+    flash_writer &m_writer;
+    const size_t m_buffer_size;
+    const size_t m_buffer_count;
+    account_ptr<uint8_t[]> mp_storage;
+
+    QueueHandle_t m_free_queue;
+    QueueHandle_t m_write_queue;
+    SemaphoreHandle_t m_done_semaphore;
+    TaskHandle_t m_writer_task = nullptr;
+
+    size_t m_current = 0;
+    size_t m_filled = 0;
+    bool m_acquired = false;
+    bool m_finished = false;
+
+    std::atomic<bool> m_failed = false;
+    std::atomic<size_t> m_bytes_written = 0;
+};
\ No newline at end of file
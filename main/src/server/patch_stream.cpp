@@ -0,0 +1,266 @@
+#include "patch_stream.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include <esp_log.h>
+
+constexpr const char *TAG = "patch_stream";
+constexpr const uint8_t MAGIC[] = {'R', 'C', 'L', 'D'};
+constexpr const uint8_t VERSION = 1U;
+
+enum opcode : uint8_t
+{
+    OPCODE_END,
+    OPCODE_COPY,
+    OPCODE_INSERT,
+};
+
+static uint32_t read_u32(const uint8_t *data)
+{
+    return static_cast<uint32_t>(data[0]) |
+           (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) |
+           (static_cast<uint32_t>(data[3]) << 24);
+}
+
+patch_stream::patch_stream(patch_source &source, stream_sink &next) : m_source(source),
+                                                                      m_next(next)
+{
+    mbedtls_sha256_init(&m_sha256);
+    mbedtls_sha256_starts(&m_sha256, 0);
+}
+
+patch_stream::~patch_stream()
+{
+    mbedtls_sha256_free(&m_sha256);
+}
+
+bool patch_stream::write(const uint8_t *data, size_t size)
+{
+    while (size)
+    {
+        switch (m_state)
+        {
+        case state::insert_data:
+        {
+            const size_t length = std::min(size, m_insert_remaining);
+
+            if (!emit(data, length))
+                return false;
+
+            data += length;
+            size -= length;
+            m_insert_remaining -= length;
+
+            if (!m_insert_remaining)
+                expect(state::opcode, 1U);
+
+            break;
+        }
+
+        case state::end:
+            return fail("data after the end of the patch!");
+
+        case state::failed:
+            return false;
+
+        default:
+        {
+            const size_t length = std::min(size, m_field_size - m_field_filled);
+
+            std::memcpy(m_field + m_field_filled, data, length);
+
+            data += length;
+            size -= length;
+            m_field_filled += length;
+
+            if (m_field_filled == m_field_size && !on_field())
+                return false;
+
+            break;
+        }
+        }
+    }
+
+    return true;
+}
+
+bool patch_stream::finish()
+{
+    if (m_state != state::end)
+        return fail("patch is truncated!");
+
+    if (m_written != m_target_size)
+        return fail("target size mismatch!");
+
+    uint8_t hash[HASH_SIZE];
+
+    mbedtls_sha256_finish(&m_sha256, hash);
+
+    if (std::memcmp(hash, m_target_hash, HASH_SIZE))
+        return fail("target hash mismatch!");
+
+    return m_next.finish();
+}
+
+void patch_stream::expect(const state next_state, const size_t field_size)
+{
+    m_state = next_state;
+    m_field_size = field_size;
+    m_field_filled = 0;
+}
+
+bool patch_stream::fail(const char *reason)
+{
+    ESP_LOGE(TAG, "%s", reason);
+
+    m_state = state::failed;
+
+    return false;
+}
+
+bool patch_stream::on_field()
+{
+    switch (m_state)
+    {
+    case state::header:
+        return on_header();
+
+    case state::opcode:
+        switch (m_field[0])
+        {
+        case OPCODE_END:
+            m_state = state::end;
+            return true;
+        case OPCODE_COPY:
+            expect(state::copy, 8U);
+            return true;
+        case OPCODE_INSERT:
+            expect(state::insert, 4U);
+            return true;
+        default:
+            return fail("invalid opcode!");
+        }
+
+    case state::copy:
+        if (!copy(read_u32(m_field), read_u32(m_field + 4)))
+            return false;
+
+        expect(state::opcode, 1U);
+
+        return true;
+
+    case state::insert:
+        m_insert_remaining = read_u32(m_field);
+
+        if (m_insert_remaining)
+            m_state = state::insert_data;
+        else
+            expect(state::opcode, 1U);
+
+        return true;
+
+    default:
+        return fail("unexpected state!");
+    }
+}
+
+bool patch_stream::on_header()
+{
+    if (std::memcmp(m_field, MAGIC, sizeof(MAGIC)) || m_field[4] != VERSION)
+        return fail("not a patch file!");
+
+    m_source_size = read_u32(m_field + 8);
+    m_target_size = read_u32(m_field + 12);
+
+    std::memcpy(m_source_hash, m_field + 16, HASH_SIZE);
+    std::memcpy(m_target_hash, m_field + 16 + HASH_SIZE, HASH_SIZE);
+
+    if (!verify_source())
+        return false;
+
+    ESP_LOGI(TAG, "applying patch, source: %zu bytes, target: %zu bytes", m_source_size, m_target_size);
+
+    expect(state::opcode, 1U);
+
+    return true;
+}
+
+bool patch_stream::verify_source()
+{
+    if (m_source_size > m_source.size())
+        return fail("source is smaller than the patch expects!");
+
+    mbedtls_sha256_context context;
+
+    mbedtls_sha256_init(&context);
+    mbedtls_sha256_starts(&context, 0);
+
+    for (size_t offset = 0; offset < m_source_size;)
+    {
+        const size_t length = std::min(m_source_size - offset, COPY_BUFFER_SIZE);
+
+        if (!m_source.read(offset, m_copy_buffer, length))
+        {
+            mbedtls_sha256_free(&context);
+
+            return fail("couldn't read the source!");
+        }
+
+        mbedtls_sha256_update(&context, m_copy_buffer, length);
+
+        offset += length;
+    }
+
+    uint8_t hash[HASH_SIZE];
+
+    mbedtls_sha256_finish(&context, hash);
+    mbedtls_sha256_free(&context);
+
+    if (std::memcmp(hash, m_source_hash, HASH_SIZE))
+        return fail("patch was made against a different source!");
+
+    return true;
+}
+
+bool patch_stream::copy(size_t offset, size_t length)
+{
+    if (offset > m_source_size || length > m_source_size - offset)
+        return fail("copy is out of the source bounds!");
+
+    while (length)
+    {
+        const size_t chunk = std::min(length, COPY_BUFFER_SIZE);
+
+        if (!m_source.read(offset, m_copy_buffer, chunk))
+            return fail("couldn't read the source!");
+
+        if (!emit(m_copy_buffer, chunk))
+            return false;
+
+        offset += chunk;
+        length -= chunk;
+    }
+
+    return true;
+}
+
+bool patch_stream::emit(const uint8_t *data, size_t size)
+{
+    if (size > m_target_size - m_written)
+        return fail("patch produces more than the target size!");
+
+    mbedtls_sha256_update(&m_sha256, data, size);
+
+    if (!m_next.write(data, size))
+    {
+        m_state = state::failed;
+
+        return false;
+    }
+
+    m_written += size;
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mbedtls/sha256.h>
+
+#include "stream_sink.h"
+
+class patch_source
+{
+public:
+    virtual ~patch_source() {}
+
+    virtual size_t size() const = 0;
+    virtual bool read(size_t offset, uint8_t *data, size_t size) = 0;
+};
+
+// applies an RCLD patch, see scripts/ota_pack.py for the format.
+class patch_stream : public stream_sink
+{
+public:
+    patch_stream(patch_source &source, stream_sink &next);
+    ~patch_stream();
+
+    bool write(const uint8_t *data, size_t size) override;
+    bool finish() override;
+
+private:
+    enum class state : uint8_t
+    {
+        header,
+        opcode,
+        copy,
+        insert,
+        insert_data,
+        end,
+        failed,
+    };
+
+    static constexpr size_t HEADER_SIZE = 80U;
+    static constexpr size_t HASH_SIZE = 32U;
+    static constexpr size_t COPY_BUFFER_SIZE = 1024U;
+
+    void expect(const state next_state, const size_t field_size);
+    bool fail(const char *reason);
+    bool on_field();
+    bool on_header();
+    bool verify_source();
+    bool copy(size_t offset, size_t length);
+    bool emit(const uint8_t *data, size_t size);
+
+    patch_source &m_source;
+    stream_sink &m_next;
+    mbedtls_sha256_context m_sha256;
+
+    state m_state = state::header;
+    uint8_t m_field[HEADER_SIZE];
+    size_t m_field_size = HEADER_SIZE;
+    size_t m_field_filled = 0;
+    size_t m_insert_remaining = 0;
+
+    size_t m_source_size = 0;
+    size_t m_target_size = 0;
+    size_t m_written = 0;
+    uint8_t m_source_hash[HASH_SIZE];
+    uint8_t m_target_hash[HASH_SIZE];
+    uint8_t m_copy_buffer[COPY_BUFFER_SIZE];
+};
\ No newline at end of file
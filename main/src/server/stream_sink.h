@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+class stream_sink
+{
+public:
+    virtual ~stream_sink() {}
+
+    virtual bool write(const uint8_t *data, size_t size) = 0;
+    virtual bool finish() = 0;
+};
\ No newline at end of file
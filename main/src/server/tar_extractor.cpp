@@ -0,0 +1,385 @@
+#include "tar_extractor.h"
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <sys/stat.h>
+
+#include <esp_log.h>
+
+constexpr const char *TAG = "tar_extractor";
+
+static size_t parse_octal(const uint8_t *field, const size_t size)
+{
+    size_t value = 0;
+
+    for (size_t i = 0; i < size && field[i]; i++)
+    {
+        if (field[i] == ' ')
+            continue;
+
+        if (field[i] < '0' || field[i] > '7')
+            break;
+
+        value = (value << 3) | (field[i] - '0');
+    }
+
+    return value;
+}
+
+static bool is_safe_path(const std::string &path)
+{
+    if (path.empty() || path.front() == '/')
+        return false;
+
+    size_t start = 0;
+
+    while (start <= path.size())
+    {
+        const size_t end = std::min(path.find('/', start), path.size());
+
+        if (path.compare(start, end - start, "..") == 0)
+            return false;
+
+        start = end + 1;
+    }
+
+    return true;
+}
+
+static bool from_hex(const char *hex, uint8_t *data, const size_t size)
+{
+    auto nibble = [](const char c) -> int
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+
+        return -1;
+    };
+
+    for (size_t i = 0; i < size; i++)
+    {
+        const int high = nibble(hex[2 * i]);
+        const int low = high < 0 ? -1 : nibble(hex[2 * i + 1]);
+
+        if (low < 0)
+            return false;
+
+        data[i] = (high << 4) | low;
+    }
+
+    return true;
+}
+
+tar_extractor::tar_extractor(const std::string &directory) : m_directory(directory)
+{
+    mbedtls_sha256_init(&m_sha256);
+}
+
+tar_extractor::~tar_extractor()
+{
+    if (mp_file)
+        fclose(mp_file);
+
+    mbedtls_sha256_free(&m_sha256);
+}
+
+bool tar_extractor::write(const uint8_t *data, size_t size)
+{
+    while (size)
+    {
+        switch (m_state)
+        {
+        case state::header:
+        {
+            const size_t length = std::min(size, BLOCK_SIZE - m_block_filled);
+
+            std::memcpy(m_block + m_block_filled, data, length);
+
+            data += length;
+            size -= length;
+            m_block_filled += length;
+
+            if (m_block_filled == BLOCK_SIZE)
+            {
+                m_block_filled = 0;
+
+                if (!on_header())
+                    return false;
+            }
+
+            break;
+        }
+
+        case state::file_data:
+        {
+            const size_t length = std::min(size, m_remaining);
+
+            if (fwrite(data, 1, length, mp_file) != length)
+                return fail_io("couldn't write file: ", m_file_name.c_str());
+
+            mbedtls_sha256_update(&m_sha256, data, length);
+
+            data += length;
+            size -= length;
+            m_remaining -= length;
+
+            if (!m_remaining && !close_file())
+                return false;
+
+            break;
+        }
+
+        case state::skip:
+        {
+            const size_t length = std::min(size, m_remaining);
+
+            data += length;
+            size -= length;
+            m_remaining -= length;
+
+            if (!m_remaining)
+                m_state = state::header;
+
+            break;
+        }
+
+        case state::end:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool tar_extractor::finish()
+{
+    if (m_state == state::failed)
+        return false;
+
+    if (m_state != state::end && !(m_state == state::header && m_zero_blocks))
+        return fail("archive is truncated!");
+
+    m_state = state::end;
+
+    return verify_manifest();
+}
+
+const tar_extractor::digest *tar_extractor::file_digest(const std::string &name) const
+{
+    const auto it = m_files.find(name);
+
+    return it == m_files.end() ? nullptr : &it->second.hash;
+}
+
+bool tar_extractor::fail(const char *reason, const char *name)
+{
+    ESP_LOGE(TAG, "%s%s", reason, name);
+
+    if (mp_file)
+    {
+        fclose(mp_file);
+
+        mp_file = nullptr;
+    }
+
+    m_state = state::failed;
+
+    return false;
+}
+
+bool tar_extractor::fail_io(const char *reason, const char *name)
+{
+    m_io_failed = true;
+
+    return fail(reason, name);
+}
+
+bool tar_extractor::on_header()
+{
+    if (std::all_of(m_block, m_block + BLOCK_SIZE, [](const uint8_t byte)
+                    { return !byte; }))
+    {
+        if (++m_zero_blocks == 2)
+            m_state = state::end;
+
+        return true;
+    }
+
+    m_zero_blocks = 0;
+
+    size_t checksum = 0;
+
+    for (size_t i = 0; i < BLOCK_SIZE; i++)
+        checksum += (i >= 148 && i < 156) ? ' ' : m_block[i];
+
+    if (checksum != parse_octal(m_block + 148, 8))
+        return fail("header checksum mismatch!");
+
+    const char *name_field = reinterpret_cast<const char *>(m_block);
+    const char *prefix_field = reinterpret_cast<const char *>(m_block + 345);
+
+    std::string name(name_field, strnlen(name_field, 100));
+
+    if (!std::memcmp(m_block + 257, "ustar", 5) && *prefix_field)
+        name = std::string(prefix_field, strnlen(prefix_field, 155)) + '/' + name;
+
+    while (!name.compare(0, 2, "./"))
+        name.erase(0, 2);
+
+    const size_t size = parse_octal(m_block + 124, 12);
+    const char type = m_block[156];
+
+    m_remaining = size;
+    m_padding = (BLOCK_SIZE - (size % BLOCK_SIZE)) % BLOCK_SIZE;
+
+    if (type == '0' || type == '\0')
+    {
+        if (!is_safe_path(name))
+            return fail("unsafe path: ", name.c_str());
+
+        if (!open_file(name))
+            return false;
+
+        if (!m_remaining)
+            return close_file();
+
+        m_state = state::file_data;
+
+        return true;
+    }
+
+    if (type == '5')
+    {
+        while (!name.empty() && name.back() == '/')
+            name.pop_back();
+
+        if (!name.empty())
+        {
+            if (!is_safe_path(name))
+                return fail("unsafe path: ", name.c_str());
+
+            const std::string path = m_directory + '/' + name;
+
+            if (mkdir(path.c_str(), 0755) && errno != EEXIST)
+                return fail_io("couldn't create directory: ", path.c_str());
+        }
+    }
+
+    m_remaining += m_padding;
+    m_state = m_remaining ? state::skip : state::header;
+
+    return true;
+}
+
+bool tar_extractor::open_file(const std::string &name)
+{
+    const std::string path = m_directory + '/' + name;
+
+    for (size_t separator = path.find('/', m_directory.size() + 1); separator != std::string::npos; separator = path.find('/', separator + 1))
+    {
+        const std::string parent = path.substr(0, separator);
+
+        if (mkdir(parent.c_str(), 0755) && errno != EEXIST)
+            return fail_io("couldn't create directory: ", parent.c_str());
+    }
+
+    mp_file = fopen(path.c_str(), "w");
+
+    if (!mp_file)
+        return fail_io("couldn't create file: ", path.c_str());
+
+    m_file_name = name;
+
+    mbedtls_sha256_starts(&m_sha256, 0);
+
+    return true;
+}
+
+bool tar_extractor::close_file()
+{
+    const bool closed = !fclose(mp_file);
+
+    mp_file = nullptr;
+
+    if (!closed)
+        return fail_io("couldn't close file: ", m_file_name.c_str());
+
+    auto &file = m_files[m_file_name];
+
+    mbedtls_sha256_finish(&m_sha256, file.hash.data());
+    file.verified = false;
+
+    m_remaining = m_padding;
+    m_state = m_remaining ? state::skip : state::header;
+
+    return true;
+}
+
+bool tar_extractor::verify_manifest()
+{
+    const std::string path = m_directory + '/' + MANIFEST_NAME;
+
+    FILE *manifest = fopen(path.c_str(), "r");
+
+    if (!manifest)
+        return fail("archive has no manifest!");
+
+    char line[256];
+
+    while (fgets(line, sizeof(line), manifest))
+    {
+        const size_t length = strcspn(line, "\r\n");
+
+        line[length] = '\0';
+
+        if (!length)
+            continue;
+
+        digest expected;
+
+        if (length < 2 * expected.size() + 2 || !from_hex(line, expected.data(), expected.size()))
+        {
+            fclose(manifest);
+
+            return fail("malformed manifest line: ", line);
+        }
+
+        const char *name = line + 2 * expected.size();
+
+        while (*name == ' ' || *name == '*')
+            name++;
+
+        while (!strncmp(name, "./", 2))
+            name += 2;
+
+        const auto file = m_files.find(name);
+
+        if (file == m_files.end() || file->second.hash != expected)
+        {
+            fclose(manifest);
+
+            return fail("manifest mismatch: ", name);
+        }
+
+        file->second.verified = true;
+    }
+
+    fclose(manifest);
+
+    // counting lines isn't enough, a file listed twice would cover for one that isn't.
+    for (const auto &[name, file] : m_files)
+        if (!file.verified && name != MANIFEST_NAME)
+            return fail("file missing from the manifest: ", name.c_str());
+
+    return true;
+}
\ No newline at end of file
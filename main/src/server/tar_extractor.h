@@ -0,0 +1,71 @@
+#pragma once
+
+#include <map>
+#include <array>
+#include <string>
+#include <cstdio>
+
+#include <mbedtls/sha256.h>
+
+#include "stream_sink.h"
+
+// extracts a ustar stream into a directory, checking every regular file against the
+// sha256sum formatted manifest the archive carries.
+class tar_extractor : public stream_sink
+{
+public:
+    using digest = std::array<uint8_t, 32>;
+
+    static constexpr const char *MANIFEST_NAME = "manifest.sha256";
+
+    tar_extractor(const std::string &directory);
+    ~tar_extractor();
+
+    bool write(const uint8_t *data, size_t size) override;
+    bool finish() override;
+
+    size_t file_count() const { return m_files.size(); }
+    const digest *file_digest(const std::string &name) const;
+
+    // whether it failed on the filesystem rather than on the archive's contents.
+    bool io_failed() const { return m_io_failed; }
+
+private:
+    enum class state : uint8_t
+    {
+        header,
+        file_data,
+        skip,
+        end,
+        failed,
+    };
+
+    struct extracted_file
+    {
+        digest hash;
+        bool verified;
+    };
+
+    static constexpr size_t BLOCK_SIZE = 512U;
+
+    bool fail(const char *reason, const char *name = "");
+    bool fail_io(const char *reason, const char *name);
+    bool on_header();
+    bool open_file(const std::string &name);
+    bool close_file();
+    bool verify_manifest();
+
+    const std::string m_directory;
+    state m_state = state::header;
+    bool m_io_failed = false;
+    uint8_t m_block[BLOCK_SIZE];
+    size_t m_block_filled = 0;
+    size_t m_zero_blocks = 0;
+    size_t m_remaining = 0;
+    size_t m_padding = 0;
+
+    FILE *mp_file = nullptr;
+    std::string m_file_name;
+    mbedtls_sha256_context m_sha256;
+    std::map<std::string, extracted_file> m_files;
+};
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "websocket_server.h"
 
+#include <limits>
 #include <vector>
 #include <cstring>
 
@@ -8,16 +9,33 @@
 #include <esp_http_server.h>
 
 #include "lock_guard.h"
+#include "memory/memory_account.h"
+#include "metrics/metrics.h"
+#include "task_config.h"
 
 using header_type = uint16_t;
 
 constexpr const char *TAG = "websocket_server";
-constexpr const UBaseType_t SERVER_CORE_ID = 1U;
-constexpr const UBaseType_t SERVER_PRIORITY = 5U;
 constexpr const size_t WS_RX_BUFFER_SIZE = 4U * 1024U;
 constexpr const size_t WS_TX_BUFFER_SIZE = 16U * 1024U;
 constexpr const size_t WS_TX_CHUNK_SIZE = 1024U;
 constexpr const size_t HEADER_SIZE = sizeof(header_type);
+constexpr const TickType_t RECEIVE_LOCK_TIMEOUT = pdMS_TO_TICKS(10);
+
+static memory_account websocket_memory("websocket");
+static lock_profile receive_lock("websocket_receive");
+static lock_profile transmit_lock("websocket_transmit");
+
+static metric_counter frames_received("rclink_websocket_frames_received_total", "Websocket frames received.");
+static metric_counter bytes_received("rclink_websocket_received_bytes_total", "Websocket payload bytes received.");
+static metric_counter frames_sent("rclink_websocket_frames_sent_total", "Websocket frames sent.");
+static metric_counter bytes_sent("rclink_websocket_sent_bytes_total", "Websocket payload bytes sent.");
+static metric_counter send_retries("rclink_websocket_send_retries_total", "Websocket frames that had to be sent again.");
+static metric_counter messages_received("rclink_websocket_messages_received_total", "Messages taken off the receive buffer.");
+static metric_counter messages_sent("rclink_websocket_messages_sent_total", "Messages queued for sending.");
+static metric_counter dropped_full("rclink_websocket_dropped_total", "Received data that was thrown away.", "reason=\"buffer_full\"");
+static metric_counter dropped_oversized("rclink_websocket_dropped_total", "Received data that was thrown away.", "reason=\"oversized\"");
+static metric_counter dropped_malformed("rclink_websocket_dropped_total", "Received data that was thrown away.", "reason=\"malformed\"");
 
 struct websocket_server_implementation
 {
@@ -25,8 +43,9 @@ struct websocket_server_implementation
     int socket_descriptor = -1;
     SemaphoreHandle_t receive_semaphore;
     SemaphoreHandle_t transmit_semaphore;
-    std::vector<uint8_t> receive_buffer;
+    std::vector<uint8_t, account_allocator<uint8_t>> receive_buffer{account_allocator<uint8_t>(websocket_memory)};
     std::vector<uint8_t> transmit_buffer;
+    size_t transmit_tracked = 0;
     size_t receive_discard;
     bool transmitting;
 };
@@ -42,7 +61,8 @@ static void shift_left(uint8_t *buffer, size_t size, size_t amount)
         std::memmove(buffer, buffer + amount, new_size);
 }
 
-static void shift_left(std::vector<uint8_t> &buffer, size_t amount)
+template <typename buffer_type>
+static void shift_left(buffer_type &buffer, size_t amount)
 {
     if (!amount)
         return;
@@ -59,11 +79,25 @@ static void shift_left(std::vector<uint8_t> &buffer, size_t amount)
         buffer.resize(0);
 }
 
+// tlvcpp only serializes into a plain vector, its capacity is booked whenever it changed.
+static void track_transmit_capacity(websocket_server_implementation &server_impl)
+{
+    const size_t capacity = server_impl.transmit_buffer.capacity();
+
+    if (capacity == server_impl.transmit_tracked)
+        return;
+
+    websocket_memory.untrack(server_impl.transmit_tracked);
+    websocket_memory.track(capacity);
+
+    server_impl.transmit_tracked = capacity;
+}
+
 static void send_async(void *arg)
 {
     auto server_impl = static_cast<websocket_server_implementation *>(arg);
 
-    lock_guard guard(server_impl->transmit_semaphore);
+    lock_guard guard(server_impl->transmit_semaphore, transmit_lock);
 
     if (server_impl->socket_descriptor == -1)
         return;
@@ -83,11 +117,16 @@ static void send_async(void *arg)
     {
         ESP_LOGW(TAG, "couldn't send frame! retrying...");
 
+        send_retries.add();
+
         httpd_queue_work(server_impl->handle, send_async, server_impl);
 
         return;
     }
 
+    frames_sent.add();
+    bytes_sent.add(ws_frame.len);
+
     server_impl->transmitting = !final;
 
     if (server_impl->transmitting)
@@ -109,6 +148,8 @@ static void send_async(void *arg)
 
         buffer.reserve(WS_TX_BUFFER_SIZE);
 
+        track_transmit_capacity(*server_impl);
+
         return;
     }
 
@@ -124,8 +165,8 @@ static void switch_client(websocket_server_implementation &server_impl)
         return;
 
     {
-        lock_guard rx_guard(server_impl.receive_semaphore);
-        lock_guard tx_guard(server_impl.transmit_semaphore);
+        lock_guard rx_guard(server_impl.receive_semaphore, receive_lock);
+        lock_guard tx_guard(server_impl.transmit_semaphore, transmit_lock);
 
         server_impl.socket_descriptor = client_descriptors[client_descriptors_size - 1];
         server_impl.receive_buffer.resize(0);
@@ -150,7 +191,7 @@ static esp_err_t handler(httpd_req_t *request)
     }
 
     {
-        lock_guard guard(server_impl->receive_semaphore);
+        lock_guard guard(server_impl->receive_semaphore, receive_lock);
 
         if (server_impl->socket_descriptor == -1)
             return ESP_FAIL;
@@ -173,6 +214,8 @@ static esp_err_t handler(httpd_req_t *request)
             {
                 ESP_LOGW(TAG, "receive buffer full!");
 
+                dropped_full.add();
+
                 return ESP_FAIL;
             }
 
@@ -186,6 +229,9 @@ static esp_err_t handler(httpd_req_t *request)
                 return ESP_FAIL;
             }
 
+            frames_received.add();
+            bytes_received.add(ws_frame.len);
+
             if (server_impl->receive_discard)
             {
                 const auto discardable = std::min(server_impl->receive_discard, ws_frame.len);
@@ -209,10 +255,13 @@ websocket_server::websocket_server(const uint16_t port) : mp_implementation(std:
     mp_implementation->receive_buffer.reserve(WS_RX_BUFFER_SIZE);
     mp_implementation->transmit_buffer.reserve(WS_TX_BUFFER_SIZE);
 
+    track_transmit_capacity(*mp_implementation);
+
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
 
-    config.task_priority = SERVER_PRIORITY;
-    config.core_id = SERVER_CORE_ID;
+    config.task_priority = WEBSOCKET_TASK.priority;
+    config.stack_size = WEBSOCKET_TASK.stack_size;
+    config.core_id = WEBSOCKET_TASK.core;
     config.server_port = port;
     config.ctrl_port += port;
     config.max_open_sockets = 5U;
@@ -239,13 +288,16 @@ websocket_server::~websocket_server()
 
     vSemaphoreDelete(mp_implementation->transmit_semaphore);
     vSemaphoreDelete(mp_implementation->receive_semaphore);
+
+    websocket_memory.untrack(mp_implementation->transmit_tracked);
 }
 
 websocket_server &websocket_server::operator>>(tlvcpp::tlv_tree_node &node)
 {
-    lock_guard guard(mp_implementation->receive_semaphore);
+    // polled, so rather come back later than stall behind a frame being received.
+    lock_guard guard(mp_implementation->receive_semaphore, receive_lock, RECEIVE_LOCK_TIMEOUT);
 
-    if (mp_implementation->socket_descriptor == -1)
+    if (!guard.owns_lock() || mp_implementation->socket_descriptor == -1)
         return *this;
 
     auto &buffer = mp_implementation->receive_buffer;
@@ -267,6 +319,8 @@ websocket_server &websocket_server::operator>>(tlvcpp::tlv_tree_node &node)
         {
             mp_implementation->receive_discard += (total_size - size);
 
+            dropped_oversized.add();
+
             dealt_with = buffer.size();
 
             break;
@@ -279,6 +333,8 @@ websocket_server &websocket_server::operator>>(tlvcpp::tlv_tree_node &node)
 
         if (received_node.deserialize(data + HEADER_SIZE, message_size))
         {
+            messages_received.add();
+
             if (received_node.data().tag())
                 node.add_child() = std::move(received_node);
             else
@@ -286,8 +342,12 @@ websocket_server &websocket_server::operator>>(tlvcpp::tlv_tree_node &node)
                     node.add_child() = std::move(child);
         }
         else
+        {
             ESP_LOGW(TAG, "deserialization error!");
 
+            dropped_malformed.add();
+        }
+
         dealt_with += total_size;
     }
 
@@ -298,7 +358,7 @@ websocket_server &websocket_server::operator>>(tlvcpp::tlv_tree_node &node)
 
 websocket_server &websocket_server::operator<<(const tlvcpp::tlv_tree_node &node)
 {
-    lock_guard guard(mp_implementation->transmit_semaphore);
+    lock_guard guard(mp_implementation->transmit_semaphore, transmit_lock);
 
     if (mp_implementation->socket_descriptor == -1)
         return *this;
@@ -310,8 +370,11 @@ websocket_server &websocket_server::operator<<(const tlvcpp::tlv_tree_node &node
         buffer.push_back(0);
 
     size_t bytes_written = 0;
+    const bool serialized = node.serialize(buffer, &bytes_written);
 
-    if (!node.serialize(buffer, &bytes_written))
+    track_transmit_capacity(*mp_implementation);
+
+    if (!serialized)
     {
         ESP_LOGW(TAG, "serialization error!");
 
@@ -331,6 +394,8 @@ websocket_server &websocket_server::operator<<(const tlvcpp::tlv_tree_node &node
 
     *message_size = bytes_written;
 
+    messages_sent.add();
+
     if (!mp_implementation->transmitting)
         httpd_queue_work(mp_implementation->handle, send_async, mp_implementation.get());
 
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+
+// placement of every long running task, all of it comes from the Tasks menu.
+struct task_config
+{
+    BaseType_t core;
+    UBaseType_t priority;
+    uint32_t stack_size;
+};
+
+constexpr const task_config HTTP_SERVER_TASK = {CONFIG_RCLINK_HTTP_SERVER_CORE, CONFIG_RCLINK_HTTP_SERVER_PRIORITY, CONFIG_RCLINK_HTTP_SERVER_STACK_SIZE};
+constexpr const task_config HTTP_WORKER_TASK = {CONFIG_RCLINK_HTTP_WORKER_CORE, CONFIG_RCLINK_HTTP_WORKER_PRIORITY, CONFIG_RCLINK_HTTP_WORKER_STACK_SIZE};
+constexpr const task_config WEBSOCKET_TASK = {CONFIG_RCLINK_WEBSOCKET_CORE, CONFIG_RCLINK_WEBSOCKET_PRIORITY, CONFIG_RCLINK_WEBSOCKET_STACK_SIZE};
+constexpr const task_config DISPATCH_TASK = {CONFIG_RCLINK_DISPATCH_CORE, CONFIG_RCLINK_DISPATCH_PRIORITY, CONFIG_RCLINK_DISPATCH_STACK_SIZE};
+constexpr const task_config OTA_WRITER_TASK = {CONFIG_RCLINK_OTA_WRITER_CORE, CONFIG_RCLINK_OTA_WRITER_PRIORITY, CONFIG_RCLINK_OTA_WRITER_STACK_SIZE};
+constexpr const task_config PHYSICS_TASK = {CONFIG_RCLINK_PHYSICS_CORE, CONFIG_RCLINK_PHYSICS_PRIORITY, CONFIG_RCLINK_PHYSICS_STACK_SIZE};
+constexpr const task_config SENSOR_TASK = {CONFIG_RCLINK_SENSOR_CORE, CONFIG_RCLINK_SENSOR_PRIORITY, CONFIG_RCLINK_SENSOR_STACK_SIZE};
\ No newline at end of file
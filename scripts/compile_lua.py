@@ -0,0 +1,88 @@
+import argparse
+import glob
+import hashlib
+import os
+import shutil
+import subprocess
+
+DEFAULT_DIRECTORY = os.path.join(os.path.dirname(__file__), '../main/app/scripts')
+REQUIRED_VERSION = 'Lua 5.4'
+
+
+def luac_version(luac):
+    result = subprocess.run([luac, '-v'], capture_output=True, text=True)
+
+    # older versions print it to stderr.
+    return (result.stdout or result.stderr).strip()
+
+
+def output_paths(source_path, directory, output):
+    bytecode_path = os.path.join(output, os.path.relpath(source_path, directory)) + 'c'
+
+    return bytecode_path, bytecode_path + '.sha256'
+
+
+def skip_script(source_path, directory, output):
+    bytecode_path, hash_path = output_paths(source_path, directory, output)
+
+    os.makedirs(os.path.dirname(bytecode_path), exist_ok=True)
+
+    # an empty hash never matches, the device compiles the source and caches it on first boot.
+    for path in (bytecode_path, hash_path):
+        open(path, 'w').close()
+
+
+def compile_script(luac, source_path, directory, output):
+    bytecode_path, hash_path = output_paths(source_path, directory, output)
+
+    with open(source_path, 'rb') as file:
+        source_hash = hashlib.sha256(file.read()).hexdigest()
+
+    if os.path.exists(bytecode_path) and os.path.exists(hash_path):
+        with open(hash_path) as file:
+            if file.read() == source_hash:
+                # only the timestamp changed, keep the build from asking again.
+                os.utime(bytecode_path)
+                os.utime(hash_path)
+
+                return False
+
+    os.makedirs(os.path.dirname(bytecode_path), exist_ok=True)
+    subprocess.run([luac, '-o', bytecode_path, source_path], check=True)
+
+    # written last, the loader only trusts bytecode with a matching source hash.
+    with open(hash_path, 'w') as file:
+        file.write(source_hash)
+
+    return True
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compiles the lua scripts to bytecode, laid out like their sources.')
+    parser.add_argument('--luac', default=shutil.which('luac5.4') or shutil.which('luac'))
+    parser.add_argument('--directory', default=DEFAULT_DIRECTORY)
+    parser.add_argument('--output', required=True, help='where the bytecode goes, the source tree stays untouched')
+    parser.add_argument('scripts', nargs='*', help='scripts to compile, every script in the directory by default')
+
+    arguments = parser.parse_args()
+    scripts = arguments.scripts or sorted(glob.glob(os.path.join(arguments.directory, '**/*.lua'), recursive=True))
+
+    # the build still gets the outputs it asked for, otherwise it would ask again every time.
+    if not arguments.luac:
+        for path in scripts:
+            skip_script(path, arguments.directory, arguments.output)
+
+        print('[compile_lua] luac not found, scripts will be compiled on the device.')
+        exit(0)
+
+    # bytecode of another version is rejected on the device and every boot compiles the
+    # source again, so that's an error rather than a silent slowdown.
+    version = luac_version(arguments.luac)
+
+    if not version.startswith(REQUIRED_VERSION):
+        print(f'[compile_lua] {arguments.luac} is "{version}", {REQUIRED_VERSION} is required, pass --luac.')
+        exit(1)
+
+    compiled = [path for path in scripts if compile_script(arguments.luac, path, arguments.directory, arguments.output)]
+
+    print(f'[compile_lua] compiled {len(compiled)} scripts.')
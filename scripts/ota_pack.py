@@ -0,0 +1,258 @@
+import argparse
+import hashlib
+import struct
+import zlib
+
+# RCLD patch format, all integers are little endian:
+#
+#   header:  'RCLD', version (u8), reserved (3 bytes), source size (u32), target size (u32),
+#            source sha256 (32 bytes), target sha256 (32 bytes)
+#   ops:     0x00                                end of patch
+#            0x01 offset (u32) length (u32)      copy from the running firmware
+#            0x02 length (u32) data              insert literal bytes
+
+MAGIC = b'RCLD'
+VERSION = 1
+HEADER_FORMAT = '<4sB3xII32s32s'
+OPCODE_END = 0
+OPCODE_COPY = 1
+OPCODE_INSERT = 2
+BLOCK_SIZE = 32
+MAX_OPERATION_SIZE = 0xFFFFFFFF
+
+
+def index_blocks(source):
+    index = {}
+
+    for offset in range(0, len(source) - BLOCK_SIZE + 1, BLOCK_SIZE):
+        index.setdefault(source[offset:offset + BLOCK_SIZE], offset)
+
+    return index
+
+
+def diff(source, target):
+    index = index_blocks(source)
+    operations = []
+    literal_start = 0
+    position = 0
+
+    def flush_literal(end):
+        if end > literal_start:
+            operations.append((OPCODE_INSERT, target[literal_start:end]))
+
+    while position + BLOCK_SIZE <= len(target):
+        offset = index.get(target[position:position + BLOCK_SIZE])
+
+        if offset is None:
+            position += 1
+
+            continue
+
+        start = position
+        end = position + BLOCK_SIZE
+        source_end = offset + BLOCK_SIZE
+
+        while start > literal_start and offset > 0 and target[start - 1] == source[offset - 1]:
+            start -= 1
+            offset -= 1
+
+        while end < len(target) and source_end < len(source) and target[end] == source[source_end]:
+            end += 1
+            source_end += 1
+
+        flush_literal(start)
+        operations.append((OPCODE_COPY, offset, end - start))
+
+        position = end
+        literal_start = end
+
+    flush_literal(len(target))
+
+    return operations
+
+
+def encode_patch(source, target, operations):
+    patch = bytearray(struct.pack(HEADER_FORMAT,
+                                  MAGIC,
+                                  VERSION,
+                                  len(source),
+                                  len(target),
+                                  hashlib.sha256(source).digest(),
+                                  hashlib.sha256(target).digest()))
+
+    for operation in operations:
+        if operation[0] == OPCODE_COPY:
+            patch += struct.pack('<BII', OPCODE_COPY, operation[1], operation[2])
+        else:
+            patch += struct.pack('<BI', OPCODE_INSERT, len(operation[1])) + operation[1]
+
+    patch += struct.pack('<B', OPCODE_END)
+
+    return bytes(patch)
+
+
+# reads a zlib stream like a file, the device inflates patches produced with --compress on
+# the fly as well.
+class InflatingReader:
+    def __init__(self, file, chunk_size=16384):
+        self.file = file
+        self.chunk_size = chunk_size
+        self.decompressor = zlib.decompressobj()
+        self.buffer = bytearray()
+
+    def read(self, size):
+        while len(self.buffer) < size and not self.decompressor.eof:
+            chunk = self.file.read(self.chunk_size)
+
+            if not chunk:
+                raise ValueError('compressed patch is truncated')
+
+            self.buffer += self.decompressor.decompress(chunk)
+
+        data = bytes(self.buffer[:size])
+        del self.buffer[:size]
+
+        return data
+
+
+def is_zlib(header):
+    # a zlib stream starts with a deflate method byte whose check bits make the first two
+    # bytes a multiple of 31, the patch magic never does.
+    return len(header) == 2 and header[0] & 0x0F == 8 and (header[0] << 8 | header[1]) % 31 == 0
+
+
+def open_patch(patch_file):
+    header = patch_file.read(2)
+    patch_file.seek(0)
+
+    return InflatingReader(patch_file) if is_zlib(header) else patch_file
+
+
+def apply_patch(source_file, patch_file, output_file, chunk_size=1024):
+    patch_file = open_patch(patch_file)
+    header = patch_file.read(struct.calcsize(HEADER_FORMAT))
+
+    if len(header) != struct.calcsize(HEADER_FORMAT):
+        raise ValueError('not a patch file')
+
+    magic, version, source_size, target_size, source_hash, target_hash = struct.unpack(HEADER_FORMAT, header)
+
+    if magic != MAGIC or version != VERSION:
+        raise ValueError('not a patch file')
+
+    source_digest = hashlib.sha256()
+    source_file.seek(0)
+
+    for offset in range(0, source_size, chunk_size):
+        source_digest.update(source_file.read(min(chunk_size, source_size - offset)))
+
+    if source_digest.digest() != source_hash:
+        raise ValueError('patch was made against a different source')
+
+    target_digest = hashlib.sha256()
+    written = 0
+
+    def emit(data):
+        nonlocal written
+
+        target_digest.update(data)
+        output_file.write(data)
+        written += len(data)
+
+    while True:
+        opcode = patch_file.read(1)
+
+        if not opcode:
+            raise ValueError('patch is truncated')
+
+        opcode = opcode[0]
+
+        if opcode == OPCODE_END:
+            break
+        elif opcode == OPCODE_COPY:
+            offset, length = struct.unpack('<II', patch_file.read(8))
+
+            if offset + length > source_size:
+                raise ValueError('copy is out of the source bounds')
+
+            source_file.seek(offset)
+
+            while length:
+                chunk = source_file.read(min(chunk_size, length))
+                emit(chunk)
+                length -= len(chunk)
+        elif opcode == OPCODE_INSERT:
+            length, = struct.unpack('<I', patch_file.read(4))
+
+            while length:
+                chunk = patch_file.read(min(chunk_size, length))
+
+                if not chunk:
+                    raise ValueError('patch is truncated')
+
+                emit(chunk)
+                length -= len(chunk)
+        else:
+            raise ValueError('invalid opcode')
+
+    if written != target_size or target_digest.digest() != target_hash:
+        raise ValueError('patched image does not match the target')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Prepares compressed and delta firmware updates.')
+    subparsers = parser.add_subparsers(dest='command', required=True)
+
+    compress_parser = subparsers.add_parser('compress', help='zlib compress an image, upload with "Content-Encoding: deflate"')
+    compress_parser.add_argument('image')
+    compress_parser.add_argument('output')
+
+    diff_parser = subparsers.add_parser('diff', help='create a patch, upload to /firmware.patch')
+    diff_parser.add_argument('source', help='image currently running on the device')
+    diff_parser.add_argument('target', help='new image')
+    diff_parser.add_argument('output')
+    diff_parser.add_argument('--compress', action='store_true', help='zlib compress the patch')
+
+    apply_parser = subparsers.add_parser('apply', help='apply a patch, compressed or not, the same way the device does')
+    apply_parser.add_argument('source')
+    apply_parser.add_argument('patch')
+    apply_parser.add_argument('output')
+
+    arguments = parser.parse_args()
+
+    if arguments.command == 'compress':
+        with open(arguments.image, 'rb') as file:
+            image = file.read()
+
+        output = zlib.compress(image, 9)
+
+        with open(arguments.output, 'wb') as file:
+            file.write(output)
+
+        print(f'{len(image)} -> {len(output)} bytes')
+    elif arguments.command == 'diff':
+        with open(arguments.source, 'rb') as file:
+            source = file.read()
+
+        with open(arguments.target, 'rb') as file:
+            target = file.read()
+
+        operations = diff(source, target)
+        output = encode_patch(source, target, operations)
+
+        if arguments.compress:
+            output = zlib.compress(output, 9)
+
+        with open(arguments.output, 'wb') as file:
+            file.write(output)
+
+        copied = sum(operation[2] for operation in operations if operation[0] == OPCODE_COPY)
+
+        print(f'{len(target)} -> {len(output)} bytes, {copied} bytes copied from the source')
+    elif arguments.command == 'apply':
+        with open(arguments.source, 'rb') as source_file, open(arguments.patch, 'rb') as patch_file, open(arguments.output, 'wb') as output_file:
+            apply_patch(source_file, patch_file, output_file)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,52 @@
+import argparse
+import hashlib
+import io
+import os
+import tarfile
+
+MANIFEST_NAME = 'manifest.sha256'
+DEFAULT_DIRECTORY = os.path.join(os.path.dirname(__file__), '../main/app/web')
+
+
+def collect_files(directory):
+    files = []
+
+    for root, _, names in os.walk(directory):
+        for name in sorted(names):
+            path = os.path.join(root, name)
+            files.append((os.path.relpath(path, directory).replace(os.sep, '/'), path))
+
+    return sorted(files)
+
+
+def pack(directory, output):
+    files = [entry for entry in collect_files(directory) if entry[0] != MANIFEST_NAME]
+    manifest = io.StringIO()
+
+    for name, path in files:
+        with open(path, 'rb') as file:
+            manifest.write(f'{hashlib.sha256(file.read()).hexdigest()}  {name}\n')
+
+    manifest_data = manifest.getvalue().encode()
+
+    with tarfile.open(output, 'w:gz', format=tarfile.USTAR_FORMAT) as tar:
+        info = tarfile.TarInfo(MANIFEST_NAME)
+        info.size = len(manifest_data)
+        tar.addfile(info, io.BytesIO(manifest_data))
+
+        for name, path in files:
+            tar.add(path, arcname=name, recursive=False)
+
+    return hashlib.sha256(manifest_data).hexdigest(), len(files)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Packs the web UI into a bundle for POST /bundle.tar.gz.')
+    parser.add_argument('output')
+    parser.add_argument('--directory', default=DEFAULT_DIRECTORY)
+
+    arguments = parser.parse_args()
+
+    manifest_hash, file_count = pack(arguments.directory, arguments.output)
+
+    print(f'packed {file_count} files, manifest sha256: {manifest_hash}')
@@ -0,0 +1,191 @@
+import argparse
+import glob
+import os
+import struct
+import zlib
+
+DEFAULT_PATTERN = os.path.join(os.path.dirname(__file__), '../main/sprites/ball_*.png')
+PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+CHANNELS = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}
+
+# lvgl 8 LV_IMG_CF_TRUE_COLOR_ALPHA layouts, the color in native byte order followed by alpha.
+VARIANTS = [
+    ('LV_COLOR_DEPTH == 32', lambda r, g, b, a: bytes((b, g, r, a))),
+    ('LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP', lambda r, g, b, a: struct.pack('>HB', rgb565(r, g, b), a)),
+    ('LV_COLOR_DEPTH == 16', lambda r, g, b, a: struct.pack('<HB', rgb565(r, g, b), a)),
+    ('LV_COLOR_DEPTH == 8', lambda r, g, b, a: bytes(((r & 0xe0) | ((g >> 5) << 2) | (b >> 6), a))),
+]
+
+
+def rgb565(r, g, b):
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+
+    if pa <= pb and pa <= pc:
+        return a
+
+    return b if pb <= pc else c
+
+
+def unfilter(data, width, height, stride):
+    rows = []
+    previous = bytearray(width * stride)
+    offset = 0
+
+    for _ in range(height):
+        kind = data[offset]
+        row = bytearray(data[offset + 1:offset + 1 + width * stride])
+        offset += 1 + width * stride
+
+        for i in range(len(row)):
+            left = row[i - stride] if i >= stride else 0
+            up = previous[i]
+            up_left = previous[i - stride] if i >= stride else 0
+
+            if kind == 1:
+                row[i] = (row[i] + left) & 0xff
+            elif kind == 2:
+                row[i] = (row[i] + up) & 0xff
+            elif kind == 3:
+                row[i] = (row[i] + ((left + up) >> 1)) & 0xff
+            elif kind == 4:
+                row[i] = (row[i] + paeth(left, up, up_left)) & 0xff
+            elif kind != 0:
+                raise ValueError(f'unknown filter type {kind}')
+
+        rows.append(row)
+        previous = row
+
+    return rows
+
+
+def decode_png(path):
+    with open(path, 'rb') as file:
+        data = file.read()
+
+    if data[:8] != PNG_SIGNATURE:
+        raise ValueError(f'{path}: not a png')
+
+    offset = 8
+    compressed = b''
+    palette = []
+    transparency = b''
+
+    while offset < len(data):
+        length, kind = struct.unpack('>I4s', data[offset:offset + 8])
+        chunk = data[offset + 8:offset + 8 + length]
+        offset += 12 + length
+
+        if kind == b'IHDR':
+            width, height, depth, color_type, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'PLTE':
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, length, 3)]
+        elif kind == b'tRNS':
+            transparency = chunk
+        elif kind == b'IDAT':
+            compressed += chunk
+        elif kind == b'IEND':
+            break
+
+    if depth != 8 or interlace or color_type not in CHANNELS:
+        raise ValueError(f'{path}: only non-interlaced 8 bit images are supported')
+
+    stride = CHANNELS[color_type]
+    pixels = []
+
+    for row in unfilter(zlib.decompress(compressed), width, height, stride):
+        for x in range(width):
+            p = row[x * stride:(x + 1) * stride]
+
+            if color_type == 6:
+                pixels.append(tuple(p))
+            elif color_type == 2:
+                pixels.append((*p, 255))
+            elif color_type == 4:
+                pixels.append((p[0], p[0], p[0], p[1]))
+            elif color_type == 0:
+                pixels.append((p[0], p[0], p[0], 255))
+            else:
+                alpha = transparency[p[0]] if p[0] < len(transparency) else 255
+                pixels.append((*palette[p[0]], alpha))
+
+    return width, height, pixels
+
+
+def format_bytes(data, indent='    ', per_line=24):
+    lines = []
+
+    for i in range(0, len(data), per_line):
+        lines.append(indent + ', '.join(f'0x{value:02x}' for value in data[i:i + per_line]) + ',')
+
+    return '\n'.join(lines)
+
+
+def generate(paths):
+    images = [decode_png(path) for path in paths]
+
+    if not images:
+        raise ValueError('no sprites found')
+
+    width, height, _ = images[0]
+
+    if any(image[0] != width or image[1] != height for image in images):
+        raise ValueError('all sprites must have the same size')
+
+    # sprites are stacked vertically so each one is a contiguous slice of the atlas.
+    pixels = [pixel for image in images for pixel in image[2]]
+
+    source = [
+        '// generated by scripts/sprite_atlas.py from ' + ', '.join(os.path.basename(path) for path in paths) + ', do not edit.',
+        '',
+        '#include "render/sprites.h"',
+        '',
+    ]
+
+    for i, (condition, convert) in enumerate(VARIANTS):
+        data = b''.join(convert(*pixel) for pixel in pixels)
+
+        source += [
+            ('#if ' if i == 0 else '#elif ') + condition,
+            'static const uint8_t atlas[] = {',
+            format_bytes(data),
+            '};',
+        ]
+
+    source += [
+        '#else',
+        '#error "unsupported LV_COLOR_DEPTH"',
+        '#endif',
+        '',
+        f'static_assert(BALL_SPRITE_COUNT == {len(images)}, "sprite count mismatch");',
+        f'static_assert(BALL_SPRITE_SIZE == {width} && BALL_SPRITE_SIZE == {height}, "sprite size mismatch");',
+        '',
+        'constexpr uint32_t SPRITE_DATA_SIZE = sizeof(atlas) / BALL_SPRITE_COUNT;',
+        '',
+        'const lv_img_dsc_t ball_sprites[BALL_SPRITE_COUNT] = {',
+    ]
+
+    for i in range(len(images)):
+        source.append(f'    {{.header = {{.cf = LV_IMG_CF_TRUE_COLOR_ALPHA, .always_zero = 0, .reserved = 0, .w = {width}, .h = {height}}}, '
+                      f'.data_size = SPRITE_DATA_SIZE, .data = atlas + {i} * SPRITE_DATA_SIZE}},')
+
+    source += ['};', '']
+
+    return '\n'.join(source)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Converts the ball sprites into a pre-decoded lvgl image atlas.')
+    parser.add_argument('output')
+    parser.add_argument('--pattern', default=DEFAULT_PATTERN)
+
+    arguments = parser.parse_args()
+
+    source = generate(sorted(glob.glob(arguments.pattern)))
+
+    with open(arguments.output, 'w') as file:
+        file.write(source)